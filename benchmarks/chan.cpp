@@ -0,0 +1,141 @@
+/**
+ * @brief Throughput of the runtime channels against a mutex-protected queue.
+ * @file chan.cpp
+ *
+ * Usage: bench-chan [messages per producer] [capacity]
+ *
+ * Every configuration moves the same messages from its producers to its
+ * consumers through one bounded queue, with blocking sends and receives.
+ */
+
+#include "verte.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief A bounded queue behind a lock, what programs used before channels.
+ */
+class LockedQueue {
+public:
+  explicit LockedQueue(size_t capacity) : capacity(capacity) {}
+
+  void send(int64_t value) {
+    std::unique_lock lock(mutex);
+    notFull.wait(lock, [&] { return values.size() < capacity; });
+    values.push_back(value);
+    lock.unlock();
+    notEmpty.notify_one();
+  }
+
+  int64_t recv() {
+    std::unique_lock lock(mutex);
+    notEmpty.wait(lock, [&] { return !values.empty(); });
+    const int64_t value = values.front();
+    values.pop_front();
+    lock.unlock();
+    notFull.notify_one();
+    return value;
+  }
+
+private:
+  size_t capacity;
+  std::mutex mutex;
+  std::condition_variable notFull, notEmpty;
+  std::deque<int64_t> values;
+};
+
+/**
+ * @brief Adapts a runtime channel to the interface of the locked queue.
+ */
+class Channel {
+public:
+  explicit Channel(size_t capacity)
+      : chan(verte_chan_new(static_cast<int32_t>(capacity))) {}
+
+  ~Channel() { verte_chan_free(chan); }
+
+  void send(int64_t value) { verte_chan_send(chan, value); }
+  int64_t recv() { return verte_chan_recv(chan); }
+
+private:
+  verte_chan *chan;
+};
+
+/**
+ * @brief Move the messages of the producers to the consumers.
+ * @return Millions of messages per second.
+ */
+template <typename Queue>
+static double run(int producers, int consumers, int64_t messages,
+                  size_t capacity) {
+  Queue queue(capacity);
+  const int64_t total = messages * producers;
+
+  std::vector<int64_t> sums(consumers);
+  std::vector<std::thread> threads;
+  const auto start = Clock::now();
+
+  for (int p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for (int64_t i = 0; i < messages; ++i)
+        queue.send(p * messages + i);
+    });
+
+  for (int c = 0; c < consumers; ++c)
+    threads.emplace_back([&, c] {
+      // Split the messages evenly, the first consumers take the remainder.
+      const int64_t share = total / consumers + (c < total % consumers);
+      for (int64_t i = 0; i < share; ++i)
+        sums[c] += queue.recv();
+    });
+
+  for (auto &thread : threads)
+    thread.join();
+
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  // Every message arrives exactly once.
+  int64_t sum = 0;
+  for (int64_t value : sums)
+    sum += value;
+
+  if (sum != total * (total - 1) / 2)
+    std::abort();
+
+  return total / seconds / 1e6;
+}
+
+int main(int argc, char **argv) {
+  const int64_t messages = argc > 1 ? std::atoll(argv[1]) : 1000000;
+  const size_t capacity = argc > 2 ? std::atoll(argv[2]) : 1024;
+
+  std::cout << std::format("{:<12} {:>14} {:>14}\n", "threads",
+                           "chan Mmsg/s", "mutex Mmsg/s");
+
+  const std::pair<int, int> configurations[] = {
+      {1, 1}, {2, 2}, {4, 4}, {1, 4}, {4, 1}};
+
+  for (auto [producers, consumers] : configurations) {
+    const double chan = run<Channel>(producers, consumers, messages, capacity);
+    const double locked =
+        run<LockedQueue>(producers, consumers, messages, capacity);
+
+    std::cout << std::format("{:<12} {:>14.2f} {:>14.2f}\n",
+                             std::format("{}P/{}C", producers, consumers),
+                             chan, locked);
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @brief Throughput of the AST dumps against parsing.
+ * @file dump.cpp
+ *
+ * Usage: bench-dump [functions]
+ *
+ * Parses a generated source, then dumps its AST in every format to a stream
+ * counting the bytes and discarding them.
+ */
+
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/json.hpp"
+#include "verte/frontend/visitors/pretty.hpp"
+#include "verte/frontend/visitors/sexpr.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int functions) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  for (int i = 0; i < functions; ++i) {
+    source += std::format("fn f{}(x: int, y: int) -> int {{\n"
+                          "  z: int = x * {} + y / 3 - LIMIT;\n"
+                          "  if [z > LIMIT] then {{ return f{}(z - 1, y); }}\n"
+                          "  return z + x * y;\n"
+                          "}}\n\n",
+                          i, i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+/**
+ * @class CountingBuffer
+ * @brief A stream buffer counting and discarding its output.
+ */
+class CountingBuffer : public std::streambuf {
+public:
+  size_t bytes = 0; /**< The bytes written. */
+
+protected:
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    bytes += static_cast<size_t>(count);
+    return count;
+  }
+
+  int_type overflow(int_type c) override {
+    bytes++;
+    return c;
+  }
+};
+
+static double elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Time a dump of the AST.
+ */
+template <typename Printer>
+static void run(const char *name, const nodes::ProgramNode &ast) {
+  CountingBuffer buffer;
+  std::ostream out(&buffer);
+  const auto start = Clock::now();
+
+  {
+    Printer printer(out);
+    ast.accept(printer);
+  }
+
+  const auto bytes = static_cast<double>(buffer.bytes);
+  const double ms = elapsed(start);
+  std::cout << std::format("{:<8} {:>10.1f} ms {:>10.1f} MB/s\n", name, ms,
+                           bytes / 1e3 / ms);
+}
+
+int main(int argc, char **argv) {
+  const int functions = argc > 1 ? std::atoi(argv[1]) : 40000;
+  const std::string source = generateSource(functions);
+
+  // Each function makes about 25 nodes.
+  auto start = Clock::now();
+  lexer::Lexer lexer(source);
+  nodes::Parser parser(lexer.allTokens());
+  const auto ast = parser.parse();
+  std::cout << std::format("{:<8} {:>10.1f} ms\n", "parse", elapsed(start));
+
+  run<visitors::PrettyPrinter>("text", *ast);
+  run<visitors::JsonPrinter>("json", *ast);
+  run<visitors::SexprPrinter>("sexpr", *ast);
+
+  return 0;
+}
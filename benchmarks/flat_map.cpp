@@ -0,0 +1,115 @@
+/**
+ * @brief The flat hash map against the standard containers.
+ * @file flat_map.cpp
+ *
+ * Usage: bench-flat_map [keys] [lookups]
+ *
+ * Times inserting identifier-like keys, looking them up, missing them, and
+ * the keyword lookup of the lexer on a mix of keywords and identifiers.
+ */
+
+#include "verte/frontend/lexer/token.hpp"
+#include "verte/utils/flat_map.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Keep a value alive past the optimizer.
+ */
+template <typename T> static void keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+static double elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Time a map type on the keys.
+ */
+template <typename Map>
+static void run(const char *name, const std::vector<std::string> &keys,
+                const std::vector<std::string> &missing, size_t lookups) {
+  auto start = Clock::now();
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i)
+    map[keys[i]] = static_cast<int>(i);
+
+  const double insert = elapsed(start);
+
+  start = Clock::now();
+  long sum = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    sum += map.find(keys[i % keys.size()])->second;
+
+  keep(sum);
+  const double hit = elapsed(start);
+
+  start = Clock::now();
+  size_t found = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    found += map.contains(missing[i % missing.size()]);
+
+  keep(found);
+  const double miss = elapsed(start);
+
+  std::cout << std::format("{:<20} insert {:>8.2f} ms  hit {:>8.2f} ms  "
+                           "miss {:>8.2f} ms\n",
+                           name, insert, hit, miss);
+}
+
+int main(int argc, char **argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  const size_t lookups =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10'000'000;
+
+  std::mt19937 random(42);
+  std::vector<std::string> keys, missing;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back(std::format("value_{}", random()));
+    missing.push_back(std::format("other_{}", random()));
+  }
+
+  run<std::unordered_map<std::string, int>>("std::unordered_map", keys,
+                                            missing, lookups);
+  run<utils::FlatMap<std::string, int>>("utils::FlatMap", keys, missing,
+                                        lookups);
+
+  // The lexer looks every identifier up among the keywords.
+  std::vector<std::string> words = {"fn", "return", "x", "counter", "if",
+                                    "then", "value", "else", "const", "y"};
+  std::unordered_map<std::string, lexer::Token::Type> reserved(
+      tokens::RESERVED.begin(), tokens::RESERVED.end());
+
+  auto start = Clock::now();
+  size_t hits = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    hits += reserved.find(words[i % words.size()]) != reserved.end();
+
+  keep(hits);
+  std::cout << std::format("{:<20} keywords {:>8.2f} ms\n",
+                           "std::unordered_map", elapsed(start));
+
+  start = Clock::now();
+  hits = 0;
+  for (size_t i = 0; i < lookups; ++i)
+    hits += tokens::RESERVED.find(words[i % words.size()]) !=
+            tokens::RESERVED.end();
+
+  keep(hits);
+  std::cout << std::format("{:<20} keywords {:>8.2f} ms\n", "utils::FlatMap",
+                           elapsed(start));
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @brief End-to-end latency of a debug build, -O0 against the previous path.
+ * @file latency.cpp
+ *
+ * Usage: bench-latency [functions] [runs]
+ *
+ * The previous path verified the module and emitted it with the default
+ * backend, SelectionDAG and the greedy register allocator. The -O0 path skips
+ * the verifier and emits with FastISel and the fast register allocator.
+ */
+
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int functions) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  for (int i = 0; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  y: int = x * {};\n"
+                          "  if [y > LIMIT] then {{ return f{}(y - 1); }}\n"
+                          "  return y + x;\n"
+                          "}}\n\n",
+                          i, i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+static double milliseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/**
+ * @struct Timings
+ * @brief The wall time of each stage of a compilation.
+ */
+struct Timings {
+  std::chrono::nanoseconds generate{}; /**< Lex, parse, generate, verify. */
+  std::chrono::nanoseconds emit{};     /**< The backend. */
+  size_t bytes = 0;                    /**< Size of the object. */
+};
+
+/**
+ * @brief Compile the source to an object.
+ * @param verify Whether the module is verified.
+ * @param backendLevel The optimization level of the backend.
+ */
+static Timings run(const std::string &source, bool verify,
+                   unsigned backendLevel) {
+  Options options;
+  options.verify = verify;
+
+  Timings timings;
+  Result result;
+  llvm::LLVMContext context;
+
+  auto start = Clock::now();
+  auto module = generate(source, context, options, result);
+  if (!module)
+    std::abort();
+
+  timings.generate = Clock::now() - start;
+
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream out(buffer);
+  std::string error;
+
+  start = Clock::now();
+  codegen::Compiler compiler(backendLevel);
+  if (!compiler.emit(*module, out, llvm::CGFT_ObjectFile, error))
+    std::abort();
+
+  timings.emit = Clock::now() - start;
+  timings.bytes = buffer.size();
+  return timings;
+}
+
+int main(int argc, char **argv) {
+  const int functions = argc > 1 ? std::atoi(argv[1]) : 10000;
+  const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+  const std::string source = generateSource(functions);
+
+  // Keep the fastest run of each, the others pay for the page faults.
+  auto best = [&](bool verify, unsigned backendLevel) {
+    Timings fastest = run(source, verify, backendLevel);
+    for (int i = 1; i < runs; ++i) {
+      const Timings timings = run(source, verify, backendLevel);
+      if (timings.generate + timings.emit < fastest.generate + fastest.emit)
+        fastest = timings;
+    }
+
+    return fastest;
+  };
+
+  const Timings previous = best(true, 2);
+  const Timings fast = best(false, 0);
+
+  std::cout << std::format("{:<12} {:>12} {:>12} {:>12} {:>12}\n", "path",
+                           "generate ms", "emit ms", "total ms", "object KiB");
+
+  for (const auto &[name, timings] :
+       {std::pair{"previous", previous}, std::pair{"-O0", fast}})
+    std::cout << std::format(
+        "{:<12} {:>12.1f} {:>12.1f} {:>12.1f} {:>12}\n", name,
+        milliseconds(timings.generate), milliseconds(timings.emit),
+        milliseconds(timings.generate + timings.emit), timings.bytes / 1024);
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @brief Latency of the language server on a large document.
+ * @file lsp.cpp
+ *
+ * Usage: bench-lsp [lines]
+ */
+
+#include "verte/driver/lsp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int lines) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  // Six lines per function.
+  for (int i = 0; i < lines / 6; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  y: int = x * {};\n"
+                          "  if [y > LIMIT] then {{ return f{}(y - 1); }}\n"
+                          "  return y + x;\n"
+                          "}}\n\n",
+                          i, i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+static double elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+static double median(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+int main(int argc, char **argv) {
+  const int lines = argc > 1 ? std::atoi(argv[1]) : 100000;
+  const std::string source = generateSource(lines);
+
+  auto start = Clock::now();
+  lsp::Document document(source);
+  std::cout << std::format("{:<28} {:>10.3f} ms ({} items)\n", "open",
+                           elapsed(start), document.getStats().items);
+
+  // Type inside a function in the middle, as an editor sends it.
+  std::vector<double> edits;
+  const auto position =
+      document.toPosition(document.getText().find("y + x", source.size() / 2));
+
+  for (int i = 0; i < 50; ++i) {
+    start = Clock::now();
+    document.edit(position, position, i % 2 ? " " : "");
+    const auto diagnostics = document.getDiagnostics();
+    edits.push_back(elapsed(start));
+
+    if (!diagnostics.empty())
+      std::abort();
+  }
+
+  std::cout << std::format("{:<28} {:>10.3f} ms ({} items reparsed)\n",
+                           "edit + diagnostics (median)", median(edits),
+                           document.getStats().reparsed);
+
+  // Definitions and hovers all over the document.
+  const std::string &text = document.getText();
+  std::vector<uint32_t> offsets;
+  for (size_t offset = text.find("LIMIT", 10); offset != std::string::npos;
+       offset = text.find("LIMIT", offset + 1))
+    offsets.push_back(static_cast<uint32_t>(offset));
+
+  size_t found = 0;
+  start = Clock::now();
+  for (uint32_t offset : offsets)
+    found += document.lookup(offset).has_value();
+
+  std::cout << std::format("{:<28} {:>10.3f} us ({} of {} resolved)\n",
+                           "lookup (mean)",
+                           elapsed(start) * 1000 / offsets.size(), found,
+                           offsets.size());
+
+  start = Clock::now();
+  const size_t symbols = document.getSymbols().size();
+  std::cout << std::format("{:<28} {:>10.3f} ms ({} symbols)\n",
+                           "document symbols", elapsed(start), symbols);
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @brief Edit-compile latency of function-granular object reuse.
+ * @file objects.cpp
+ *
+ * Usage: bench-objects [functions] [level]
+ *
+ * Compiles a source into a fresh store, then again after editing a single
+ * function, and compares with compiling the whole module each time.
+ */
+
+#include "verte/driver/objects.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int functions, int edited) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  for (int i = 0; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  y: int = x * {};\n"
+                          "  if [y > LIMIT] then {{ return f{}(y - 1); }}\n"
+                          "  return y + x;\n"
+                          "}}\n\n",
+                          i, i == edited ? 11 : i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+static double elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  const int functions = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+  Options options;
+  options.optLevel = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 2;
+
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-bench-objects-{}", getpid());
+  std::filesystem::remove_all(directory);
+
+  const std::string source = generateSource(functions, -1);
+  const std::string edited = generateSource(functions, functions / 2);
+
+  objects::FunctionCompiler compiler(options, directory);
+  auto run = [&](const char *name, const std::string &version) {
+    const auto start = Clock::now();
+    if (!compiler.compile(version).success())
+      std::abort();
+
+    std::cout << std::format("{:<10} {:>10.1f} ms ({}/{} functions reused)\n",
+                             name, elapsed(start), compiler.getStats().reused,
+                             compiler.getStats().functions);
+  };
+
+  run("cold", source);
+  run("edit", edited);
+  run("revert", source);
+
+  const auto start = Clock::now();
+  if (!compile(edited, options).success())
+    std::abort();
+
+  std::cout << std::format("{:<10} {:>10.1f} ms\n", "whole", elapsed(start));
+
+  std::filesystem::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @brief Wall time of a pipelined compilation against a sequential one.
+ * @file pipeline.cpp
+ *
+ * Usage: bench-pipeline [functions] [optimization level]
+ */
+
+#include "verte/driver/pipeline.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int functions) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  for (int i = 0; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  y: int = x * {};\n"
+                          "  if [y > LIMIT] then {{ return f{}(y - 1); }}\n"
+                          "  return y + x;\n"
+                          "}}\n\n",
+                          i, i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+static double milliseconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char **argv) {
+  const int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+  const std::string source = generateSource(functions);
+
+  Options options;
+  options.optLevel = argc > 2 ? std::atoi(argv[2]) : 2;
+
+  auto start = Clock::now();
+  if (!compile(source, options).success())
+    std::abort();
+
+  const auto sequential = Clock::now() - start;
+
+  pipeline::PipelinedCompiler compiler(options);
+  start = Clock::now();
+  if (!compiler.compile(source).success())
+    std::abort();
+
+  const auto pipelined = Clock::now() - start;
+  const auto &stats = compiler.getStats();
+
+  std::cout << std::format("{:<24} {:>10.1f} ms\n", "sequential",
+                           milliseconds(sequential));
+  std::cout << std::format("{:<24} {:>10.1f} ms ({} items)\n", "pipelined",
+                           milliseconds(pipelined), stats.items);
+
+  // The pipeline tends to its slowest stage, plus the emission.
+  std::cout << std::format("{:<24} {:>10.1f} ms\n", "  lex",
+                           milliseconds(stats.lex));
+  std::cout << std::format("{:<24} {:>10.1f} ms\n", "  parse",
+                           milliseconds(stats.parse));
+  std::cout << std::format("{:<24} {:>10.1f} ms\n", "  generate + optimize",
+                           milliseconds(stats.generate));
+  std::cout << std::format("{:<24} {:>10.1f} ms\n", "  emit",
+                           milliseconds(stats.emit));
+
+  return 0;
+}
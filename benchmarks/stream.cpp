@@ -0,0 +1,80 @@
+/**
+ * @brief Peak memory of a streamed compilation against a whole one.
+ * @file stream.cpp
+ *
+ * Usage: bench-stream [functions]
+ *
+ * The streamed compilation runs first, the peak of the process then only
+ * grows with the whole compilation.
+ */
+
+#include "verte/driver/stream.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+
+using namespace verte;
+using Clock = std::chrono::steady_clock;
+
+static std::string generateSource(int functions) {
+  std::string source = "const LIMIT: int = 1000;\n";
+
+  for (int i = 0; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  y: int = x * {};\n"
+                          "  if [y > LIMIT] then {{ return f{}(y - 1); }}\n"
+                          "  return y + x;\n"
+                          "}}\n\n",
+                          i, i % 7 + 1, i > 0 ? i - 1 : 0);
+  }
+
+  return source;
+}
+
+static double peakMegabytes() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024;
+}
+
+static double elapsed(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+int main(int argc, char **argv) {
+  const int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+  // The source is held in memory here, as it would be in the page cache.
+  std::istringstream in(generateSource(functions));
+  const double baseline = peakMegabytes();
+
+  auto start = Clock::now();
+  size_t bytes = 0;
+  stream::StreamingCompiler compiler({});
+  if (!compiler.compile(in, [&](std::string_view output) {
+         bytes += output.size();
+       }).success())
+    std::abort();
+
+  std::cout << std::format("{:<10} {:>10.1f} ms {:>8.1f} MB peak ({} modules, "
+                           "{} KB of objects)\n",
+                           "streamed", elapsed(start),
+                           peakMegabytes() - baseline,
+                           compiler.getStats().modules, bytes / 1024);
+
+  start = Clock::now();
+  if (!compile(in.str()).success())
+    std::abort();
+
+  std::cout << std::format("{:<10} {:>10.1f} ms {:>8.1f} MB peak\n", "whole",
+                           elapsed(start), peakMegabytes() - baseline);
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * @brief Compilation throughput of concurrent, independent pipelines.
+ * @file throughput.cpp
+ *
+ * Usage: bench-throughput [compilations per thread] [functions per source]
+ */
+
+#include "verte/driver/compile.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace verte;
+
+static std::string generateSource(int functions) {
+  std::string source = "fn f0(x: int) -> int { return x + 1; }\n";
+
+  for (int i = 1; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  if [x > {}] then {{ return f{}(x - 1) * 2; }}\n"
+                          "  return x % {};\n"
+                          "}}\n",
+                          i, i, i - 1, i + 1);
+  }
+
+  return source;
+}
+
+int main(int argc, char **argv) {
+  const int compilations = argc > 1 ? std::atoi(argv[1]) : 32;
+  const int functions = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  const std::string source = generateSource(functions);
+  const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  double baseline = 0;
+  std::cout << std::format("{:>8} {:>16} {:>10}\n", "threads", "compiles/s",
+                           "speedup");
+
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&] {
+        for (int i = 0; i < compilations; ++i) {
+          if (!compile(source).success())
+            std::abort();
+        }
+      });
+    }
+
+    for (auto &worker : workers)
+      worker.join();
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const double throughput = threads * compilations / elapsed.count();
+    if (threads == 1)
+      baseline = throughput;
+
+    std::cout << std::format("{:>8} {:>16.1f} {:>9.2f}x\n", threads,
+                             throughput, throughput / baseline);
+  }
+
+  return 0;
+}
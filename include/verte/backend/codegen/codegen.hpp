@@ -7,12 +7,16 @@
 #define VERTE_BACKEND_CODEGEN_CODEGEN_HPP
 
 #include "verte/frontend/visitors/base.hpp"
+#include "verte/utils/flat_map.hpp"
 #include "verte/utils/logger.hpp"
 
+#include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <memory>
+#include <string_view>
+#include <vector>
 
 /**
  * @namespace verte::codegen
@@ -31,6 +35,29 @@ namespace verte::codegen {
    * @brief Unique pointer to an LLVM IR builder.
    */
   using BuilderPtr = std::unique_ptr<llvm::IRBuilder<>>;
+
+  /**
+   * @enum Overflow
+   * @brief The behavior of the integer arithmetic on overflow.
+   */
+  enum class Overflow : uint8_t {
+    WRAP,    /**< Wrap around silently, as two's complement. */
+    TRAP,    /**< Abort the program. */
+    SATURATE /**< Clamp to the bounds of the type. */
+  };
+
+  /**
+   * @struct Options
+   * @brief Options controlling the code generation.
+   */
+  struct Options {
+    bool bench = false;  /**< Emit `bench` blocks and a harness `main`. */
+    bool shared = false; /**< Hide every symbol not marked `#[export]`. */
+    bool framePointers = false; /**< Keep the frame pointers, for profilers
+                                   unwinding the stack. */
+    Overflow overflow = Overflow::WRAP; /**< Integer overflow behavior, unless
+                                           a function sets its own. */
+  };
 } // namespace verte::codegen
 
 /**
@@ -51,9 +78,12 @@ namespace verte::codegen {
      * @brief Construct a new Codegen.
      * @param context LLVM context.
      * @param module LLVM module.
+     * @param options Code generation options.
      */
-    Codegen(llvm::LLVMContext &context, ModulePtr module)
-        : context(context), currentFunc(), logger("codegen") {
+    Codegen(llvm::LLVMContext &context, ModulePtr module,
+            Options options = {})
+        : context(context), options(options), currentFunc(),
+          overflow(options.overflow), logger("codegen") {
       this->builder = std::make_unique<llvm::IRBuilder<>>(context);
       this->module = std::move(module);
       initTable();
@@ -65,6 +95,52 @@ namespace verte::codegen {
      */
     llvm::Module &getModule() const;
 
+    /**
+     * @brief Take the ownership of the module, once generation is done.
+     * @return The module.
+     */
+    ModulePtr takeModule();
+
+    /**
+     * @brief Attach the lines of the source to the generated instructions, as
+     * a line table. Call it before generating the programs of the source.
+     * @param source The source the programs were parsed from.
+     * @param fileName The name of the source file.
+     */
+    void attachLines(std::string_view source, const std::string &fileName);
+
+    /**
+     * @brief Generate several programs as one, i.e the cached items of a
+     * source.
+     * @param parts The programs, in source order.
+     */
+    void generate(const std::vector<const ProgramNode *> &parts);
+
+    /**
+     * @brief Generate a program after the previous ones, i.e an item of a
+     * source streamed through the pipeline.
+     * @param part The program.
+     * @return The functions defined by the program, i.e to optimize them.
+     */
+    std::vector<llvm::Function *> append(const ProgramNode &part);
+
+    /**
+     * @brief Complete the module once every program was appended.
+     * @return The functions defined to complete it.
+     */
+    std::vector<llvm::Function *> finalize();
+
+    /**
+     * @brief Take the module generated so far, and go on in a new one.
+     *
+     * The symbols of the taken module are declared in the new one on first
+     * use. Its local functions, i.e benchmarks, become hidden so that the
+     * harness can reach them.
+     *
+     * @return The module generated so far.
+     */
+    ModulePtr split();
+
     /**
      * @brief Visit a ProgramNode.
      * @param node The ProgramNode to visit.
@@ -157,6 +233,20 @@ namespace verte::codegen {
      */
     auto visit(const ReturnNode &node) -> RetT override;
 
+    /**
+     * @brief Visit a BenchNode.
+     * @param node The BenchNode to visit.
+     * @return The generated LLVM function, if benchmarks are enabled.
+     */
+    auto visit(const BenchNode &node) -> RetT override;
+
+    /**
+     * @brief Visit an AsmNode.
+     * @param node The AsmNode to visit.
+     * @return The output of the assembly, if any.
+     */
+    auto visit(const AsmNode &node) -> RetT override;
+
   private:
     /**
      * @brief Get the LLVM type for a given TypeInfo.
@@ -165,6 +255,20 @@ namespace verte::codegen {
      */
     llvm::Type *getType(const TypeInfo &type) const;
 
+    /**
+     * @brief Find a function of the module, or of the modules taken before.
+     * @param name The name of the function.
+     * @return The function, or null if it is unknown.
+     */
+    llvm::Function *findFunction(const std::string &name);
+
+    /**
+     * @brief Find a global of the module, or of the modules taken before.
+     * @param name The name of the global.
+     * @return The global, or null if it is unknown.
+     */
+    llvm::GlobalVariable *findGlobal(const std::string &name);
+
     /**
      * @brief Load a global variable.
      * @param name The name of the global variable.
@@ -179,6 +283,135 @@ namespace verte::codegen {
      */
     llvm::Value *createString(const std::string &value);
 
+    /**
+     * @brief Lower the `black_box(x)` builtin.
+     * @param node The call to lower.
+     * @return The value of `x`, opaque to the optimizer.
+     */
+    llvm::Value *createBlackBox(const CallNode &node);
+
+    /**
+     * @brief Lower the `parallel_for(n, body)` builtin to the runtime pool.
+     * @param node The call to lower, `body` names a `fn(int) -> void`.
+     * @return The call into the runtime.
+     */
+    llvm::Value *createParallelFor(const CallNode &node);
+
+    /**
+     * @brief Lower the `numa_nodes()`, `numa_node()` and `node_alloc(size)`
+     * builtins to their runtime functions.
+     * @param node The call to lower.
+     * @return The result of the runtime function.
+     */
+    llvm::Value *createNumaBuiltin(const CallNode &node);
+
+    /**
+     * @brief Lower the asynchronous I/O builtins, `read_at_async`,
+     * `write_at_async`, `submit`, `wait`, `register_buffer`, `register_file`
+     * and `unregister_file`, to the runtime.
+     * @param node The call to lower.
+     * @return The result of the runtime function.
+     */
+    llvm::Value *createAioBuiltin(const CallNode &node);
+
+    /**
+     * @brief Lower the channel builtins, `chan<T>(capacity)`, `send(c, v)`,
+     * `recv(c)`, `try_send(c, v)` and `try_recv(c, fallback)`, to the
+     * runtime channels.
+     * @param node The call to lower.
+     * @return The channel, the value received or whether it was sent.
+     */
+    llvm::Value *createChannelBuiltin(const CallNode &node);
+
+    /**
+     * @brief Define a global channel, created by a constructor of the module.
+     * @param node The declaration of the channel.
+     */
+    void createGlobalChannel(const VarDeclNode &node);
+
+    /**
+     * @brief Widen a value to the 64 bits slot of a runtime channel.
+     * @param value The value to send.
+     * @return The slot.
+     */
+    llvm::Value *toChannelSlot(llvm::Value *value);
+
+    /**
+     * @brief Narrow the 64 bits slot of a runtime channel to a value.
+     * @param slot The slot received.
+     * @param type The element type of the channel.
+     * @return The value.
+     */
+    llvm::Value *fromChannelSlot(llvm::Value *slot, llvm::Type *type);
+
+    /**
+     * @brief Check the constraints of an inline assembly against its
+     * operands and output, before LLVM asserts on them.
+     * @param constraints The constraints string.
+     * @param type The type of the assembly.
+     */
+    void checkConstraints(const std::string &constraints,
+                          llvm::FunctionType *type);
+
+    /**
+     * @brief Emit an integer `+`, `-` or `*` with the overflow behavior of
+     * the current function.
+     *
+     * Checked operations lower to the `*.with.overflow` and `*.sat`
+     * intrinsics. Trapping ones branch to a cold block shared by the whole
+     * function, so the check costs one jump on overflow flag. Constant
+     * operands are folded, an overflow while trapping is a compile error.
+     *
+     * @param op The operation.
+     * @param lhs The left operand.
+     * @param rhs The right operand.
+     * @param name The name of the result.
+     * @return The result.
+     */
+    llvm::Value *createArithmetic(llvm::Instruction::BinaryOps op,
+                                  llvm::Value *lhs, llvm::Value *rhs,
+                                  const std::string &name);
+
+    /**
+     * @brief Get the block trapping on overflow in the current function,
+     * created on first use.
+     * @return The block.
+     */
+    llvm::BasicBlock *getTrapBlock();
+
+    /**
+     * @brief Get the overflow behavior of a function from its attributes.
+     * @param attributes The attributes of the function.
+     * @return The behavior, the default one if not set.
+     */
+    Overflow getOverflow(const Attributes &attributes) const;
+
+    /**
+     * @brief Emit the `main` driving the benchmark runtime.
+     * @return The `main`.
+     */
+    llvm::Function *createBenchHarness();
+
+    /**
+     * @brief Check that all the attributes of a declaration are known.
+     * @param attributes The attributes to check.
+     * @param name The name of the declaration.
+     */
+    void checkAttributes(const Attributes &attributes, const std::string &name);
+
+    /**
+     * @brief Set the visibility of a defined symbol from its attributes.
+     * @param value The symbol to update.
+     * @param attributes The attributes of its declaration.
+     */
+    void setVisibility(llvm::GlobalValue *value, const Attributes &attributes);
+
+    /**
+     * @brief Keep the frame pointer of a function, if requested.
+     * @param func The function to update.
+     */
+    void setFrameAttributes(llvm::Function *func) const;
+
     /**
      * @brief Emit an error message and exit.
      * @tparam Args Argument types.
@@ -207,19 +440,62 @@ namespace verte::codegen {
       func->setCallingConv(llvm::CallingConv::C);
     }
 
+    /**
+     * @brief Point the instructions generated next at the first line of a
+     * node, once lines are attached.
+     * @param node The node being generated.
+     */
+    void setDebugLocation(const ASTNode &node);
+
+    /**
+     * @brief Get the line and column of an offset of the attached source.
+     * @param offset The offset.
+     * @return The line and the column, from 1.
+     */
+    std::pair<unsigned, unsigned> lineOf(uint32_t offset) const;
+
     llvm::LLVMContext &context; /**< LLVM context. */
     ModulePtr module;           /**< LLVM module. */
     BuilderPtr builder;         /**< LLVM IR builder. */
+    Options options;            /**< Code generation options. */
 
     std::unique_ptr<types::Function>
         currentFunc; /**< Current function being processed. */
 
-    std::unordered_map<std::string, llvm::Constant *>
+    Overflow overflow; /**< Overflow behavior of the current function. */
+    llvm::BasicBlock *trapBlock =
+        nullptr; /**< Overflow trap of the current function, if any. */
+
+    utils::FlatMap<std::string, llvm::Constant *>
         constants; /**< Constants, i.e true/false. */
 
-    std::unordered_map<std::string, llvm::GlobalVariable *>
+    utils::FlatMap<std::string, llvm::GlobalVariable *>
         globals; /**< Global variables. */
 
+    std::vector<std::pair<std::string, llvm::Function *>>
+        benches; /**< Benchmarks, in declaration order. */
+
+    /**
+     * @struct External
+     * @brief A symbol of a module taken by `split`.
+     */
+    struct External {
+      llvm::Type *type = nullptr; /**< The function or value type. */
+      llvm::AttributeList attributes; /**< The attributes of a function. */
+      bool defined = false;           /**< Whether it was defined. */
+      bool constant = true;           /**< Whether a global is constant. */
+      llvm::GlobalValue::ThreadLocalMode threadLocal =
+          llvm::GlobalValue::NotThreadLocal; /**< The TLS model of a global. */
+    };
+
+    std::unordered_map<std::string, External>
+        externals; /**< The symbols of the taken modules, by name. */
+
+    std::unique_ptr<llvm::DIBuilder>
+        debugInfo; /**< Builder of the line table, once lines are attached. */
+    llvm::DIFile *debugFile = nullptr; /**< The file of the line table. */
+    std::vector<uint32_t> lineStarts;  /**< The offset of each line. */
+
     utils::Logger logger; /**< The logger. */
   };
 } // namespace verte::codegen
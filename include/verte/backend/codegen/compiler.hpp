@@ -6,10 +6,14 @@
 #ifndef VERTE_BACKEND_CODEGEN_COMPILER_HPP
 #define VERTE_BACKEND_CODEGEN_COMPILER_HPP
 
+#include "llvm/IR/DiagnosticHandler.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <memory>
 #include <string>
+#include <vector>
 
 /**
  * @namespace verte::codegen
@@ -19,6 +23,45 @@
 namespace verte::codegen {
   using namespace llvm;
 
+  /**
+   * @brief Initialize the LLVM targets, once per process.
+   * @note Safe to call from any number of threads.
+   */
+  void initializeTargets();
+
+  /**
+   * @brief Get the name of a CPU of the host target.
+   * @param cpu The CPU, `native` for the one of the host.
+   * @param error Set to the reason of the failure, if any.
+   * @return The name LLVM knows the CPU by, empty if it is unknown.
+   */
+  std::string resolveCpu(const std::string &cpu, std::string &error);
+
+  /**
+   * @class BackendDiagnostics
+   * @brief Collects the errors reported by the backend, i.e inline assembly
+   * the target rejects, which would otherwise exit the process.
+   */
+  class BackendDiagnostics : public DiagnosticHandler {
+  public:
+    /**
+     * @brief Construct a new BackendDiagnostics.
+     * @param errors Receives the errors, one per line.
+     */
+    explicit BackendDiagnostics(std::string &errors) noexcept
+        : errors(errors) {}
+
+    /**
+     * @brief Collect a diagnostic if it is an error.
+     * @param info The diagnostic.
+     * @return True if it was collected, the others are printed as usual.
+     */
+    bool handleDiagnostics(const DiagnosticInfo &info) override;
+
+  private:
+    std::string &errors; /**< The collected errors. */
+  };
+
   /**
    * @brief Compiler class that handles JIT and native compilation for
    * llvm::Module.
@@ -27,8 +70,15 @@ namespace verte::codegen {
   public:
     /**
      * @brief Construct a new Compiler object.
+     * @param optLevel The optimization level of the backend, 0 to 3. At 0,
+     * instructions are selected by FastISel and registers allocated by the
+     * fast allocator, for the lowest latency.
+     * @param cpu The CPU to generate code for, `native` for the host's.
+     * @note Compilers hold no shared state, any number of them may be used
+     * from different threads.
      */
-    Compiler() noexcept;
+    explicit Compiler(unsigned optLevel = 2,
+                      std::string cpu = "generic") noexcept;
 
     /**
      * @brief Compile the given module into native code.
@@ -38,6 +88,56 @@ namespace verte::codegen {
      */
     bool compile(Module &module, const std::string &outputPath);
 
+    /**
+     * @brief Emit the given module for the host target into a stream.
+     * @param module The module to emit.
+     * @param dest The stream to emit into.
+     * @param fileType The kind of file to emit.
+     * @param error Set to the reason of the failure, if any.
+     * @return True if emission succeeded, false otherwise.
+     */
+    bool emit(Module &module, raw_pwrite_stream &dest,
+              CodeGenFileType fileType, std::string &error);
+
+    /**
+     * @brief Emit the assembly of a module for the host target, annotated
+     * for humans to review.
+     *
+     * Each function starts with the size of its code and of its stack frame,
+     * and the instructions follow the source lines they were generated from,
+     * as attached by `Codegen::attachLines`. The line table itself is left
+     * out of the listing.
+     *
+     * @param module The module to emit.
+     * @param assembly Receives the annotated assembly.
+     * @param error Set to the reason of the failure, if any.
+     * @return True if emission succeeded, false otherwise.
+     */
+    bool annotate(Module &module, std::string &assembly, std::string &error);
+
+    /**
+     * @brief Link an object file into an executable or a shared library.
+     * @param objectPath The object file to link.
+     * @param outputPath The file path to save the executable.
+     * @param shared Link a shared library instead of an executable.
+     * @return True if linking succeeded, false otherwise.
+     */
+    bool link(const std::string &objectPath, const std::string &outputPath,
+              bool shared = false);
+
+    /**
+     * @brief Link object files into an executable or a shared library.
+     * @param objectPaths The object files to link.
+     * @param outputPath The file path to save the executable.
+     * @param shared Link a shared library instead of an executable.
+     * @param profileAllocations Link the allocation profiler, which replaces
+     * `malloc` and friends of the whole executable.
+     * @return True if linking succeeded, false otherwise.
+     */
+    bool link(const std::vector<std::string> &objectPaths,
+              const std::string &outputPath, bool shared = false,
+              bool profileAllocations = false);
+
   private:
     /**
      * @brief Compile the given module into native code.
@@ -46,6 +146,9 @@ namespace verte::codegen {
      * @return True if compilation succeeded, false otherwise.
      */
     bool native(Module &module, const std::string &outputPath);
+
+    unsigned optLevel; /**< The optimization level of the backend. */
+    std::string cpu;   /**< The CPU to generate code for. */
   };
 } // namespace verte::codegen
 
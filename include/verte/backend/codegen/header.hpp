@@ -0,0 +1,53 @@
+/**
+ * @brief Generates the C header of a shared library.
+ * @file header.hpp
+ */
+
+#ifndef VERTE_BACKEND_CODEGEN_HEADER_HPP
+#define VERTE_BACKEND_CODEGEN_HEADER_HPP
+
+#include "verte/frontend/parser/ast.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @namespace verte::codegen
+ * @brief Code generation namespace. Contains all code generation related
+ * classes and functions.
+ */
+namespace verte::codegen {
+  /**
+   * @brief Generate the C header declaring the exported symbols of a program.
+   *
+   * Only the top-level declarations marked `#[export]` are declared, in
+   * source order. Booleans are declared as `bool`, following the C ABI.
+   *
+   * @param parts The programs to declare, in source order.
+   * @param name The name of the library, used for the include guard.
+   * @return The header source.
+   */
+  [[nodiscard]] std::string
+  generateHeader(const std::vector<const nodes::ProgramNode *> &parts,
+                 std::string_view name);
+
+  /**
+   * @brief Generate the C declarations of the exported symbols of a program,
+   * i.e of an item streamed through the compiler.
+   * @param part The program to declare.
+   * @return The declarations, one per line.
+   */
+  [[nodiscard]] std::string generateDeclarations(const nodes::ProgramNode &part);
+
+  /**
+   * @brief Wrap declarations into a C header.
+   * @param declarations The declarations, one per line.
+   * @param name The name of the library, used for the include guard.
+   * @return The header source.
+   */
+  [[nodiscard]] std::string wrapHeader(std::string_view declarations,
+                                       std::string_view name);
+} // namespace verte::codegen
+
+#endif // VERTE_BACKEND_CODEGEN_HEADER_HPP
@@ -0,0 +1,86 @@
+/**
+ * @brief Static throughput estimation of machine code.
+ * @file mca.hpp
+ */
+
+#ifndef VERTE_BACKEND_CODEGEN_MCA_HPP
+#define VERTE_BACKEND_CODEGEN_MCA_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace verte::codegen
+ * @brief Code generation namespace. Contains all code generation related
+ * classes and functions.
+ */
+namespace verte::codegen {
+  /**
+   * @struct ThroughputEstimate
+   * @brief The steady state of a region of machine code run in a loop.
+   */
+  struct ThroughputEstimate {
+    std::string function; /**< The function of the region. */
+    std::string region;   /**< The label the region starts at, or the
+                             function itself. */
+    size_t instructions = 0;  /**< Instructions of one iteration. */
+    double cycles = 0;        /**< Cycles per iteration. */
+    double ipc = 0;           /**< Instructions per cycle. */
+    double dependencyShare = 0; /**< Share of the cycles waiting on data
+                                   dependencies, from 0 to 1. */
+
+    std::vector<std::pair<std::string, double>>
+        pressure; /**< Cycles per iteration of each busy resource unit. */
+    std::vector<std::pair<std::string, double>>
+        bottlenecks; /**< Share of the cycles each resource unit held up
+                        ready instructions, the most limiting first. */
+  };
+
+  /**
+   * @class ThroughputEstimator
+   * @brief Runs regions of machine code through the LLVM Machine Code
+   * Analyzer, the model of the out-of-order pipeline of a CPU.
+   *
+   * Without a function, the innermost loops of every function are estimated:
+   * the regions from a label to the last backward branch to it that contain
+   * no other loop. A named function is estimated whole, as if it were the
+   * body of a loop.
+   */
+  class ThroughputEstimator {
+  public:
+    /**
+     * @brief Construct a new ThroughputEstimator.
+     * @param cpu The CPU to model, `native` for the one of the host.
+     * @param iterations The iterations to simulate each region for.
+     */
+    explicit ThroughputEstimator(std::string cpu, unsigned iterations = 100);
+
+    /**
+     * @brief Estimate the regions of assembly for the host target.
+     * @param assembly The assembly, i.e emitted for the same CPU.
+     * @param function The function to estimate whole, empty to estimate the
+     * innermost loops of every function.
+     * @param estimates Receives the estimates, in assembly order.
+     * @param error Set to the reason of the failure, if any.
+     * @return True if every region could be estimated, false otherwise.
+     */
+    bool estimate(std::string_view assembly, const std::string &function,
+                  std::vector<ThroughputEstimate> &estimates,
+                  std::string &error) const;
+
+    /**
+     * @brief Print estimates for humans.
+     * @param estimates The estimates.
+     * @return The report, one section per region.
+     */
+    std::string report(const std::vector<ThroughputEstimate> &estimates) const;
+
+  private:
+    std::string cpu;       /**< The CPU to model. */
+    unsigned iterations;   /**< The iterations of each simulation. */
+  };
+} // namespace verte::codegen
+
+#endif // VERTE_BACKEND_CODEGEN_MCA_HPP
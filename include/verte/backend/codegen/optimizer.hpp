@@ -0,0 +1,78 @@
+/**
+ * @brief Optimization of generated functions.
+ * @file optimizer.hpp
+ */
+
+#ifndef VERTE_BACKEND_CODEGEN_OPTIMIZER_HPP
+#define VERTE_BACKEND_CODEGEN_OPTIMIZER_HPP
+
+#include "llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+
+#include <memory>
+
+/**
+ * @namespace verte::codegen
+ * @brief Code generation namespace. Contains all code generation related
+ * classes and functions.
+ */
+namespace verte::codegen {
+  /**
+   * @class Optimizer
+   * @brief Runs the optimization pipeline of an optimization level.
+   *
+   * Functions are first simplified one by one, so that a function may be
+   * optimized as soon as it is generated. Once the module is complete, the
+   * module stage runs the default LLVM pipeline of the level over it, with
+   * the inliner and the interprocedural passes. At -O1 there is no module
+   * stage, the functions are only optimized on their own.
+   *
+   * @note An optimizer works on the LLVM context of the functions it is given,
+   * it must stay on the thread generating them.
+   */
+  class Optimizer {
+  public:
+    /**
+     * @brief Construct a new Optimizer.
+     * @param level The optimization level, 0 to 3. Level 0 does nothing.
+     */
+    explicit Optimizer(unsigned level);
+
+    Optimizer(const Optimizer &) = delete;
+    Optimizer &operator=(const Optimizer &) = delete;
+
+    /**
+     * @brief Optimize a function, if it has a body.
+     * @param function The function to optimize.
+     */
+    void run(llvm::Function &function);
+
+    /**
+     * @brief Run the module stage, once every function is generated.
+     * @param module The module, whose functions went through `run`.
+     */
+    void finish(llvm::Module &module);
+
+    /**
+     * @brief Optimize every function of a module, then the module itself.
+     * @param module The module to optimize.
+     */
+    void run(llvm::Module &module);
+
+  private:
+    unsigned level; /**< The optimization level. */
+
+    llvm::LoopAnalysisManager loops;         /**< The loop analyses. */
+    llvm::FunctionAnalysisManager functions; /**< The function analyses. */
+    llvm::CGSCCAnalysisManager sccs;         /**< The call graph analyses. */
+    llvm::ModuleAnalysisManager modules;     /**< The module analyses. */
+    std::unique_ptr<llvm::PassBuilder> builder; /**< The pass builder. */
+    llvm::FunctionPassManager passes; /**< The function pipeline. */
+    llvm::ModulePassManager modulePasses; /**< The module pipeline. */
+  };
+} // namespace verte::codegen
+
+#endif // VERTE_BACKEND_CODEGEN_OPTIMIZER_HPP
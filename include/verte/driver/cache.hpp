@@ -0,0 +1,189 @@
+/**
+ * @brief Shared content-addressed compilation cache over HTTP.
+ * @file cache.hpp
+ */
+
+#ifndef VERTE_DRIVER_CACHE_HPP
+#define VERTE_DRIVER_CACHE_HPP
+
+#include "verte/driver/compile.hpp"
+#include "verte/utils/logger.hpp"
+#include "verte/utils/server.hpp"
+#include "verte/utils/socket.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @namespace verte::cache
+ * @brief Compilation results shared between machines.
+ *
+ * Entries live at `<prefix>/<key>`, the key being the lowercase hex SHA-256 of
+ * everything influencing the output: compiler version, target, options and
+ * source. `GET` answers `200` with the entry or `404`, `PUT` stores the body
+ * and answers `201`. Entries are the encoded `Result` of `remote::encodeResult`
+ * and never change once written.
+ */
+namespace verte::cache {
+  /**
+   * @brief Compute the cache key of a compilation.
+   * @param source The source code to compile.
+   * @param options The options of the compilation.
+   * @return The key, 64 lowercase hex digits.
+   */
+  [[nodiscard]] std::string computeKey(std::string_view source,
+                                       const Options &options);
+
+  /**
+   * @brief Check if a text is a well formed cache key.
+   * @param key The text to check.
+   * @return True if the text is 64 lowercase hex digits, false otherwise.
+   */
+  [[nodiscard]] bool isKey(std::string_view key) noexcept;
+
+  /**
+   * @class Client
+   * @brief Queries and fills a cache server.
+   *
+   * The cache is best effort: unreachable servers and malformed answers are
+   * logged and treated as misses, they never fail a build.
+   */
+  class Client {
+  public:
+    /**
+     * @brief Construct a client of the server at an endpoint.
+     * @param endpoint The endpoint of the server.
+     * @param prefix The path the entries are served under.
+     */
+    explicit Client(utils::Endpoint endpoint,
+                    std::string prefix = "/v1/cache");
+
+    /**
+     * @brief Create a client from an URL, i.e `http://cache:8080/v1/cache`.
+     * @param url The URL of the cache.
+     * @return The client, or nothing if the URL is malformed.
+     */
+    [[nodiscard]] static std::optional<Client> fromUrl(std::string_view url);
+
+    /**
+     * @brief Look up a compilation result.
+     * @param key The cache key.
+     * @return The result, or nothing on a miss.
+     */
+    [[nodiscard]] std::optional<Result> get(const std::string &key) const;
+
+    /**
+     * @brief Upload a compilation result.
+     * @param key The cache key.
+     * @param result The result to upload.
+     * @return True if the server stored the result, false otherwise.
+     */
+    bool put(const std::string &key, const Result &result) const;
+
+    /**
+     * @brief Compile through the cache, uploading the successful misses.
+     * @tparam Compile Callable compiling the source on a miss.
+     * @param source The source code to compile.
+     * @param options The options of the compilation.
+     * @param compile The compilation to run on a miss.
+     * @return The result of the compilation.
+     */
+    template <typename Compile>
+    Result compile(std::string_view source, const Options &options,
+                   Compile &&compile) const {
+      const std::string key = computeKey(source, options);
+      if (auto result = get(key))
+        return std::move(*result);
+
+      Result result = compile(source, options);
+      if (result.success())
+        put(key, result);
+
+      return result;
+    }
+
+  private:
+    /**
+     * @brief Send a request and read the answer.
+     * @param method The HTTP method.
+     * @param key The cache key.
+     * @param body The body of the request.
+     * @return The status code and the body of the answer.
+     */
+    std::pair<int, std::string> request(std::string_view method,
+                                        const std::string &key,
+                                        std::string_view body = {}) const;
+
+    utils::Endpoint endpoint; /**< The endpoint of the server. */
+    std::string prefix;       /**< The path the entries are served under. */
+    std::chrono::milliseconds timeout{2000}; /**< Per socket operation. */
+    utils::Logger logger;                    /**< The logger. */
+  };
+
+  /**
+   * @class Server
+   * @brief Reference cache server storing entries in a directory.
+   */
+  class Server {
+  public:
+    /**
+     * @brief Start listening, port 0 picks any free port.
+     * @param endpoint The endpoint to listen on.
+     * @param directory The directory storing the entries.
+     * @param prefix The path the entries are served under.
+     */
+    Server(const utils::Endpoint &endpoint, std::filesystem::path directory,
+           std::string prefix = "/v1/cache");
+
+    /**
+     * @brief Stop the server, waiting for the open connections.
+     */
+    ~Server();
+
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    /**
+     * @brief Get the port the server listens on.
+     * @return The port.
+     */
+    [[nodiscard]] uint16_t getPort() const { return server.getPort(); }
+
+    /**
+     * @brief Serve requests until `stop` is called.
+     */
+    void run();
+
+    /**
+     * @brief Stop serving, from any thread.
+     */
+    void stop();
+
+  private:
+    /**
+     * @brief Serve the request of a connection.
+     * @param connection The connection.
+     */
+    void serve(const utils::Socket &connection);
+
+    /**
+     * @brief Get the path of an entry.
+     * @param key The cache key.
+     * @return The path of the entry.
+     */
+    std::filesystem::path entryPath(std::string_view key) const;
+
+    utils::ConnectionServer server;    /**< Serves the connections. */
+    std::filesystem::path directory;   /**< The directory of the entries. */
+    std::string prefix;                /**< The URL path of the entries. */
+    std::atomic<uint64_t> uploads = 0; /**< Names temporary files. */
+
+    utils::Logger logger; /**< The logger. */
+  };
+} // namespace verte::cache
+
+#endif // VERTE_DRIVER_CACHE_HPP
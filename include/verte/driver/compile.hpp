@@ -0,0 +1,156 @@
+/**
+ * @brief Library entry point compiling Verte source held in memory.
+ * @file compile.hpp
+ */
+
+#ifndef VERTE_DRIVER_COMPILE_HPP
+#define VERTE_DRIVER_COMPILE_HPP
+
+#include "verte/backend/codegen/codegen.hpp"
+#include "verte/utils/logger.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @namespace verte
+ * @brief The root namespace of the compiler.
+ */
+namespace verte {
+  /**
+   * @struct Diagnostic
+   * @brief A message reported while compiling.
+   */
+  struct Diagnostic {
+    /**
+     * @enum Severity
+     * @brief The severity of a diagnostic.
+     */
+    enum class Severity : uint8_t {
+      WARNING, /**< The compilation may continue. */
+      ERROR    /**< The compilation failed. */
+    } severity;
+
+    std::string message; /**< The message. */
+    uint32_t line;       /**< The line in the source, 0 if unknown. */
+    uint32_t column;     /**< The column in the source, 0 if unknown. */
+  };
+
+  /**
+   * @enum OutputKind
+   * @brief The kind of output produced by a compilation.
+   */
+  enum class OutputKind : uint8_t {
+    OBJECT,  /**< Native object file for the host. */
+    BITCODE, /**< LLVM bitcode. */
+    IR,      /**< Textual LLVM IR. */
+    ASSEMBLY /**< Assembly for the host. */
+  };
+
+  /**
+   * @struct Options
+   * @brief Options of a compilation.
+   *
+   * Together with the LLVM context created for it, the options are the whole
+   * state of a compilation. Independent compilations may run concurrently.
+   */
+  struct Options {
+    OutputKind output = OutputKind::OBJECT; /**< The output to produce. */
+    std::string moduleName = "main";        /**< The LLVM module name. */
+    bool verify = true;                     /**< Verify the generated IR. */
+    unsigned optLevel = 0; /**< The optimization level, 0 to 3. */
+    bool annotate = false; /**< Interleave the assembly with the source lines
+                              and summarize each function. */
+    std::string cpu = "generic"; /**< The CPU to generate code for, `native`
+                                    for the one of the host. */
+    codegen::Options codegen;               /**< Code generation options. */
+
+    std::optional<utils::LogLevel>
+        logLevel; /**< Log level of the compilation, global if unset. */
+  };
+
+  /**
+   * @struct Result
+   * @brief The result of a compilation.
+   */
+  struct Result {
+    std::vector<Diagnostic> diagnostics; /**< Reported diagnostics. */
+    std::string output; /**< The output, empty if the compilation failed. */
+    std::string header; /**< The C header, when building a shared library. */
+
+    /**
+     * @brief Check if the compilation succeeded.
+     * @return True if no error was reported, false otherwise.
+     */
+    [[nodiscard]] bool success() const noexcept {
+      for (const auto &diagnostic : diagnostics) {
+        if (diagnostic.severity == Diagnostic::Severity::ERROR)
+          return false;
+      }
+
+      return true;
+    }
+  };
+
+  /**
+   * @brief Generate the LLVM module of Verte source code.
+   * @param source The source code to compile.
+   * @param context The LLVM context owning the module.
+   * @param options The options of the compilation.
+   * @param result Receives the diagnostics.
+   * @param declarations Prototypes declared ahead of the source, i.e the
+   * functions provided by an embedding host.
+   * @return The module, or null if the compilation failed.
+   */
+  [[nodiscard]] codegen::ModulePtr
+  generate(std::string_view source, llvm::LLVMContext &context,
+           const Options &options, Result &result,
+           const std::vector<const nodes::ProtoNode *> &declarations = {});
+
+  /**
+   * @brief Generate the LLVM module of already parsed programs.
+   * @param parts The programs, generated as one in the given order.
+   * @param context The LLVM context owning the module.
+   * @param options The options of the compilation.
+   * @param result Receives the diagnostics, and the header if any.
+   * @param declarations Prototypes declared ahead of the programs.
+   * @return The module, or null if the compilation failed.
+   */
+  [[nodiscard]] codegen::ModulePtr
+  generate(const std::vector<const nodes::ProgramNode *> &parts,
+           llvm::LLVMContext &context, const Options &options, Result &result,
+           const std::vector<const nodes::ProtoNode *> &declarations = {});
+
+  /**
+   * @brief Optimize a generated module at the requested level.
+   * @param module The module to optimize.
+   * @param options The options of the compilation.
+   */
+  void optimize(llvm::Module &module, const Options &options);
+
+  /**
+   * @brief Emit a generated module as the requested output.
+   * @param module The module to emit.
+   * @param options The options of the compilation.
+   * @param result Receives the output, or an error diagnostic.
+   */
+  void emit(llvm::Module &module, const Options &options, Result &result);
+
+  /**
+   * @brief Compile Verte source code entirely in memory.
+   *
+   * Neither the filesystem nor external processes are used, the output is
+   * returned in the result buffer.
+   *
+   * @param source The source code to compile.
+   * @param options The options of the compilation.
+   * @return The diagnostics and the output of the compilation.
+   */
+  [[nodiscard]] Result compile(std::string_view source,
+                               const Options &options = {});
+} // namespace verte
+
+#endif // VERTE_DRIVER_COMPILE_HPP
@@ -0,0 +1,183 @@
+/**
+ * @brief JIT session embedding Verte into a host program.
+ * @file jit.hpp
+ */
+
+#ifndef VERTE_DRIVER_JIT_HPP
+#define VERTE_DRIVER_JIT_HPP
+
+#include "verte/driver/compile.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/parser/ast.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Forward declaration.
+namespace llvm::orc {
+  class LLJIT;
+}
+
+/**
+ * @namespace verte::jit
+ * @brief JIT compilation of Verte code inside a host program.
+ */
+namespace verte::jit {
+  /**
+   * @typedef DataType
+   * @brief Alias to the data types of the language.
+   */
+  using DataType = types::TypeInfo::DataType;
+
+  /**
+   * @typedef Signature
+   * @brief The return type followed by the parameter types of a function.
+   */
+  using Signature = std::vector<DataType>;
+
+  /**
+   * @struct HostType
+   * @brief Maps a host type to the data type it is passed as.
+   * @tparam T The host type.
+   */
+  template <typename T> struct HostType;
+
+  // clang-format off
+  template <> struct HostType<void> { static constexpr auto value = DataType::VOID; };
+  template <> struct HostType<bool> { static constexpr auto value = DataType::BOOL; };
+  template <> struct HostType<int32_t> { static constexpr auto value = DataType::INTEGER; };
+  template <> struct HostType<float> { static constexpr auto value = DataType::FLOAT; };
+  template <> struct HostType<double> { static constexpr auto value = DataType::DOUBLE; };
+  template <> struct HostType<char *> { static constexpr auto value = DataType::STRING; };
+  template <> struct HostType<const char *> { static constexpr auto value = DataType::STRING; };
+  // clang-format on
+
+  /**
+   * @struct HostSignature
+   * @brief Maps a host function type to its signature.
+   * @tparam Fn The host function type.
+   */
+  template <typename Fn> struct HostSignature;
+
+  template <typename Ret, typename... Args>
+  struct HostSignature<Ret(Args...)> {
+    /**
+     * @brief Get the signature of the function type.
+     * @return The signature.
+     */
+    static Signature get() {
+      return {HostType<Ret>::value, HostType<Args>::value...};
+    }
+  };
+
+  /**
+   * @class Session
+   * @brief A JIT session, compiling Verte code into the host process.
+   *
+   * Host functions are registered as Verte externs, and compiled Verte
+   * functions are looked up as plain function pointers. Calls in either
+   * direction are native calls.
+   */
+  class Session {
+  public:
+    /**
+     * @brief Construct a new Session.
+     * @param options The options used to compile the sources.
+     * @throws errors::JitError If the JIT cannot target the host.
+     */
+    explicit Session(Options options = {});
+
+    /**
+     * @brief Destroy the session, and the code it compiled.
+     */
+    ~Session();
+
+    /**
+     * @brief Register a host function callable from Verte.
+     * @param proto The Verte prototype of the function.
+     * @param address The address of the function.
+     * @throws errors::JitError If the function is already defined.
+     */
+    void define(nodes::ProtoPtr proto, void *address);
+
+    /**
+     * @brief Register a host function callable from Verte.
+     * @tparam Ret The return type of the function.
+     * @tparam Args The parameter types of the function.
+     * @param prototype The Verte prototype, i.e `add(a: int, b: int) -> int`.
+     * @param function The function.
+     * @throws errors::JitError If the prototype does not match the function.
+     */
+    template <typename Ret, typename... Args>
+    void define(std::string_view prototype, Ret (*function)(Args...)) {
+      auto proto = parsePrototype(prototype);
+      if (signatureOf(*proto) != HostSignature<Ret(Args...)>::get())
+        throw errors::JitError("Prototype does not match the host function: " +
+                               proto->getName());
+
+      define(std::move(proto), reinterpret_cast<void *>(function));
+    }
+
+    /**
+     * @brief Compile source code into the session.
+     *
+     * The source may call the registered host functions, and the functions
+     * of the sources compiled before it.
+     *
+     * @param source The source code to compile.
+     * @return The diagnostics of the compilation, the output is left empty.
+     */
+    Result compile(std::string_view source);
+
+    /**
+     * @brief Look a compiled function up.
+     * @tparam Fn The host function type, i.e `int32_t(int32_t, int32_t)`.
+     * @param name The name of the function.
+     * @return The function pointer.
+     * @throws errors::JitError If the function is unknown or does not match.
+     */
+    template <typename Fn> Fn *lookup(std::string_view name) {
+      auto address = lookupAddress(name, HostSignature<Fn>::get());
+      return reinterpret_cast<Fn *>(address);
+    }
+
+  private:
+    /**
+     * @brief Parse a Verte prototype.
+     * @param prototype The prototype, without the `fn` keyword.
+     * @return The prototype node.
+     */
+    static nodes::ProtoPtr parsePrototype(std::string_view prototype);
+
+    /**
+     * @brief Get the signature of a prototype.
+     * @param proto The prototype.
+     * @return The signature.
+     */
+    static Signature signatureOf(const nodes::ProtoNode &proto);
+
+    /**
+     * @brief Look the address of a compiled function up.
+     * @param name The name of the function.
+     * @param signature The signature expected by the caller.
+     * @return The address of the function.
+     */
+    void *lookupAddress(std::string_view name, const Signature &signature);
+
+    std::string backendErrors; /**< Errors of the last materialization. */
+    std::unique_ptr<llvm::orc::LLJIT> jit; /**< The JIT. */
+    Options options;                       /**< The compilation options. */
+
+    std::vector<nodes::ProtoPtr>
+        declarations; /**< Functions visible to the next compilations. */
+
+    std::unordered_map<std::string, Signature>
+        signatures; /**< Signatures of the visible functions. */
+  };
+} // namespace verte::jit
+
+#endif // VERTE_DRIVER_JIT_HPP
@@ -0,0 +1,305 @@
+/**
+ * @brief Language server over stdio.
+ * @file lsp.hpp
+ */
+
+#ifndef VERTE_DRIVER_LSP_HPP
+#define VERTE_DRIVER_LSP_HPP
+
+#include "verte/types.hpp"
+#include "verte/utils/logger.hpp"
+
+#include "llvm/Support/JSON.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Forward declaration.
+namespace verte::nodes {
+  class ProgramNode;
+}
+
+/**
+ * @namespace verte::lsp
+ * @brief Editor support through the Language Server Protocol.
+ */
+namespace verte::lsp {
+  using types::Location;
+
+  /**
+   * @struct Position
+   * @brief A position as the protocol counts it.
+   */
+  struct Position {
+    uint32_t line = 0;      /**< The line, from 0. */
+    uint32_t character = 0; /**< The UTF-16 code unit in the line, from 0. */
+  };
+
+  /**
+   * @struct Symbol
+   * @brief A declaration of a document.
+   */
+  struct Symbol {
+    /**
+     * @enum Kind
+     * @brief The kind of declaration.
+     */
+    enum class Kind : uint8_t {
+      FUNCTION,  /**< A function or prototype. */
+      VARIABLE,  /**< A variable. */
+      CONSTANT,  /**< A constant. */
+      PARAMETER, /**< A function parameter. */
+      BENCH      /**< A benchmark block. */
+    } kind;      /**< The kind of declaration. */
+
+    std::string name;   /**< The declared name. */
+    std::string detail; /**< The signature, i.e `fn f(x: int) -> int`. */
+    Location selection; /**< The span of the name. */
+    Location extent;    /**< The span of the whole declaration. */
+    bool global;        /**< Whether the symbol is visible in all items. */
+  };
+
+  /**
+   * @struct Reference
+   * @brief A name used in a document, and its declaration.
+   */
+  struct Reference {
+    Location location; /**< The span of the name. */
+    Symbol symbol;     /**< The declaration of the name. */
+  };
+
+  /**
+   * @struct Diagnostic
+   * @brief A problem found in a document.
+   */
+  struct Diagnostic {
+    Location location;   /**< The span of the problem. */
+    std::string message; /**< The description of the problem. */
+  };
+
+  /**
+   * @class Document
+   * @brief An open source file, kept analysed as it is edited.
+   *
+   * The document is split into top-level items, as in watch mode. An edit only
+   * lexes and parses the items around the changed text: the items before keep
+   * their state, the ones after are shifted once the lexer is back in step with
+   * them. Every item holds its declarations and the names it uses, sorted by
+   * offset, so that queries are two binary searches and a hash lookup.
+   */
+  class Document {
+  public:
+    /**
+     * @struct Stats
+     * @brief Statistics of the last update.
+     */
+    struct Stats {
+      size_t items = 0;    /**< The items of the document. */
+      size_t reparsed = 0; /**< The items lexed and parsed again. */
+    };
+
+    /**
+     * @brief Construct a new Document.
+     * @param text The text of the document.
+     */
+    explicit Document(std::string text = {});
+
+    ~Document();
+    Document(Document &&) noexcept;
+    Document &operator=(Document &&) noexcept;
+
+    /**
+     * @brief Replace the text of the document.
+     * @param text The new text.
+     */
+    void update(std::string text);
+
+    /**
+     * @brief Replace a range of the text of the document.
+     * @param start The start of the range.
+     * @param end The end of the range.
+     * @param text The text replacing the range.
+     */
+    void edit(Position start, Position end, std::string_view text);
+
+    /**
+     * @brief Get the text of the document.
+     * @return The text.
+     */
+    [[nodiscard]] const std::string &getText() const { return text; }
+
+    /**
+     * @brief Get the statistics of the last update.
+     * @return The statistics.
+     */
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+    /**
+     * @brief Convert a position into an offset, clamped to the text.
+     * @param position The position.
+     * @return The offset.
+     */
+    [[nodiscard]] uint32_t toOffset(Position position) const;
+
+    /**
+     * @brief Convert an offset into a position.
+     * @param offset The offset.
+     * @return The position.
+     */
+    [[nodiscard]] Position toPosition(uint32_t offset) const;
+
+    /**
+     * @brief Get the problems of the document.
+     * @return The syntax errors and the unknown names, in order.
+     */
+    [[nodiscard]] std::vector<Diagnostic> getDiagnostics() const;
+
+    /**
+     * @brief Find the name at an offset and its declaration.
+     * @param offset The offset.
+     * @return The reference, or nothing if there is no known name there.
+     */
+    [[nodiscard]] std::optional<Reference> lookup(uint32_t offset) const;
+
+    /**
+     * @brief Get the top-level declarations of the document.
+     * @return The declarations, in order.
+     */
+    [[nodiscard]] std::vector<Symbol> getSymbols() const;
+
+  private:
+    struct Item;
+
+    /**
+     * @brief Lex and parse the items from an offset, until the lexer is back
+     * in step with the previous items.
+     * @param begin The offset to start at, at a token or at 0.
+     * @param changed The end of the changed text, in the new text.
+     * @param previous The previous items which may be reused, in order.
+     * @param delta The shift of the previous items.
+     */
+    void reparse(uint32_t begin, uint32_t changed,
+                 std::vector<std::unique_ptr<Item>> previous, int64_t delta);
+
+    /**
+     * @brief Index the global declarations of all the items.
+     */
+    void indexGlobals();
+
+    /**
+     * @brief Find the item spanning an offset.
+     * @param offset The offset.
+     * @return The item, or null if the offset is between items.
+     */
+    [[nodiscard]] const Item *findItem(uint32_t offset) const;
+
+    /**
+     * @brief Move a symbol of an item to the current offsets.
+     * @param item The item of the symbol.
+     * @param symbol The symbol.
+     * @return The moved symbol.
+     */
+    [[nodiscard]] static Symbol place(const Item &item, const Symbol &symbol);
+
+    std::string text;            /**< The text. */
+    std::vector<uint32_t> lines; /**< The offsets of the lines. */
+    std::vector<std::unique_ptr<Item>> items; /**< The items, in order. */
+
+    std::unordered_map<std::string, std::pair<const Item *, size_t>>
+        globals; /**< The global declarations, by name. */
+
+    Stats stats; /**< The statistics of the last update. */
+  };
+
+  /**
+   * @brief Read a message framed by a `Content-Length` header.
+   * @param in The stream to read from.
+   * @return The body of the message, or nothing at the end of the stream.
+   */
+  [[nodiscard]] std::optional<std::string> readMessage(std::istream &in);
+
+  /**
+   * @brief Write a message framed by a `Content-Length` header.
+   * @param out The stream to write to.
+   * @param message The message.
+   */
+  void writeMessage(std::ostream &out, const llvm::json::Value &message);
+
+  /**
+   * @class Server
+   * @brief Answers the requests of an editor about Verte documents.
+   *
+   * Supports diagnostics, go to definition, hover and document symbols, with
+   * full or incremental text synchronization.
+   */
+  class Server {
+  public:
+    /**
+     * @brief Construct a new Server.
+     * @param out The stream the messages are written to.
+     */
+    explicit Server(std::ostream &out) : out(out), logger("lsp", std::cerr) {}
+
+    /**
+     * @brief Serve the messages of a stream until `exit`.
+     * @param in The stream to read from.
+     * @return The exit code, 0 if `shutdown` came before `exit`.
+     */
+    int run(std::istream &in);
+
+    /**
+     * @brief Handle a message.
+     * @param message The message.
+     * @return False once the client asked to exit, true otherwise.
+     */
+    bool handle(const llvm::json::Value &message);
+
+    /**
+     * @brief Get an open document.
+     * @param uri The URI of the document.
+     * @return The document, or null if it is not open.
+     */
+    [[nodiscard]] const Document *getDocument(const std::string &uri) const;
+
+  private:
+    /**
+     * @brief Answer a request.
+     * @param method The method of the request.
+     * @param params The parameters of the request.
+     * @return The result of the request.
+     */
+    llvm::json::Value request(llvm::StringRef method,
+                              const llvm::json::Object &params);
+
+    /**
+     * @brief Handle a notification.
+     * @param method The method of the notification.
+     * @param params The parameters of the notification.
+     */
+    void notification(llvm::StringRef method,
+                      const llvm::json::Object &params);
+
+    /**
+     * @brief Send the diagnostics of a document.
+     * @param uri The URI of the document.
+     */
+    void publishDiagnostics(const std::string &uri);
+
+    std::ostream &out;    /**< The stream the messages are written to. */
+    utils::Logger logger; /**< The logger. */
+
+    std::unordered_map<std::string, Document>
+        documents;         /**< The open documents. */
+    bool shutdown = false; /**< Whether shutdown was requested. */
+  };
+} // namespace verte::lsp
+
+#endif // VERTE_DRIVER_LSP_HPP
@@ -0,0 +1,138 @@
+/**
+ * @brief Function-granular reuse of machine code across compilations.
+ * @file objects.hpp
+ */
+
+#ifndef VERTE_DRIVER_OBJECTS_HPP
+#define VERTE_DRIVER_OBJECTS_HPP
+
+#include "verte/driver/compile.hpp"
+#include "verte/frontend/parser/ast.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @namespace verte::objects
+ * @brief Compiling each function to its own object, kept in a local store.
+ */
+namespace verte::objects {
+  /**
+   * @class ObjectStore
+   * @brief A directory of objects, named `<key>.o` after their key.
+   *
+   * Objects are written to a temporary file then renamed, so that concurrent
+   * compilations sharing a store never see a partial object.
+   */
+  class ObjectStore {
+  public:
+    /**
+     * @brief Open a store, creating its directory if needed.
+     * @param directory The directory of the store.
+     * @throws errors::IOError If the directory cannot be created.
+     */
+    explicit ObjectStore(std::filesystem::path directory);
+
+    /**
+     * @brief Get the path of an object.
+     * @param key The key of the object.
+     * @return The path, whether the object exists or not.
+     */
+    [[nodiscard]] std::filesystem::path path(std::string_view key) const;
+
+    /**
+     * @brief Check if the store holds an object.
+     * @param key The key of the object.
+     * @return True if the object exists, false otherwise.
+     */
+    [[nodiscard]] bool contains(std::string_view key) const;
+
+    /**
+     * @brief Store an object.
+     * @param key The key of the object.
+     * @param object The content of the object.
+     * @return The path of the object.
+     * @throws errors::IOError If the object cannot be written.
+     */
+    std::filesystem::path put(std::string_view key, std::string_view object);
+
+  private:
+    std::filesystem::path directory; /**< The directory of the store. */
+  };
+
+  /**
+   * @class FunctionCompiler
+   * @brief Compiles successive versions of a source, reusing the object of
+   * every function which did not change.
+   *
+   * A function is keyed by its tokens, the interfaces of the symbols it
+   * references as declared before it, and the options. Each changed function
+   * is generated, optimized and emitted in a module of its own, which declares
+   * the other symbols. Unchanged functions are only declared. The globals,
+   * prototypes and benchmarks make one more object, keyed by its bitcode.
+   *
+   * Functions are optimized apart, so nothing is inlined across them: editing
+   * a body only recompiles that function, changing a signature also
+   * recompiles the functions referencing it.
+   */
+  class FunctionCompiler {
+  public:
+    /**
+     * @struct Stats
+     * @brief Statistics of the last compilation.
+     */
+    struct Stats {
+      size_t functions = 0; /**< The functions of the source. */
+      size_t reused = 0;    /**< The functions reused from the store. */
+    };
+
+    /**
+     * @brief Construct a new FunctionCompiler.
+     * @param options The options of the compilations, always emitting objects.
+     * @param store The directory of the object store.
+     * @throws errors::IOError If the store cannot be opened.
+     */
+    FunctionCompiler(Options options, std::filesystem::path store);
+
+    /**
+     * @brief Compile a version of the source.
+     * @param source The source code.
+     * @return The diagnostics and the header of the compilation, the output
+     * is left empty.
+     */
+    [[nodiscard]] Result compile(std::string_view source);
+
+    /**
+     * @brief Get the objects of the last compilation, to link together.
+     * @return The paths of the objects in the store.
+     */
+    [[nodiscard]] const std::vector<std::filesystem::path> &
+    getObjects() const {
+      return objects;
+    }
+
+    /**
+     * @brief Get the statistics of the last compilation.
+     * @return The statistics.
+     */
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+  private:
+    Options options;   /**< The options of the compilations. */
+    ObjectStore store; /**< The objects of the functions. */
+    Stats stats;       /**< The statistics of the last compilation. */
+
+    std::vector<std::filesystem::path>
+        objects; /**< The objects of the last compilation. */
+
+    std::unordered_map<std::string, std::unique_ptr<nodes::ProgramNode>>
+        items; /**< The parsed items, by their tokens. */
+  };
+} // namespace verte::objects
+
+#endif // VERTE_DRIVER_OBJECTS_HPP
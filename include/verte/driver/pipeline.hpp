@@ -0,0 +1,80 @@
+/**
+ * @brief Pipelined compilation of the items of a source across threads.
+ * @file pipeline.hpp
+ */
+
+#ifndef VERTE_DRIVER_PIPELINE_HPP
+#define VERTE_DRIVER_PIPELINE_HPP
+
+#include "verte/driver/compile.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+/**
+ * @namespace verte::pipeline
+ * @brief Compiling the top-level items of a source as soon as they are ready.
+ */
+namespace verte::pipeline {
+  /**
+   * @class PipelinedCompiler
+   * @brief Compiles a source with one thread per stage.
+   *
+   * The lexer splits the source into top-level items, which flow to the parser
+   * then to code generation through bounded lock-free queues. Code generation
+   * optimizes every function as soon as it is generated: both work on the same
+   * LLVM context, which is not thread safe, so they share the last stage. The
+   * module is emitted once all the items went through.
+   *
+   * The output is the one of `verte::compile`. When several stages fail, the
+   * error of the earliest stage is reported, as a sequential compilation would.
+   */
+  class PipelinedCompiler {
+  public:
+    /**
+     * @struct Stats
+     * @brief Statistics of the last compilation.
+     *
+     * The time of a stage excludes its waits on the queues, the wall time of
+     * a pipeline tends to the time of its slowest stage.
+     */
+    struct Stats {
+      size_t items = 0;                    /**< The items of the source. */
+      std::chrono::nanoseconds lex{};      /**< The time spent lexing. */
+      std::chrono::nanoseconds parse{};    /**< The time spent parsing. */
+      std::chrono::nanoseconds generate{}; /**< The time spent generating and
+                                              optimizing the IR. */
+      std::chrono::nanoseconds emit{};     /**< The time spent emitting. */
+    };
+
+    /**
+     * @brief Construct a new PipelinedCompiler.
+     * @param options The options of the compilations.
+     * @param capacity The items each queue holds before its producer waits.
+     */
+    explicit PipelinedCompiler(Options options, size_t capacity = 256)
+        : options(std::move(options)), capacity(capacity) {}
+
+    /**
+     * @brief Compile a source.
+     * @param source The source code.
+     * @return The result of the compilation.
+     */
+    [[nodiscard]] Result compile(std::string_view source);
+
+    /**
+     * @brief Get the statistics of the last compilation.
+     * @return The statistics.
+     */
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+  private:
+    Options options; /**< The options of the compilations. */
+    size_t capacity; /**< The capacity of the queues. */
+    Stats stats;     /**< The statistics of the last compilation. */
+  };
+} // namespace verte::pipeline
+
+#endif // VERTE_DRIVER_PIPELINE_HPP
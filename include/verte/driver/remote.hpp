@@ -0,0 +1,235 @@
+/**
+ * @brief Distributed compilation over TCP.
+ * @file remote.hpp
+ */
+
+#ifndef VERTE_DRIVER_REMOTE_HPP
+#define VERTE_DRIVER_REMOTE_HPP
+
+#include "verte/driver/compile.hpp"
+#include "verte/utils/logger.hpp"
+#include "verte/utils/server.hpp"
+#include "verte/utils/socket.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @namespace verte::remote
+ * @brief Compilation jobs shipped to `vertec --worker` processes.
+ *
+ * Every message is a frame made of a little endian `uint32_t` payload size, a
+ * `uint8_t` frame kind and the payload. A client sends a `PING` or a `COMPILE`
+ * frame, the worker answers with a `PONG` or a `RESULT` frame. A connection
+ * may carry any number of exchanges.
+ */
+namespace verte::remote {
+  /**
+   * @brief Version of the protocol, workers and clients must agree on it.
+   */
+  inline constexpr uint32_t PROTOCOL_VERSION = 6;
+
+  /**
+   * @brief The default port of the workers.
+   */
+  inline constexpr uint16_t DEFAULT_PORT = 7890;
+
+  /**
+   * @enum FrameKind
+   * @brief The kind of a protocol frame.
+   */
+  enum class FrameKind : uint8_t {
+    PING = 1,    /**< Health check, no payload. */
+    PONG = 2,    /**< Health check answer, the version and the job slots. */
+    COMPILE = 3, /**< Compile job, the options and the source. */
+    RESULT = 4   /**< Compile job answer, the serialized result. */
+  };
+
+  /**
+   * @brief Encode the compile job of a source.
+   * @param source The source code to compile.
+   * @param options The options of the compilation.
+   * @return The payload of the `COMPILE` frame.
+   */
+  [[nodiscard]] std::string encodeJob(std::string_view source,
+                                      const Options &options);
+
+  /**
+   * @brief Decode a compile job.
+   * @param payload The payload of a `COMPILE` frame.
+   * @param source Receives the source code.
+   * @param options Receives the options.
+   */
+  void decodeJob(std::string_view payload, std::string &source,
+                 Options &options);
+
+  /**
+   * @brief Encode the result of a compilation.
+   * @param result The result to encode.
+   * @return The payload of the `RESULT` frame.
+   */
+  [[nodiscard]] std::string encodeResult(const Result &result);
+
+  /**
+   * @brief Decode the result of a compilation.
+   * @param payload The payload of a `RESULT` frame.
+   * @return The decoded result.
+   */
+  [[nodiscard]] Result decodeResult(std::string_view payload);
+
+  /**
+   * @class Worker
+   * @brief Serves compile jobs, each connection on its own thread.
+   */
+  class Worker {
+  public:
+    /**
+     * @brief Start listening, port 0 picks any free port.
+     * @param endpoint The endpoint to listen on.
+     * @param jobs The number of jobs compiled at once, 0 for one per core.
+     */
+    explicit Worker(const utils::Endpoint &endpoint, uint32_t jobs = 0);
+
+    /**
+     * @brief Stop the worker, waiting for the running jobs.
+     */
+    ~Worker();
+
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    /**
+     * @brief Get the port the worker listens on.
+     * @return The port.
+     */
+    [[nodiscard]] uint16_t getPort() const { return server.getPort(); }
+
+    /**
+     * @brief Serve connections until `stop` is called.
+     */
+    void run();
+
+    /**
+     * @brief Stop serving, from any thread.
+     */
+    void stop();
+
+  private:
+    /**
+     * @brief Serve the exchanges of a single connection.
+     * @param connection The connection.
+     */
+    void serve(utils::Socket &connection);
+
+    /**
+     * @brief Compile a job, once a job slot is free.
+     * @param payload The payload of the `COMPILE` frame.
+     * @return The payload of the `RESULT` frame.
+     */
+    std::string compileJob(std::string_view payload);
+
+    utils::ConnectionServer server; /**< Serves the connections. */
+    uint32_t jobs;                  /**< The number of job slots. */
+
+    std::mutex mutex;                /**< Guards the field below. */
+    std::condition_variable changed; /**< Signals the field below. */
+    uint32_t running = 0;            /**< The running jobs. */
+
+    utils::Logger logger; /**< The logger. */
+  };
+
+  /**
+   * @struct SchedulerOptions
+   * @brief Options of a scheduler.
+   */
+  struct SchedulerOptions {
+    std::chrono::milliseconds connectTimeout{500}; /**< To reach a worker. */
+    std::chrono::milliseconds jobTimeout{60000};   /**< To finish a job. */
+    std::chrono::milliseconds retryAfter{5000}; /**< To retry a dead worker. */
+    bool localFallback = true; /**< Compile locally without workers. */
+  };
+
+  /**
+   * @class Scheduler
+   * @brief Spreads compile jobs over a pool of workers.
+   *
+   * Jobs go round-robin to the healthy workers. A worker failing a job is
+   * skipped until it answers a health check again, the job is retried on the
+   * next one, and compiled locally once no worker is left.
+   *
+   * @note Thread-safe, a build may compile any number of jobs at once.
+   */
+  class Scheduler {
+  public:
+    /**
+     * @brief Construct a new Scheduler.
+     * @param workers The endpoints of the workers.
+     * @param options The options of the scheduler.
+     */
+    explicit Scheduler(std::vector<utils::Endpoint> workers,
+                       SchedulerOptions options = {});
+
+    /**
+     * @brief Compile source code on a worker.
+     * @param source The source code to compile.
+     * @param options The options of the compilation.
+     * @return The result of the compilation.
+     */
+    [[nodiscard]] Result compile(std::string_view source,
+                                 const Options &options = {});
+
+    /**
+     * @brief Check the health of a worker.
+     * @param endpoint The endpoint of the worker.
+     * @return True if the worker answered with the same protocol version.
+     */
+    [[nodiscard]] bool ping(const utils::Endpoint &endpoint) const;
+
+    /**
+     * @brief Get the number of workers currently considered healthy.
+     * @return The number of healthy workers.
+     */
+    [[nodiscard]] size_t healthyWorkers();
+
+  private:
+    /**
+     * @struct WorkerState
+     * @brief Health state of a worker.
+     */
+    struct WorkerState {
+      utils::Endpoint endpoint; /**< The endpoint of the worker. */
+      bool checked = false;     /**< Whether the worker answered a ping. */
+      bool failed = false;      /**< Whether the last job failed. */
+      std::chrono::steady_clock::time_point
+          failedAt{}; /**< The last failure. */
+    };
+
+    /**
+     * @brief Check if a worker may receive a job, pinging it if needed.
+     * @param worker The worker.
+     * @return True if the worker may receive a job.
+     */
+    bool available(WorkerState &worker);
+
+    /**
+     * @brief Mark a worker as failed.
+     * @param worker The worker.
+     * @param reason The reason of the failure.
+     */
+    void markFailed(WorkerState &worker, const std::string &reason);
+
+    std::vector<WorkerState> workers; /**< The workers. */
+    SchedulerOptions options;         /**< The options. */
+    std::mutex mutex;                 /**< Guards the health states. */
+    std::atomic<size_t> next = 0;     /**< The next worker to use. */
+    utils::Logger logger;             /**< The logger. */
+  };
+} // namespace verte::remote
+
+#endif // VERTE_DRIVER_REMOTE_HPP
@@ -0,0 +1,88 @@
+/**
+ * @brief Compilation of huge sources in bounded memory.
+ * @file stream.hpp
+ */
+
+#ifndef VERTE_DRIVER_STREAM_HPP
+#define VERTE_DRIVER_STREAM_HPP
+
+#include "verte/driver/compile.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string_view>
+#include <utility>
+
+/**
+ * @namespace verte::stream
+ * @brief Compiling a source one top-level item at a time.
+ */
+namespace verte::stream {
+  /**
+   * @typedef Sink
+   * @brief Receives the output of every flushed module, in order.
+   */
+  using Sink = std::function<void(std::string_view output)>;
+
+  /**
+   * @class StreamingCompiler
+   * @brief Compiles a source read chunk by chunk, keeping one item in memory.
+   *
+   * Every item is lexed from the chunks read so far, parsed, generated and
+   * optimized, then its tokens and tree are freed. Once the functions
+   * generated reach a number of instructions, the module is emitted to the
+   * sink as its own output and freed: objects are linked together, bitcode
+   * modules may be linked with `llvm-link`. The later modules declare the
+   * symbols of the earlier ones on first use.
+   *
+   * Memory is bounded by the largest item and the flush threshold, plus the
+   * names of the symbols and the constants interned by the LLVM context.
+   */
+  class StreamingCompiler {
+  public:
+    /**
+     * @struct Stats
+     * @brief Statistics of the last compilation.
+     */
+    struct Stats {
+      size_t items = 0;      /**< The items of the source. */
+      size_t modules = 0;    /**< The modules flushed to the sink. */
+      size_t maxTokens = 0;  /**< The tokens of the largest item. */
+      size_t maxBuffer = 0;  /**< The most source bytes held at once. */
+    };
+
+    /**
+     * @brief Construct a new StreamingCompiler.
+     * @param options The options of the compilations.
+     * @param threshold The instructions flushing the module.
+     * @param chunk The bytes read from the source at once.
+     */
+    explicit StreamingCompiler(Options options, size_t threshold = 1 << 16,
+                               size_t chunk = 1 << 16)
+        : options(std::move(options)), threshold(threshold), chunk(chunk) {}
+
+    /**
+     * @brief Compile a source.
+     * @param in The stream of the source code.
+     * @param sink Receives the outputs.
+     * @return The diagnostics and the header of the compilation, the output
+     * is left empty.
+     */
+    [[nodiscard]] Result compile(std::istream &in, const Sink &sink);
+
+    /**
+     * @brief Get the statistics of the last compilation.
+     * @return The statistics.
+     */
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+  private:
+    Options options;  /**< The options of the compilations. */
+    size_t threshold; /**< The instructions flushing the module. */
+    size_t chunk;     /**< The bytes read at once. */
+    Stats stats;      /**< The statistics of the last compilation. */
+  };
+} // namespace verte::stream
+
+#endif // VERTE_DRIVER_STREAM_HPP
@@ -0,0 +1,135 @@
+/**
+ * @brief Incremental rebuilds of a watched source file.
+ * @file watch.hpp
+ */
+
+#ifndef VERTE_DRIVER_WATCH_HPP
+#define VERTE_DRIVER_WATCH_HPP
+
+#include "verte/driver/compile.hpp"
+#include "verte/frontend/lexer/token.hpp"
+#include "verte/frontend/parser/ast.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace verte::watch
+ * @brief Rebuilding a source file whenever it is saved.
+ */
+namespace verte::watch {
+  /**
+   * @brief Split tokens into top-level items.
+   *
+   * An item ends at a `;` or at the `}` closing its outermost block, unless an
+   * `else` follows. Attributes belong to the item they precede.
+   *
+   * @param tokens The tokens of a source, ending with the end of stream.
+   * @return The `[begin, end)` token ranges of the items.
+   */
+  [[nodiscard]] std::vector<std::pair<size_t, size_t>>
+  splitItems(const std::vector<lexer::Token> &tokens);
+
+  /**
+   * @class IncrementalCompiler
+   * @brief Compiles successive versions of a source, parsing only the items
+   * which changed since the previous version.
+   *
+   * Items are keyed by their tokens, so that edits of whitespace and comments
+   * do not count as changes. Code generation runs over the whole program,
+   * since items depend on the declarations of each other.
+   */
+  class IncrementalCompiler {
+  public:
+    /**
+     * @struct Stats
+     * @brief Statistics of the last compilation.
+     */
+    struct Stats {
+      size_t items = 0;  /**< The items of the source. */
+      size_t reused = 0; /**< The items reused from the previous version. */
+    };
+
+    /**
+     * @brief Construct a new IncrementalCompiler.
+     * @param options The options of the compilations.
+     */
+    explicit IncrementalCompiler(Options options)
+        : options(std::move(options)) {}
+
+    /**
+     * @brief Compile a version of the source.
+     * @param source The source code.
+     * @return The result of the compilation.
+     */
+    [[nodiscard]] Result compile(std::string_view source);
+
+    /**
+     * @brief Get the statistics of the last compilation.
+     * @return The statistics.
+     */
+    [[nodiscard]] const Stats &getStats() const { return stats; }
+
+  private:
+    Options options; /**< The options of the compilations. */
+    Stats stats;     /**< The statistics of the last compilation. */
+
+    std::unordered_map<std::string, std::unique_ptr<nodes::ProgramNode>>
+        items; /**< The parsed items, by their tokens. */
+  };
+
+  /**
+   * @class Watcher
+   * @brief Waits for the saves of a file with inotify.
+   *
+   * The directory of the file is watched rather than the file, editors often
+   * save by replacing the file.
+   */
+  class Watcher {
+  public:
+    /**
+     * @brief Start watching a file.
+     * @param file The file to watch.
+     * @param debounce The quiet time ending a burst of events.
+     */
+    explicit Watcher(std::filesystem::path file,
+                     std::chrono::milliseconds debounce =
+                         std::chrono::milliseconds(50));
+
+    /**
+     * @brief Stop watching.
+     */
+    ~Watcher();
+
+    Watcher(const Watcher &) = delete;
+    Watcher &operator=(const Watcher &) = delete;
+
+    /**
+     * @brief Wait until the file was saved and stayed quiet for a while.
+     */
+    void wait();
+
+  private:
+    /**
+     * @brief Read the pending events.
+     * @param timeout How long to wait for events in ms, negative blocks.
+     * @return Whether the file was written or replaced, nothing if no event
+     * came in time.
+     */
+    std::optional<bool> readEvents(int timeout);
+
+    std::filesystem::path file;          /**< The watched file. */
+    std::chrono::milliseconds debounce;  /**< The quiet time of a save. */
+    int fd = -1;                         /**< The inotify instance. */
+  };
+} // namespace verte::watch
+
+#endif // VERTE_DRIVER_WATCH_HPP
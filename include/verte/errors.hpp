@@ -132,6 +132,32 @@ namespace verte::errors {
      */
     CodegenError(const std::string &message) : VerteError(message) {}
   };
+
+  /**
+   * @class JitError
+   * @brief The error for JIT session errors.
+   */
+  class JitError : public VerteError {
+  public:
+    /**
+     * @brief Constructs a new JitError.
+     * @param message The error message.
+     */
+    JitError(const std::string &message) : VerteError(message) {}
+  };
+
+  /**
+   * @class NetworkError
+   * @brief The error for socket and protocol errors.
+   */
+  class NetworkError : public VerteError {
+  public:
+    /**
+     * @brief Constructs a new NetworkError.
+     * @param message The error message.
+     */
+    NetworkError(const std::string &message) : VerteError(message) {}
+  };
 } // namespace verte::errors
 
 #endif // VERTE_ERRORS_HPP
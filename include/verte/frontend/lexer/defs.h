@@ -43,7 +43,8 @@ namespace verte::defs {
   _(COMMA, ",")     /**< Comma token. */                                       \
   _(DOT, ".")       /**< Dot token. */                                         \
   _(COLON, ":")     /**< Colon token. */                                       \
-  _(SEMICOLON, ";") /**< Semicolon token. */
+  _(SEMICOLON, ";") /**< Semicolon token. */                                   \
+  _(HASH, "#")      /**< Hash token. */
 /** @} */
 
 /**
@@ -92,7 +93,9 @@ namespace verte::defs {
   _(FOR, "for")       /**< 'for' keyword token. */                             \
   _(WHILE, "while")   /**< 'while' keyword token. */                           \
   _(FN, "fn")         /**< 'fn' keyword token. */                              \
-  _(RETURN, "return") /**< 'return' keyword token. */
+  _(RETURN, "return") /**< 'return' keyword token. */                          \
+  _(BENCH, "bench")   /**< 'bench' keyword token. */                           \
+  _(ASM, "asm")       /**< 'asm' keyword token. */
 /** @} */
 
 /**
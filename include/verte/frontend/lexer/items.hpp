@@ -0,0 +1,61 @@
+/**
+ * @brief Splitting a stream of tokens into top-level items.
+ * @file items.hpp
+ */
+
+#ifndef VERTE_FRONTEND_LEXER_ITEMS_HPP
+#define VERTE_FRONTEND_LEXER_ITEMS_HPP
+
+#include "verte/frontend/lexer/token.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace verte::lexer
+ * @brief Lexer namespace, containing lexer-related classes and functions.
+ */
+namespace verte::lexer {
+  /**
+   * @class ItemSplitter
+   * @brief Splits tokens into top-level items as they are lexed.
+   *
+   * Follows `watch::splitItems`: an item ends at a `;` or at the `}` closing
+   * its outermost block, unless an `else` follows. Every item is handed out
+   * with an end of stream token, ready to be parsed on its own.
+   */
+  class ItemSplitter {
+  public:
+    /**
+     * @typedef Handler
+     * @brief Receives the items, in order.
+     */
+    using Handler = std::function<void(std::vector<Token>)>;
+
+    /**
+     * @brief Construct a new ItemSplitter.
+     * @param handler Receives the items.
+     */
+    explicit ItemSplitter(Handler handler) : handler(std::move(handler)) {}
+
+    /**
+     * @brief Feed the next token.
+     * @param token The token, the end of stream hands out the last item.
+     */
+    void feed(Token token);
+
+  private:
+    /**
+     * @brief Hand out the current item.
+     */
+    void flush();
+
+    Handler handler;         /**< Receives the items. */
+    std::vector<Token> item; /**< The tokens of the current item. */
+    int depth = 0;           /**< The nesting of braces and parentheses. */
+    bool closed = false;     /**< Whether the last token closed the item. */
+  };
+} // namespace verte::lexer
+
+#endif // VERTE_FRONTEND_LEXER_ITEMS_HPP
@@ -30,6 +30,18 @@ namespace verte::lexer {
     explicit Lexer(std::string_view source) noexcept
         : source(source), index(0), line(1), column(1), logger("Lexer") {}
 
+    /**
+     * @brief Construct a new Lexer object resuming inside the source.
+     * @param source The source string to lex.
+     * @param index The index to start lexing at.
+     * @param line The line number at the index.
+     * @param column The column number at the index.
+     */
+    Lexer(std::string_view source, size_t index, uint32_t line,
+          uint32_t column) noexcept
+        : source(source), index(index), line(line), column(column),
+          logger("Lexer") {}
+
     /**
      * @brief Get the next token from the source code.
      * @return The next token from the source code.
@@ -49,6 +61,12 @@ namespace verte::lexer {
      */
     bool atEof() const noexcept;
 
+    /**
+     * @brief Get the index the lexer reached, i.e where it failed.
+     * @return The current index in the source code.
+     */
+    [[nodiscard]] size_t getIndex() const noexcept { return index; }
+
   private:
     /**
      * @brief Get the current character from the source code.
@@ -74,7 +92,7 @@ namespace verte::lexer {
      * @brief Skip whitespace and skit comments.
      * @return The next non-whitespace/comment character.
      */
-    char skip() noexcept;
+    char skip();
 
     /**
      * @brief Skip whitespace characters in the source code.
@@ -86,7 +104,7 @@ namespace verte::lexer {
      * @brief Skip comments in the source code.
      * @return The next non-comment character.
      */
-    char skipComments() noexcept;
+    char skipComments();
 
     /**
      * @brief Walk the tokenizer through until the predicate is false.
@@ -119,6 +137,12 @@ namespace verte::lexer {
      */
     [[nodiscard]] Token parseSymbol();
 
+    /**
+     * @brief Get the meta information of the token being lexed.
+     * @return The position of its first character and its length.
+     */
+    [[nodiscard]] Token::Meta meta() const noexcept;
+
     /**
      * @brief Handles an error message.
      * @param message The error message.
@@ -130,6 +154,7 @@ namespace verte::lexer {
     size_t index;    /**< The current index in the source code. */
     uint32_t line;   /**< The current line number. */
     uint32_t column; /**< The current column number. */
+    Token::Meta start{}; /**< The start of the token being lexed. */
 
     utils::Logger logger; /**< The logger for the lexer. */
   };
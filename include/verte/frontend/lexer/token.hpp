@@ -7,10 +7,11 @@
 #define VERTE_FRONTEND_LEXER_TOKENS_H
 
 #include "verte/frontend/lexer/defs.h"
+#include "verte/utils/flat_map.hpp"
 
 #include <cstdint>
 #include <format>
-#include <unordered_map>
+#include <string>
 
 /**
  * @namespace verte::lexer
@@ -50,8 +51,10 @@ namespace verte::lexer {
      * @brief Token meta information.
      */
     struct Meta {
-      uint32_t line;   /**< The line number. */
-      uint32_t column; /**< The column number. */
+      uint32_t line;       /**< The line number of the first character. */
+      uint32_t column;     /**< The column number of the first character. */
+      uint32_t offset = 0; /**< The offset of the first character. */
+      uint32_t length = 0; /**< The length of the token in the source. */
     } meta;
 
     /**
@@ -127,7 +130,7 @@ namespace verte::tokens {
    * @brief Reserved keywords.
    */
   // clang-format off
-  static const std::unordered_map<std::string, lexer::Token::Type> RESERVED = {
+  inline const utils::FlatMap<std::string, lexer::Token::Type> RESERVED = {
     #define _(name, value) {value, lexer::Token::Type::name},
       TOKENS
     #undef _
@@ -136,7 +139,7 @@ namespace verte::tokens {
   /**
    * @brief Atomic symbols and operators.
    */
-  static const std::unordered_map<std::string, lexer::Token::Type> ATOMIC = {
+  inline const utils::FlatMap<std::string, lexer::Token::Type> ATOMIC = {
     #define _(name, value) {value, lexer::Token::Type::name},
       SYMBOLS
       OPERATORS
@@ -166,7 +169,7 @@ namespace verte::tokens {
   /**
    * @brief Mapping of precedence for operators.
    */
-  inline static const std::unordered_map<Token::Type, int> PRECEDENCE = {
+  inline const utils::FlatMap<Token::Type, int> PRECEDENCE = {
       {Token::Type::OR, 1},        {Token::Type::EQUAL, 2},
       {Token::Type::NEQ_EQUAL, 2}, {Token::Type::LESS, 3},
       {Token::Type::GREATER, 3},   {Token::Type::LT_EQUAL, 3},
@@ -83,6 +83,32 @@ namespace verte::nodes {
      * @return The return type of the visitor.
      */
     virtual auto accept(ASTVisitor &visitor) const -> types::RetT = 0;
+
+    /**
+     * @brief Get the span of the node in the source.
+     * @return The span, from the first to the last token.
+     */
+    const Location &getLocation() const { return location; }
+
+    /**
+     * @brief Get the span of the name the node declares or refers to.
+     * @return The span, empty for unnamed nodes.
+     */
+    const Location &getNameLocation() const { return nameLocation; }
+
+    /**
+     * @brief Set the spans of the node.
+     * @param location The span of the node.
+     * @param nameLocation The span of its name, if any.
+     */
+    void setLocation(Location location, Location nameLocation = {}) {
+      this->location = location;
+      this->nameLocation = nameLocation;
+    }
+
+  private:
+    Location location;     /**< The span of the node. */
+    Location nameLocation; /**< The span of the name of the node. */
   };
 
   /**
@@ -168,11 +194,12 @@ namespace verte::nodes {
      * @param type Type information of the variable.
      * @param value Value of the variable.
      * @param isConst Whether the variable is constant. Default is false.
+     * @param attributes Attributes of the variable.
      */
     VarDeclNode(std::string name, TypeInfo type, NodePtr value,
-                bool isConst = false) noexcept
+                bool isConst = false, Attributes attributes = {}) noexcept
         : name(std::move(name)), type(type), value(std::move(value)),
-          isConst(isConst) {}
+          isConst(isConst), attributes(std::move(attributes)) {}
 
     /**
      * @brief Get the name of the variable.
@@ -198,6 +225,12 @@ namespace verte::nodes {
      */
     const bool isConstant() const { return isConst; }
 
+    /**
+     * @brief Get the attributes of the variable.
+     * @return Attributes of the variable.
+     */
+    const Attributes &getAttributes() const { return attributes; }
+
     /**
      * @brief Accept a visitor for the node.
      * @param visitor Visitor to accept.
@@ -210,6 +243,8 @@ namespace verte::nodes {
     TypeInfo type;    /**< Type information. */
     NodePtr value;    /**< Value of the variable. */
     bool isConst;     /**< Whether the variable is constant. */
+
+    Attributes attributes; /**< Attributes of the variable. */
   };
 
   /**
@@ -450,11 +485,12 @@ namespace verte::nodes {
      * @param name Name of the function.
      * @param args Arguments of the function.
      * @param returnType Return type of the function.
+     * @param attributes Attributes of the function.
      */
     ProtoNode(const std::string &name, std::vector<Parameter> params,
-              TypeInfo returnType)
+              TypeInfo returnType, Attributes attributes = {})
         : name(std::move(name)), params(std::move(params)),
-          returnType(returnType) {}
+          returnType(returnType), attributes(std::move(attributes)) {}
 
     /**
      * @brief Get the name of the function.
@@ -474,6 +510,12 @@ namespace verte::nodes {
      */
     const TypeInfo &getRetType() const { return returnType; }
 
+    /**
+     * @brief Get the attributes of the function.
+     * @return Attributes of the function.
+     */
+    const Attributes &getAttributes() const { return attributes; }
+
     /**
      * @brief Accept a visitor for the node.
      * @param visitor Visitor to accept.
@@ -485,6 +527,7 @@ namespace verte::nodes {
     std::string name;              /**< Name of the function. */
     std::vector<Parameter> params; /**< Arguments of the function. */
     TypeInfo returnType;           /**< Return type. */
+    Attributes attributes;         /**< Attributes of the function. */
   };
 
   /**
@@ -620,6 +663,111 @@ namespace verte::nodes {
   private:
     NodePtr value; /**< The value to return. */
   };
+
+  /**
+   * @class BenchNode
+   * @brief Benchmark block node.
+   */
+  class BenchNode : public ASTNode {
+  public:
+    /**
+     * @brief Construct a new BenchNode.
+     * @param name Name of the benchmark.
+     * @param body Body measured by the benchmark.
+     */
+    BenchNode(std::string name, BlockPtr body) noexcept
+        : name(std::move(name)), body(std::move(body)) {}
+
+    /**
+     * @brief Get the name of the benchmark.
+     * @return Name of the benchmark.
+     */
+    const std::string &getName() const { return name; }
+
+    /**
+     * @brief Get the body of the benchmark.
+     * @return Body of the benchmark.
+     */
+    const BlockPtr &getBody() const { return body; }
+
+    /**
+     * @brief Accept a visitor for the node.
+     * @param visitor Visitor to accept.
+     * @return The return value of the visitor.
+     */
+    auto accept(ASTVisitor &visitor) const -> RetT override;
+
+  private:
+    std::string name; /**< Name of the benchmark. */
+    BlockPtr body;    /**< Body of the benchmark. */
+  };
+
+  /**
+   * @class AsmNode
+   * @brief Inline assembly expression node.
+   */
+  class AsmNode : public ASTNode {
+  public:
+    /**
+     * @brief Construct a new AsmNode.
+     * @param code The assembly template, operands are referenced as `$0`...
+     * @param constraints The LLVM constraints of the outputs, the operands and
+     * the clobbers, i.e `=r,r,~{memory}`.
+     * @param operands The input operands.
+     * @param type The type of the output, `void` if none.
+     * @param isVolatile Whether the assembly has side effects.
+     */
+    AsmNode(std::string code, std::string constraints,
+            std::vector<NodePtr> operands, TypeInfo type,
+            bool isVolatile) noexcept
+        : code(std::move(code)), constraints(std::move(constraints)),
+          operands(std::move(operands)), type(std::move(type)),
+          isVolatile(isVolatile) {}
+
+    /**
+     * @brief Get the assembly template.
+     * @return The assembly template.
+     */
+    const std::string &getCode() const { return code; }
+
+    /**
+     * @brief Get the constraints of the assembly.
+     * @return The constraints of the assembly.
+     */
+    const std::string &getConstraints() const { return constraints; }
+
+    /**
+     * @brief Get the input operands.
+     * @return The input operands.
+     */
+    const std::vector<NodePtr> &getOperands() const { return operands; }
+
+    /**
+     * @brief Get the type of the output.
+     * @return The type of the output.
+     */
+    const TypeInfo &getType() const { return type; }
+
+    /**
+     * @brief Check if the assembly has side effects.
+     * @return True if it may neither be removed nor merged.
+     */
+    bool hasSideEffects() const { return isVolatile; }
+
+    /**
+     * @brief Accept a visitor for the node.
+     * @param visitor Visitor to accept.
+     * @return The return value of the visitor.
+     */
+    auto accept(ASTVisitor &visitor) const -> RetT override;
+
+  private:
+    std::string code;              /**< The assembly template. */
+    std::string constraints;       /**< The constraints string. */
+    std::vector<NodePtr> operands; /**< The input operands. */
+    TypeInfo type;                 /**< The type of the output. */
+    bool isVolatile;               /**< Whether it has side effects. */
+  };
 } // namespace verte::nodes
 
 #endif // VERTE_FRONTEND_PARSER_AST_HPP
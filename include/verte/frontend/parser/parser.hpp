@@ -24,10 +24,8 @@ namespace verte::nodes {
    * @return The precedence.
    */
   [[nodiscard]] static inline int getPrecedence(lexer::Token::Type type) {
-    if (tokens::PRECEDENCE.contains(type))
-      return tokens::PRECEDENCE.at(type);
-
-    return -1;
+    const auto precedence = tokens::PRECEDENCE.find(type);
+    return precedence != tokens::PRECEDENCE.end() ? precedence->second : -1;
   }
 } // namespace verte::nodes
 
@@ -67,8 +65,9 @@ namespace verte::nodes {
 
     /**
      * @brief Parse a variable declaration statment.
+     * @param attributes The attributes preceding the declaration.
      */
-    [[nodiscard]] NodePtr parseVarDecl();
+    [[nodiscard]] NodePtr parseVarDecl(Attributes attributes = {});
 
     /**
      * @brief Parse an assignment statement.
@@ -90,14 +89,28 @@ namespace verte::nodes {
 
     /**
      * @brief Parse a function declaration statement.
+     * @param attributes The attributes preceding the declaration.
      */
-    [[nodiscard]] NodePtr parseFuncDecl();
+    [[nodiscard]] NodePtr parseFuncDecl(Attributes attributes = {});
 
     /**
      * @brief Parse prototype for a function declaration.
+     * @param attributes The attributes of the function.
      * @return The parsed prototype.
      */
-    [[nodiscard]] ProtoPtr parseProto();
+    [[nodiscard]] ProtoPtr parseProto(Attributes attributes = {});
+
+    /**
+     * @brief Parse a declaration preceded by attributes.
+     * @return The parsed declaration.
+     */
+    [[nodiscard]] NodePtr parseAttributed();
+
+    /**
+     * @brief Parse attribute lists, i.e `#[export, overflow(trap)]`.
+     * @return The parsed attributes.
+     */
+    [[nodiscard]] Attributes parseAttributes();
 
     /**
      * @brief Parse a parameter list for a function declaration.
@@ -123,6 +136,12 @@ namespace verte::nodes {
      */
     [[nodiscard]] NodePtr parseReturn();
 
+    /**
+     * @brief Parse a benchmark block.
+     * @return The parsed benchmark block.
+     */
+    [[nodiscard]] NodePtr parseBench();
+
     /**
      * @brief Parse an expression statement.
      * @return The parsed expression statement.
@@ -167,6 +186,12 @@ namespace verte::nodes {
      */
     [[nodiscard]] NodePtr parseCall(VariablePtr callee);
 
+    /**
+     * @brief Parse an inline assembly expression.
+     * @return The parsed inline assembly expression.
+     */
+    [[nodiscard]] NodePtr parseAsm();
+
     /**
      * @brief Get the current token.
      * @return The current token.
@@ -208,6 +233,27 @@ namespace verte::nodes {
      */
     [[noreturn]] void error(const std::string &message);
 
+    /**
+     * @brief Get the span of a token.
+     * @param token The token.
+     * @return The span of the token in the source.
+     */
+    [[nodiscard]] static Location locate(const Token &token) noexcept;
+
+    /**
+     * @brief Get the span from a token up to the last consumed token.
+     * @param begin The index of the first token.
+     * @return The span in the source.
+     */
+    [[nodiscard]] Location span(size_t begin) const;
+
+    /**
+     * @brief Get the span from an offset up to the last consumed token.
+     * @param offset The offset of the first character.
+     * @return The span in the source.
+     */
+    [[nodiscard]] Location spanFrom(uint32_t offset) const;
+
     /**
      * @brief Shortcut for creating nodes.
      * @tparam T The type of node to create.
@@ -124,6 +124,20 @@ namespace verte::visitors {
      * @return The return value of the visit.
      */
     virtual auto visit(const ReturnNode &node) -> RetT = 0;
+
+    /**
+     * @brief Visit a benchmark node.
+     * @param node The benchmark node to visit.
+     * @return The return value of the visit.
+     */
+    virtual auto visit(const BenchNode &node) -> RetT = 0;
+
+    /**
+     * @brief Visit an inline assembly node.
+     * @param node The inline assembly node to visit.
+     * @return The return value of the visit.
+     */
+    virtual auto visit(const AsmNode &node) -> RetT = 0;
   };
 } // namespace verte::visitors
 
@@ -0,0 +1,111 @@
+/**
+ * @brief JSON dump of the AST.
+ * @file json.hpp
+ */
+
+#ifndef VERTE_FRONTEND_VISITORS_JSON_HPP
+#define VERTE_FRONTEND_VISITORS_JSON_HPP
+
+#include "verte/frontend/visitors/base.hpp"
+#include "verte/utils/writer.hpp"
+
+#include <ostream>
+#include <string_view>
+
+/**
+ * @namespace verte::visitors
+ * @brief The visitors namespace. Contains AST visitors.
+ */
+namespace verte::visitors {
+  /**
+   * @class JsonPrinter
+   * @brief Dumps the AST as JSON Lines, one object per top-level item.
+   *
+   * Every node is an object with its `kind`, the `offset` and `length` of its
+   * span in the source, then its fields. Children are nested objects, lists of
+   * children are arrays. A program prints each of its items on its own line,
+   * so that consumers parse huge dumps one item at a time.
+   */
+  class JsonPrinter : public ASTVisitor {
+  public:
+    /**
+     * @brief Construct a new JsonPrinter.
+     * @param stream The output stream.
+     */
+    explicit JsonPrinter(std::ostream &stream) : writer(stream) {}
+
+    /**
+     * @brief Hand the output buffered so far to the stream, which is also done
+     * after every program and on destruction.
+     */
+    void flush() { writer.flush(); }
+
+    auto visit(const ProgramNode &node) -> RetT override;
+    auto visit(const LiteralNode &node) -> RetT override;
+    auto visit(const VarDeclNode &node) -> RetT override;
+    auto visit(const AssignNode &node) -> RetT override;
+    auto visit(const VariableNode &node) -> RetT override;
+    auto visit(const IfNode &node) -> RetT override;
+    auto visit(const IfElseNode &node) -> RetT override;
+    auto visit(const BinaryNode &node) -> RetT override;
+    auto visit(const UnaryNode &node) -> RetT override;
+    auto visit(const ProtoNode &node) -> RetT override;
+    auto visit(const BlockNode &node) -> RetT override;
+    auto visit(const FuncDeclNode &node) -> RetT override;
+    auto visit(const CallNode &node) -> RetT override;
+    auto visit(const ReturnNode &node) -> RetT override;
+    auto visit(const BenchNode &node) -> RetT override;
+    auto visit(const AsmNode &node) -> RetT override;
+
+  private:
+    /**
+     * @brief Open the object of a node, with its kind and span.
+     * @param kind The kind of the node.
+     * @param node The node.
+     */
+    void open(std::string_view kind, const ASTNode &node);
+
+    /**
+     * @brief Write a field name, preceded by a comma.
+     * @param name The name of the field.
+     */
+    void key(std::string_view name);
+
+    /**
+     * @brief Write a string field.
+     * @param name The name of the field.
+     * @param value The string.
+     */
+    void field(std::string_view name, std::string_view value);
+
+    /**
+     * @brief Write a child node field, `null` if there is none.
+     * @param name The name of the field.
+     * @param child The child node.
+     */
+    void field(std::string_view name, const ASTNode *child);
+
+    /**
+     * @brief Write an array field of child nodes.
+     * @param name The name of the field.
+     * @param children The child nodes.
+     */
+    void field(std::string_view name, const std::vector<NodePtr> &children);
+
+    /**
+     * @brief Write the attributes field, if there are attributes.
+     * @param attributes The attributes.
+     */
+    void attributes(const Attributes &attributes);
+
+    /**
+     * @brief Write a quoted and escaped JSON string.
+     * @param value The string.
+     */
+    void string(std::string_view value);
+
+    utils::BufferedWriter writer; /**< The buffered output stream. */
+  };
+} // namespace verte::visitors
+
+#endif // VERTE_FRONTEND_VISITORS_JSON_HPP
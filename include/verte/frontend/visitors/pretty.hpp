@@ -7,6 +7,7 @@
 #define VERTE_FRONTEND_VISITORS_PRETTY_HPP
 
 #include "verte/frontend/visitors/base.hpp"
+#include "verte/utils/writer.hpp"
 
 #include <iostream>
 #include <sstream>
@@ -35,7 +36,7 @@ namespace verte::visitors {
     /**
      * @brief Construct a new PrettyPrinter.
      */
-    PrettyPrinter() : stream(std::cout) {}
+    PrettyPrinter() : writer(std::cout) {}
 
     /**
      * @brief Construct a new PrettyPrinter object.
@@ -43,7 +44,13 @@ namespace verte::visitors {
      * @param stream The output stream.
      */
     template <OutputStream Stream>
-    PrettyPrinter(Stream &stream) : stream(stream) {}
+    PrettyPrinter(Stream &stream) : writer(stream) {}
+
+    /**
+     * @brief Hand the output buffered so far to the stream, which is also done
+     * after every program and on destruction.
+     */
+    void flush() { writer.flush(); }
 
     /**
      * @brief Visit a ProgramAST node.
@@ -129,19 +136,33 @@ namespace verte::visitors {
      */
     auto visit(const ReturnNode &node) -> RetT override;
 
+    /**
+     * @brief Visit a BenchNode node.
+     * @param node The BenchNode node to visit.
+     */
+    auto visit(const BenchNode &node) -> RetT override;
+
+    /**
+     * @brief Visit a AsmNode node.
+     * @param node The AsmNode node to visit.
+     */
+    auto visit(const AsmNode &node) -> RetT override;
+
   private:
     /**
      * @brief Print the current indentation level.
-     * @return The output stream with the indentation printed.
+     * @return The writer with the indentation printed.
      */
-    std::ostream &printIndent() {
-      for (int i = 0; i < indentLevel * 2; ++i) {
-        stream << ' ';
-      }
-
-      return stream;
+    utils::BufferedWriter &printIndent() {
+      return writer.fill(' ', static_cast<size_t>(indentLevel) * 2);
     }
 
+    /**
+     * @brief Print the attributes of a declaration, if any.
+     * @param attributes The attributes to print.
+     */
+    void printAttributes(const Attributes &attributes);
+
     /**
      * @brief The IndentGuard class is a helper class used to manage the
      * indentation level in the PrettyPrinter.
@@ -168,8 +189,8 @@ namespace verte::visitors {
     // Allow the IndentGuard class to access the private members of the
     friend class IndentGuard;
 
-    int indentLevel = 0;  /**< The current indentation level. */
-    std::ostream &stream; /**< The output stream. */
+    int indentLevel = 0;          /**< The current indentation level. */
+    utils::BufferedWriter writer; /**< The buffered output stream. */
   };
 } // namespace verte::visitors
 
@@ -0,0 +1,83 @@
+/**
+ * @brief S-expression dump of the AST.
+ * @file sexpr.hpp
+ */
+
+#ifndef VERTE_FRONTEND_VISITORS_SEXPR_HPP
+#define VERTE_FRONTEND_VISITORS_SEXPR_HPP
+
+#include "verte/frontend/visitors/base.hpp"
+#include "verte/utils/writer.hpp"
+
+#include <ostream>
+#include <string_view>
+
+/**
+ * @namespace verte::visitors
+ * @brief The visitors namespace. Contains AST visitors.
+ */
+namespace verte::visitors {
+  /**
+   * @class SexprPrinter
+   * @brief Dumps the AST as S-expressions, one form per top-level item.
+   *
+   * The forms mirror the source: `(fn name ((x int)) int (block ...))`,
+   * `(const name int 3)`, `(+ x 1)`, `(call f x)`. Variables are bare symbols
+   * and literals print as written, strings quoted. Attributes come last, as
+   * `(attr name args...)`.
+   */
+  class SexprPrinter : public ASTVisitor {
+  public:
+    /**
+     * @brief Construct a new SexprPrinter.
+     * @param stream The output stream.
+     */
+    explicit SexprPrinter(std::ostream &stream) : writer(stream) {}
+
+    /**
+     * @brief Hand the output buffered so far to the stream, which is also done
+     * after every program and on destruction.
+     */
+    void flush() { writer.flush(); }
+
+    auto visit(const ProgramNode &node) -> RetT override;
+    auto visit(const LiteralNode &node) -> RetT override;
+    auto visit(const VarDeclNode &node) -> RetT override;
+    auto visit(const AssignNode &node) -> RetT override;
+    auto visit(const VariableNode &node) -> RetT override;
+    auto visit(const IfNode &node) -> RetT override;
+    auto visit(const IfElseNode &node) -> RetT override;
+    auto visit(const BinaryNode &node) -> RetT override;
+    auto visit(const UnaryNode &node) -> RetT override;
+    auto visit(const ProtoNode &node) -> RetT override;
+    auto visit(const BlockNode &node) -> RetT override;
+    auto visit(const FuncDeclNode &node) -> RetT override;
+    auto visit(const CallNode &node) -> RetT override;
+    auto visit(const ReturnNode &node) -> RetT override;
+    auto visit(const BenchNode &node) -> RetT override;
+    auto visit(const AsmNode &node) -> RetT override;
+
+  private:
+    /**
+     * @brief Write the name, parameters and return type of a prototype.
+     * @param node The prototype.
+     */
+    void signature(const ProtoNode &node);
+
+    /**
+     * @brief Write the attributes, each preceded by a space.
+     * @param attributes The attributes.
+     */
+    void attributes(const Attributes &attributes);
+
+    /**
+     * @brief Write a quoted and escaped string.
+     * @param value The string.
+     */
+    void string(std::string_view value);
+
+    utils::BufferedWriter writer; /**< The buffered output stream. */
+  };
+} // namespace verte::visitors
+
+#endif // VERTE_FRONTEND_VISITORS_SEXPR_HPP
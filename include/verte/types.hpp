@@ -9,9 +9,11 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Value.h"
 
+#include "verte/utils/flat_map.hpp"
+
 #include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -47,6 +49,7 @@ namespace verte::types {
       DOUBLE,   /**< Double type. */
       STRING,   /**< String type. */
       BOOL,     /**< Boolean type. */
+      CHANNEL,  /**< Channel type, i.e `chan<int>`. */
       VOID,     /**< Void type. */
       UNKNOWN   /**< Unknown type. */
     } dataType; /**< The data type of the node. */
@@ -94,6 +97,19 @@ namespace verte::types {
       return DataType::UNKNOWN;
     }
 
+    /**
+     * @brief Get the type of the values of a channel.
+     * @return The element type, i.e `int` for `chan<int>`, unknown for the
+     * other types.
+     */
+    TypeInfo element() const {
+      if (dataType != DataType::CHANNEL)
+        return TypeInfo();
+
+      const std::string inner = name.substr(5, name.size() - 6);
+      return TypeInfo(toEnum(inner), inner);
+    }
+
     /**
      * @brief Convert a DataType to a string.
      * @param dataType Data type to convert.
@@ -111,6 +127,8 @@ namespace verte::types {
           return "str";
         case DataType::BOOL:
           return "bool";
+        case DataType::CHANNEL:
+          return "chan";
         case DataType::VOID:
           return "void";
         case DataType::UNKNOWN:
@@ -120,23 +138,116 @@ namespace verte::types {
     }
   };
 
+  /**
+   * @struct Location
+   * @brief A span of the source code.
+   */
+  struct Location {
+    uint32_t offset = 0; /**< The offset of the first character. */
+    uint32_t length = 0; /**< The length of the span. */
+
+    /**
+     * @brief Get the offset past the last character.
+     * @return The end offset.
+     */
+    uint32_t end() const noexcept { return offset + length; }
+  };
+
   /**
    * @struct Parameter
    * @brief Represents a parameter in a function declaration.
    */
   struct Parameter {
-    std::string name; /**< The name of the parameter. */
-    TypeInfo type;    /**< The type of the parameter. */
+    std::string name;  /**< The name of the parameter. */
+    TypeInfo type;     /**< The type of the parameter. */
+    Location location; /**< The location of the name. */
 
     /**
      * @brief Construct a new Parameter.
      * @param name The name of the parameter.
      * @param type The type of the parameter.
+     * @param location The location of the name.
      */
-    Parameter(const std::string &name, const TypeInfo &type)
-        : name(name), type(type){};
+    Parameter(const std::string &name, const TypeInfo &type,
+              Location location = {})
+        : name(name), type(type), location(location){};
   };
 
+  /**
+   * @struct Attribute
+   * @brief Represents an attribute, i.e `#[export]` or `#[name(arg, ...)]`.
+   */
+  struct Attribute {
+    std::string name;              /**< The name of the attribute. */
+    std::vector<std::string> args; /**< The arguments of the attribute. */
+  };
+
+  /**
+   * @typedef Attributes
+   * @brief The attributes attached to a declaration.
+   */
+  using Attributes = std::vector<Attribute>;
+
+  /**
+   * @brief Find an attribute by name.
+   * @param attributes The attributes to search.
+   * @param name The name of the attribute.
+   * @return The attribute, or null if it is not present.
+   */
+  inline const Attribute *findAttribute(const Attributes &attributes,
+                                        std::string_view name) {
+    for (const auto &attribute : attributes) {
+      if (attribute.name == name)
+        return &attribute;
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * @brief Check if a function queries the NUMA topology or allocates from it.
+   * @param name The name of the function.
+   * @return True for `numa_nodes`, `numa_node` and `node_alloc`.
+   */
+  inline bool isNumaBuiltin(std::string_view name) {
+    return name == "numa_nodes" || name == "numa_node" ||
+           name == "node_alloc";
+  }
+
+  /**
+   * @brief Check if a function performs asynchronous I/O.
+   * @param name The name of the function.
+   * @return True for `read_at_async`, `write_at_async`, `submit`, `wait`,
+   * `register_buffer`, `register_file` and `unregister_file`.
+   */
+  inline bool isAioBuiltin(std::string_view name) {
+    return name == "read_at_async" || name == "write_at_async" ||
+           name == "submit" || name == "wait" || name == "register_buffer" ||
+           name == "register_file" || name == "unregister_file";
+  }
+
+  /**
+   * @brief Check if a function operates on channels.
+   * @param name The name of the function.
+   * @return True for `send`, `recv`, `try_send`, `try_recv` and the
+   * constructors of the channel types, i.e `chan<int>`.
+   */
+  inline bool isChannelBuiltin(std::string_view name) {
+    return name == "send" || name == "recv" || name == "try_send" ||
+           name == "try_recv" || name.starts_with("chan<");
+  }
+
+  /**
+   * @brief Check if a function is built into the compiler.
+   * @param name The name of the function.
+   * @return True for `black_box` and the runtime builtins, i.e
+   * `parallel_for`.
+   */
+  inline bool isBuiltin(std::string_view name) {
+    return name == "black_box" || name == "parallel_for" ||
+           isNumaBuiltin(name) || isChannelBuiltin(name) || isAioBuiltin(name);
+  }
+
   /**
    * @struct Function
    * @brief Represents a function.
@@ -147,10 +258,10 @@ namespace verte::types {
     llvm::Type *retType;      /**< The return type of the function. */
 
     std::vector<llvm::Type *> paramTypes; /**< The types of the parameters. */
-    std::unordered_map<std::string, llvm::Constant *>
+    utils::FlatMap<std::string, llvm::Constant *>
         constants; /**< Constants. */
 
-    std::unordered_map<std::string, llvm::AllocaInst *>
+    utils::FlatMap<std::string, llvm::AllocaInst *>
         locals; /**< Local variables. */
 
     /**
@@ -6,32 +6,61 @@
 #ifndef VERTE_UTILS_ARGPARSER_HPP
 #define VERTE_UTILS_ARGPARSER_HPP
 
-/**
- * @def VERTE_VERSION
- * @brief The version of the compiler.
- */
-#ifndef VERTE_VERSION
-#  define VERTE_VERSION "0.1.0"
-#endif // VERTE_VERSION
-
+#include "verte/backend/codegen/codegen.hpp"
 #include "verte/errors.hpp"
 #include "verte/utils/logger.hpp"
+#include "verte/version.hpp"
 
 #include "llvm/Support/CommandLine.h"
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 /**
  * @namespace verte::utils
  * @brief The namespace for utility functions.
  */
 namespace verte::utils {
+  /**
+   * @enum AstFormat
+   * @brief The format of the printed AST.
+   */
+  enum class AstFormat : uint8_t {
+    NONE,  /**< The AST is not printed. */
+    TEXT,  /**< Indented text, for humans. */
+    JSON,  /**< JSON Lines, one object per top-level item. */
+    SEXPR  /**< S-expressions, one form per top-level item. */
+  };
+
+  /**
+   * @enum Emit
+   * @brief What the driver produces.
+   */
+  enum class Emit : uint8_t {
+    EXECUTABLE, /**< A linked executable, or shared library. */
+    ASSEMBLY    /**< The assembly of the host target. */
+  };
+
+  /**
+   * @enum Instrumentation
+   * @brief The instrumentation linked into the compiled program.
+   */
+  enum class Instrumentation : uint8_t {
+    NONE, /**< The program is not instrumented. */
+    ALLOC /**< Sampling heap allocation profiler. */
+  };
+
   /**
    * @class ArgParser
    * @brief The argument parser for command line arguments.
+   * @note Options are registered in the process wide `llvm::cl` registry,
+   * there may only be one parser per process. It is meant for the `vertec`
+   * driver, embedders configure compilations through `verte::Options`.
    */
   class ArgParser {
   public:
@@ -50,11 +79,14 @@ namespace verte::utils {
       logger.info("Initialized argument parser.");
     }
 
+    ArgParser(const ArgParser &) = delete;
+    ArgParser &operator=(const ArgParser &) = delete;
+
     /**
-     * @brief Check if the AST should be printed.
-     * @return True if the AST should be printed, false otherwise.
+     * @brief Get the format of the printed AST.
+     * @return The format, `NONE` if the AST should not be printed.
      */
-    [[nodiscard]] bool shouldPrintAst() const { return printAst.getValue(); }
+    [[nodiscard]] AstFormat getAstFormat() const { return printAst.getValue(); }
 
     /**
      * @brief Check if the generated LLVM IR should be printed.
@@ -62,6 +94,132 @@ namespace verte::utils {
      */
     [[nodiscard]] bool shouldPrintIr() const { return printIr.getValue(); }
 
+    /**
+     * @brief Get what the driver should produce.
+     * @return The output, `EXECUTABLE` unless requested otherwise.
+     */
+    [[nodiscard]] Emit getEmit() const { return emit.getValue(); }
+
+    /**
+     * @brief Check if the assembly should be annotated with the source.
+     * @return True if the assembly should be annotated, false otherwise.
+     */
+    [[nodiscard]] bool shouldAnnotate() const { return annotate.getValue(); }
+
+    /**
+     * @brief Get the CPU to generate code for.
+     * @return The CPU, `generic` unless requested otherwise.
+     */
+    [[nodiscard]] std::string getCpu() const { return mcpu.getValue(); }
+
+    /**
+     * @brief Get the function the throughput report is about.
+     * @return Empty for the innermost loops, nothing if no report is asked.
+     */
+    [[nodiscard]] std::optional<std::string> getMcaReport() const {
+      if (!mcaReport.getNumOccurrences())
+        return std::nullopt;
+
+      return mcaReport.getValue();
+    }
+
+    /**
+     * @brief Check if a benchmark harness should be built.
+     * @return True if the benchmarks should be built, false otherwise.
+     */
+    [[nodiscard]] bool shouldBench() const { return bench.getValue(); }
+
+    /**
+     * @brief Check if a shared library should be built.
+     * @return True if a shared library should be built, false otherwise.
+     */
+    [[nodiscard]] bool shouldBuildShared() const { return shared.getValue(); }
+
+    /**
+     * @brief Get the default behavior of the integer arithmetic on overflow.
+     * @return The behavior, `WRAP` unless requested otherwise.
+     */
+    [[nodiscard]] codegen::Overflow getOverflow() const {
+      return overflow.getValue();
+    }
+
+    /**
+     * @brief Get the instrumentation linked into the program.
+     * @return The instrumentation, `NONE` if the program is not instrumented.
+     */
+    [[nodiscard]] Instrumentation getInstrumentation() const {
+      return instrument.getValue();
+    }
+
+    /**
+     * @brief Check if the stages should run on separate threads.
+     * @return True if the compilation should be pipelined, false otherwise.
+     */
+    [[nodiscard]] bool shouldPipeline() const { return pipeline.getValue(); }
+
+    /**
+     * @brief Check if the input should be compiled one item at a time.
+     * @return True if the compilation should stream, false otherwise.
+     */
+    [[nodiscard]] bool shouldStream() const { return stream.getValue(); }
+
+    /**
+     * @brief Get the optimization level.
+     * @return The optimization level, 0 to 3 if valid.
+     */
+    [[nodiscard]] unsigned getOptLevel() const { return optLevel.getValue(); }
+
+    /**
+     * @brief Check if the generated LLVM IR should be verified.
+     * @return True if the IR should be verified, false otherwise.
+     * @note The IR is always verified from -O1, the flag is for -O0.
+     */
+    [[nodiscard]] bool shouldVerify() const { return verify.getValue(); }
+
+    /**
+     * @brief Check if the input file should be rebuilt on every save.
+     * @return True if the input file should be watched, false otherwise.
+     */
+    [[nodiscard]] bool shouldWatch() const { return watch.getValue(); }
+
+    /**
+     * @brief Check if a language server should be served over stdio.
+     * @return True if in language server mode, false otherwise.
+     */
+    [[nodiscard]] bool shouldServeLsp() const { return lsp.getValue(); }
+
+    /**
+     * @brief Get the endpoint to serve compile jobs on, in worker mode.
+     * @return The `host:port` endpoint, empty outside of worker mode.
+     */
+    [[nodiscard]] const std::string &getWorkerEndpoint() const {
+      return worker.getValue();
+    }
+
+    /**
+     * @brief Get the endpoints of the workers to compile on.
+     * @return The `host:port` endpoints, empty to compile locally.
+     */
+    [[nodiscard]] std::vector<std::string> getRemoteWorkers() const {
+      return {remote.begin(), remote.end()};
+    }
+
+    /**
+     * @brief Get the directory of the local object store.
+     * @return The directory, empty to compile the whole module.
+     */
+    [[nodiscard]] const std::string &getObjectStore() const {
+      return objectStore.getValue();
+    }
+
+    /**
+     * @brief Get the URL of the shared compilation cache.
+     * @return The URL, empty to compile without cache.
+     */
+    [[nodiscard]] const std::string &getCacheUrl() const {
+      return cache.getValue();
+    }
+
     /**
      * @brief Get the log level.
      * @return The log level.
@@ -114,6 +272,13 @@ namespace verte::utils {
   private:
     using StringOption = llvm::cl::opt<std::string>;
 
+    /**
+     * @brief Category for the options.
+     * @note Declared first, the options below register into it.
+     */
+    llvm::cl::OptionCategory category{
+        "Options to control the excerpt compiler."};
+
     /**
      * @brief Input option.
      */
@@ -121,7 +286,7 @@ namespace verte::utils {
     StringOption inputFile{
         llvm::cl::Positional,
         llvm::cl::desc("<input file>"),
-        llvm::cl::Required,
+        llvm::cl::Optional,
         llvm::cl::ValueRequired,
         llvm::cl::cat(category)}; /**< The input file. */
             
@@ -137,9 +302,18 @@ namespace verte::utils {
     /**
      * @brief Print ast option.
      */
-    llvm::cl::opt<bool> printAst{
+    llvm::cl::opt<AstFormat> printAst{
         "print-ast",
         llvm::cl::desc("Print the AST"),
+        llvm::cl::ValueOptional,
+        llvm::cl::init(AstFormat::NONE),
+        llvm::cl::values(
+          clEnumValN(AstFormat::TEXT, "", ""),
+          clEnumValN(AstFormat::TEXT, "text", "Indented text (default)"),
+          clEnumValN(AstFormat::JSON, "json", "JSON Lines, one item per line"),
+          clEnumValN(AstFormat::SEXPR, "sexpr", "S-expressions, one item per "
+                                                "line")
+        ),
         llvm::cl::cat(category)};
 
     /**
@@ -150,6 +324,188 @@ namespace verte::utils {
       llvm::cl::desc("Print the generated LLVM IR"),
       llvm::cl::cat(category)};
 
+    /**
+     * @brief Output option.
+     */
+    llvm::cl::opt<Emit> emit{
+        "emit",
+        llvm::cl::desc("What to produce"),
+        llvm::cl::init(Emit::EXECUTABLE),
+        llvm::cl::values(
+          clEnumValN(Emit::EXECUTABLE, "exe",
+                     "A linked executable (default)"),
+          clEnumValN(Emit::ASSEMBLY, "asm", "Assembly, to stdout unless -o "
+                                            "is given")
+        ),
+        llvm::cl::cat(category)};
+
+    /**
+     * @brief Annotate the assembly option.
+     */
+    llvm::cl::opt<bool> annotate{
+      "annotate",
+      llvm::cl::desc("Interleave the assembly with the source lines and "
+                     "summarize each function"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Target CPU option.
+     */
+    StringOption mcpu{
+      "mcpu",
+      llvm::cl::desc("The CPU to generate code for, `native` for the host"),
+      llvm::cl::value_desc("cpu"),
+      llvm::cl::init("generic"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Throughput report option.
+     */
+    StringOption mcaReport{
+      "mca-report",
+      llvm::cl::desc("Estimate the throughput of the innermost loops, or of "
+                     "a function, on the -mcpu"),
+      llvm::cl::value_desc("function"),
+      llvm::cl::ValueOptional,
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Build a benchmark harness option.
+     */
+    llvm::cl::opt<bool> bench{
+      "bench",
+      llvm::cl::desc("Build the `bench` blocks into a benchmark harness"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Integer overflow behavior option.
+     */
+    llvm::cl::opt<codegen::Overflow> overflow{
+        "overflow",
+        llvm::cl::desc("Behavior of the integer arithmetic on overflow"),
+        llvm::cl::init(codegen::Overflow::WRAP),
+        llvm::cl::values(
+          clEnumValN(codegen::Overflow::WRAP, "wrap",
+                     "Wrap around silently (default)"),
+          clEnumValN(codegen::Overflow::TRAP, "trap", "Abort the program"),
+          clEnumValN(codegen::Overflow::SATURATE, "saturate",
+                     "Clamp to the bounds of the type")
+        ),
+        llvm::cl::cat(category)};
+
+    /**
+     * @brief Instrument the program option.
+     */
+    llvm::cl::opt<Instrumentation> instrument{
+        "instrument",
+        llvm::cl::desc("Instrument the compiled program"),
+        llvm::cl::init(Instrumentation::NONE),
+        llvm::cl::values(
+          clEnumValN(Instrumentation::ALLOC, "alloc",
+                     "Sample the heap allocations into a pprof profile")
+        ),
+        llvm::cl::cat(category)};
+
+    /**
+     * @brief Build a shared library option.
+     */
+    llvm::cl::opt<bool> shared{
+      "shared",
+      llvm::cl::desc("Build a shared library and its C header, only "
+                     "`#[export]` symbols are visible"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Optimization level option.
+     */
+    llvm::cl::opt<unsigned> optLevel{
+      "O",
+      llvm::cl::desc("Optimization level, from 0 to 3"),
+      llvm::cl::value_desc("level"),
+      llvm::cl::Prefix,
+      llvm::cl::init(0),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Verify the generated IR option.
+     */
+    llvm::cl::opt<bool> verify{
+      "verify",
+      llvm::cl::desc("Verify the generated LLVM IR, always done from -O1"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Pipelined compilation option.
+     */
+    llvm::cl::opt<bool> pipeline{
+      "pipeline",
+      llvm::cl::desc("Lex, parse and generate the items of the input on "
+                     "separate threads"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Streaming compilation option.
+     */
+    llvm::cl::opt<bool> stream{
+      "stream",
+      llvm::cl::desc("Compile the input one top-level item at a time, in "
+                     "bounded memory"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Watch mode option.
+     */
+    llvm::cl::opt<bool> watch{
+      "watch",
+      llvm::cl::desc("Rebuild whenever the input file is saved"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Language server option.
+     */
+    llvm::cl::opt<bool> lsp{
+      "lsp",
+      llvm::cl::desc("Serve the Language Server Protocol over stdio"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Serve compile jobs option.
+     */
+    StringOption worker{
+      "worker",
+      llvm::cl::desc("Serve compile jobs on an endpoint instead of compiling"),
+      llvm::cl::value_desc("host:port"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Compile on workers option.
+     */
+    llvm::cl::list<std::string> remote{
+      "remote",
+      llvm::cl::desc("Compile on workers, locally if none of them answers"),
+      llvm::cl::value_desc("host:port,..."),
+      llvm::cl::CommaSeparated,
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Local object store option.
+     */
+    StringOption objectStore{
+      "object-store",
+      llvm::cl::desc("Compile each function to its own object, reusing the "
+                     "unchanged ones from a local store"),
+      llvm::cl::value_desc("directory"),
+      llvm::cl::cat(category)};
+
+    /**
+     * @brief Shared compilation cache option.
+     */
+    StringOption cache{
+      "cache",
+      llvm::cl::desc("Look up and upload the compilation in a shared cache"),
+      llvm::cl::value_desc("http://host:port[/prefix]"),
+      llvm::cl::cat(category)};
+
     /**
     * @brief Set the log level flag.
     */
@@ -164,11 +520,7 @@ namespace verte::utils {
         clEnumValN(utils::LogLevel::ERROR, "error", "Error log level")
       ),
       llvm::cl::cat(category)};
-    
-    /**
-     * @brief Category for the options.
-     */
-    llvm::cl::OptionCategory category{"Options to control the excerpt compiler."};
+
 
     Logger logger; /**< The logger for the ArgParser. */
     // clang-format on
@@ -0,0 +1,624 @@
+/**
+ * @brief Open-addressing hash map with inline storage.
+ * @file flat_map.hpp
+ */
+
+#ifndef VERTE_UTILS_FLAT_MAP_HPP
+#define VERTE_UTILS_FLAT_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @namespace verte::utils
+ * @brief The namespace for utility functions.
+ */
+namespace verte::utils {
+  /**
+   * @struct FlatHash
+   * @brief The default hash of a FlatMap, transparent for strings so that
+   * `std::string_view` and literals are looked up without a copy.
+   *
+   * @tparam K The type of the keys.
+   */
+  template <typename K> struct FlatHash : std::hash<K> {};
+
+  template <> struct FlatHash<std::string> {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const noexcept {
+      return std::hash<std::string_view>{}(key);
+    }
+  };
+
+  /**
+   * @class FlatMap
+   * @brief An open-addressing hash map keeping its entries in one array.
+   *
+   * Slots are split into groups of 16, each with a control byte per slot
+   * holding 7 bits of the hash of its key, or marking it empty or erased. A
+   * lookup compares the control bytes of a whole group at once, with SSE2 when
+   * available, and only compares the keys whose 7 bits match. Groups are
+   * probed quadratically until one has an empty slot. The table grows past
+   * 7/8 full, erased slots are reclaimed when it does.
+   *
+   * Unlike `std::unordered_map`, inserting or erasing moves the entries:
+   * iterators, pointers and references are invalidated by any insertion.
+   * Keys must not be modified through iterators.
+   *
+   * @tparam K The type of the keys.
+   * @tparam V The type of the values.
+   * @tparam Hash The hash of the keys, transparent for heterogeneous lookup.
+   * @tparam Equal The comparison of the keys.
+   */
+  template <typename K, typename V, typename Hash = FlatHash<K>,
+            typename Equal = std::equal_to<>>
+  class FlatMap {
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+
+  private:
+    static constexpr size_t GROUP = 16; /**< The slots of a group. */
+
+    /**
+     * @enum Control
+     * @brief The control bytes not holding a hash, both negative.
+     */
+    enum Control : int8_t {
+      EMPTY = -128, /**< The slot was never used. */
+      ERASED = -2   /**< The slot was erased, probes go on past it. */
+    };
+
+    /**
+     * @struct Slot
+     * @brief Storage for an entry, constructed only when its slot is full.
+     */
+    struct Slot {
+      union {
+        value_type value; /**< The entry. */
+      };
+
+      Slot() noexcept {}
+      ~Slot() {}
+    };
+
+    /**
+     * @struct Group
+     * @brief The control bytes of a group, matched at once.
+     */
+    struct Group {
+#if defined(__SSE2__)
+      __m128i bytes; /**< The control bytes. */
+
+      explicit Group(const int8_t *control)
+          : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(control))) {
+      }
+
+      /**
+       * @brief Match the slots holding a hash.
+       * @return One bit per matching slot.
+       */
+      [[nodiscard]] uint32_t match(int8_t hash) const {
+        return static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), bytes)));
+      }
+
+      /**
+       * @brief Match the empty or erased slots, whose byte is negative.
+       * @return One bit per matching slot.
+       */
+      [[nodiscard]] uint32_t matchFree() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+      }
+#else
+      int8_t bytes[GROUP]; /**< The control bytes. */
+
+      explicit Group(const int8_t *control) {
+        std::memcpy(bytes, control, GROUP);
+      }
+
+      [[nodiscard]] uint32_t match(int8_t hash) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; ++i)
+          mask |= static_cast<uint32_t>(bytes[i] == hash) << i;
+
+        return mask;
+      }
+
+      [[nodiscard]] uint32_t matchFree() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; ++i)
+          mask |= static_cast<uint32_t>(bytes[i] < 0) << i;
+
+        return mask;
+      }
+#endif
+
+      /**
+       * @brief Match the empty slots.
+       * @return One bit per empty slot.
+       */
+      [[nodiscard]] uint32_t matchEmpty() const { return match(EMPTY); }
+    };
+
+    /**
+     * @class Iterator
+     * @brief Walks the full slots in table order.
+     * @tparam Const Whether the entries are read only.
+     */
+    template <bool Const> class Iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = FlatMap::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+      using reference =
+          std::conditional_t<Const, const value_type &, value_type &>;
+
+      Iterator() = default;
+
+      /**
+       * @brief Convert a mutable iterator to a read-only one.
+       */
+      template <bool Other>
+        requires(Const && !Other)
+      Iterator(const Iterator<Other> &other)
+          : control(other.control), slot(other.slot), last(other.last) {}
+
+      reference operator*() const { return slot->value; }
+      pointer operator->() const { return &slot->value; }
+
+      Iterator &operator++() {
+        ++control;
+        ++slot;
+        skip();
+        return *this;
+      }
+
+      Iterator operator++(int) {
+        Iterator previous = *this;
+        ++*this;
+        return previous;
+      }
+
+      bool operator==(const Iterator &other) const {
+        return slot == other.slot;
+      }
+
+    private:
+      friend class FlatMap;
+      template <bool> friend class Iterator;
+
+      using SlotPtr = std::conditional_t<Const, const Slot *, Slot *>;
+
+      Iterator(const int8_t *control, SlotPtr slot, const int8_t *last)
+          : control(control), slot(slot), last(last) {}
+
+      /**
+       * @brief Move to the next full slot, or to the end.
+       */
+      void skip() {
+        while (control != last && *control < 0) {
+          ++control;
+          ++slot;
+        }
+      }
+
+      const int8_t *control = nullptr; /**< The control byte of the slot. */
+      SlotPtr slot = nullptr;          /**< The slot. */
+      const int8_t *last = nullptr;    /**< The end of the control bytes. */
+    };
+
+  public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatMap() = default;
+
+    /**
+     * @brief Construct a map from entries, the first of equal keys wins.
+     * @param entries The entries.
+     */
+    FlatMap(std::initializer_list<value_type> entries) {
+      reserve(entries.size());
+      for (const auto &entry : entries)
+        try_emplace(entry.first, entry.second);
+    }
+
+    FlatMap(const FlatMap &other) {
+      reserve(other.count);
+      for (const auto &entry : other)
+        insertNew(mix(Hash{}(entry.first)), entry.first, entry.second);
+    }
+
+    FlatMap(FlatMap &&other) noexcept { swap(other); }
+
+    FlatMap &operator=(FlatMap other) noexcept {
+      swap(other);
+      return *this;
+    }
+
+    ~FlatMap() { destroy(); }
+
+    /**
+     * @brief Swap the contents of two maps.
+     * @param other The other map.
+     */
+    void swap(FlatMap &other) noexcept {
+      std::swap(control, other.control);
+      std::swap(slots, other.slots);
+      std::swap(capacity, other.capacity);
+      std::swap(count, other.count);
+      std::swap(growthLeft, other.growthLeft);
+    }
+
+    iterator begin() {
+      iterator it(control.get(), slots.get(), control.get() + capacity);
+      it.skip();
+      return it;
+    }
+
+    iterator end() {
+      return iterator(control.get() + capacity, slots.get() + capacity,
+                      control.get() + capacity);
+    }
+
+    const_iterator begin() const {
+      const_iterator it(control.get(), slots.get(), control.get() + capacity);
+      it.skip();
+      return it;
+    }
+
+    const_iterator end() const {
+      return const_iterator(control.get() + capacity, slots.get() + capacity,
+                            control.get() + capacity);
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return count; }
+    [[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+    /**
+     * @brief Get the number of slots.
+     * @return The capacity, a multiple of the group size.
+     */
+    [[nodiscard]] size_t slotCount() const noexcept { return capacity; }
+
+    /**
+     * @brief Make room for entries, so that inserting them does not grow the
+     * table.
+     * @param entries The number of entries.
+     */
+    void reserve(size_t entries) {
+      size_t needed = GROUP;
+      while (maxLoad(needed) < entries)
+        needed *= 2;
+
+      if (needed > capacity)
+        rehash(needed);
+    }
+
+    /**
+     * @brief Erase every entry, keeping the capacity.
+     */
+    void clear() noexcept {
+      destroyEntries();
+      std::fill_n(control.get(), capacity, EMPTY);
+      count = 0;
+      growthLeft = maxLoad(capacity);
+    }
+
+    /**
+     * @brief Find an entry.
+     * @param key The key, or anything hashing and comparing as one.
+     * @return The entry, or the end.
+     */
+    template <typename Key> iterator find(const Key &key) {
+      const size_t index = lookup(key);
+      return index == capacity ? end() : iteratorAt(index);
+    }
+
+    template <typename Key> const_iterator find(const Key &key) const {
+      const size_t index = lookup(key);
+      if (index == capacity)
+        return end();
+
+      return const_iterator(control.get() + index, slots.get() + index,
+                            control.get() + capacity);
+    }
+
+    template <typename Key> [[nodiscard]] bool contains(const Key &key) const {
+      return lookup(key) != capacity;
+    }
+
+    /**
+     * @brief Get the value of a key.
+     * @param key The key.
+     * @return The value.
+     * @throws std::out_of_range If the key is missing.
+     */
+    template <typename Key> V &at(const Key &key) {
+      const size_t index = lookup(key);
+      if (index == capacity)
+        throw std::out_of_range("FlatMap::at: missing key");
+
+      return slots[index].value.second;
+    }
+
+    template <typename Key> const V &at(const Key &key) const {
+      return const_cast<FlatMap *>(this)->at(key);
+    }
+
+    /**
+     * @brief Get the value of a key, inserting a default one if missing.
+     * @param key The key, converted to the key type when inserted.
+     * @return The value.
+     */
+    template <typename Key> V &operator[](Key &&key) {
+      return try_emplace(std::forward<Key>(key)).first->second;
+    }
+
+    /**
+     * @brief Insert an entry unless the key is present.
+     * @param key The key, converted to the key type when inserted.
+     * @param args The arguments constructing the value.
+     * @return The entry of the key, and whether it was inserted.
+     */
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+      const size_t hash = mix(Hash{}(key));
+      if (const size_t index = lookup(key, hash); index != capacity)
+        return {iteratorAt(index), false};
+
+      const size_t index = insertNew(hash, std::forward<Key>(key),
+                                     std::forward<Args>(args)...);
+      return {iteratorAt(index), true};
+    }
+
+    /**
+     * @brief Insert an entry unless its key is present.
+     * @param entry The entry.
+     * @return The entry of the key, and whether it was inserted.
+     */
+    std::pair<iterator, bool> insert(value_type entry) {
+      return try_emplace(std::move(entry.first), std::move(entry.second));
+    }
+
+    /**
+     * @brief Insert or replace the value of a key.
+     * @param key The key.
+     * @param value The value.
+     * @return The entry of the key, and whether it was inserted.
+     */
+    template <typename Key, typename Value>
+    std::pair<iterator, bool> insert_or_assign(Key &&key, Value &&value) {
+      auto result = try_emplace(std::forward<Key>(key));
+      result.first->second = std::forward<Value>(value);
+      return result;
+    }
+
+    /**
+     * @brief Erase the entry of a key.
+     * @param key The key.
+     * @return The number of entries erased, 0 or 1.
+     */
+    template <typename Key> size_t erase(const Key &key) {
+      const size_t index = lookup(key);
+      if (index == capacity)
+        return 0;
+
+      eraseAt(index);
+      return 1;
+    }
+
+    /**
+     * @brief Erase an entry.
+     * @param position The entry.
+     * @return The next entry.
+     */
+    iterator erase(iterator position) {
+      const size_t index = static_cast<size_t>(position.slot - slots.get());
+      eraseAt(index);
+      return ++position;
+    }
+
+  private:
+    /**
+     * @brief Spread the bits of a hash, `std::hash` being the identity for
+     * integers.
+     */
+    static size_t mix(size_t hash) noexcept {
+      uint64_t value = static_cast<uint64_t>(hash);
+      value ^= value >> 32;
+      value *= 0x9e3779b97f4a7c15ull;
+      return static_cast<size_t>(value ^ (value >> 29));
+    }
+
+    /**
+     * @brief Get the 7 bits of a hash kept in the control bytes.
+     */
+    static int8_t tag(size_t hash) noexcept {
+      return static_cast<int8_t>(hash & 0x7f);
+    }
+
+    /**
+     * @brief Get the entries a number of slots holds before growing.
+     */
+    static size_t maxLoad(size_t slots) noexcept { return slots - slots / 8; }
+
+    iterator iteratorAt(size_t index) {
+      return iterator(control.get() + index, slots.get() + index,
+                      control.get() + capacity);
+    }
+
+    template <typename Key> size_t lookup(const Key &key) const {
+      return lookup(key, mix(Hash{}(key)));
+    }
+
+    /**
+     * @brief Find the slot of a key.
+     * @return The index of the slot, or the capacity if missing.
+     */
+    template <typename Key> size_t lookup(const Key &key, size_t hash) const {
+      if (capacity == 0)
+        return capacity;
+
+      const size_t mask = capacity / GROUP - 1;
+      size_t group = (hash >> 7) & mask;
+
+      for (size_t step = 1;; ++step) {
+        const Group bytes(control.get() + group * GROUP);
+
+        for (uint32_t match = bytes.match(tag(hash)); match;
+             match &= match - 1) {
+          const size_t index = group * GROUP + std::countr_zero(match);
+          if (Equal{}(slots[index].value.first, key))
+            return index;
+        }
+
+        if (bytes.matchEmpty())
+          return capacity;
+
+        group = (group + step) & mask;
+      }
+    }
+
+    /**
+     * @brief Find a free slot for a hash, assuming its key is missing.
+     * @return The index of the slot.
+     */
+    size_t findFree(size_t hash) const {
+      const size_t mask = capacity / GROUP - 1;
+      size_t group = (hash >> 7) & mask;
+
+      for (size_t step = 1;; ++step) {
+        const Group bytes(control.get() + group * GROUP);
+        if (const uint32_t free = bytes.matchFree())
+          return group * GROUP + std::countr_zero(free);
+
+        group = (group + step) & mask;
+      }
+    }
+
+    /**
+     * @brief Insert an entry whose key is missing.
+     * @param hash The mixed hash of the key.
+     * @return The index of its slot.
+     */
+    template <typename Key, typename... Args>
+    size_t insertNew(size_t hash, Key &&key, Args &&...args) {
+      if (capacity == 0)
+        rehash(GROUP);
+
+      size_t index = findFree(hash);
+
+      // Filling an empty slot may leave a group without one, which probes
+      // need to stop: past the load factor, grow or reclaim erased slots.
+      if (control[index] == EMPTY && growthLeft == 0) {
+        rehash(maxLoad(capacity) / 2 < count ? capacity * 2 : capacity);
+        index = findFree(hash);
+      }
+
+      if (control[index] == EMPTY)
+        growthLeft--;
+
+      std::construct_at(&slots[index].value, std::piecewise_construct,
+                        std::forward_as_tuple(K(std::forward<Key>(key))),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+      control[index] = tag(hash);
+      count++;
+      return index;
+    }
+
+    /**
+     * @brief Erase the entry of a full slot.
+     */
+    void eraseAt(size_t index) {
+      std::destroy_at(&slots[index].value);
+      count--;
+
+      // Probes stop at a group with an empty slot, which they would also do
+      // here: the slot may be empty again.
+      const Group bytes(control.get() + index / GROUP * GROUP);
+      if (bytes.matchEmpty()) {
+        control[index] = EMPTY;
+        growthLeft++;
+      }
+
+      else
+        control[index] = ERASED;
+    }
+
+    /**
+     * @brief Move the entries to a table of the given number of slots.
+     */
+    void rehash(size_t slotCount) {
+      auto oldControl = std::move(control);
+      auto oldSlots = std::move(slots);
+      const size_t oldCapacity = capacity;
+
+      control = std::make_unique<int8_t[]>(slotCount);
+      slots = std::make_unique<Slot[]>(slotCount);
+      std::fill_n(control.get(), slotCount, EMPTY);
+      capacity = slotCount;
+      growthLeft = maxLoad(slotCount) - count;
+
+      for (size_t i = 0; i < oldCapacity; ++i) {
+        if (oldControl[i] < 0)
+          continue;
+
+        auto &value = oldSlots[i].value;
+        const size_t hash = mix(Hash{}(value.first));
+        const size_t index = findFree(hash);
+
+        std::construct_at(&slots[index].value, std::move(value));
+        control[index] = tag(hash);
+        std::destroy_at(&value);
+      }
+    }
+
+    /**
+     * @brief Destroy the entries, leaving the control bytes as they are.
+     */
+    void destroyEntries() noexcept {
+      for (size_t i = 0; i < capacity; ++i) {
+        if (control[i] >= 0)
+          std::destroy_at(&slots[i].value);
+      }
+    }
+
+    void destroy() noexcept {
+      destroyEntries();
+      control.reset();
+      slots.reset();
+      capacity = count = growthLeft = 0;
+    }
+
+    std::unique_ptr<int8_t[]> control; /**< The control bytes of the slots. */
+    std::unique_ptr<Slot[]> slots;     /**< The slots. */
+    size_t capacity = 0;               /**< The number of slots. */
+    size_t count = 0;                  /**< The number of entries. */
+    size_t growthLeft = 0; /**< The empty slots which may still be filled. */
+  };
+} // namespace verte::utils
+
+#endif // VERTE_UTILS_FLAT_MAP_HPP
@@ -6,9 +6,11 @@
 #ifndef VERTE_UTILS_LOGGER_HPP
 #define VERTE_UTILS_LOGGER_HPP
 
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -46,24 +48,70 @@ namespace verte::utils {
   /**
    * @namespace verte::utils::logging
    * @brief The namespace for global logging configuration.
+   * @note The log level is the only state of a compilation that is not owned
+   * by it: the loggers of the lexer, parser and code generator read it when
+   * they log, and every entry point running a compilation on a thread
+   * installs `Options::logLevel` with a `ScopedLevel`, including the worker
+   * threads of `--pipeline`.
    */
   namespace logging {
     /**
      * @brief The global log level.
      */
-    inline LogLevel globalLevel = LogLevel::NONE;
+    inline std::atomic<LogLevel> globalLevel = LogLevel::NONE;
+
+    /**
+     * @brief The log level of the compilation running on this thread.
+     * @note Overrides the global log level when set.
+     */
+    inline thread_local std::optional<LogLevel> threadLevel;
 
     /**
      * @brief Sets the global log level.
      * @param level The LogLevel to set as global.
      */
-    inline void setLevel(LogLevel level) { globalLevel = level; }
+    inline void setLevel(LogLevel level) {
+      globalLevel.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the log level in effect on this thread.
+     * @return The log level of this thread, or else the global log level.
+     */
+    inline LogLevel getLevel() {
+      if (threadLevel)
+        return *threadLevel;
+
+      return globalLevel.load(std::memory_order_relaxed);
+    }
 
     /**
-     * @brief Get the global log level.
-     * @return The global log level.
+     * @class ScopedLevel
+     * @brief Sets the log level of this thread for the lifetime of a scope.
      */
-    inline LogLevel getLevel() { return globalLevel; }
+    class ScopedLevel {
+    public:
+      /**
+       * @brief Construct a new ScopedLevel.
+       * @param level The log level, none keeps the current one.
+       */
+      explicit ScopedLevel(std::optional<LogLevel> level) noexcept
+          : previous(threadLevel) {
+        if (level)
+          threadLevel = level;
+      }
+
+      /**
+       * @brief Restore the previous log level of this thread.
+       */
+      ~ScopedLevel() { threadLevel = previous; }
+
+      ScopedLevel(const ScopedLevel &) = delete;
+      ScopedLevel &operator=(const ScopedLevel &) = delete;
+
+    private:
+      std::optional<LogLevel> previous; /**< The level to restore. */
+    };
   } // namespace logging
 
   /**
@@ -162,10 +210,13 @@ namespace verte::utils {
 
       // Unpacking code and prefix.
       const auto &[code, prefix] = LEVEL_DATA[static_cast<uint8_t>(level)];
-      output << "[" + timestamp + "]";
-      output << std::format("{}[{}:{}]: \x1B[0m ", code, name, prefix);
-      output << std::vformat(message, std::make_format_args(args...));
-      output << "\n";
+
+      // Write the line at once, so concurrent loggers do not interleave.
+      std::string line = "[" + timestamp + "]";
+      line += std::format("{}[{}:{}]: \x1B[0m ", code, name, prefix);
+      line += std::vformat(message, std::make_format_args(args...));
+      line += "\n";
+      output << line;
     }
 
     /**
@@ -0,0 +1,147 @@
+/**
+ * @brief Bounded lock-free queue between two threads.
+ * @file queue.hpp
+ */
+
+#ifndef VERTE_UTILS_QUEUE_HPP
+#define VERTE_UTILS_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+/**
+ * @namespace verte::utils
+ * @brief The namespace for utility functions.
+ */
+namespace verte::utils {
+  /**
+   * @class SpscQueue
+   * @brief A bounded single-producer single-consumer ring.
+   *
+   * The producer only writes the tail and the consumer only writes the head,
+   * each on its own cache line, so that neither needs a lock. A full or empty
+   * queue is waited on by spinning, then by yielding the thread. The producer
+   * closes the queue once done, the consumer then drains it.
+   *
+   * @tparam T The type of the elements.
+   */
+  template <typename T> class SpscQueue {
+  public:
+    /**
+     * @brief Construct a new SpscQueue.
+     * @param capacity The capacity, rounded up to a power of two.
+     */
+    explicit SpscQueue(size_t capacity)
+        : mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          slots(std::make_unique<std::optional<T>[]>(mask + 1)) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief Push an element, unless the queue is full.
+     * @param value The element, left untouched if the queue is full.
+     * @return True if the element was pushed, false otherwise.
+     */
+    bool tryPush(T &value) {
+      const size_t tail = this->tail.load(std::memory_order_relaxed);
+      if (tail - cachedHead > mask) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (tail - cachedHead > mask)
+          return false;
+      }
+
+      slots[tail & mask].emplace(std::move(value));
+      this->tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Pop an element, unless the queue is empty.
+     * @return The element, or nothing if the queue is empty.
+     */
+    std::optional<T> tryPop() {
+      const size_t head = this->head.load(std::memory_order_relaxed);
+      if (head == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (head == cachedTail)
+          return std::nullopt;
+      }
+
+      auto &slot = slots[head & mask];
+      std::optional<T> value = std::move(slot);
+      slot.reset();
+
+      this->head.store(head + 1, std::memory_order_release);
+      return value;
+    }
+
+    /**
+     * @brief Push an element, waiting while the queue is full.
+     * @param value The element.
+     */
+    void push(T value) {
+      for (unsigned spins = 0; !tryPush(value); ++spins)
+        pause(spins);
+    }
+
+    /**
+     * @brief Pop an element, waiting while the queue is empty.
+     * @return The element, or nothing once the queue is closed and empty.
+     */
+    std::optional<T> pop() {
+      for (unsigned spins = 0;; ++spins) {
+        if (auto value = tryPop())
+          return value;
+
+        // Elements pushed before closing are visible once closed is.
+        if (closed.load(std::memory_order_acquire))
+          return tryPop();
+
+        pause(spins);
+      }
+    }
+
+    /**
+     * @brief Close the queue, no element may be pushed afterwards.
+     */
+    void close() { closed.store(true, std::memory_order_release); }
+
+  private:
+    /**
+     * @brief Wait a little for the other thread.
+     * @param spins The times waited so far.
+     */
+    static void pause(unsigned spins) {
+      if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+        return;
+      }
+
+      std::this_thread::yield();
+    }
+
+    static constexpr size_t LINE = 64; /**< The size of a cache line. */
+
+    const size_t mask;                        /**< The capacity minus one. */
+    std::unique_ptr<std::optional<T>[]> slots; /**< The ring. */
+
+    alignas(LINE) std::atomic<size_t> head{0}; /**< The next slot to pop. */
+    size_t cachedTail = 0; /**< The tail last seen by the consumer. */
+
+    alignas(LINE) std::atomic<size_t> tail{0}; /**< The next slot to push. */
+    size_t cachedHead = 0; /**< The head last seen by the producer. */
+
+    alignas(LINE) std::atomic<bool> closed{false}; /**< Whether closed. */
+  };
+} // namespace verte::utils
+
+#endif // VERTE_UTILS_QUEUE_HPP
@@ -0,0 +1,74 @@
+/**
+ * @brief TCP server running a thread per connection.
+ * @file server.hpp
+ */
+
+#ifndef VERTE_UTILS_SERVER_HPP
+#define VERTE_UTILS_SERVER_HPP
+
+#include "verte/utils/socket.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+namespace verte::utils {
+  /**
+   * @class ConnectionServer
+   * @brief Accepts connections and serves each one on its own thread.
+   *
+   * Stopping shuts the listener and the open connections down, then waits for
+   * every connection to wind down.
+   */
+  class ConnectionServer {
+  public:
+    /**
+     * @brief The function serving a connection, until the peer leaves.
+     */
+    using Handler = std::function<void(Socket &connection)>;
+
+    /**
+     * @brief Start listening, port 0 picks any free port.
+     * @param endpoint The endpoint to listen on.
+     */
+    explicit ConnectionServer(const Endpoint &endpoint);
+
+    /**
+     * @brief Stop the server, waiting for the open connections.
+     */
+    ~ConnectionServer();
+
+    ConnectionServer(const ConnectionServer &) = delete;
+    ConnectionServer &operator=(const ConnectionServer &) = delete;
+
+    /**
+     * @brief Get the port the server listens on.
+     * @return The port.
+     */
+    [[nodiscard]] uint16_t getPort() const { return port; }
+
+    /**
+     * @brief Serve connections until `stop` is called.
+     * @param handler Serves a connection, called on the connection's thread.
+     */
+    void run(const Handler &handler);
+
+    /**
+     * @brief Stop serving, from any thread.
+     */
+    void stop();
+
+  private:
+    Socket listener; /**< The listening socket. */
+    uint16_t port;   /**< The port listened on. */
+
+    std::mutex mutex;                  /**< Guards the fields below. */
+    std::condition_variable changed;   /**< Signals the fields below. */
+    std::unordered_set<Socket *> open; /**< The open connections. */
+    bool stopping = false;             /**< Set once stopped. */
+  };
+} // namespace verte::utils
+
+#endif // VERTE_UTILS_SERVER_HPP
@@ -0,0 +1,150 @@
+/**
+ * @brief Minimal blocking TCP sockets.
+ * @file socket.hpp
+ */
+
+#ifndef VERTE_UTILS_SOCKET_HPP
+#define VERTE_UTILS_SOCKET_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @namespace verte::utils
+ * @brief The utils namespace. Contains utility classes and functions.
+ */
+namespace verte::utils {
+  /**
+   * @struct Endpoint
+   * @brief A TCP endpoint, i.e `127.0.0.1:7000`.
+   */
+  struct Endpoint {
+    std::string host; /**< The host name or address. */
+    uint16_t port;    /**< The port. */
+
+    /**
+     * @brief Parse an endpoint of the form `host:port`.
+     * @param text The text to parse.
+     * @return The endpoint, or nothing if the text is malformed.
+     */
+    [[nodiscard]] static std::optional<Endpoint> parse(std::string_view text);
+
+    /**
+     * @brief Format the endpoint as `host:port`.
+     * @return The formatted endpoint.
+     */
+    [[nodiscard]] std::string toString() const;
+  };
+
+  /**
+   * @class Socket
+   * @brief Owning handle of a connected or listening TCP socket.
+   *
+   * All operations block, failures are reported as `errors::NetworkError`.
+   */
+  class Socket {
+  public:
+    /**
+     * @brief Construct an invalid socket.
+     */
+    Socket() noexcept = default;
+
+    /**
+     * @brief Take the ownership of a file descriptor.
+     * @param fd The file descriptor.
+     */
+    explicit Socket(int fd) noexcept : fd(fd) {}
+
+    /**
+     * @brief Close the socket.
+     */
+    ~Socket();
+
+    Socket(const Socket &) = delete;
+    Socket &operator=(const Socket &) = delete;
+
+    Socket(Socket &&other) noexcept;
+    Socket &operator=(Socket &&other) noexcept;
+
+    /**
+     * @brief Connect to an endpoint.
+     * @param endpoint The endpoint to connect to.
+     * @param timeout The time allowed to establish the connection.
+     * @return The connected socket.
+     */
+    [[nodiscard]] static Socket connect(const Endpoint &endpoint,
+                                        std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Listen on an endpoint, port 0 picks any free port.
+     * @param endpoint The endpoint to listen on.
+     * @return The listening socket.
+     */
+    [[nodiscard]] static Socket listen(const Endpoint &endpoint);
+
+    /**
+     * @brief Accept a connection on a listening socket.
+     * @return The connection, invalid once the socket was shut down.
+     */
+    [[nodiscard]] Socket accept() const;
+
+    /**
+     * @brief Get the port the socket is bound to.
+     * @return The local port.
+     */
+    [[nodiscard]] uint16_t localPort() const;
+
+    /**
+     * @brief Bound the time spent in a single send or receive.
+     * @param timeout The timeout, zero blocks forever.
+     */
+    void setTimeout(std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief Send a whole buffer.
+     * @param data The buffer to send.
+     */
+    void sendAll(std::string_view data) const;
+
+    /**
+     * @brief Receive the bytes available, waiting for at least one.
+     * @param buffer Receives the bytes.
+     * @param size The size of the buffer.
+     * @return The number of bytes received, 0 once the peer closed.
+     */
+    [[nodiscard]] size_t receive(char *buffer, size_t size) const;
+
+    /**
+     * @brief Receive exactly `size` bytes.
+     * @param size The number of bytes to receive.
+     * @return The bytes, or nothing if the peer closed the connection first.
+     */
+    [[nodiscard]] std::optional<std::string> receiveExact(size_t size) const;
+
+    /**
+     * @brief Receive until the peer closes the connection.
+     * @return The received bytes.
+     */
+    [[nodiscard]] std::string receiveAll() const;
+
+    /**
+     * @brief Stop both directions, unblocking any pending operation.
+     */
+    void shutdown() const noexcept;
+
+    /**
+     * @brief Check if the socket holds a file descriptor.
+     * @return True if the socket is valid, false otherwise.
+     */
+    [[nodiscard]] bool valid() const noexcept { return fd >= 0; }
+
+  private:
+    int fd = -1; /**< The file descriptor. */
+  };
+} // namespace verte::utils
+
+#endif // VERTE_UTILS_SOCKET_HPP
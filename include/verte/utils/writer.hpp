@@ -0,0 +1,118 @@
+/**
+ * @brief Buffered output for large dumps.
+ * @file writer.hpp
+ */
+
+#ifndef VERTE_UTILS_WRITER_HPP
+#define VERTE_UTILS_WRITER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string_view>
+
+/**
+ * @namespace verte::utils
+ * @brief The utils namespace. Contains utility classes and functions.
+ */
+namespace verte::utils {
+  /**
+   * @class BufferedWriter
+   * @brief Collects small writes into a buffer, handed to a stream in large
+   * blocks.
+   *
+   * Writes only copy into the buffer, the stream is called once the buffer is
+   * full, on `flush` and on destruction. Text larger than the buffer goes to
+   * the stream directly.
+   */
+  class BufferedWriter {
+  public:
+    /**
+     * @brief Construct a new BufferedWriter.
+     * @param stream The stream receiving the blocks.
+     * @param capacity The size of the buffer.
+     */
+    explicit BufferedWriter(std::ostream &stream, size_t capacity = 1 << 16)
+        : stream(stream), buffer(std::make_unique<char[]>(capacity)),
+          capacity(capacity) {}
+
+    /**
+     * @brief Flush the buffer.
+     */
+    ~BufferedWriter() { flush(); }
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    /**
+     * @brief Write text.
+     * @param text The text.
+     * @return The writer.
+     */
+    BufferedWriter &write(std::string_view text) {
+      if (text.size() > capacity - size) {
+        flush();
+
+        if (text.size() >= capacity) {
+          stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+          return *this;
+        }
+      }
+
+      std::memcpy(buffer.get() + size, text.data(), text.size());
+      size += text.size();
+      return *this;
+    }
+
+    /**
+     * @brief Write a character.
+     * @param c The character.
+     * @return The writer.
+     */
+    BufferedWriter &put(char c) {
+      if (size == capacity)
+        flush();
+
+      buffer[size++] = c;
+      return *this;
+    }
+
+    /**
+     * @brief Write a character several times, i.e indentation.
+     * @param c The character.
+     * @param count The number of times.
+     * @return The writer.
+     */
+    BufferedWriter &fill(char c, size_t count);
+
+    /**
+     * @brief Write an unsigned integer in decimal.
+     * @param value The integer.
+     * @return The writer.
+     */
+    BufferedWriter &number(size_t value);
+
+    BufferedWriter &operator<<(std::string_view text) { return write(text); }
+    BufferedWriter &operator<<(char c) { return put(c); }
+
+    /**
+     * @brief Hand the buffer to the stream.
+     */
+    void flush() {
+      if (size == 0)
+        return;
+
+      stream.write(buffer.get(), static_cast<std::streamsize>(size));
+      size = 0;
+    }
+
+  private:
+    std::ostream &stream;            /**< The stream receiving the blocks. */
+    std::unique_ptr<char[]> buffer;  /**< The buffer. */
+    size_t capacity;                 /**< The size of the buffer. */
+    size_t size = 0;                 /**< The bytes in the buffer. */
+  };
+} // namespace verte::utils
+
+#endif // VERTE_UTILS_WRITER_HPP
@@ -0,0 +1,17 @@
+/**
+ * @brief Version of the compiler.
+ * @file version.hpp
+ */
+
+#ifndef VERTE_VERSION_HPP
+#define VERTE_VERSION_HPP
+
+/**
+ * @def VERTE_VERSION
+ * @brief The version of the compiler.
+ */
+#ifndef VERTE_VERSION
+#  define VERTE_VERSION "0.1.0"
+#endif // VERTE_VERSION
+
+#endif // VERTE_VERSION_HPP
@@ -0,0 +1,575 @@
+/**
+ * @brief Batched asynchronous file I/O.
+ * @file aio.c
+ *
+ * Every thread queues its reads and writes in its own io_uring, created on
+ * first use, then submits the whole batch with one system call, so many
+ * operations are in flight at once. Registered buffers and files spare the
+ * kernel mapping the pages and looking up the file of every operation.
+ *
+ * Where io_uring is unavailable, or with `VERTE_AIO=threads`, submitted
+ * batches are run by a few I/O threads with `pread` and `pwrite` instead.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "verte.h"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define VERTE_AIO_DEPTH 256  /**< Operations in flight per thread. */
+#define VERTE_AIO_BUFFERS 16 /**< Registered buffers per thread. */
+#define VERTE_AIO_FILES 64   /**< Registered files per thread. */
+#define VERTE_AIO_THREADS 4  /**< Default number of fallback I/O threads. */
+
+/**
+ * @struct aio_request
+ * @brief An operation, from its queueing until its result is taken.
+ */
+typedef struct aio_request {
+  int32_t ticket; /**< The ticket of the operation, -1 once free. */
+  atomic_int done; /**< Whether it completed, the futex of the fallback. */
+  int64_t result;  /**< Bytes transferred, or a negated errno. */
+
+  int32_t fd;               /**< The file. */
+  int32_t write;            /**< Whether it writes rather than reads. */
+  char *buffer;             /**< The memory read into or written from. */
+  int64_t size;             /**< The number of bytes. */
+  int64_t offset;           /**< The offset in the file. */
+  struct aio_request *next; /**< Next operation of a fallback batch. */
+} aio_request;
+
+/**
+ * @struct aio_ring
+ * @brief The operations of a thread and its io_uring, if any.
+ */
+typedef struct aio_ring {
+  int fd; /**< The io_uring, -1 for the fallback. */
+
+  unsigned *sq_head;  /**< Submissions consumed by the kernel. */
+  unsigned *sq_tail;  /**< Submissions queued. */
+  unsigned *sq_mask;  /**< Mask of the submission indices. */
+  unsigned *sq_array; /**< Submission entries, in order. */
+  unsigned *cq_head;  /**< Completions consumed. */
+  unsigned *cq_tail;  /**< Completions posted by the kernel. */
+  unsigned *cq_mask;  /**< Mask of the completion indices. */
+  struct io_uring_sqe *sqes; /**< Submission entries. */
+  struct io_uring_cqe *cqes; /**< Completion entries. */
+
+  void *sq_map;     /**< Mapping of the submission ring. */
+  void *cq_map;     /**< Mapping of the completion ring. */
+  size_t sq_size;   /**< Size of the submission ring mapping. */
+  size_t cq_size;   /**< Size of the completion ring mapping. */
+  size_t sqes_size; /**< Size of the submission entries mapping. */
+
+  unsigned queued;          /**< Operations queued but not submitted. */
+  aio_request *batch;       /**< The fallback operations not submitted. */
+  aio_request **batch_tail; /**< Where the next one is linked. */
+  int32_t next_ticket;      /**< The ticket of the next operation. */
+
+  struct iovec buffers[VERTE_AIO_BUFFERS]; /**< Registered buffers. */
+  int32_t buffer_count;                    /**< Number of buffers. */
+  int32_t files[VERTE_AIO_FILES];          /**< Registered files. */
+  int32_t file_count;                      /**< Number of files. */
+
+  aio_request requests[VERTE_AIO_DEPTH]; /**< Indexed by ticket. */
+} aio_ring;
+
+/**
+ * @struct aio_state
+ * @brief The fallback I/O threads, started on first use.
+ */
+static struct aio_state {
+  pthread_once_t once;    /**< Creates the key of the rings. */
+  pthread_key_t key;      /**< Releases the ring of an exiting thread. */
+  pthread_once_t started; /**< Starts the I/O threads. */
+  pthread_mutex_t lock;   /**< Guards the queue. */
+  pthread_cond_t ready;   /**< Signals queued operations. */
+  aio_request *head;      /**< The submitted fallback operations. */
+  aio_request **tail;     /**< Where the next batch is linked. */
+} aio = {
+    .once = PTHREAD_ONCE_INIT,
+    .started = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .ready = PTHREAD_COND_INITIALIZER,
+    .tail = &aio.head,
+};
+
+static _Thread_local aio_ring *current; /**< The ring of the thread. */
+
+/**
+ * @brief Map the rings of a new io_uring.
+ * @return Whether the io_uring can be used.
+ */
+static int ring_setup(aio_ring *ring) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  const int fd = (int)syscall(__NR_io_uring_setup, VERTE_AIO_DEPTH, &params);
+  if (fd < 0)
+    return 0;
+
+  // `IORING_OP_READ` and `IORING_OP_WRITE` came with this feature, in 5.6.
+  if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+    close(fd);
+    return 0;
+  }
+
+  ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+  // Both rings share a mapping since 5.4.
+  const int single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single)
+    ring->sq_size = ring->cq_size =
+        ring->sq_size > ring->cq_size ? ring->sq_size : ring->cq_size;
+
+  ring->sq_map = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  ring->cq_map = single || ring->sq_map == MAP_FAILED
+                     ? ring->sq_map
+                     : mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+  if (ring->sq_map == MAP_FAILED || ring->cq_map == MAP_FAILED ||
+      ring->sqes == MAP_FAILED) {
+    if (ring->sqes != MAP_FAILED)
+      munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map)
+      munmap(ring->cq_map, ring->cq_size);
+    if (ring->sq_map != MAP_FAILED)
+      munmap(ring->sq_map, ring->sq_size);
+
+    close(fd);
+    return 0;
+  }
+
+  char *sq = ring->sq_map, *cq = ring->cq_map;
+  ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+  ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+  ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+  ring->fd = fd;
+  return 1;
+}
+
+/**
+ * @brief Take the completions posted by the kernel.
+ */
+static void ring_reap(aio_ring *ring) {
+  unsigned head = *ring->cq_head;
+  const unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+  for (; head != tail; head++) {
+    const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    aio_request *request = &ring->requests[cqe->user_data];
+
+    request->result = cqe->res;
+    atomic_store_explicit(&request->done, 1, memory_order_relaxed);
+  }
+
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Queue an operation in the submission ring.
+ */
+static void ring_push(aio_ring *ring, aio_request *request) {
+  const unsigned tail = *ring->sq_tail;
+  const unsigned index = tail & *ring->sq_mask;
+
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = request->write ? IORING_OP_WRITE : IORING_OP_READ;
+  sqe->fd = request->fd;
+  sqe->addr = (uintptr_t)request->buffer;
+  sqe->len = request->size > UINT32_MAX ? UINT32_MAX : (uint32_t)request->size;
+  sqe->off = (uint64_t)request->offset;
+  sqe->user_data = (uint64_t)(request - ring->requests);
+
+  // Operations within a registered buffer use it as is.
+  for (int32_t i = 0; i < ring->buffer_count; i++) {
+    const char *base = ring->buffers[i].iov_base;
+    if (request->buffer >= base &&
+        request->buffer + sqe->len <= base + ring->buffers[i].iov_len) {
+      sqe->opcode = request->write ? IORING_OP_WRITE_FIXED
+                                   : IORING_OP_READ_FIXED;
+      sqe->buf_index = (uint16_t)i;
+      break;
+    }
+  }
+
+  for (int32_t i = 0; i < ring->file_count; i++) {
+    if (ring->files[i] == request->fd) {
+      sqe->fd = i;
+      sqe->flags |= IOSQE_FIXED_FILE;
+      break;
+    }
+  }
+
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring->queued++;
+}
+
+/**
+ * @brief Run the submitted fallback operations.
+ */
+static void *aio_worker(void *unused) {
+  (void)unused;
+
+  for (;;) {
+    pthread_mutex_lock(&aio.lock);
+    while (!aio.head)
+      pthread_cond_wait(&aio.ready, &aio.lock);
+
+    aio_request *request = aio.head;
+    aio.head = request->next;
+    if (!aio.head)
+      aio.tail = &aio.head;
+
+    pthread_mutex_unlock(&aio.lock);
+
+    const ssize_t result =
+        request->write ? pwrite(request->fd, request->buffer,
+                                (size_t)request->size, request->offset)
+                       : pread(request->fd, request->buffer,
+                               (size_t)request->size, request->offset);
+
+    request->result = result < 0 ? -errno : result;
+    atomic_store_explicit(&request->done, 1, memory_order_release);
+    syscall(SYS_futex, &request->done, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Start the fallback I/O threads, `VERTE_AIO_THREADS` of them.
+ */
+static void aio_start(void) {
+  const char *limit = getenv("VERTE_AIO_THREADS");
+  int threads = limit ? atoi(limit) : VERTE_AIO_THREADS;
+  threads = threads > 0 ? threads : 1;
+
+  for (int i = 0; i < threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, aio_worker, NULL) == 0)
+      pthread_detach(thread);
+  }
+}
+
+/**
+ * @brief Submit the queued operations of a ring.
+ * @return The number of operations submitted, or a negated errno.
+ */
+static int32_t aio_submit(aio_ring *ring) {
+  int32_t submitted = 0;
+
+  if (ring->fd < 0) {
+    if (!ring->batch)
+      return 0;
+
+    pthread_once(&aio.started, aio_start);
+    for (aio_request *request = ring->batch; request; request = request->next)
+      submitted++;
+
+    pthread_mutex_lock(&aio.lock);
+    *aio.tail = ring->batch;
+    aio.tail = ring->batch_tail;
+    pthread_mutex_unlock(&aio.lock);
+    pthread_cond_broadcast(&aio.ready);
+
+    ring->batch = NULL;
+    ring->batch_tail = &ring->batch;
+    return submitted;
+  }
+
+  while (ring->queued > 0) {
+    const long result = syscall(__NR_io_uring_enter, ring->fd, ring->queued,
+                                0, 0, NULL, 0);
+    if (result < 0 && errno == EINTR)
+      continue;
+
+    if (result < 0)
+      return -errno;
+
+    ring->queued -= (unsigned)result;
+    submitted += (int32_t)result;
+  }
+
+  return submitted;
+}
+
+/**
+ * @brief Wait for an operation and free its ticket.
+ * @return The result of the operation.
+ */
+static int64_t aio_wait(aio_ring *ring, aio_request *request) {
+  // Operations are only waited for once submitted.
+  const int32_t submitted = aio_submit(ring);
+  if (submitted < 0)
+    return submitted;
+
+  while (!atomic_load_explicit(&request->done, memory_order_acquire)) {
+    if (ring->fd < 0) {
+      syscall(SYS_futex, &request->done, FUTEX_WAIT_PRIVATE, 0, NULL, NULL,
+              0);
+      continue;
+    }
+
+    ring_reap(ring);
+    if (atomic_load_explicit(&request->done, memory_order_relaxed))
+      break;
+
+    const long result = syscall(__NR_io_uring_enter, ring->fd, 0, 1,
+                                IORING_ENTER_GETEVENTS, NULL, 0);
+    if (result < 0 && errno != EINTR)
+      return -errno;
+  }
+
+  request->ticket = -1;
+  return request->result;
+}
+
+/**
+ * @brief Release the ring of an exiting thread, once its operations are
+ * done with the buffers.
+ */
+static void aio_release(void *data) {
+  aio_ring *ring = data;
+
+  for (int32_t i = 0; i < VERTE_AIO_DEPTH; i++) {
+    if (ring->requests[i].ticket >= 0)
+      aio_wait(ring, &ring->requests[i]);
+  }
+
+  if (ring->fd >= 0) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != ring->sq_map)
+      munmap(ring->cq_map, ring->cq_size);
+
+    munmap(ring->sq_map, ring->sq_size);
+    close(ring->fd);
+  }
+
+  free(ring);
+}
+
+/**
+ * @brief Create the key releasing the rings.
+ */
+static void aio_init(void) { pthread_key_create(&aio.key, aio_release); }
+
+/**
+ * @brief Get the ring of the calling thread, created on first use.
+ * @return The ring, or null if it could not be allocated.
+ */
+static aio_ring *aio_current(void) {
+  if (current)
+    return current;
+
+  pthread_once(&aio.once, aio_init);
+
+  aio_ring *ring = calloc(1, sizeof(aio_ring));
+  if (!ring)
+    return NULL;
+
+  ring->fd = -1;
+  ring->batch_tail = &ring->batch;
+  for (int32_t i = 0; i < VERTE_AIO_DEPTH; i++)
+    ring->requests[i].ticket = -1;
+
+  const char *mode = getenv("VERTE_AIO");
+  if (!mode || strcmp(mode, "threads") != 0)
+    ring_setup(ring);
+
+  pthread_setspecific(aio.key, ring);
+  return current = ring;
+}
+
+/**
+ * @brief Queue a read or a write.
+ * @return Its ticket, or a negated errno.
+ */
+static int32_t aio_queue(int32_t fd, int32_t write, char *buffer,
+                         int64_t size, int64_t offset) {
+  aio_ring *ring = aio_current();
+  if (!ring)
+    return -ENOMEM;
+
+  if (size < 0 || offset < 0)
+    return -EINVAL;
+
+  // Take the next free ticket, tickets are reused once waited for.
+  for (int32_t tries = 0; tries < VERTE_AIO_DEPTH; tries++) {
+    const int32_t ticket = ring->next_ticket;
+    ring->next_ticket = (ticket + 1) & INT32_MAX;
+
+    aio_request *request = &ring->requests[ticket % VERTE_AIO_DEPTH];
+    if (request->ticket >= 0)
+      continue;
+
+    request->ticket = ticket;
+    atomic_store_explicit(&request->done, 0, memory_order_relaxed);
+    request->fd = fd;
+    request->write = write;
+    request->buffer = buffer;
+    request->size = size;
+    request->offset = offset;
+    request->next = NULL;
+
+    if (ring->fd >= 0) {
+      ring_push(ring, request);
+    } else {
+      *ring->batch_tail = request;
+      ring->batch_tail = &request->next;
+    }
+
+    return ticket;
+  }
+
+  return -EBUSY;
+}
+
+int32_t verte_read_at_async(int32_t fd, char *buffer, int64_t size,
+                            int64_t offset) {
+  return aio_queue(fd, 0, buffer, size, offset);
+}
+
+int32_t verte_write_at_async(int32_t fd, char *buffer, int64_t size,
+                             int64_t offset) {
+  return aio_queue(fd, 1, buffer, size, offset);
+}
+
+int32_t verte_submit(void) {
+  aio_ring *ring = aio_current();
+  return ring ? aio_submit(ring) : -ENOMEM;
+}
+
+int64_t verte_wait(int32_t ticket) {
+  aio_ring *ring = aio_current();
+  if (!ring)
+    return -ENOMEM;
+
+  if (ticket < 0 ||
+      ring->requests[ticket % VERTE_AIO_DEPTH].ticket != ticket)
+    return -EINVAL;
+
+  return aio_wait(ring, &ring->requests[ticket % VERTE_AIO_DEPTH]);
+}
+
+int32_t verte_register_buffer(char *buffer, int64_t size) {
+  aio_ring *ring = aio_current();
+  if (!ring)
+    return -ENOMEM;
+
+  // The fallback has nothing to register.
+  if (ring->fd < 0)
+    return 0;
+
+  if (ring->buffer_count == VERTE_AIO_BUFFERS)
+    return -ENOSPC;
+
+  // The kernel takes the whole table at once.
+  if (ring->buffer_count > 0)
+    syscall(__NR_io_uring_register, ring->fd, IORING_UNREGISTER_BUFFERS, NULL,
+            0);
+
+  ring->buffers[ring->buffer_count].iov_base = buffer;
+  ring->buffers[ring->buffer_count].iov_len = (size_t)size;
+
+  if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS,
+              ring->buffers, ring->buffer_count + 1) == 0) {
+    ring->buffer_count++;
+    return 0;
+  }
+
+  const int32_t error = -errno;
+  if (ring->buffer_count > 0 &&
+      syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS,
+              ring->buffers, ring->buffer_count) != 0)
+    ring->buffer_count = 0;
+
+  return error;
+}
+
+int32_t verte_register_file(int32_t fd) {
+  aio_ring *ring = aio_current();
+  if (!ring)
+    return -ENOMEM;
+
+  if (ring->fd < 0)
+    return 0;
+
+  if (ring->file_count == VERTE_AIO_FILES)
+    return -ENOSPC;
+
+  if (ring->file_count > 0)
+    syscall(__NR_io_uring_register, ring->fd, IORING_UNREGISTER_FILES, NULL,
+            0);
+
+  ring->files[ring->file_count] = fd;
+  if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_FILES,
+              ring->files, ring->file_count + 1) == 0) {
+    ring->file_count++;
+    return 0;
+  }
+
+  const int32_t error = -errno;
+  if (ring->file_count > 0 &&
+      syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_FILES,
+              ring->files, ring->file_count) != 0)
+    ring->file_count = 0;
+
+  return error;
+}
+
+int32_t verte_unregister_file(int32_t fd) {
+  aio_ring *ring = aio_current();
+  if (!ring)
+    return -ENOMEM;
+
+  if (ring->fd < 0)
+    return 0;
+
+  int32_t index = 0;
+  while (index < ring->file_count && ring->files[index] != fd)
+    index++;
+
+  if (index == ring->file_count)
+    return -ENOENT;
+
+  // The kernel takes the whole table at once, it drops its reference to the
+  // file with it.
+  syscall(__NR_io_uring_register, ring->fd, IORING_UNREGISTER_FILES, NULL, 0);
+
+  ring->files[index] = ring->files[--ring->file_count];
+  if (ring->file_count > 0 &&
+      syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_FILES,
+              ring->files, ring->file_count) != 0)
+    ring->file_count = 0;
+
+  return 0;
+}
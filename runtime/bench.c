@@ -0,0 +1,186 @@
+/**
+ * @brief Benchmark harness runtime.
+ * @file bench.c
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "verte.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define VERTE_BENCH_SAMPLE_NS 5000000ull   /**< Target time per sample. */
+#define VERTE_BENCH_WARMUP_NS 100000000ull /**< Warmup time per benchmark. */
+#define VERTE_BENCH_SAMPLES 30             /**< Default sample count. */
+
+/**
+ * @struct bench_result
+ * @brief Statistics of a single benchmark.
+ */
+typedef struct bench_result {
+  uint64_t iterations; /**< Iterations per sample. */
+  int32_t samples;     /**< Number of samples. */
+  double mean;         /**< Mean ns per iteration. */
+  double median;       /**< Median ns per iteration. */
+  double stddev;       /**< Standard deviation of ns per iteration. */
+} bench_result;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t run_batch(void (*fn)(void), uint64_t iterations) {
+  const uint64_t start = now_ns();
+  for (uint64_t i = 0; i < iterations; ++i)
+    fn();
+
+  return now_ns() - start;
+}
+
+static uint64_t calibrate(void (*fn)(void)) {
+  uint64_t iterations = 1;
+
+  // Grow the batch until it takes long enough to be timed reliably.
+  for (;;) {
+    const uint64_t elapsed = run_batch(fn, iterations);
+    if (elapsed >= VERTE_BENCH_SAMPLE_NS)
+      return iterations;
+
+    // Extrapolate from the last batch, but never grow more than 10x at once.
+    uint64_t next = iterations * 10;
+    if (elapsed > 0) {
+      const double scale = (double)VERTE_BENCH_SAMPLE_NS / (double)elapsed;
+      const uint64_t estimate = (uint64_t)((double)iterations * scale * 1.2);
+
+      if (estimate < next)
+        next = estimate;
+    }
+
+    iterations = next > iterations ? next : iterations + 1;
+  }
+}
+
+static int compare_doubles(const void *lhs, const void *rhs) {
+  const double a = *(const double *)lhs;
+  const double b = *(const double *)rhs;
+  return (a > b) - (a < b);
+}
+
+static bench_result run_bench(const verte_bench *bench, int32_t samples) {
+  bench_result result = {0};
+  result.iterations = calibrate(bench->fn);
+  result.samples = samples;
+
+  // Warm caches, branch predictors and the CPU frequency up.
+  const uint64_t warmup = now_ns();
+  while (now_ns() - warmup < VERTE_BENCH_WARMUP_NS)
+    run_batch(bench->fn, result.iterations);
+
+  double *times = malloc(sizeof(double) * (size_t)samples);
+  if (!times)
+    return result;
+
+  double sum = 0;
+  for (int32_t i = 0; i < samples; ++i) {
+    const uint64_t elapsed = run_batch(bench->fn, result.iterations);
+    times[i] = (double)elapsed / (double)result.iterations;
+    sum += times[i];
+  }
+
+  result.mean = sum / samples;
+
+  double variance = 0;
+  for (int32_t i = 0; i < samples; ++i)
+    variance += (times[i] - result.mean) * (times[i] - result.mean);
+
+  result.stddev = samples > 1 ? sqrt(variance / (samples - 1)) : 0;
+
+  qsort(times, (size_t)samples, sizeof(double), compare_doubles);
+  result.median = samples % 2 ? times[samples / 2]
+                              : (times[samples / 2 - 1] + times[samples / 2]) / 2;
+
+  free(times);
+  return result;
+}
+
+static void print_json_string(const char *str) {
+  putchar('"');
+  for (; *str; ++str) {
+    if (*str == '"' || *str == '\\')
+      putchar('\\');
+
+    putchar(*str);
+  }
+
+  putchar('"');
+}
+
+int32_t verte_bench_main(int32_t argc, char **argv,
+                         const verte_bench *benches, int32_t count) {
+  int json = 0;
+  int32_t samples = VERTE_BENCH_SAMPLES;
+  const char *filter = NULL;
+
+  for (int32_t i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--json") == 0)
+      json = 1;
+
+    else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+      filter = argv[++i];
+
+    else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+      samples = atoi(argv[++i]);
+
+    else {
+      fprintf(stderr, "usage: %s [--json] [--filter <str>] [--samples <n>]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  if (samples < 1)
+    samples = 1;
+
+  if (json)
+    printf("{\"benchmarks\": [");
+  else
+    printf("%-32s %12s %14s %14s %14s\n", "benchmark", "iterations",
+           "mean (ns)", "median (ns)", "stddev (ns)");
+
+  int first = 1;
+  for (int32_t i = 0; i < count; ++i) {
+    if (filter && !strstr(benches[i].name, filter))
+      continue;
+
+    const bench_result result = run_bench(&benches[i], samples);
+
+    if (json) {
+      printf("%s\n  {\"name\": ", first ? "" : ",");
+      print_json_string(benches[i].name);
+      printf(", \"iterations\": %llu, \"samples\": %d, \"mean_ns\": %.3f, "
+             "\"median_ns\": %.3f, \"stddev_ns\": %.3f}",
+             (unsigned long long)result.iterations, result.samples,
+             result.mean, result.median, result.stddev);
+    }
+
+    else {
+      printf("%-32s %12llu %14.3f %14.3f %14.3f\n", benches[i].name,
+             (unsigned long long)result.iterations, result.mean,
+             result.median, result.stddev);
+    }
+
+    fflush(stdout);
+    first = 0;
+  }
+
+  if (json)
+    printf("\n]}\n");
+
+  return 0;
+}
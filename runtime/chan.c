@@ -0,0 +1,281 @@
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer channels.
+ * @file chan.c
+ *
+ * A channel is a ring of cells, each with a sequence number telling whose
+ * turn it is: a sender may fill the cell of position `p` once its sequence
+ * is `p`, a receiver may empty it once it is `p + 1`. Positions are claimed
+ * with a compare and swap, so no lock is ever held and a preempted thread
+ * only delays the cell it claimed.
+ *
+ * Blocking calls spin a little, then sleep on an eventcount: a futex whose
+ * low bit tells that a thread sleeps on it. The other side only writes it,
+ * and only calls the kernel, when the bit is set, so the fast path writes
+ * nothing but the positions and the cells.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "verte.h"
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define VERTE_CHAN_SPINS 256             /**< Retries before sleeping. */
+#define VERTE_CHAN_MAX_CAPACITY (1 << 30) /**< Larger capacities are capped. */
+#define VERTE_CHAN_SLEEPING 1u            /**< Flag of an eventcount. */
+
+/**
+ * @struct chan_cell
+ * @brief A slot of the ring.
+ */
+typedef struct chan_cell {
+  atomic_size_t sequence; /**< The position the cell is ready for. */
+  int64_t value;          /**< The value, owned by the claimer. */
+} chan_cell;
+
+/**
+ * @struct verte_chan
+ * @brief A channel. Each side has its own cache line, so senders and
+ * receivers do not invalidate each other's position.
+ */
+struct verte_chan {
+  _Alignas(64) atomic_size_t send_position; /**< Next position to fill. */
+  _Alignas(64) atomic_size_t recv_position; /**< Next position to empty. */
+
+  _Alignas(64) atomic_uint senders; /**< Eventcount of full channels. */
+  _Alignas(64) atomic_uint receivers; /**< Eventcount of empty channels. */
+
+  _Alignas(64) size_t mask; /**< Capacity minus one. */
+  int32_t spins;            /**< Retries before sleeping, none on one CPU. */
+  chan_cell cells[];        /**< The ring. */
+};
+
+/**
+ * @brief Hint the CPU that the thread is spinning.
+ */
+static inline void chan_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Fill the next cell, if the channel is not full.
+ * @return Whether the value was sent.
+ */
+static int chan_push(verte_chan *chan, int64_t value) {
+  size_t position =
+      atomic_load_explicit(&chan->send_position, memory_order_relaxed);
+
+  for (;;) {
+    chan_cell *cell = &chan->cells[position & chan->mask];
+    const size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    const intptr_t turn = (intptr_t)sequence - (intptr_t)position;
+
+    // The cell still holds the value of the previous lap.
+    if (turn < 0)
+      return 0;
+
+    // Another sender took the position, retry at the one it left.
+    if (turn > 0) {
+      position =
+          atomic_load_explicit(&chan->send_position, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(
+            &chan->send_position, &position, position + 1,
+            memory_order_relaxed, memory_order_relaxed)) {
+      cell->value = value;
+      atomic_store_explicit(&cell->sequence, position + 1,
+                            memory_order_release);
+      return 1;
+    }
+  }
+}
+
+/**
+ * @brief Empty the next cell, if the channel is not empty.
+ * @return Whether a value was received.
+ */
+static int chan_pop(verte_chan *chan, int64_t *value) {
+  size_t position =
+      atomic_load_explicit(&chan->recv_position, memory_order_relaxed);
+
+  for (;;) {
+    chan_cell *cell = &chan->cells[position & chan->mask];
+    const size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    const intptr_t turn = (intptr_t)sequence - (intptr_t)(position + 1);
+
+    // The cell was not filled yet.
+    if (turn < 0)
+      return 0;
+
+    if (turn > 0) {
+      position =
+          atomic_load_explicit(&chan->recv_position, memory_order_relaxed);
+      continue;
+    }
+
+    if (atomic_compare_exchange_weak_explicit(
+            &chan->recv_position, &position, position + 1,
+            memory_order_relaxed, memory_order_relaxed)) {
+      *value = cell->value;
+
+      // Hand the cell to the sender of the next lap.
+      atomic_store_explicit(&cell->sequence, position + chan->mask + 1,
+                            memory_order_release);
+      return 1;
+    }
+  }
+}
+
+/**
+ * @brief Wake the sleepers of the other side, if there are any.
+ *
+ * The fence pairs with the one of a sleeper registering itself: either it
+ * sees the cell this side just filled or emptied, or this side sees it
+ * registered. Clearing the flag wakes every sleeper at once, so the calls
+ * after it are free until one of them sleeps again.
+ *
+ * @param event The eventcount the other side sleeps on.
+ */
+static void chan_notify(atomic_uint *event) {
+  atomic_thread_fence(memory_order_seq_cst);
+
+  unsigned current = atomic_load_explicit(event, memory_order_relaxed);
+  while (current & VERTE_CHAN_SLEEPING) {
+    const unsigned next = (current + 2) & ~VERTE_CHAN_SLEEPING;
+    if (atomic_compare_exchange_weak_explicit(event, &current, next,
+                                              memory_order_relaxed,
+                                              memory_order_relaxed)) {
+      syscall(SYS_futex, event, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Register as a sleeper of one side of the channel.
+ * @param event The eventcount to sleep on.
+ * @return The value to sleep on, once the channel was checked again.
+ */
+static unsigned chan_register(atomic_uint *event) {
+  const unsigned seen = atomic_fetch_or_explicit(event, VERTE_CHAN_SLEEPING,
+                                                 memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  return seen | VERTE_CHAN_SLEEPING;
+}
+
+/**
+ * @brief Sleep until the other side notifies, or return at once if it
+ * already did since the registration.
+ * @param event The eventcount to sleep on.
+ * @param seen The value returned by the registration.
+ */
+static void chan_sleep(atomic_uint *event, unsigned seen) {
+  syscall(SYS_futex, event, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+}
+
+verte_chan *verte_chan_new(int32_t capacity) {
+  // The generated code has no way to handle a missing channel.
+  if (capacity < 1) {
+    fprintf(stderr, "verte: channel capacity must be positive, got %d\n",
+            capacity);
+    abort();
+  }
+
+  // With a single cell, a filled one would look free to the next lap.
+  size_t size = 2;
+  while (size < (size_t)capacity && size < VERTE_CHAN_MAX_CAPACITY)
+    size <<= 1;
+
+  const size_t bytes = sizeof(verte_chan) + size * sizeof(chan_cell);
+  verte_chan *chan = aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+  if (!chan) {
+    fprintf(stderr, "verte: cannot allocate a channel of %zu values\n", size);
+    abort();
+  }
+
+  atomic_init(&chan->send_position, 0);
+  atomic_init(&chan->recv_position, 0);
+  atomic_init(&chan->senders, 0);
+  atomic_init(&chan->receivers, 0);
+  chan->mask = size - 1;
+
+  // The other side cannot make progress while this one spins on one CPU.
+  chan->spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? VERTE_CHAN_SPINS : 0;
+
+  for (size_t i = 0; i < size; i++)
+    atomic_init(&chan->cells[i].sequence, i);
+
+  return chan;
+}
+
+void verte_chan_free(verte_chan *chan) { free(chan); }
+
+int32_t verte_chan_try_send(verte_chan *chan, int64_t value) {
+  if (!chan_push(chan, value))
+    return 0;
+
+  chan_notify(&chan->receivers);
+  return 1;
+}
+
+int32_t verte_chan_try_recv(verte_chan *chan, int64_t *value) {
+  if (!chan_pop(chan, value))
+    return 0;
+
+  chan_notify(&chan->senders);
+  return 1;
+}
+
+void verte_chan_send(verte_chan *chan, int64_t value) {
+  for (int spins = 0; !chan_push(chan, value); spins++) {
+    if (spins < chan->spins) {
+      chan_relax();
+      continue;
+    }
+
+    // Register before checking again, a receiver emptying a cell from now
+    // on wakes this thread.
+    const unsigned seen = chan_register(&chan->senders);
+    if (chan_push(chan, value))
+      break;
+
+    chan_sleep(&chan->senders, seen);
+  }
+
+  chan_notify(&chan->receivers);
+}
+
+int64_t verte_chan_recv(verte_chan *chan) {
+  int64_t value;
+  for (int spins = 0; !chan_pop(chan, &value); spins++) {
+    if (spins < chan->spins) {
+      chan_relax();
+      continue;
+    }
+
+    const unsigned seen = chan_register(&chan->receivers);
+    if (chan_pop(chan, &value))
+      break;
+
+    chan_sleep(&chan->receivers, seen);
+  }
+
+  chan_notify(&chan->senders);
+  return value;
+}
@@ -0,0 +1,807 @@
+/**
+ * @brief Sampling heap allocation profiler, linked with `--instrument=alloc`.
+ * @file alloc.c
+ *
+ * Interposes `malloc`, `calloc`, `realloc` and `free` for the whole program,
+ * libc included, and forwards them to the glibc allocator. Allocations are
+ * sampled once every `VERTE_ALLOC_SAMPLE` bytes on average (512 KiB by
+ * default, 1 samples every allocation). The call stack of a sampled allocation
+ * is unwound through the frame pointers and aggregated per site with the
+ * allocated and still live counts and bytes, scaled back to estimates of the
+ * totals. The profile is written at exit in the pprof format to
+ * `VERTE_ALLOC_PROFILE` (`alloc.pprof` by default).
+ *
+ * Built as its own archive, outside of the runtime library, so it is only
+ * linked into instrumented programs.
+ */
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE
+#endif // _GNU_SOURCE
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define VERTE_ALLOC_RATE (512 * 1024)  /**< Default mean bytes per sample. */
+#define VERTE_ALLOC_MAX_DEPTH 64       /**< Deepest recorded call stack. */
+#define VERTE_ALLOC_PATH "alloc.pprof" /**< Default profile path. */
+#define VERTE_ALLOC_SCAN_WORDS 256     /**< Stack words scanned for a frame. */
+
+/** @brief The glibc allocator, which the interposed functions forward to. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+/** @brief Bounds of the code of the executable, from the linker script. */
+extern char __executable_start[];
+extern char etext[];
+
+/**
+ * @struct alloc_site
+ * @brief The samples of one call stack, weighted into estimates.
+ */
+typedef struct alloc_site {
+  uint64_t hash;                        /**< Hash of the call stack. */
+  uint32_t depth;                       /**< Number of frames. */
+  uintptr_t pcs[VERTE_ALLOC_MAX_DEPTH]; /**< Call sites, innermost first. */
+  double allocs;                        /**< Estimated allocations. */
+  double alloc_bytes;                   /**< Estimated allocated bytes. */
+  double live;                          /**< Estimated live allocations. */
+  double live_bytes;                    /**< Estimated live bytes. */
+} alloc_site;
+
+/**
+ * @struct live_block
+ * @brief A sampled allocation not freed yet.
+ */
+typedef struct live_block {
+  uintptr_t ptr;  /**< The block, 0 for an empty slot. */
+  uint32_t site;  /**< Index of its site. */
+  size_t size;    /**< Requested size. */
+  double weight;  /**< Allocations it stands for. */
+} live_block;
+
+static int64_t sample_rate;    /**< Mean bytes per sample, 0 if disabled. */
+static uint64_t started_ns;    /**< Wall clock time at startup. */
+static atomic_flag lock = ATOMIC_FLAG_INIT; /**< Guards the tables. */
+
+static alloc_site *sites;      /**< Every site, in order of first sample. */
+static uint32_t site_count;    /**< Number of sites. */
+static uint32_t site_capacity; /**< Capacity of `sites`. */
+static uint32_t *site_slots;   /**< Hash of the sites, index + 1 or 0. */
+static uint32_t site_mask;     /**< Slot count of `site_slots` minus one. */
+
+static live_block *live;       /**< Linear probing set of live samples. */
+static size_t live_mask;       /**< Slot count of `live` minus one. */
+static atomic_size_t live_count; /**< Number of live samples. */
+
+#define VERTE_TLS __thread __attribute__((tls_model("initial-exec")))
+
+static VERTE_TLS int64_t until_sample; /**< Bytes left before a sample. */
+static VERTE_TLS uint64_t rng;         /**< State of the interval generator. */
+static VERTE_TLS uintptr_t stack_top;  /**< Upper bound of this stack. */
+static VERTE_TLS int busy;             /**< Set while recording a sample. */
+
+static void acquire(void) {
+  while (atomic_flag_test_and_set_explicit(&lock, memory_order_acquire))
+    sched_yield();
+}
+
+static void release(void) {
+  atomic_flag_clear_explicit(&lock, memory_order_release);
+}
+
+static uint64_t mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdull;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ull;
+  return value ^ (value >> 33);
+}
+
+static uint64_t now_ns(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Draw the bytes until the next sample from an exponential distribution, so
+// every byte is equally likely to be sampled whatever the allocation sizes.
+static int64_t next_interval(void) {
+  if (sample_rate <= 1)
+    return 0;
+
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+
+  const double uniform = ((double)(rng >> 11) + 0.5) / 9007199254740992.0;
+  return (int64_t)(-log(uniform) * (double)sample_rate) + 1;
+}
+
+// The frames of this thread lie below its stack top, the unwinder never reads
+// past it even when a frame without frame pointer left garbage behind.
+static uintptr_t find_stack_top(void) {
+  pthread_attr_t attr;
+  void *addr;
+  size_t size;
+
+  if (pthread_getattr_np(pthread_self(), &attr) != 0)
+    return 0;
+
+  const int found = pthread_attr_getstack(&attr, &addr, &size) == 0;
+  pthread_attr_destroy(&attr);
+  return found ? (uintptr_t)addr + size : 0;
+}
+
+static int in_executable(uintptr_t pc) {
+  return pc > (uintptr_t)__executable_start + 8 && pc <= (uintptr_t)etext;
+}
+
+// A return address of the executable follows a call instruction.
+static int is_return(uintptr_t pc) {
+  if (!in_executable(pc))
+    return 0;
+
+#if defined(__x86_64__)
+  const uint8_t *code = (const uint8_t *)pc;
+  return code[-5] == 0xe8 ||                                // rel32
+         (code[-2] == 0xff && (code[-1] & 0xf8) == 0xd0) || // register
+         (code[-3] == 0xff && (code[-2] & 0x38) == 0x10) || // disp8
+         (code[-6] == 0xff && (code[-5] & 0x38) == 0x10) || // disp32
+         (code[-7] == 0xff && (code[-6] & 0x38) == 0x10);   // sib disp32
+#else
+  return 1;
+#endif
+}
+
+static int is_frame(const uintptr_t *frame, const uintptr_t *below) {
+  return frame > below && (uintptr_t)frame % sizeof(uintptr_t) == 0 &&
+         (uintptr_t)(frame + 2) <= stack_top;
+}
+
+// Libc is built without frame pointers, the call from the program into a libc
+// function allocating on its behalf is missing from the chain, which may even
+// break when the function reuses the frame pointer register. Its return
+// address is still on the stack above the frame, as is the frame pointer of
+// the program, saved by the libc function.
+static uintptr_t *recover(uintptr_t *frame, uintptr_t *next, uintptr_t *pcs,
+                          uint32_t *depth) {
+  uintptr_t *word = frame + 2;
+  uintptr_t *end = next ? next : word + VERTE_ALLOC_SCAN_WORDS;
+  uintptr_t *saved = NULL;
+
+  for (; word < end && (uintptr_t)(word + 1) <= stack_top; ++word) {
+    if (is_return(*word)) {
+      pcs[(*depth)++] = *word - 1;
+      return next ? next : saved;
+    }
+
+    // The frame pointer of the program was pushed right below its return
+    // address, the stale words further down are ignored.
+    uintptr_t *candidate = (uintptr_t *)*word;
+    if (is_frame(candidate, word + 1))
+      saved = candidate;
+  }
+
+  return next;
+}
+
+// Walk the frame pointer chain from the given frame, whose caller comes first.
+static uint32_t unwind(uintptr_t *frame, uintptr_t *pcs) {
+  uint32_t depth = 0;
+
+  while (depth < VERTE_ALLOC_MAX_DEPTH && frame &&
+         (uintptr_t)frame % sizeof(uintptr_t) == 0 &&
+         (uintptr_t)(frame + 2) <= stack_top) {
+    // Past the outermost frame, garbage may point back into the stack, above
+    // which no code is mapped.
+    const uintptr_t pc = frame[1];
+    if (!pc || pc > (uintptr_t)frame)
+      break;
+
+    // Point into the call instruction rather than after it.
+    pcs[depth++] = pc - 1;
+
+    uintptr_t *next = (uintptr_t *)frame[0];
+    if (!is_frame(next, frame))
+      next = NULL;
+
+    if (!in_executable(pc) && depth < VERTE_ALLOC_MAX_DEPTH)
+      next = recover(frame, next, pcs, &depth);
+
+    frame = next;
+  }
+
+  return depth;
+}
+
+static uint64_t hash_stack(const uintptr_t *pcs, uint32_t depth) {
+  uint64_t hash = depth;
+  for (uint32_t i = 0; i < depth; ++i)
+    hash = mix(hash ^ pcs[i]);
+
+  return hash;
+}
+
+// Find or add the site of a call stack, UINT32_MAX if out of memory.
+static uint32_t find_site(const uintptr_t *pcs, uint32_t depth) {
+  const uint64_t hash = hash_stack(pcs, depth);
+
+  if (site_slots) {
+    for (uint32_t slot = (uint32_t)hash & site_mask;;
+         slot = (slot + 1) & site_mask) {
+      const uint32_t index = site_slots[slot];
+      if (!index)
+        break;
+
+      const alloc_site *site = &sites[index - 1];
+      if (site->hash == hash && site->depth == depth &&
+          memcmp(site->pcs, pcs, depth * sizeof(uintptr_t)) == 0)
+        return index - 1;
+    }
+  }
+
+  if (site_count == site_capacity) {
+    const uint32_t capacity = site_capacity ? site_capacity * 2 : 64;
+    alloc_site *grown = __libc_realloc(sites, capacity * sizeof(alloc_site));
+    if (!grown)
+      return UINT32_MAX;
+
+    sites = grown;
+    site_capacity = capacity;
+  }
+
+  // Keep the slots at most half full.
+  if (!site_slots || (site_count + 1) * 2 > site_mask + 1) {
+    const uint32_t slots = site_slots ? (site_mask + 1) * 2 : 128;
+    uint32_t *grown = __libc_calloc(slots, sizeof(uint32_t));
+    if (!grown)
+      return UINT32_MAX;
+
+    for (uint32_t i = 0; i < site_count; ++i) {
+      uint32_t slot = (uint32_t)sites[i].hash & (slots - 1);
+      while (grown[slot])
+        slot = (slot + 1) & (slots - 1);
+
+      grown[slot] = i + 1;
+    }
+
+    __libc_free(site_slots);
+    site_slots = grown;
+    site_mask = slots - 1;
+  }
+
+  alloc_site *site = &sites[site_count];
+  memset(site, 0, sizeof(alloc_site));
+  site->hash = hash;
+  site->depth = depth;
+  memcpy(site->pcs, pcs, depth * sizeof(uintptr_t));
+
+  uint32_t slot = (uint32_t)hash & site_mask;
+  while (site_slots[slot])
+    slot = (slot + 1) & site_mask;
+
+  site_slots[slot] = ++site_count;
+  return site_count - 1;
+}
+
+static size_t live_slot(uintptr_t ptr) { return mix(ptr) & live_mask; }
+
+static int insert_live(uintptr_t ptr, uint32_t site, size_t size,
+                       double weight) {
+  const size_t count = atomic_load_explicit(&live_count, memory_order_relaxed);
+
+  // Keep the set at most half full.
+  if (!live || (count + 1) * 2 > live_mask + 1) {
+    const size_t slots = live ? (live_mask + 1) * 2 : 1024;
+    live_block *grown = __libc_calloc(slots, sizeof(live_block));
+    if (!grown)
+      return 0;
+
+    live_block *old = live;
+    const size_t old_slots = live ? live_mask + 1 : 0;
+    live = grown;
+    live_mask = slots - 1;
+
+    for (size_t i = 0; i < old_slots; ++i) {
+      if (!old[i].ptr)
+        continue;
+
+      size_t slot = live_slot(old[i].ptr);
+      while (live[slot].ptr)
+        slot = (slot + 1) & live_mask;
+
+      live[slot] = old[i];
+    }
+
+    __libc_free(old);
+  }
+
+  size_t slot = live_slot(ptr);
+  while (live[slot].ptr)
+    slot = (slot + 1) & live_mask;
+
+  live[slot] = (live_block){ptr, site, size, weight};
+  atomic_store_explicit(&live_count, count + 1, memory_order_relaxed);
+  return 1;
+}
+
+// Remove a freed block if it was sampled, before it may be handed out again.
+// The entry is copied to `taken`, if given, its ptr is 0 if there was none.
+static void forget(void *ptr, live_block *taken) {
+  acquire();
+
+  size_t slot = live ? live_slot((uintptr_t)ptr) : 0;
+  while (live && live[slot].ptr && live[slot].ptr != (uintptr_t)ptr)
+    slot = (slot + 1) & live_mask;
+
+  if (!live || !live[slot].ptr) {
+    release();
+    return;
+  }
+
+  alloc_site *site = &sites[live[slot].site];
+  site->live -= live[slot].weight;
+  site->live_bytes -= live[slot].weight * (double)live[slot].size;
+
+  if (taken)
+    *taken = live[slot];
+
+  // Shift the following entries back instead of leaving a tombstone.
+  for (size_t next = (slot + 1) & live_mask; live[next].ptr;
+       next = (next + 1) & live_mask) {
+    const size_t home = live_slot(live[next].ptr);
+    if (((next - home) & live_mask) >= ((next - slot) & live_mask)) {
+      live[slot] = live[next];
+      slot = next;
+    }
+  }
+
+  live[slot].ptr = 0;
+  atomic_fetch_sub_explicit(&live_count, 1, memory_order_relaxed);
+  release();
+}
+
+// Put back an entry taken by `forget`, the block was not freed after all.
+static void restore(const live_block *taken) {
+  acquire();
+
+  if (insert_live(taken->ptr, taken->site, taken->size, taken->weight)) {
+    alloc_site *site = &sites[taken->site];
+    site->live += taken->weight;
+    site->live_bytes += taken->weight * (double)taken->size;
+  }
+
+  release();
+}
+
+static __attribute__((noinline)) void record(void *ptr, size_t size,
+                                             uintptr_t *frame) {
+  if (busy)
+    return;
+
+  busy = 1;
+  if (!stack_top)
+    stack_top = find_stack_top();
+
+  uintptr_t pcs[VERTE_ALLOC_MAX_DEPTH];
+  const uint32_t depth = unwind(frame, pcs);
+
+  // A sample stands for every allocation it was likely drawn among.
+  const double weight =
+      sample_rate <= 1
+          ? 1.0
+          : 1.0 / -expm1(-(double)(size ? size : 1) / (double)sample_rate);
+
+  acquire();
+  const uint32_t index = find_site(pcs, depth);
+
+  if (index != UINT32_MAX) {
+    alloc_site *site = &sites[index];
+    site->allocs += weight;
+    site->alloc_bytes += weight * (double)size;
+
+    if (insert_live((uintptr_t)ptr, index, size, weight)) {
+      site->live += weight;
+      site->live_bytes += weight * (double)size;
+    }
+  }
+
+  release();
+  busy = 0;
+}
+
+static inline int should_sample(size_t size) {
+  if (!sample_rate)
+    return 0;
+
+  if (until_sample > (int64_t)size) {
+    until_sample -= (int64_t)size;
+    return 0;
+  }
+
+  // Seed the generator of this thread on its first sample.
+  if (!rng)
+    rng = mix((uintptr_t)&rng ^ now_ns(CLOCK_MONOTONIC)) | 1;
+
+  until_sample = next_interval();
+  return 1;
+}
+
+void *malloc(size_t size) {
+  void *ptr = __libc_malloc(size);
+  if (ptr && should_sample(size))
+    record(ptr, size, __builtin_frame_address(0));
+
+  return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+  // The product may overflow, libc fails such a request.
+  size_t bytes;
+  if (__builtin_mul_overflow(count, size, &bytes))
+    return __libc_calloc(count, size);
+
+  void *ptr = __libc_calloc(count, size);
+  if (ptr && should_sample(bytes))
+    record(ptr, bytes, __builtin_frame_address(0));
+
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+  live_block taken = {0};
+  if (ptr && atomic_load_explicit(&live_count, memory_order_relaxed))
+    forget(ptr, &taken);
+
+  void *moved = __libc_realloc(ptr, size);
+
+  // A failed reallocation leaves the block as it was, a zero size frees it.
+  if (!moved && size && taken.ptr)
+    restore(&taken);
+
+  if (moved && should_sample(size))
+    record(moved, size, __builtin_frame_address(0));
+
+  return moved;
+}
+
+void free(void *ptr) {
+  if (ptr && atomic_load_explicit(&live_count, memory_order_relaxed))
+    forget(ptr, NULL);
+
+  __libc_free(ptr);
+}
+
+/**
+ * @struct pb_buffer
+ * @brief A growable buffer of protobuf encoded bytes.
+ */
+typedef struct pb_buffer {
+  uint8_t *data; /**< The bytes, NULL once out of memory. */
+  size_t size;   /**< Number of bytes. */
+  size_t capacity; /**< Capacity of `data`. */
+  int failed;    /**< Set once out of memory. */
+} pb_buffer;
+
+static void pb_write(pb_buffer *buffer, const void *data, size_t size) {
+  if (buffer->failed)
+    return;
+
+  if (buffer->size + size > buffer->capacity) {
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+    while (capacity < buffer->size + size)
+      capacity *= 2;
+
+    uint8_t *grown = __libc_realloc(buffer->data, capacity);
+    if (!grown) {
+      buffer->failed = 1;
+      return;
+    }
+
+    buffer->data = grown;
+    buffer->capacity = capacity;
+  }
+
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size += size;
+}
+
+static void pb_varint(pb_buffer *buffer, uint64_t value) {
+  uint8_t bytes[10];
+  size_t size = 0;
+
+  do {
+    bytes[size++] = (uint8_t)(value & 0x7f) | (value > 0x7f ? 0x80 : 0);
+    value >>= 7;
+  } while (value);
+
+  pb_write(buffer, bytes, size);
+}
+
+static void pb_uint(pb_buffer *buffer, uint32_t field, uint64_t value) {
+  pb_varint(buffer, (uint64_t)field << 3);
+  pb_varint(buffer, value);
+}
+
+static void pb_bytes(pb_buffer *buffer, uint32_t field, const void *data,
+                     size_t size) {
+  pb_varint(buffer, (uint64_t)field << 3 | 2);
+  pb_varint(buffer, size);
+  pb_write(buffer, data, size);
+}
+
+static void pb_message(pb_buffer *buffer, uint32_t field,
+                       pb_buffer *message) {
+  pb_bytes(buffer, field, message->data, message->size);
+  buffer->failed |= message->failed;
+  message->size = 0;
+}
+
+/**
+ * @struct mapping
+ * @brief An executable mapping of the process.
+ */
+typedef struct mapping {
+  uintptr_t start;  /**< First address. */
+  uintptr_t limit;  /**< Address past the end. */
+  uint64_t offset;  /**< Offset in the file. */
+  const char *path; /**< Path of the file, in the maps buffer. */
+} mapping;
+
+// Read a whole file without stdio, which could allocate.
+static char *read_file(const char *path) {
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+
+  size_t size = 0, capacity = 16384;
+  char *data = __libc_malloc(capacity);
+
+  while (data) {
+    if (size + 1 == capacity) {
+      char *grown = __libc_realloc(data, capacity * 2);
+      if (!grown) {
+        __libc_free(data);
+        data = NULL;
+        break;
+      }
+
+      data = grown;
+      capacity *= 2;
+    }
+
+    const ssize_t count = read(fd, data + size, capacity - size - 1);
+    if (count <= 0)
+      break;
+
+    size += (size_t)count;
+  }
+
+  close(fd);
+  if (data)
+    data[size] = '\0';
+
+  return data;
+}
+
+// Parse the executable file mappings out of /proc/self/maps, in place.
+static size_t parse_mappings(char *maps, mapping *mappings, size_t capacity) {
+  size_t count = 0;
+
+  for (char *line = maps; line && *line && count < capacity;) {
+    char *end = strchr(line, '\n');
+    if (end)
+      *end = '\0';
+
+    // start-limit perms offset dev inode path
+    char *cursor;
+    mapping entry = {0};
+    entry.start = strtoull(line, &cursor, 16);
+    entry.limit = strtoull(cursor + 1, &cursor, 16);
+
+    const char *perms = cursor + 1;
+    entry.offset = strtoull(perms + 5, &cursor, 16);
+    const char *path = strchr(cursor, '/');
+
+    if (perms[2] == 'x' && path) {
+      entry.path = path;
+      mappings[count++] = entry;
+    }
+
+    line = end ? end + 1 : NULL;
+  }
+
+  return count;
+}
+
+static uint64_t find_mapping(const mapping *mappings, size_t count,
+                             uintptr_t pc) {
+  for (size_t i = 0; i < count; ++i) {
+    if (pc >= mappings[i].start && pc < mappings[i].limit)
+      return i + 1;
+  }
+
+  return 0;
+}
+
+// The fixed entries of the string table, mapping paths follow.
+static const char *const STRINGS[] = {
+    "",      "alloc_objects", "count",       "alloc_space",
+    "bytes", "inuse_objects", "inuse_space", "space"};
+
+enum { STRING_COUNT = sizeof(STRINGS) / sizeof(STRINGS[0]) };
+
+static void value_type(pb_buffer *profile, pb_buffer *scratch,
+                       uint32_t field, uint64_t type, uint64_t unit) {
+  pb_uint(scratch, 1, type);
+  pb_uint(scratch, 2, unit);
+  pb_message(profile, field, scratch);
+}
+
+// Encode the profile, see profile.proto of pprof for the fields.
+static void encode(pb_buffer *profile, const mapping *mappings,
+                   size_t mapping_count) {
+  pb_buffer scratch = {0}, packed = {0};
+
+  value_type(profile, &scratch, 1, 1, 2);
+  value_type(profile, &scratch, 1, 3, 4);
+  value_type(profile, &scratch, 1, 5, 2);
+  value_type(profile, &scratch, 1, 6, 4);
+
+  // Give every distinct address a location, ids start at 1.
+  size_t frames = 0;
+  for (uint32_t i = 0; i < site_count; ++i)
+    frames += sites[i].depth;
+
+  size_t slots = 16;
+  while (slots < frames * 2)
+    slots *= 2;
+
+  uintptr_t *addresses = __libc_calloc(slots, sizeof(uintptr_t));
+  uint64_t *ids = __libc_calloc(slots, sizeof(uint64_t));
+  uint64_t next_id = 1;
+
+  if (!addresses || !ids) {
+    profile->failed = 1;
+    slots = 0;
+  }
+
+  for (uint32_t i = 0; i < site_count && slots; ++i) {
+    const alloc_site *site = &sites[i];
+
+    for (uint32_t j = 0; j < site->depth; ++j) {
+      size_t slot = mix(site->pcs[j]) & (slots - 1);
+      while (ids[slot] && addresses[slot] != site->pcs[j])
+        slot = (slot + 1) & (slots - 1);
+
+      if (!ids[slot]) {
+        addresses[slot] = site->pcs[j];
+        ids[slot] = next_id++;
+
+        pb_uint(&scratch, 1, ids[slot]);
+        pb_uint(&scratch, 2,
+                find_mapping(mappings, mapping_count, site->pcs[j]));
+        pb_uint(&scratch, 3, site->pcs[j]);
+        pb_message(profile, 4, &scratch);
+      }
+
+      pb_varint(&packed, ids[slot]);
+    }
+
+    pb_message(&scratch, 1, &packed);
+
+    const double values[] = {site->allocs, site->alloc_bytes, site->live,
+                             site->live_bytes};
+    for (size_t k = 0; k < 4; ++k)
+      pb_varint(&packed, (uint64_t)llround(values[k] > 0 ? values[k] : 0));
+
+    pb_message(&scratch, 2, &packed);
+    pb_message(profile, 2, &scratch);
+  }
+
+  for (size_t i = 0; i < mapping_count; ++i) {
+    pb_uint(&scratch, 1, i + 1);
+    pb_uint(&scratch, 2, mappings[i].start);
+    pb_uint(&scratch, 3, mappings[i].limit);
+    pb_uint(&scratch, 4, mappings[i].offset);
+    pb_uint(&scratch, 5, STRING_COUNT + i);
+    pb_message(profile, 3, &scratch);
+  }
+
+  for (size_t i = 0; i < STRING_COUNT; ++i)
+    pb_bytes(profile, 6, STRINGS[i], strlen(STRINGS[i]));
+
+  for (size_t i = 0; i < mapping_count; ++i)
+    pb_bytes(profile, 6, mappings[i].path, strlen(mappings[i].path));
+
+  const uint64_t now = now_ns(CLOCK_REALTIME);
+  pb_uint(profile, 9, now);
+  pb_uint(profile, 10, now - started_ns);
+  value_type(profile, &scratch, 11, 7, 4);
+  pb_uint(profile, 12, (uint64_t)(sample_rate > 1 ? sample_rate : 1));
+
+  __libc_free(addresses);
+  __libc_free(ids);
+  __libc_free(scratch.data);
+  __libc_free(packed.data);
+}
+
+static void write_all(int fd, const char *data, size_t size) {
+  while (size) {
+    const ssize_t written = write(fd, data, size);
+    if (written <= 0)
+      return;
+
+    data += written;
+    size -= (size_t)written;
+  }
+}
+
+static void write_message(const char *prefix, const char *path) {
+  write_all(STDERR_FILENO, prefix, strlen(prefix));
+  write_all(STDERR_FILENO, path, strlen(path));
+  write_all(STDERR_FILENO, "\n", 1);
+}
+
+static void dump(void) {
+  busy = 1;
+  acquire();
+
+  const char *path = getenv("VERTE_ALLOC_PROFILE");
+  if (!path || !*path)
+    path = VERTE_ALLOC_PATH;
+
+  enum { MAX_MAPPINGS = 4096 };
+  char *maps = read_file("/proc/self/maps");
+  mapping *mappings = __libc_malloc(MAX_MAPPINGS * sizeof(mapping));
+  const size_t mapping_count =
+      maps && mappings ? parse_mappings(maps, mappings, MAX_MAPPINGS) : 0;
+
+  pb_buffer profile = {0};
+  encode(&profile, mappings, mapping_count);
+
+  const int fd = profile.failed
+                     ? -1
+                     : open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                            0644);
+
+  if (fd >= 0) {
+    write_all(fd, (const char *)profile.data, profile.size);
+    close(fd);
+    write_message("verte: wrote the allocation profile to ", path);
+  } else {
+    write_message("verte: failed to write the allocation profile to ", path);
+  }
+
+  __libc_free(profile.data);
+  __libc_free(mappings);
+  __libc_free(maps);
+  sample_rate = 0;
+  release();
+}
+
+static __attribute__((constructor)) void start(void) {
+  busy = 1;
+
+  const char *rate = getenv("VERTE_ALLOC_SAMPLE");
+  const long long parsed = rate && *rate ? atoll(rate) : VERTE_ALLOC_RATE;
+  started_ns = now_ns(CLOCK_REALTIME);
+
+  if (parsed > 0) {
+    atexit(dump);
+    sample_rate = parsed;
+  }
+
+  busy = 0;
+}
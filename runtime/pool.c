@@ -0,0 +1,406 @@
+/**
+ * @brief NUMA-aware worker pool and node-local arenas.
+ * @file pool.c
+ *
+ * The topology is read from `/sys/devices/system/node` on first use. Every
+ * node gets workers pinned to its CPUs and a share of each `parallel_for`,
+ * the workers run their own share before stealing from the other nodes,
+ * nearest first. A given range is always split the same way, so the data a
+ * loop first touched stays local to the iterations of the next ones.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "verte.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define VERTE_POOL_MAX_NODES 64       /**< Nodes beyond are ignored. */
+#define VERTE_POOL_CHUNKS 8           /**< Chunks per worker and loop. */
+#define VERTE_ARENA_CHUNK (2ul << 20) /**< Arena growth, a huge page. */
+#define VERTE_ARENA_ALIGN 64ul        /**< Allocations never share lines. */
+
+/**
+ * @struct pool_node
+ * @brief A NUMA node, its CPUs, its share of the current loop and its arena.
+ */
+typedef struct pool_node {
+  _Alignas(64) atomic_long next; /**< Next index of the share of the loop. */
+  long end;                      /**< End of the share of the loop. */
+
+  _Alignas(64) cpu_set_t cpus; /**< The usable CPUs of the node. */
+  int32_t id;                  /**< The id of the node. */
+  int32_t workers;             /**< Number of workers. */
+  int32_t steal[VERTE_POOL_MAX_NODES];    /**< Other nodes, nearest first. */
+  int32_t distance[VERTE_POOL_MAX_NODES]; /**< Distances to the nodes. */
+
+  pthread_mutex_t arena_lock; /**< Guards the arena. */
+  char *arena;                /**< Free space of the current chunk. */
+  size_t arena_left;          /**< Bytes left in the current chunk. */
+} pool_node;
+
+/**
+ * @struct pool_state
+ * @brief The pool, created on first use.
+ */
+static struct pool_state {
+  pthread_once_t once; /**< Initializes the pool. */
+  int32_t count;       /**< Number of nodes. */
+  int32_t workers;     /**< Number of worker threads. */
+  pool_node nodes[VERTE_POOL_MAX_NODES]; /**< The nodes. */
+  int16_t cpu_node[CPU_SETSIZE];         /**< The node of each CPU. */
+
+  pthread_mutex_t job;   /**< Serializes the loops of different threads. */
+  pthread_mutex_t lock;  /**< Guards the fields below. */
+  pthread_cond_t start;  /**< Signals a new loop to the workers. */
+  pthread_cond_t done;   /**< Signals the end of a loop to its caller. */
+  uint64_t generation;   /**< Number of loops started. */
+  int32_t active;        /**< Workers still running the loop. */
+  void (*body)(int32_t); /**< The body of the loop. */
+  long grain;            /**< Iterations taken at once. */
+} pool = {
+    .once = PTHREAD_ONCE_INIT,
+    .job = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static _Thread_local int32_t current_node = -1; /**< Node of a worker. */
+static _Thread_local int in_loop;               /**< Whether running a loop. */
+
+/**
+ * @brief Read a small sysfs file.
+ * @return The length read, 0 if the file is missing.
+ */
+static size_t read_file(const char *path, char *buffer, size_t size) {
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return 0;
+
+  const size_t length = fread(buffer, 1, size - 1, file);
+  buffer[length] = '\0';
+  fclose(file);
+  return length;
+}
+
+/**
+ * @brief Parse a list such as `0-3,8,10-11` into a CPU set or an array of
+ * ids, whichever is given.
+ */
+static void parse_list(const char *list, cpu_set_t *set, int32_t *ids,
+                       int32_t *count) {
+  for (const char *at = list; *at;) {
+    char *stop;
+    const long first = strtol(at, &stop, 10);
+    if (stop == at)
+      break;
+
+    long last = first;
+    if (*stop == '-')
+      last = strtol(stop + 1, &stop, 10);
+
+    for (long id = first; id <= last; ++id) {
+      if (set && id < CPU_SETSIZE)
+        CPU_SET(id, set);
+
+      if (ids && *count < VERTE_POOL_MAX_NODES)
+        ids[(*count)++] = (int32_t)id;
+    }
+
+    at = *stop == ',' ? stop + 1 : stop;
+  }
+}
+
+/**
+ * @brief Read the nodes, their CPUs and distances, without the CPUs the
+ * process may not run on.
+ */
+static void discover(const cpu_set_t *allowed) {
+  char path[128], buffer[4096];
+  int32_t ids[VERTE_POOL_MAX_NODES], online = 0;
+
+  if (read_file("/sys/devices/system/node/online", buffer, sizeof(buffer)))
+    parse_list(buffer, NULL, ids, &online);
+
+  for (int32_t i = 0; i < online; ++i) {
+    pool_node *node = &pool.nodes[pool.count];
+    CPU_ZERO(&node->cpus);
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+             ids[i]);
+    if (read_file(path, buffer, sizeof(buffer)))
+      parse_list(buffer, &node->cpus, NULL, NULL);
+
+    CPU_AND(&node->cpus, &node->cpus, allowed);
+    if (CPU_COUNT(&node->cpus) == 0)
+      continue;
+
+    // The distances are listed for every online node, in order.
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/distance",
+             ids[i]);
+    int32_t distances[VERTE_POOL_MAX_NODES], known = 0;
+    if (read_file(path, buffer, sizeof(buffer))) {
+      char *at = buffer, *stop;
+      for (long value; known < online; at = stop) {
+        value = strtol(at, &stop, 10);
+        if (stop == at)
+          break;
+
+        distances[known++] = (int32_t)value;
+      }
+    }
+
+    for (int32_t j = 0; j < online; ++j)
+      node->distance[j] = j < known ? distances[j] : (i == j ? 10 : 20);
+
+    node->id = i; // Index into the online nodes until renumbered.
+    pool.count++;
+  }
+
+  // Without sysfs, i.e in some containers, all the CPUs are a single node.
+  if (pool.count == 0) {
+    pool.nodes[0].cpus = *allowed;
+    pool.nodes[0].id = 0;
+    pool.nodes[0].distance[0] = 10;
+    pool.count = 1;
+  }
+
+  for (int32_t i = 0; i < pool.count; ++i) {
+    pool_node *node = &pool.nodes[i];
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &node->cpus))
+        pool.cpu_node[cpu] = (int16_t)i;
+    }
+
+    // Order the other nodes by distance, by insertion.
+    int32_t count = 0;
+    for (int32_t j = 0; j < pool.count; ++j) {
+      if (j == i)
+        continue;
+
+      const int32_t distance = node->distance[pool.nodes[j].id];
+      int32_t at = count++;
+      for (; at > 0 && node->distance[pool.nodes[node->steal[at - 1]].id] >
+                           distance;
+           --at)
+        node->steal[at] = node->steal[at - 1];
+
+      node->steal[at] = j;
+    }
+  }
+
+  for (int32_t i = 0; i < pool.count; ++i)
+    pool.nodes[i].id = i;
+}
+
+/**
+ * @brief Run the iterations left in the share of a node.
+ */
+static void run_share(pool_node *node, void (*body)(int32_t), long grain) {
+  for (;;) {
+    long index = atomic_fetch_add_explicit(&node->next, grain,
+                                           memory_order_relaxed);
+    if (index >= node->end)
+      return;
+
+    const long stop = index + grain < node->end ? index + grain : node->end;
+    for (; index < stop; ++index)
+      body((int32_t)index);
+  }
+}
+
+/**
+ * @brief Run the share of a node, then steal from the others.
+ */
+static void run_loop(int32_t node, void (*body)(int32_t), long grain) {
+  run_share(&pool.nodes[node], body, grain);
+
+  for (int32_t i = 0; i < pool.count - 1; ++i)
+    run_share(&pool.nodes[pool.nodes[node].steal[i]], body, grain);
+}
+
+static void *worker_main(void *arg) {
+  pool_node *node = arg;
+  current_node = node->id;
+  in_loop = 1;
+
+  // Pinned to the node, the kernel still balances between its CPUs.
+  pthread_setaffinity_np(pthread_self(), sizeof(node->cpus), &node->cpus);
+
+  uint64_t seen = 0;
+  for (;;) {
+    pthread_mutex_lock(&pool.lock);
+    while (pool.generation == seen)
+      pthread_cond_wait(&pool.start, &pool.lock);
+
+    seen = pool.generation;
+    void (*body)(int32_t) = pool.body;
+    const long grain = pool.grain;
+    pthread_mutex_unlock(&pool.lock);
+
+    run_loop(node->id, body, grain);
+
+    pthread_mutex_lock(&pool.lock);
+    if (--pool.active == 0)
+      pthread_cond_signal(&pool.done);
+    pthread_mutex_unlock(&pool.lock);
+  }
+
+  return NULL;
+}
+
+static void initialize(void) {
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    CPU_ZERO(&allowed);
+    for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); ++cpu)
+      CPU_SET(cpu, &allowed);
+  }
+
+  discover(&allowed);
+
+  // One worker per usable CPU, unless capped by `VERTE_POOL_THREADS`.
+  long limit = CPU_COUNT(&allowed);
+  const char *threads = getenv("VERTE_POOL_THREADS");
+  if (threads && atol(threads) > 0)
+    limit = atol(threads);
+
+  // Hand the workers to the nodes in turn, as long as they have CPUs left.
+  for (int32_t assigned = 1; assigned && pool.workers < limit;) {
+    assigned = 0;
+    for (int32_t i = 0; i < pool.count && pool.workers < limit; ++i) {
+      pool_node *node = &pool.nodes[i];
+      if (node->workers >= CPU_COUNT(&node->cpus))
+        continue;
+
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, worker_main, node) != 0)
+        continue;
+
+      pthread_detach(thread);
+      node->workers++;
+      pool.workers++;
+      assigned = 1;
+    }
+  }
+
+  for (int32_t i = 0; i < pool.count; ++i)
+    pthread_mutex_init(&pool.nodes[i].arena_lock, NULL);
+}
+
+int32_t verte_numa_nodes(void) {
+  pthread_once(&pool.once, initialize);
+  return pool.count;
+}
+
+int32_t verte_numa_node(void) {
+  pthread_once(&pool.once, initialize);
+  if (current_node >= 0)
+    return current_node;
+
+  const int cpu = sched_getcpu();
+  return cpu >= 0 && cpu < CPU_SETSIZE ? pool.cpu_node[cpu] : 0;
+}
+
+void verte_parallel_for(int32_t n, void (*body)(int32_t)) {
+  pthread_once(&pool.once, initialize);
+  if (n <= 0)
+    return;
+
+  // A nested loop runs in its thread, the others are busy with the outer one.
+  if (in_loop || pool.workers == 0) {
+    for (int32_t i = 0; i < n; ++i)
+      body(i);
+
+    return;
+  }
+
+  pthread_mutex_lock(&pool.job);
+
+  // Each node gets a contiguous share, in proportion to its workers.
+  long begin = 0;
+  for (int32_t i = 0, before = 0; i < pool.count; ++i) {
+    pool_node *node = &pool.nodes[i];
+    before += node->workers;
+
+    const long end = (long)n * before / pool.workers;
+    atomic_store_explicit(&node->next, begin, memory_order_relaxed);
+    node->end = end;
+    begin = end;
+  }
+
+  long grain = n / ((long)pool.workers * VERTE_POOL_CHUNKS);
+  grain = grain > 0 ? grain : 1;
+
+  pthread_mutex_lock(&pool.lock);
+  pool.body = body;
+  pool.grain = grain;
+  pool.active = pool.workers;
+  pool.generation++;
+  pthread_cond_broadcast(&pool.start);
+  pthread_mutex_unlock(&pool.lock);
+
+  // The caller helps from its own node.
+  in_loop = 1;
+  run_loop(verte_numa_node(), body, grain);
+  in_loop = 0;
+
+  pthread_mutex_lock(&pool.lock);
+  while (pool.active > 0)
+    pthread_cond_wait(&pool.done, &pool.lock);
+  pthread_mutex_unlock(&pool.lock);
+
+  pthread_mutex_unlock(&pool.job);
+}
+
+char *verte_node_alloc(int64_t size) {
+  const int32_t id = verte_numa_node();
+  if (size <= 0)
+    return NULL;
+
+  pool_node *node = &pool.nodes[id];
+  const size_t bytes =
+      ((size_t)size + VERTE_ARENA_ALIGN - 1) & ~(VERTE_ARENA_ALIGN - 1);
+
+  pthread_mutex_lock(&node->arena_lock);
+  if (bytes > node->arena_left) {
+    const size_t chunk = bytes > VERTE_ARENA_CHUNK
+                             ? (bytes + VERTE_ARENA_CHUNK - 1) &
+                                   ~(VERTE_ARENA_CHUNK - 1)
+                             : VERTE_ARENA_CHUNK;
+
+    char *memory = mmap(NULL, chunk, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+      pthread_mutex_unlock(&node->arena_lock);
+      return NULL;
+    }
+
+    // Pages are placed on the node of the thread touching them first. Workers
+    // are pinned to the node of the arena, other threads were on it when
+    // `sched_getcpu` ran but may have moved since: the placement is then only
+    // a best effort.
+    const long page = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < chunk; offset += (size_t)page)
+      ((volatile char *)memory)[offset] = 0;
+
+    // The rest of the old chunk is left behind.
+    node->arena = memory;
+    node->arena_left = chunk;
+  }
+
+  char *result = node->arena;
+  node->arena += bytes;
+  node->arena_left -= bytes;
+  pthread_mutex_unlock(&node->arena_lock);
+  return result;
+}
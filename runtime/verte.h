@@ -0,0 +1,207 @@
+/**
+ * @brief Runtime support library linked into compiled Verte programs.
+ * @file verte.h
+ */
+
+#ifndef VERTE_RUNTIME_VERTE_H
+#define VERTE_RUNTIME_VERTE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct verte_bench
+ * @brief A benchmark emitted from a `bench name { ... }` block.
+ */
+typedef struct verte_bench {
+  const char *name; /**< The name of the benchmark. */
+  void (*fn)(void); /**< Runs one iteration of the benchmark. */
+} verte_bench;
+
+/**
+ * @brief Run the benchmarks of a program, called by the generated `main`.
+ *
+ * Each benchmark is calibrated until a batch of iterations takes long enough
+ * to time reliably, warmed up, then sampled. The mean, median and standard
+ * deviation of the nanoseconds per iteration are reported on stdout.
+ *
+ * Recognized arguments:
+ *   - `--json`: report as JSON instead of a table.
+ *   - `--filter <str>`: only run benchmarks whose name contains `str`.
+ *   - `--samples <n>`: number of timed samples per benchmark.
+ *
+ * @param argc Argument count of the program.
+ * @param argv Arguments of the program.
+ * @param benches The benchmarks.
+ * @param count Number of benchmarks.
+ * @return The exit code of the program.
+ */
+int32_t verte_bench_main(int32_t argc, char **argv,
+                         const verte_bench *benches, int32_t count);
+
+/**
+ * @brief Get the number of NUMA nodes the program runs on.
+ * @return The number of nodes, 1 without NUMA.
+ */
+int32_t verte_numa_nodes(void);
+
+/**
+ * @brief Get the NUMA node of the calling thread.
+ * @return The node a worker is pinned to, or the node of the current CPU.
+ */
+int32_t verte_numa_node(void);
+
+/**
+ * @brief Run `body(i)` for every `i` in `[0, n)` on the worker pool.
+ *
+ * Each node runs a contiguous share of the range, split the same way on
+ * every call, before stealing from the nearest nodes. The caller helps and
+ * returns once every iteration ran. Nested loops run sequentially.
+ *
+ * @param n The number of iterations.
+ * @param body The body of the loop.
+ */
+void verte_parallel_for(int32_t n, void (*body)(int32_t));
+
+/**
+ * @brief Allocate from the arena of the node of the calling thread.
+ *
+ * The memory is touched from the calling thread, so its pages are local to
+ * the node for pool workers, which are pinned. For other threads the node is
+ * where they last ran, the placement is a best effort. It is aligned on a
+ * cache line and only released at exit.
+ *
+ * @param size The size in bytes.
+ * @return The memory, or null if it is exhausted.
+ */
+char *verte_node_alloc(int64_t size);
+
+/**
+ * @struct verte_chan
+ * @brief A bounded lock-free multi-producer multi-consumer channel of 64 bits
+ * values, the runtime side of `chan<T>`.
+ */
+typedef struct verte_chan verte_chan;
+
+/**
+ * @brief Create a channel.
+ * @param capacity The number of values it holds, rounded up to a power of
+ * two, at least two.
+ * @return The channel.
+ * @note Aborts if the capacity is not positive or the channel cannot be
+ * allocated.
+ */
+verte_chan *verte_chan_new(int32_t capacity);
+
+/**
+ * @brief Free a channel no thread uses anymore.
+ * @param chan The channel.
+ */
+void verte_chan_free(verte_chan *chan);
+
+/**
+ * @brief Send a value, waiting while the channel is full.
+ * @param chan The channel.
+ * @param value The value.
+ */
+void verte_chan_send(verte_chan *chan, int64_t value);
+
+/**
+ * @brief Receive a value, waiting while the channel is empty.
+ * @param chan The channel.
+ * @return The oldest value.
+ */
+int64_t verte_chan_recv(verte_chan *chan);
+
+/**
+ * @brief Send a value unless the channel is full.
+ * @param chan The channel.
+ * @param value The value.
+ * @return 1 if it was sent, 0 otherwise.
+ */
+int32_t verte_chan_try_send(verte_chan *chan, int64_t value);
+
+/**
+ * @brief Receive a value unless the channel is empty.
+ * @param chan The channel.
+ * @param value Receives the oldest value.
+ * @return 1 if a value was received, 0 otherwise.
+ */
+int32_t verte_chan_try_recv(verte_chan *chan, int64_t *value);
+
+/**
+ * @brief Queue a read of `size` bytes at `offset` of a file into `buffer`.
+ *
+ * The operations of a thread are queued in its io_uring, or for I/O threads
+ * running `pread` and `pwrite` where it is unavailable or with
+ * `VERTE_AIO=threads`. At most 256 are in flight per thread, the buffer must
+ * stay valid until the operation is waited for.
+ *
+ * @param fd The file.
+ * @param buffer The memory to read into.
+ * @param size The number of bytes.
+ * @param offset The offset in the file.
+ * @return The ticket of the operation, or a negated errno.
+ */
+int32_t verte_read_at_async(int32_t fd, char *buffer, int64_t size,
+                            int64_t offset);
+
+/**
+ * @brief Queue a write of `size` bytes of `buffer` at `offset` of a file.
+ * @param fd The file.
+ * @param buffer The memory to write.
+ * @param size The number of bytes.
+ * @param offset The offset in the file.
+ * @return The ticket of the operation, or a negated errno.
+ */
+int32_t verte_write_at_async(int32_t fd, char *buffer, int64_t size,
+                             int64_t offset);
+
+/**
+ * @brief Submit the operations queued by the calling thread at once.
+ * @return The number of operations submitted, or a negated errno.
+ */
+int32_t verte_submit(void);
+
+/**
+ * @brief Wait for an operation of the calling thread, submitting the queued
+ * ones first, and free its ticket.
+ * @param ticket The ticket of the operation.
+ * @return The number of bytes transferred, or a negated errno.
+ */
+int64_t verte_wait(int32_t ticket);
+
+/**
+ * @brief Register a buffer with the io_uring of the calling thread, the
+ * operations within it skip mapping its pages.
+ * @param buffer The memory.
+ * @param size The size of the memory.
+ * @return 0, or a negated errno.
+ */
+int32_t verte_register_buffer(char *buffer, int64_t size);
+
+/**
+ * @brief Register a file with the io_uring of the calling thread, its
+ * operations skip looking it up. The registration keeps the file open: it
+ * must be unregistered before the descriptor is closed, or a new file opened
+ * with the same descriptor would not be seen.
+ * @param fd The file.
+ * @return 0, or a negated errno.
+ */
+int32_t verte_register_file(int32_t fd);
+
+/**
+ * @brief Unregister a file registered by the calling thread.
+ * @param fd The file.
+ * @return 0, or `-ENOENT` if the file was not registered.
+ */
+int32_t verte_unregister_file(int32_t fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VERTE_RUNTIME_VERTE_H
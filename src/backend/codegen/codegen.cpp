@@ -6,17 +6,140 @@
 #include "verte/backend/codegen/codegen.hpp"
 #include "verte/errors.hpp"
 
+#include <llvm/IR/InlineAsm.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include <algorithm>
+#include <cctype>
+
 namespace verte::codegen {
   llvm::Module &Codegen::getModule() const { return *module; }
 
+  ModulePtr Codegen::takeModule() { return std::move(module); }
+
   auto Codegen::visit(const ProgramNode &node) -> RetT {
-    for (const auto &child : node.getBody()) {
-      child->accept(*this);
+    generate({&node});
+    return {};
+  }
+
+  void Codegen::generate(const std::vector<const ProgramNode *> &parts) {
+    for (const auto *part : parts)
+      append(*part);
+
+    finalize();
+  }
+
+  std::vector<llvm::Function *> Codegen::append(const ProgramNode &part) {
+    std::vector<llvm::Function *> defined;
+
+    for (const auto &child : part.getBody()) {
+      const auto value = child->accept(*this);
+
+      // Prototypes return their declaration.
+      const auto *func = std::get_if<llvm::Function *>(&value);
+      if (func && *func && !(*func)->isDeclaration())
+        defined.push_back(*func);
     }
 
+    return defined;
+  }
+
+  std::vector<llvm::Function *> Codegen::finalize() {
+    if (debugInfo)
+      debugInfo->finalize();
+
+    if (options.bench)
+      return {createBenchHarness()};
+
     return {};
   }
 
+  void Codegen::attachLines(std::string_view source,
+                            const std::string &fileName) {
+    lineStarts = {0};
+    for (size_t i = 0; i < source.size(); ++i)
+      if (source[i] == '\n')
+        lineStarts.push_back(i + 1);
+
+    // Only lines are described, not the types nor the variables. The source
+    // travels with the module, for the annotated assembly.
+    debugInfo = std::make_unique<llvm::DIBuilder>(*module);
+    debugFile = debugInfo->createFile(fileName, ".", {},
+                                      llvm::StringRef(source));
+    debugInfo->createCompileUnit(llvm::dwarf::DW_LANG_C, debugFile, "vertec",
+                                 false, "", 0, "",
+                                 llvm::DICompileUnit::LineTablesOnly);
+
+    module->addModuleFlag(llvm::Module::Warning, "Debug Info Version",
+                          llvm::DEBUG_METADATA_VERSION);
+    module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+  }
+
+  void Codegen::setDebugLocation(const ASTNode &node) {
+    llvm::DISubprogram *subprogram =
+        currentFunc ? currentFunc->llvmFunc->getSubprogram() : nullptr;
+
+    // Benchmarks and initializers have no lines of their own.
+    if (!subprogram) {
+      builder->SetCurrentDebugLocation(llvm::DebugLoc());
+      return;
+    }
+
+    const auto [line, column] = lineOf(node.getLocation().offset);
+    builder->SetCurrentDebugLocation(
+        llvm::DILocation::get(context, line, column, subprogram));
+  }
+
+  std::pair<unsigned, unsigned> Codegen::lineOf(uint32_t offset) const {
+    const auto next =
+        std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+
+    const auto line = static_cast<unsigned>(next - lineStarts.begin());
+    return {line, offset - *std::prev(next) + 1};
+  }
+
+  ModulePtr Codegen::split() {
+    for (auto &function : *module) {
+      if (function.isIntrinsic())
+        continue;
+
+      if (function.hasLocalLinkage()) {
+        function.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        function.setVisibility(llvm::GlobalValue::HiddenVisibility);
+      }
+
+      auto &external = externals[function.getName().str()];
+      external = {function.getFunctionType(), function.getAttributes(),
+                  external.defined || !function.isDeclaration()};
+    }
+
+    // Functions load global constants from their global from now on. Plain
+    // values still fold into later initializers, those referring to the taken
+    // module, i.e strings, do not.
+    for (const auto &[name, global] : globals) {
+      externals[name] = {global->getValueType(), {}, true,
+                         global->isConstant(), global->getThreadLocalMode()};
+
+      if (const auto constant = constants.find(name);
+          constant != constants.end() &&
+          !llvm::isa<llvm::ConstantData>(constant->second))
+        constants.erase(name);
+    }
+
+    globals.clear();
+
+    auto taken = std::move(module);
+    module = std::make_unique<llvm::Module>(taken->getModuleIdentifier(),
+                                            context);
+
+    for (auto &[name, func] : benches)
+      func = findFunction(func->getName().str());
+
+    return taken;
+  }
+
   auto Codegen::visit(const LiteralNode &node) -> RetT {
     const auto &value = node.getValue();
     const auto &typeInfo = node.getType();
@@ -44,6 +167,7 @@ namespace verte::codegen {
       case STRING:
         return createString(value);
 
+      case CHANNEL:
       case VOID:
       case UNKNOWN:
         return {};
@@ -56,8 +180,13 @@ namespace verte::codegen {
     auto type = getType(node.getType());
     const std::string &name = node.getName();
 
+    checkAttributes(node.getAttributes(), name);
+
     // Handle local definition.
     if (currentFunc != nullptr) {
+      if (!node.getAttributes().empty())
+        error("Attributes are only allowed on global variables: " + name);
+
       auto value = std::get<llvm::Value *>(node.getValue()->accept(*this));
       if (!value)
         error("Invalid value for variable: " + name);
@@ -73,6 +202,10 @@ namespace verte::codegen {
       currentFunc->locals[name] = alloca;
     }
 
+    // Handle global channels, created before the program runs.
+    else if (node.getType().dataType == TypeInfo::DataType::CHANNEL)
+      createGlobalChannel(node);
+
     // Handle global definition.
     else {
       llvm::Constant *valuePtr = llvm::Constant::getNullValue(type);
@@ -81,17 +214,36 @@ namespace verte::codegen {
       if (!value)
         error("Invalid value for variable declaration: " + name);
 
-      if (!node.isConstant())
-        error("Global variable must be constant: " + name);
+      if (findAttribute(node.getAttributes(), "overflow"))
+        error("Attribute `overflow` only applies to functions: " + name);
+
+      const bool threadLocal =
+          findAttribute(node.getAttributes(), "thread_local") != nullptr;
+      if (threadLocal && node.isConstant())
+        error("Attribute `thread_local` only applies to mutable globals: " +
+              name);
 
-      valuePtr = llvm::cast<llvm::Constant>(value);
-      constants[name] = valuePtr; // Register the constant to the codegen.
+      valuePtr = llvm::dyn_cast<llvm::Constant>(value);
+      if (!valuePtr)
+        error("Global variable must be initialized by a constant: " + name);
+
+      // Only the constants are folded into their uses.
+      if (node.isConstant())
+        constants[name] = valuePtr;
 
       // Create the global variable.
       auto globalVar = new llvm::GlobalVariable(
-          *module, type, true, llvm::GlobalValue::ExternalLinkage, valuePtr,
-          name);
+          *module, type, node.isConstant(), llvm::GlobalValue::ExternalLinkage,
+          valuePtr, name);
+
+      // An executable owns its thread-locals, their offset from the thread
+      // pointer is fixed at load time.
+      if (threadLocal)
+        globalVar->setThreadLocalMode(
+            options.shared ? llvm::GlobalValue::GeneralDynamicTLSModel
+                           : llvm::GlobalValue::InitialExecTLSModel);
 
+      setVisibility(globalVar, node.getAttributes());
       globals[name] = globalVar;
     }
 
@@ -105,8 +257,9 @@ namespace verte::codegen {
     if (constants.contains(name))
       error("Cannot assign to a constant: " + name);
 
-    else if (globals.contains(name))
-      error("Cannot assign to a global variable: " + name);
+    auto *global = findGlobal(name);
+    if (global && global->isConstant())
+      error("Cannot assign to a constant: " + name);
 
     auto value = std::get<llvm::Value *>(node.getValue()->accept(*this));
     if (!value)
@@ -114,41 +267,58 @@ namespace verte::codegen {
 
     // Checking in function scope.
     if (currentFunc != nullptr) {
-      if (currentFunc->constants.find(name) != currentFunc->constants.end())
+      if (global) {
+        builder->CreateStore(value, global);
+        return {};
+      }
+
+      if (currentFunc->constants.contains(name))
         error("Cannot assign to constant variable: " + name);
 
-      else if (currentFunc->locals.find(name) == currentFunc->locals.end())
+      const auto local = currentFunc->locals.find(name);
+      if (local == currentFunc->locals.end())
         error("Unknown variable referenced: " + name);
 
-      if (currentFunc->locals.contains(name)) {
-        auto alloca = currentFunc->locals[name];
-        builder->CreateStore(value, alloca);
-
-        return {};
-      }
+      builder->CreateStore(value, local->second);
+      return {};
     }
 
+    if (global)
+      error("Global variable can only be assigned in a function: " + name);
+
     // Variable not found in locals, globals.
     error("Unknown variable referenced: " + name);
   }
 
   auto Codegen::visit(const VariableNode &node) -> RetT {
-    const std::string name = node.getName();
+    const std::string &name = node.getName();
+
+    // There is nothing to load from outside of a function.
+    if (currentFunc == nullptr) {
+      if (const auto constant = constants.find(name);
+          constant != constants.end())
+        return constant->second;
+
+      if (findGlobal(name))
+        error("Global variable must be initialized by a constant: " + name);
+    }
 
-    if (globals.contains(name))
+    if (findGlobal(name))
       return loadGlobal(name);
 
-    else if (constants.contains(name))
-      return constants[name];
+    else if (const auto constant = constants.find(name);
+             constant != constants.end())
+      return constant->second;
 
     if (currentFunc != nullptr) {
-      if (currentFunc->locals.contains(name)) {
-        auto alloca = currentFunc->locals[name];
-        return builder->CreateLoad(alloca->getAllocatedType(), alloca, name);
-      }
-
-      if (currentFunc->constants.contains(name))
-        return currentFunc->constants[name];
+      const auto &locals = currentFunc->locals;
+      if (const auto local = locals.find(name); local != locals.end())
+        return builder->CreateLoad(local->second->getAllocatedType(),
+                                   local->second, name);
+
+      const auto &scoped = currentFunc->constants;
+      if (const auto constant = scoped.find(name); constant != scoped.end())
+        return constant->second;
     }
 
     error("Unknown variable referenced: " + name);
@@ -177,7 +347,8 @@ namespace verte::codegen {
     // Create the body of the if-statement.
     builder->SetInsertPoint(then);
     node.getBlock()->accept(*this);
-    builder->CreateBr(merge);
+    if (!builder->GetInsertBlock()->getTerminator())
+      builder->CreateBr(merge);
 
     builder->SetInsertPoint(merge);
     return {};
@@ -209,12 +380,14 @@ namespace verte::codegen {
     // Create the body of the if-statement.
     builder->SetInsertPoint(then);
     node.getIfNode()->getBlock()->accept(*this);
-    builder->CreateBr(merge);
+    if (!builder->GetInsertBlock()->getTerminator())
+      builder->CreateBr(merge);
 
     // Create the body of the else-statement.
     builder->SetInsertPoint(else_);
     node.getElseBlock()->accept(*this);
-    builder->CreateBr(merge);
+    if (!builder->GetInsertBlock()->getTerminator())
+      builder->CreateBr(merge);
 
     builder->SetInsertPoint(merge);
     return {};
@@ -236,9 +409,9 @@ namespace verte::codegen {
       error("Binary operands must have the same type.");
 
     // clang-format off
-    if (op == "+") return builder->CreateAdd(lhs, rhs, "addtmp");
-    else if (op == "-") return builder->CreateSub(lhs, rhs, "subtmp");
-    else if (op == "*") return builder->CreateMul(lhs, rhs, "multmp");
+    if (op == "+") return createArithmetic(llvm::Instruction::Add, lhs, rhs, "addtmp");
+    else if (op == "-") return createArithmetic(llvm::Instruction::Sub, lhs, rhs, "subtmp");
+    else if (op == "*") return createArithmetic(llvm::Instruction::Mul, lhs, rhs, "multmp");
     else if (op == "/") return builder->CreateFDiv(lhs, rhs, "divtmp");
     else if (op == "%") return builder->CreateSRem(lhs, rhs, "modtmp");
     else if (op == "<") return builder->CreateICmpULT(lhs, rhs, "cmptmp");
@@ -259,8 +432,10 @@ namespace verte::codegen {
     if (!operand)
       error("Invalid operand for unary operation");
 
-    if (op == "-")
-      return builder->CreateNeg(operand, "negtmp");
+    if (op == "-") {
+      auto zero = llvm::Constant::getNullValue(operand->getType());
+      return createArithmetic(llvm::Instruction::Sub, zero, operand, "negtmp");
+    }
 
     else if (op == "!")
       return builder->CreateNot(operand, "nottmp");
@@ -270,43 +445,88 @@ namespace verte::codegen {
 
   auto Codegen::visit(const ProtoNode &node) -> RetT {
     const std::string name = node.getName();
+    checkAttributes(node.getAttributes(), name);
+
+    if (findAttribute(node.getAttributes(), "thread_local"))
+      error("Attribute `thread_local` only applies to mutable globals: " +
+            name);
 
     // Get parameter types.
     std::vector<llvm::Type *> paramTypes;
-    for (const auto &param : node.getParams())
+    for (const auto &param : node.getParams()) {
       paramTypes.push_back(getType(param.type));
+      if (!paramTypes.back())
+        error("Unknown type for parameter: " + param.name);
+    }
 
     // Create the function type.
     llvm::Type *returnType = getType(node.getRetType());
+    if (!returnType)
+      error("Unknown return type for function: " + name);
+
     llvm::FunctionType *funcType =
         llvm::FunctionType::get(returnType, paramTypes, false);
 
+    // Re-declaring a function is fine as long as the signatures agree.
+    if (llvm::Function *existing = findFunction(name)) {
+      if (existing->getFunctionType() != funcType)
+        error("Conflicting declaration of function: " + name);
+
+      return existing;
+    }
+
     // Create the function.
     llvm::Function *func = llvm::Function::Create(
         funcType, llvm::Function::ExternalLinkage, name, module.get());
+    setFrameAttributes(func);
 
-    // Set the names for the function arguments.
+    // Set the names for the function arguments, booleans follow the C ABI.
     size_t i = 0;
-    for (auto &arg : func->args())
+    for (auto &arg : func->args()) {
       arg.setName(node.getParams()[i++].name);
+      if (arg.getType()->isIntegerTy(1))
+        arg.addAttr(llvm::Attribute::ZExt);
+    }
+
+    if (returnType->isIntegerTy(1))
+      func->addRetAttr(llvm::Attribute::ZExt);
 
     return func;
   }
 
   auto Codegen::visit(const BlockNode &node) -> RetT {
     // Visit the children nodes.
-    for (const auto &child : node.getBody())
+    for (const auto &child : node.getBody()) {
+      if (debugInfo)
+        setDebugLocation(*child);
+
       child->accept(*this);
+    }
 
     return {};
   }
 
   auto Codegen::visit(const FuncDeclNode &node) -> RetT {
+    // The benchmark harness provides its own `main`.
+    if (options.bench && node.getProto()->getName() == "main") {
+      logger.warn("Skipping `main`, the benchmark harness replaces it.");
+      return {};
+    }
+
     llvm::Function *func =
         std::get<llvm::Function *>(node.getProto()->accept(*this));
 
+    const auto external = externals.find(node.getProto()->getName());
+    if (!func->empty() ||
+        (external != externals.end() && external->second.defined))
+      error("Redefinition of function: " + node.getProto()->getName());
+
     // Saving the previous function.
     std::unique_ptr<Function> prev = std::move(currentFunc);
+    const Overflow prevOverflow = overflow;
+    llvm::BasicBlock *prevTrapBlock = trapBlock;
+    overflow = getOverflow(node.getProto()->getAttributes());
+    trapBlock = nullptr;
 
     // Update the current function.
     const std::string &name = node.getProto()->getName();
@@ -318,6 +538,20 @@ namespace verte::codegen {
 
     currentFunc->llvmFunc = func;
 
+    // The prologue belongs to the line of the declaration.
+    const llvm::DebugLoc prevLocation = builder->getCurrentDebugLocation();
+    if (debugInfo) {
+      const unsigned line = lineOf(node.getLocation().offset).first;
+      func->setSubprogram(debugInfo->createFunction(
+          debugFile, name, func->getName(), debugFile, line,
+          debugInfo->createSubroutineType(
+              debugInfo->getOrCreateTypeArray({})),
+          line, llvm::DINode::FlagPrototyped,
+          llvm::DISubprogram::SPFlagDefinition));
+
+      setDebugLocation(node);
+    }
+
     // Create the entry block.
     llvm::BasicBlock *block = llvm::BasicBlock::Create(context, "entry", func);
     builder->SetInsertPoint(block);
@@ -334,15 +568,45 @@ namespace verte::codegen {
     // Visit the function body.
     node.getBody()->accept(*this);
 
+    // Close the last block, falling off a non-void function is unreachable.
+    if (!builder->GetInsertBlock()->getTerminator()) {
+      if (retType->isVoidTy())
+        builder->CreateRetVoid();
+      else
+        builder->CreateUnreachable();
+    }
+
+    setVisibility(func, node.getProto()->getAttributes());
+
     // Reset the current function.
+    builder->SetCurrentDebugLocation(prevLocation);
     currentFunc = std::move(prev);
+    overflow = prevOverflow;
+    trapBlock = prevTrapBlock;
     return func;
   }
 
   auto Codegen::visit(const CallNode &node) -> RetT {
     // Get the callee function.
     std::string name = node.getCallee()->getName();
-    llvm::Function *callee = module->getFunction(name);
+    if (name == "black_box")
+      return createBlackBox(node);
+
+    else if (name == "parallel_for")
+      return createParallelFor(node);
+
+    // The channel and I/O operations do not shadow the functions of the
+    // program, i.e `send` or `wait` from the C library.
+    else if (isChannelBuiltin(name) && !findFunction(name))
+      return createChannelBuiltin(node);
+
+    else if (isAioBuiltin(name) && !findFunction(name))
+      return createAioBuiltin(node);
+
+    else if (isNumaBuiltin(name))
+      return createNumaBuiltin(node);
+
+    llvm::Function *callee = findFunction(name);
 
     if (!callee)
       error("Unknown function referenced: " + name);
@@ -352,8 +616,9 @@ namespace verte::codegen {
     for (const auto &arg : node.getArgs())
       args.push_back(std::get<llvm::Value *>(arg->accept(*this)));
 
-    // Create the call instruction.
-    return builder->CreateCall(callee, args, "calltmp");
+    // Create the call instruction, void results cannot be named.
+    const bool isVoid = callee->getReturnType()->isVoidTy();
+    return builder->CreateCall(callee, args, isVoid ? "" : "calltmp");
   }
 
   auto Codegen::visit(const ReturnNode &node) -> RetT {
@@ -364,6 +629,84 @@ namespace verte::codegen {
     return {};
   }
 
+  auto Codegen::visit(const BenchNode &node) -> RetT {
+    if (currentFunc != nullptr)
+      error("Benchmark must be declared at the top level: " + node.getName());
+
+    // Benchmarks are only emitted when building the harness.
+    if (!options.bench)
+      return {};
+
+    // Each benchmark is a `void()` run in a loop by the runtime, it must not
+    // be inlined so the loop measures exactly one call per iteration.
+    auto funcType = llvm::FunctionType::get(builder->getVoidTy(), false);
+    llvm::Function *func =
+        llvm::Function::Create(funcType, llvm::Function::InternalLinkage,
+                               "bench." + node.getName(), module.get());
+
+    func->addFnAttr(llvm::Attribute::NoInline);
+    setFrameAttributes(func);
+
+    currentFunc = std::make_unique<Function>(
+        Function(func->getName().str(), {}, builder->getVoidTy()));
+
+    currentFunc->llvmFunc = func;
+    trapBlock = nullptr;
+
+    llvm::BasicBlock *block = llvm::BasicBlock::Create(context, "entry", func);
+    builder->SetInsertPoint(block);
+    node.getBody()->accept(*this);
+
+    if (!builder->GetInsertBlock()->getTerminator())
+      builder->CreateRetVoid();
+
+    currentFunc = nullptr;
+    trapBlock = nullptr;
+    benches.emplace_back(node.getName(), func);
+    return func;
+  }
+
+  auto Codegen::visit(const AsmNode &node) -> RetT {
+    if (currentFunc == nullptr)
+      error("Inline assembly must be inside a function.");
+
+    llvm::Type *resultType = getType(node.getType());
+    if (!resultType)
+      error("Unknown output type for inline assembly: " +
+            node.getType().name);
+
+    std::vector<llvm::Value *> operands;
+    std::vector<llvm::Type *> operandTypes;
+    for (const auto &operand : node.getOperands()) {
+      auto value = std::get<llvm::Value *>(operand->accept(*this));
+      if (!value)
+        error("Invalid operand for inline assembly.");
+
+      operands.push_back(value);
+      operandTypes.push_back(value->getType());
+    }
+
+    auto type = llvm::FunctionType::get(resultType, operandTypes, false);
+    checkConstraints(node.getConstraints(), type);
+
+    // As in C, an assembly without output is only there for its effects.
+    auto inlineAsm = llvm::InlineAsm::get(
+        type, node.getCode(), node.getConstraints(),
+        node.hasSideEffects() || resultType->isVoidTy());
+
+    auto call = builder->CreateCall(type, inlineAsm, operands,
+                                    resultType->isVoidTy() ? "" : "asmtmp");
+
+    // Without effects nor memory clobber, the optimizer may merge, hoist or
+    // delete the assembly like any pure computation.
+    call->setDoesNotThrow();
+    if (!inlineAsm->hasSideEffects() &&
+        node.getConstraints().find("~{memory}") == std::string::npos)
+      call->setDoesNotAccessMemory();
+
+    return call;
+  }
+
   llvm::Type *Codegen::getType(const TypeInfo &type) const {
     switch (type.dataType) {
       case TypeInfo::DataType::INTEGER:
@@ -381,6 +724,17 @@ namespace verte::codegen {
       case TypeInfo::DataType::STRING:
         return builder->getInt8PtrTy();
 
+      case TypeInfo::DataType::CHANNEL: {
+        // The handle is a bare pointer, which opaque pointers would not tell
+        // apart. A named struct per element type keeps `chan<int>` and
+        // `chan<str>` distinct, i.e `%"chan<int>" = type { ptr }`.
+        if (auto *channel = llvm::StructType::getTypeByName(context, type.name))
+          return channel;
+
+        return llvm::StructType::create(context, {builder->getInt8PtrTy()},
+                                        type.name);
+      }
+
       case TypeInfo::DataType::VOID:
         return builder->getVoidTy();
 
@@ -389,11 +743,46 @@ namespace verte::codegen {
     }
   }
 
+  llvm::Function *Codegen::findFunction(const std::string &name) {
+    if (llvm::Function *function = module->getFunction(name))
+      return function;
+
+    const auto external = externals.find(name);
+    if (external == externals.end())
+      return nullptr;
+
+    auto *type = llvm::dyn_cast<llvm::FunctionType>(external->second.type);
+    if (!type)
+      return nullptr;
+
+    llvm::Function *function = llvm::Function::Create(
+        type, llvm::Function::ExternalLinkage, name, module.get());
+
+    function->setAttributes(external->second.attributes);
+    return function;
+  }
+
+  llvm::GlobalVariable *Codegen::findGlobal(const std::string &name) {
+    if (const auto global = globals.find(name); global != globals.end())
+      return global->second;
+
+    const auto external = externals.find(name);
+    if (external == externals.end() ||
+        external->second.type->isFunctionTy())
+      return nullptr;
+
+    auto *global = new llvm::GlobalVariable(
+        *module, external->second.type, external->second.constant,
+        llvm::GlobalValue::ExternalLinkage, nullptr, name, nullptr,
+        external->second.threadLocal);
+
+    globals[name] = global;
+    return global;
+  }
+
   llvm::Value *Codegen::loadGlobal(const std::string &name) {
-    if (globals.contains(name)) {
-      auto globalVar = globals[name];
+    if (auto *globalVar = findGlobal(name))
       return builder->CreateLoad(globalVar->getValueType(), globalVar, name);
-    }
 
     error("Unknown global variable: " + name);
   }
@@ -408,6 +797,565 @@ namespace verte::codegen {
     return builder->CreatePointerCast(str, llvm::Type::getInt8PtrTy(context));
   }
 
+  llvm::Value *Codegen::createParallelFor(const CallNode &node) {
+    const auto &args = node.getArgs();
+    if (args.size() != 2)
+      error("`parallel_for` expects a count and a function.");
+
+    auto count = std::get<llvm::Value *>(args[0]->accept(*this));
+    if (!count || !count->getType()->isIntegerTy(32))
+      error("`parallel_for` expects an `int` count.");
+
+    // The body is passed by name, there are no function values otherwise.
+    const auto *name = dynamic_cast<const VariableNode *>(args[1].get());
+    llvm::Function *body = name ? findFunction(name->getName()) : nullptr;
+    auto bodyType = llvm::FunctionType::get(builder->getVoidTy(),
+                                            {builder->getInt32Ty()}, false);
+
+    if (!body || body->getFunctionType() != bodyType)
+      error("`parallel_for` expects the name of a `fn(int) -> void`.");
+
+    // void verte_parallel_for(int n, void (*body)(int))
+    auto type = llvm::FunctionType::get(
+        builder->getVoidTy(), {builder->getInt32Ty(), bodyType->getPointerTo()},
+        false);
+
+    auto run = module->getOrInsertFunction("verte_parallel_for", type);
+    return builder->CreateCall(run, {count, body});
+  }
+
+  llvm::Value *Codegen::createNumaBuiltin(const CallNode &node) {
+    const std::string &name = node.getCallee()->getName();
+
+    // int verte_numa_nodes(void), int verte_numa_node(void) and
+    // char *verte_node_alloc(int64_t size)
+    auto type =
+        name == "node_alloc"
+            ? llvm::FunctionType::get(builder->getInt8PtrTy(),
+                                      {builder->getInt64Ty()}, false)
+            : llvm::FunctionType::get(builder->getInt32Ty(), false);
+
+    const auto &args = node.getArgs();
+    if (args.size() != type->getNumParams())
+      error("`" + name + "` expects " +
+            std::to_string(type->getNumParams()) + " argument(s).");
+
+    std::vector<llvm::Value *> values;
+    for (const auto &arg : args) {
+      auto value = std::get<llvm::Value *>(arg->accept(*this));
+      if (!value || !value->getType()->isIntegerTy(32))
+        error("`" + name + "` expects an `int` argument.");
+
+      values.push_back(builder->CreateSExt(value, builder->getInt64Ty()));
+    }
+
+    auto callee = module->getOrInsertFunction("verte_" + name, type);
+    return builder->CreateCall(callee, values, "calltmp");
+  }
+
+  llvm::Value *Codegen::createChannelBuiltin(const CallNode &node) {
+    if (currentFunc == nullptr)
+      error("Channels must be used inside a function.");
+
+    const std::string &name = node.getCallee()->getName();
+    const auto &args = node.getArgs();
+    auto ptrType = builder->getInt8PtrTy();
+    auto slotType = builder->getInt64Ty();
+
+    // struct verte_chan *verte_chan_new(int32_t capacity)
+    if (name.starts_with("chan<")) {
+      if (args.size() != 1)
+        error("`" + name + "` expects a capacity.");
+
+      auto capacity = std::get<llvm::Value *>(args[0]->accept(*this));
+      if (!capacity || !capacity->getType()->isIntegerTy(32))
+        error("`" + name + "` expects an `int` capacity.");
+
+      // Other capacities are checked by the runtime.
+      if (auto *constant = llvm::dyn_cast<llvm::ConstantInt>(capacity);
+          constant && constant->getSExtValue() < 1)
+        error("`" + name + "` expects a positive capacity.");
+
+      auto type = llvm::FunctionType::get(ptrType, {builder->getInt32Ty()},
+                                          false);
+      auto create = module->getOrInsertFunction("verte_chan_new", type);
+      llvm::Value *handle = builder->CreateCall(create, {capacity}, "chan");
+
+      auto channelType = getType(TypeInfo(TypeInfo::DataType::CHANNEL, name));
+      return builder->CreateInsertValue(llvm::UndefValue::get(channelType),
+                                        handle, 0);
+    }
+
+    const size_t arity = name == "recv" ? 1 : 2;
+    if (args.size() != arity)
+      error("`" + name + "` expects " + std::to_string(arity) +
+            " argument(s).");
+
+    auto channel = std::get<llvm::Value *>(args[0]->accept(*this));
+    auto *channelType =
+        channel ? llvm::dyn_cast<llvm::StructType>(channel->getType())
+                : nullptr;
+    const std::string typeName = channelType && channelType->hasName()
+                                     ? channelType->getName().str()
+                                     : "";
+    if (!typeName.starts_with("chan<"))
+      error("`" + name + "` expects a channel, i.e `chan<int>`.");
+
+    const TypeInfo element = TypeInfo(TypeInfo::DataType::CHANNEL, typeName)
+                                 .element();
+    llvm::Type *elementType = getType(element);
+    llvm::Value *handle = builder->CreateExtractValue(channel, 0, "handle");
+
+    // The value sent, or received if the channel is empty.
+    llvm::Value *value = nullptr;
+    if (arity == 2) {
+      value = std::get<llvm::Value *>(args[1]->accept(*this));
+      if (!value || value->getType() != elementType)
+        error("`" + name + "` expects a `" + element.name + "` value for a `" +
+              typeName + "`.");
+    }
+
+    // void verte_chan_send(struct verte_chan *chan, int64_t value) and
+    // int32_t verte_chan_try_send(struct verte_chan *chan, int64_t value)
+    if (name == "send" || name == "try_send") {
+      const bool blocking = name == "send";
+      auto type = llvm::FunctionType::get(
+          blocking ? builder->getVoidTy() : builder->getInt32Ty(),
+          {ptrType, slotType}, false);
+
+      auto callee = module->getOrInsertFunction("verte_chan_" + name, type);
+      llvm::Value *sent =
+          builder->CreateCall(callee, {handle, toChannelSlot(value)},
+                              blocking ? "" : "sent");
+
+      return blocking ? sent : builder->CreateICmpNE(
+                                   sent, builder->getInt32(0), "senttmp");
+    }
+
+    // int64_t verte_chan_recv(struct verte_chan *chan)
+    if (name == "recv") {
+      auto type = llvm::FunctionType::get(slotType, {ptrType}, false);
+      auto callee = module->getOrInsertFunction("verte_chan_recv", type);
+      return fromChannelSlot(builder->CreateCall(callee, {handle}, "slot"),
+                             elementType);
+    }
+
+    // int32_t verte_chan_try_recv(struct verte_chan *chan, int64_t *value),
+    // the slot lives in the entry block so that it is allocated once.
+    llvm::BasicBlock &entry = currentFunc->llvmFunc->getEntryBlock();
+    llvm::IRBuilder<> entryBuilder(&entry, entry.begin());
+    auto slot = entryBuilder.CreateAlloca(slotType, nullptr, "slot");
+
+    auto type = llvm::FunctionType::get(builder->getInt32Ty(),
+                                        {ptrType, slotType->getPointerTo()},
+                                        false);
+    auto callee = module->getOrInsertFunction("verte_chan_try_recv", type);
+    llvm::Value *received =
+        builder->CreateCall(callee, {handle, slot}, "received");
+
+    llvm::Value *result =
+        fromChannelSlot(builder->CreateLoad(slotType, slot), elementType);
+    return builder->CreateSelect(
+        builder->CreateICmpNE(received, builder->getInt32(0)), result, value,
+        "recvtmp");
+  }
+
+  llvm::Value *Codegen::createAioBuiltin(const CallNode &node) {
+    const std::string &name = node.getCallee()->getName();
+
+    // The parameters, `i` is an `int`, `l` an `int` widened to 64 bits for
+    // sizes and offsets and `s` a `str`.
+    const bool single = name == "wait" || name == "register_file" ||
+                        name == "unregister_file";
+    const std::string_view params = name == "submit"              ? ""
+                                    : single                      ? "i"
+                                    : name == "register_buffer"   ? "sl"
+                                                                  : "isll";
+
+    const auto &args = node.getArgs();
+    if (args.size() != params.size())
+      error("`" + name + "` expects " + std::to_string(params.size()) +
+            " argument(s).");
+
+    std::vector<llvm::Type *> types;
+    std::vector<llvm::Value *> values;
+    for (size_t i = 0; i < params.size(); i++) {
+      auto value = std::get<llvm::Value *>(args[i]->accept(*this));
+      const bool isStr = params[i] == 's';
+
+      if (!value || (isStr ? !value->getType()->isPointerTy()
+                           : !value->getType()->isIntegerTy(32)))
+        error("`" + name + "` expects a `" + (isStr ? "str" : "int") +
+              "` argument " + std::to_string(i + 1) + ".");
+
+      if (params[i] == 'l')
+        value = builder->CreateSExt(value, builder->getInt64Ty());
+
+      types.push_back(value->getType());
+      values.push_back(value);
+    }
+
+    // int64_t verte_wait(int32_t ticket), the others return an `int32_t`.
+    const bool isWait = name == "wait";
+    auto type = llvm::FunctionType::get(
+        isWait ? builder->getInt64Ty() : builder->getInt32Ty(), types, false);
+
+    auto callee = module->getOrInsertFunction("verte_" + name, type);
+    llvm::Value *result = builder->CreateCall(callee, values, "calltmp");
+    return isWait ? builder->CreateTrunc(result, builder->getInt32Ty())
+                  : result;
+  }
+
+  void Codegen::createGlobalChannel(const VarDeclNode &node) {
+    const std::string &name = node.getName();
+    if (findAttribute(node.getAttributes(), "overflow"))
+      error("Attribute `overflow` only applies to functions: " + name);
+
+    // The constructor only runs on the main thread, before `main`.
+    if (node.isConstant() ||
+        findAttribute(node.getAttributes(), "thread_local"))
+      error("Global channels must be mutable and shared between threads: " +
+            name);
+
+    auto type = getType(node.getType());
+    auto globalVar = new llvm::GlobalVariable(
+        *module, type, false, llvm::GlobalValue::ExternalLinkage,
+        llvm::Constant::getNullValue(type), name);
+
+    setVisibility(globalVar, node.getAttributes());
+    globals[name] = globalVar;
+
+    auto initType = llvm::FunctionType::get(builder->getVoidTy(), false);
+    llvm::Function *init =
+        llvm::Function::Create(initType, llvm::Function::InternalLinkage,
+                               "verte.init." + name, module.get());
+
+    setFrameAttributes(init);
+    currentFunc = std::make_unique<Function>(
+        Function(init->getName().str(), {}, builder->getVoidTy()));
+
+    currentFunc->llvmFunc = init;
+    trapBlock = nullptr;
+
+    builder->SetInsertPoint(llvm::BasicBlock::Create(context, "entry", init));
+    auto value = std::get<llvm::Value *>(node.getValue()->accept(*this));
+    if (!value || value->getType() != type)
+      error("Invalid value for the global channel: " + name);
+
+    builder->CreateStore(value, globalVar);
+    builder->CreateRetVoid();
+
+    currentFunc = nullptr;
+    trapBlock = nullptr;
+    llvm::appendToGlobalCtors(*module, init, 65535);
+  }
+
+  llvm::Value *Codegen::toChannelSlot(llvm::Value *value) {
+    llvm::Type *type = value->getType();
+    if (type->isPointerTy())
+      return builder->CreatePtrToInt(value, builder->getInt64Ty());
+
+    if (type->isFloatingPointTy())
+      value = builder->CreateBitCast(
+          value, builder->getIntNTy(type->getPrimitiveSizeInBits()));
+
+    return builder->CreateZExt(value, builder->getInt64Ty());
+  }
+
+  llvm::Value *Codegen::fromChannelSlot(llvm::Value *slot, llvm::Type *type) {
+    if (type->isPointerTy())
+      return builder->CreateIntToPtr(slot, type);
+
+    if (!type->isFloatingPointTy())
+      return builder->CreateTrunc(slot, type);
+
+    slot = builder->CreateTrunc(
+        slot, builder->getIntNTy(type->getPrimitiveSizeInBits()));
+    return builder->CreateBitCast(slot, type);
+  }
+
+  void Codegen::checkConstraints(const std::string &constraints,
+                                 llvm::FunctionType *type) {
+    const auto parsed = llvm::InlineAsm::ParseConstraints(constraints);
+    if (parsed.empty() && !constraints.empty())
+      error("Invalid inline assembly constraints: " + constraints);
+
+    size_t outputs = 0, inputs = 0;
+    for (const auto &constraint : parsed) {
+      if (constraint.isIndirect)
+        error("Inline assembly memory operands are not supported: " +
+              constraints);
+
+      if (constraint.Type == llvm::InlineAsm::isOutput) {
+        outputs++;
+        continue;
+      }
+
+      if (constraint.Type != llvm::InlineAsm::isInput)
+        continue;
+
+      // A tied operand shares the register of the output, i.e `0`.
+      const auto &codes = constraint.Codes;
+      const bool tied = !codes.empty() && !codes[0].empty() &&
+                        std::isdigit(static_cast<unsigned char>(codes[0][0]));
+      if (tied && inputs < type->getNumParams() &&
+          type->getParamType(inputs) != type->getReturnType())
+        error("Inline assembly operand " + std::to_string(inputs) +
+              " is tied to an output of another type: " + constraints);
+
+      inputs++;
+    }
+
+    const size_t expected = type->getReturnType()->isVoidTy() ? 0 : 1;
+    if (outputs != expected)
+      error("Inline assembly must have " + std::to_string(expected) +
+            " output constraint(s), got " + std::to_string(outputs) + ": " +
+            constraints);
+
+    if (inputs != type->getNumParams())
+      error("Inline assembly has " + std::to_string(type->getNumParams()) +
+            " operand(s) for " + std::to_string(inputs) +
+            " input constraint(s): " + constraints);
+  }
+
+  llvm::Value *Codegen::createArithmetic(llvm::Instruction::BinaryOps op,
+                                         llvm::Value *lhs, llvm::Value *rhs,
+                                         const std::string &name) {
+    llvm::Type *type = lhs->getType();
+    if (overflow == Overflow::WRAP || !type->isIntegerTy() ||
+        type->isIntegerTy(1))
+      return builder->CreateBinOp(op, lhs, rhs, name);
+
+    const bool isAdd = op == llvm::Instruction::Add;
+    const bool isSub = op == llvm::Instruction::Sub;
+
+    // Fold the constants, they may initialize constants and globals.
+    const auto *left = llvm::dyn_cast<llvm::ConstantInt>(lhs);
+    const auto *right = llvm::dyn_cast<llvm::ConstantInt>(rhs);
+    if (left && right) {
+      const llvm::APInt &a = left->getValue(), &b = right->getValue();
+      bool overflowed = false;
+      const llvm::APInt result = isAdd   ? a.sadd_ov(b, overflowed)
+                                 : isSub ? a.ssub_ov(b, overflowed)
+                                         : a.smul_ov(b, overflowed);
+
+      if (!overflowed)
+        return llvm::ConstantInt::get(context, result);
+
+      if (overflow == Overflow::TRAP)
+        error("Integer overflow in constant expression.");
+
+      return llvm::ConstantInt::get(context, isAdd   ? a.sadd_sat(b)
+                                             : isSub ? a.ssub_sat(b)
+                                                     : a.smul_sat(b));
+    }
+
+    if (overflow == Overflow::SATURATE && op != llvm::Instruction::Mul) {
+      return builder->CreateBinaryIntrinsic(
+          isAdd ? llvm::Intrinsic::sadd_sat : llvm::Intrinsic::ssub_sat, lhs,
+          rhs, nullptr, name);
+    }
+
+    auto pair = builder->CreateBinaryIntrinsic(
+        isAdd   ? llvm::Intrinsic::sadd_with_overflow
+        : isSub ? llvm::Intrinsic::ssub_with_overflow
+                : llvm::Intrinsic::smul_with_overflow,
+        lhs, rhs);
+
+    auto value = builder->CreateExtractValue(pair, 0, name);
+    auto overflowed = builder->CreateExtractValue(pair, 1, "overflow");
+
+    // The exact product is negative when the signs of the operands differ.
+    if (overflow == Overflow::SATURATE) {
+      const unsigned bits = type->getIntegerBitWidth();
+      auto negative = builder->CreateICmpSLT(
+          builder->CreateXor(lhs, rhs), llvm::ConstantInt::get(type, 0));
+      auto bound = builder->CreateSelect(
+          negative,
+          llvm::ConstantInt::get(context, llvm::APInt::getSignedMinValue(bits)),
+          llvm::ConstantInt::get(context, llvm::APInt::getSignedMaxValue(bits)));
+
+      return builder->CreateSelect(overflowed, bound, value, name + ".sat");
+    }
+
+    auto unlikely = llvm::MDBuilder(context).createBranchWeights(1, 1 << 20);
+    auto next = llvm::BasicBlock::Create(
+        context, "nooverflow", builder->GetInsertBlock()->getParent());
+
+    builder->CreateCondBr(overflowed, getTrapBlock(), next, unlikely);
+    builder->SetInsertPoint(next);
+    return value;
+  }
+
+  llvm::BasicBlock *Codegen::getTrapBlock() {
+    if (trapBlock)
+      return trapBlock;
+
+    // The trap is cold and never returns, the block is laid out of line.
+    trapBlock = llvm::BasicBlock::Create(
+        context, "overflow.trap", builder->GetInsertBlock()->getParent());
+
+    llvm::IRBuilder<> trap(trapBlock);
+    trap.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+    trap.CreateUnreachable();
+    return trapBlock;
+  }
+
+  Overflow Codegen::getOverflow(const Attributes &attributes) const {
+    const Attribute *attribute = findAttribute(attributes, "overflow");
+    if (!attribute)
+      return options.overflow;
+
+    // The argument was checked with the other attributes.
+    const std::string &mode = attribute->args.front();
+    return mode == "trap"       ? Overflow::TRAP
+           : mode == "saturate" ? Overflow::SATURATE
+                                : Overflow::WRAP;
+  }
+
+  llvm::Value *Codegen::createBlackBox(const CallNode &node) {
+    if (node.getArgs().size() != 1)
+      error("`black_box` expects exactly one argument.");
+
+    auto value = std::get<llvm::Value *>(node.getArgs()[0]->accept(*this));
+    if (!value)
+      error("Invalid argument for `black_box`.");
+
+    // Route the value through an empty asm statement in a general purpose
+    // register. The optimizer can neither see through it nor delete it.
+    llvm::Type *type = value->getType();
+    llvm::Type *regType = type;
+
+    if (type->isIntegerTy(1))
+      regType = builder->getInt8Ty();
+
+    else if (type->isFloatingPointTy())
+      regType = builder->getIntNTy(type->getPrimitiveSizeInBits());
+
+    llvm::Value *reg = value;
+    if (type->isIntegerTy(1))
+      reg = builder->CreateZExt(value, regType);
+
+    else if (type->isFloatingPointTy())
+      reg = builder->CreateBitCast(value, regType);
+
+    auto asmType = llvm::FunctionType::get(regType, {regType}, false);
+    auto blackBox = llvm::InlineAsm::get(asmType, "", "=r,0,~{memory}", true);
+    llvm::Value *result = builder->CreateCall(asmType, blackBox, {reg});
+
+    if (type->isIntegerTy(1))
+      return builder->CreateTrunc(result, type);
+
+    else if (type->isFloatingPointTy())
+      return builder->CreateBitCast(result, type);
+
+    return result;
+  }
+
+  llvm::Function *Codegen::createBenchHarness() {
+    if (findFunction("main"))
+      error("Benchmark harness conflicts with an existing `main`.");
+
+    // struct { i8 *name; void (*fn)(); }
+    auto benchFnType = llvm::FunctionType::get(builder->getVoidTy(), false);
+    auto entryType = llvm::StructType::get(
+        context, {builder->getInt8PtrTy(), benchFnType->getPointerTo()});
+
+    std::vector<llvm::Constant *> entries;
+    for (const auto &[name, func] : benches) {
+      auto nameConst = llvm::ConstantDataArray::getString(context, name, true);
+      auto nameVar = new llvm::GlobalVariable(
+          *module, nameConst->getType(), true,
+          llvm::GlobalValue::PrivateLinkage, nameConst, "bench.name");
+
+      entries.push_back(llvm::ConstantStruct::get(
+          entryType,
+          {llvm::ConstantExpr::getPointerCast(nameVar,
+                                              builder->getInt8PtrTy()),
+           func}));
+    }
+
+    auto tableType = llvm::ArrayType::get(entryType, entries.size());
+    auto table = new llvm::GlobalVariable(
+        *module, tableType, true, llvm::GlobalValue::PrivateLinkage,
+        llvm::ConstantArray::get(tableType, entries), "bench.table");
+
+    // int verte_bench_main(int argc, char **argv, bench *table, int count)
+    auto argvType = builder->getInt8PtrTy()->getPointerTo();
+    auto runType = llvm::FunctionType::get(
+        builder->getInt32Ty(),
+        {builder->getInt32Ty(), argvType, entryType->getPointerTo(),
+         builder->getInt32Ty()},
+        false);
+
+    auto run = module->getOrInsertFunction("verte_bench_main", runType);
+
+    auto mainType = llvm::FunctionType::get(
+        builder->getInt32Ty(), {builder->getInt32Ty(), argvType}, false);
+
+    auto main = llvm::Function::Create(
+        mainType, llvm::Function::ExternalLinkage, "main", module.get());
+    setFrameAttributes(main);
+
+    builder->SetInsertPoint(llvm::BasicBlock::Create(context, "entry", main));
+
+    auto first = builder->CreateConstInBoundsGEP2_32(tableType, table, 0, 0);
+    auto count = builder->getInt32(entries.size());
+
+    builder->CreateRet(builder->CreateCall(
+        run, {main->getArg(0), main->getArg(1), first, count}));
+
+    return main;
+  }
+
+  void Codegen::checkAttributes(const Attributes &attributes,
+                                const std::string &name) {
+    for (const auto &attribute : attributes) {
+      if (attribute.name == "export") {
+        if (!attribute.args.empty())
+          error("Attribute `export` takes no arguments: " + name);
+
+        continue;
+      }
+
+      if (attribute.name == "overflow") {
+        const auto &args = attribute.args;
+        if (args.size() != 1 ||
+            (args[0] != "wrap" && args[0] != "trap" && args[0] != "saturate"))
+          error("Attribute `overflow` takes one of `wrap`, `trap` or "
+                "`saturate`: " +
+                name);
+
+        continue;
+      }
+
+      if (attribute.name == "thread_local") {
+        if (!attribute.args.empty())
+          error("Attribute `thread_local` takes no arguments: " + name);
+
+        continue;
+      }
+
+      error("Unknown attribute `" + attribute.name + "` on: " + name);
+    }
+  }
+
+  void Codegen::setVisibility(llvm::GlobalValue *value,
+                              const Attributes &attributes) {
+    // Executables keep every symbol visible, as before.
+    if (!options.shared)
+      return;
+
+    value->setVisibility(findAttribute(attributes, "export")
+                             ? llvm::GlobalValue::DefaultVisibility
+                             : llvm::GlobalValue::HiddenVisibility);
+  }
+
+  void Codegen::setFrameAttributes(llvm::Function *func) const {
+    if (options.framePointers)
+      func->addFnAttr("frame-pointer", "all");
+  }
+
   template <typename... Args>
   [[noreturn]] void Codegen::error(const std::string &message, Args &&...args) {
     logger.error(message, std::forward<Args>(args)...); // Log then throw.
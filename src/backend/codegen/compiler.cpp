@@ -5,61 +5,436 @@
 
 #include "verte/backend/codegen/compiler.hpp"
 
+/**
+ * @def VERTE_RUNTIME_LIBRARY
+ * @brief Path of the runtime library linked into compiled programs.
+ */
+#ifndef VERTE_RUNTIME_LIBRARY
+#  define VERTE_RUNTIME_LIBRARY "libVerteRuntime.a"
+#endif // VERTE_RUNTIME_LIBRARY
+
+/**
+ * @def VERTE_ALLOC_PROFILER_LIBRARY
+ * @brief Path of the allocation profiler linked into instrumented programs.
+ */
+#ifndef VERTE_ALLOC_PROFILER_LIBRARY
+#  define VERTE_ALLOC_PROFILER_LIBRARY "libVerteAllocProfiler.a"
+#endif // VERTE_ALLOC_PROFILER_LIBRARY
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/TargetRegistry.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <cctype>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 
 namespace verte::codegen {
-  Compiler::Compiler() noexcept {
-    InitializeAllTargetInfos();
-    InitializeAllTargets();
-    InitializeAllTargetMCs();
-    InitializeAllAsmParsers();
-    InitializeAllAsmPrinters();
+  void initializeTargets() {
+    static std::once_flag initialized;
+
+    std::call_once(initialized, [] {
+      InitializeAllTargetInfos();
+      InitializeAllTargets();
+      InitializeAllTargetMCs();
+      InitializeAllAsmParsers();
+      InitializeAllAsmPrinters();
+    });
+  }
+
+  /**
+   * @brief Get the LLVM code generation level of a level.
+   * @param level The level, 0 to 3.
+   * @return The LLVM code generation level.
+   */
+  static CodeGenOpt::Level toCodeGenLevel(unsigned level) {
+    switch (level) {
+      case 0:
+        return CodeGenOpt::None;
+
+      case 1:
+        return CodeGenOpt::Less;
+
+      case 2:
+        return CodeGenOpt::Default;
+
+      default:
+        return CodeGenOpt::Aggressive;
+    }
+  }
+
+  Compiler::Compiler(unsigned optLevel, std::string cpu) noexcept
+      : optLevel(optLevel), cpu(std::move(cpu)) {
+    initializeTargets();
   }
 
   bool Compiler::compile(Module &module, const std::string &outputPath) {
     if (!native(module, outputPath))
       return false;
 
-    std::string command = "gcc " + outputPath + ".o" + " -o " + outputPath;
-    int result = std::system(command.c_str());
-
-    if (result != 0) {
-      errs() << "Error: Linking failed: " << result << "\n";
+    if (!link(outputPath + ".o", outputPath))
       return false;
-    }
 
     // Clean up the temporary object file.
     std::remove((outputPath + ".o").c_str());
     return true;
   }
 
-  bool Compiler::native(Module &module, const std::string &outputPath) {
+  bool BackendDiagnostics::handleDiagnostics(const DiagnosticInfo &info) {
+    if (info.getSeverity() != DS_Error)
+      return false;
+
+    raw_string_ostream out(errors);
+    if (!errors.empty())
+      out << '\n';
+
+    DiagnosticPrinterRawOStream printer(out);
+    info.print(printer);
+    return true;
+  }
+
+  std::string resolveCpu(const std::string &cpu, std::string &error) {
+    initializeTargets();
+    const std::string name =
+        cpu == "native" ? sys::getHostCPUName().str() : cpu;
+
+    auto targetTriple = llvm::sys::getDefaultTargetTriple();
+    auto target = TargetRegistry::lookupTarget(targetTriple, error);
+    if (!target)
+      return "";
+
+    // Unknown CPUs are only warned about by LLVM, and ignored.
+    std::unique_ptr<MCSubtargetInfo> subtarget(
+        target->createMCSubtargetInfo(targetTriple, "", ""));
+    if (!subtarget->isCPUStringValid(name)) {
+      error = std::format("Unknown CPU for {}: {}", targetTriple, name);
+      return "";
+    }
+
+    return name;
+  }
+
+  /**
+   * @brief Create a machine for the host target.
+   * @param options The options of the target.
+   * @param optLevel The optimization level of the backend.
+   * @param cpu The CPU to generate code for.
+   * @param error Set to the reason of the failure, if any.
+   * @return The machine, or null if the target or the CPU is not available.
+   */
+  static std::unique_ptr<TargetMachine>
+  createTargetMachine(const TargetOptions &options, unsigned optLevel,
+                      const std::string &cpu, std::string &error) {
     auto targetTriple = llvm::sys::getDefaultTargetTriple();
-    std::string error;
 
     auto target = TargetRegistry::lookupTarget(targetTriple, error);
-    if (!target) {
-      errs() << error;
+    if (!target)
+      return nullptr;
+
+    const std::string name = resolveCpu(cpu, error);
+    if (name.empty())
+      return nullptr;
+
+    auto features = "";
+
+    std::unique_ptr<TargetMachine> targetMachine(target->createTargetMachine(
+        targetTriple, name, features, options, Reloc::PIC_));
+
+    // Without optimizations the latency matters, not the code: FastISel
+    // skips building a selection DAG per block, and the pipeline gets the
+    // fast register allocator and no machine code optimizations.
+    targetMachine->setOptLevel(toCodeGenLevel(optLevel));
+    if (optLevel == 0)
+      targetMachine->setFastISel(true);
+
+    return targetMachine;
+  }
+
+  /**
+   * @brief Emit a module with a machine.
+   * @param module The module to emit.
+   * @param targetMachine The machine to emit it for.
+   * @param dest The stream to emit into.
+   * @param fileType The kind of file to emit.
+   * @param error Set to the reason of the failure, if any.
+   * @return True if emission succeeded, false otherwise.
+   */
+  static bool run(Module &module, TargetMachine &targetMachine,
+                  raw_pwrite_stream &dest, CodeGenFileType fileType,
+                  std::string &error) {
+    module.setDataLayout(targetMachine.createDataLayout());
+    module.setTargetTriple(targetMachine.getTargetTriple().str());
+
+    legacy::PassManager pass;
+    if (targetMachine.addPassesToEmitFile(pass, dest, nullptr, fileType)) {
+      error = "targetMachine can't emit a file of this type";
       return false;
     }
 
-    auto cpu = "generic";
-    auto features = "";
+    // Inline assembly is only parsed for the target here.
+    std::string diagnostics;
+    LLVMContext &context = module.getContext();
+    auto previous = context.getDiagnosticHandler();
+    context.setDiagnosticHandler(
+        std::make_unique<BackendDiagnostics>(diagnostics));
+
+    pass.run(module);
+    context.setDiagnosticHandler(std::move(previous));
+
+    if (!diagnostics.empty()) {
+      error = diagnostics;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool Compiler::emit(Module &module, raw_pwrite_stream &dest,
+                      CodeGenFileType fileType, std::string &error) {
+    auto targetMachine =
+        createTargetMachine(TargetOptions(), optLevel, cpu, error);
+    return targetMachine && run(module, *targetMachine, dest, fileType, error);
+  }
+
+  /**
+   * @struct FunctionSummary
+   * @brief What the annotated assembly tells about a function.
+   */
+  struct FunctionSummary {
+    uint64_t size = 0;      /**< The size of its code, in bytes. */
+    uint64_t frame = 0;     /**< The size of its stack frame, in bytes. */
+    std::string frameKind;  /**< `static`, or `dynamic` with allocas. */
+  };
+
+  /**
+   * @brief Summarize the functions of a module, from its object.
+   *
+   * The sizes are those of the symbols of the object, the frames those the
+   * backend reports while emitting it, as `-fstack-usage` does.
+   *
+   * @param module The module, left untouched.
+   * @param optLevel The optimization level of the backend.
+   * @param cpu The CPU to generate code for.
+   * @param summaries Receives the summaries, by function name.
+   * @param error Set to the reason of the failure, if any.
+   * @return True if the object was emitted, false otherwise.
+   */
+  static bool
+  summarize(const Module &module, unsigned optLevel, const std::string &cpu,
+            std::unordered_map<std::string, FunctionSummary> &summaries,
+            std::string &error) {
+    SmallString<128> usagePath;
+    if (auto code = sys::fs::createTemporaryFile("verte-stack", "su",
+                                                 usagePath)) {
+      error = code.message();
+      return false;
+    }
 
     TargetOptions options;
-    auto targetMachine = target->createTargetMachine(
-        targetTriple, cpu, features, options, Reloc::PIC_);
+    options.StackUsageOutput = usagePath.str().str();
+
+    // The backend rewrites parts of the IR it emits, emit a copy.
+    auto copy = CloneModule(module);
+    SmallVector<char, 0> object;
+    raw_svector_ostream out(object);
 
-    module.setDataLayout(targetMachine->createDataLayout());
-    module.setTargetTriple(targetTriple);
+    auto targetMachine = createTargetMachine(options, optLevel, cpu, error);
+    const bool emitted =
+        targetMachine &&
+        run(*copy, *targetMachine, out, CGFT_ObjectFile, error);
 
+    // Every line reads `file:line:function<TAB>size<TAB>kind`.
+    std::ifstream usage(usagePath.c_str());
+    for (std::string line; std::getline(usage, line);) {
+      std::istringstream fields(line);
+      std::string location, kind;
+      uint64_t frame = 0;
+      if (!(fields >> location >> frame >> kind))
+        continue;
+
+      auto &summary = summaries[location.substr(location.rfind(':') + 1)];
+      summary.frame = frame;
+      summary.frameKind = kind;
+    }
+
+    usage.close();
+    sys::fs::remove(usagePath);
+    if (!emitted)
+      return false;
+
+    auto file = object::ObjectFile::createObjectFile(
+        MemoryBufferRef(StringRef(object.data(), object.size()), "annotate"));
+    if (!file) {
+      error = toString(file.takeError());
+      return false;
+    }
+
+    for (const auto &[symbol, size] : object::computeSymbolSizes(**file)) {
+      auto type = symbol.getType();
+      auto name = symbol.getName();
+      if (!type || !name || *type != object::SymbolRef::ST_Function) {
+        consumeError(type.takeError());
+        consumeError(name.takeError());
+        continue;
+      }
+
+      summaries[name->str()].size = size;
+    }
+
+    return true;
+  }
+
+  bool Compiler::annotate(Module &module, std::string &assembly,
+                          std::string &error) {
+    std::unordered_map<std::string, FunctionSummary> summaries;
+    if (!summarize(module, optLevel, cpu, summaries, error))
+      return false;
+
+    // The source travels with the line table, see `Codegen::attachLines`.
+    std::vector<std::string> lines;
+    for (const auto *unit : module.debug_compile_units())
+      if (auto source = unit->getFile()->getSource()) {
+        std::istringstream input(source->str());
+        for (std::string line; std::getline(input, line);)
+          lines.push_back(std::move(line));
+      }
+
+    TargetOptions options;
+    options.MCOptions.AsmVerbose = true;
+    auto targetMachine = createTargetMachine(options, optLevel, cpu, error);
+    if (!targetMachine)
+      return false;
+
+    std::string text;
+    {
+      SmallVector<char, 0> buffer;
+      raw_svector_ostream out(buffer);
+      if (!run(module, *targetMachine, out, CGFT_AssemblyFile, error))
+        return false;
+
+      text.assign(buffer.begin(), buffer.end());
+    }
+
+    const std::string comment =
+        targetMachine->getMCAsmInfo()->getCommentString().str();
+
+    // Replace the line directives by the lines they point at, and leave the
+    // debug sections out: the listing is for humans, the object has them.
+    std::istringstream input(text);
+    std::string output;
+    bool inDebugSection = false;
+    size_t lastLine = 0;
+
+    for (std::string line; std::getline(input, line);) {
+      const size_t start = line.find_first_not_of(" \t");
+      const std::string_view code =
+          start == std::string::npos ? "" : std::string_view(line).substr(start);
+
+      if (code.starts_with(".section"))
+        inDebugSection =
+            code.size() > 9 && code.substr(9).starts_with(".debug_");
+      else if (code.starts_with(".text") || code.starts_with(".data") ||
+               code.starts_with(".bss"))
+        inDebugSection = false;
+
+      if (inDebugSection)
+        continue;
+
+      // `.loc file line column`, only emitted when the line changes.
+      if (code.starts_with(".loc\t") || code.starts_with(".loc ")) {
+        std::istringstream fields{std::string(code.substr(5))};
+        size_t file = 0, number = 0;
+        fields >> file >> number;
+
+        if (number != 0 && number != lastLine && number <= lines.size())
+          output += std::format("{} {:>4} | {}\n", comment, number,
+                                lines[number - 1]);
+
+        lastLine = number == 0 ? lastLine : number;
+        continue;
+      }
+
+      // Numbered files only name the source in the line table.
+      if (code.starts_with(".file\t") && code.size() > 6 &&
+          std::isdigit(static_cast<unsigned char>(code[6])))
+        continue;
+
+      const size_t begin = line.find("-- Begin function ");
+      if (begin != std::string::npos) {
+        const std::string name = line.substr(begin + 18);
+        const auto found = summaries.find(name);
+
+        if (found != summaries.end()) {
+          const auto &summary = found->second;
+          output += std::format("{} {}: {} bytes of code, {} bytes of {} "
+                                "stack frame\n",
+                                comment, name, summary.size, summary.frame,
+                                summary.frameKind.empty()
+                                    ? "static"
+                                    : summary.frameKind);
+        }
+
+        lastLine = 0;
+      }
+
+      output += line;
+      output += '\n';
+    }
+
+    assembly = std::move(output);
+    return true;
+  }
+
+  bool Compiler::link(const std::string &objectPath,
+                      const std::string &outputPath, bool shared) {
+    return link(std::vector{objectPath}, outputPath, shared);
+  }
+
+  bool Compiler::link(const std::vector<std::string> &objectPaths,
+                      const std::string &outputPath, bool shared,
+                      bool profileAllocations) {
+    std::string command = std::string("gcc ") + (shared ? "-shared " : "");
+    for (const auto &objectPath : objectPaths)
+      command += objectPath + " ";
+
+    command += "-o " + outputPath + " ";
+
+    // Nothing references the profiler, its whole archive is pulled in.
+    if (profileAllocations) {
+      command += "-Wl,--whole-archive " VERTE_ALLOC_PROFILER_LIBRARY
+                 " -Wl,--no-whole-archive -pthread ";
+    }
+
+    command += VERTE_RUNTIME_LIBRARY " -lm -pthread";
+    int result = std::system(command.c_str());
+
+    if (result != 0) {
+      errs() << "Error: Linking failed: " << result << "\n";
+      return false;
+    }
+
+    return true;
+  }
+
+  bool Compiler::native(Module &module, const std::string &outputPath) {
     std::error_code errorCode;
     raw_fd_ostream dest(outputPath + ".o", errorCode,
                         sys::fs::OpenFlags::OF_None);
@@ -69,17 +444,13 @@ namespace verte::codegen {
       return false;
     }
 
-    legacy::PassManager pass;
-    auto fileType = CodeGenFileType::CGFT_ObjectFile;
-
-    if (targetMachine->addPassesToEmitFile(pass, dest, nullptr, fileType)) {
-      errs() << "targetMachine can't emit a file of this type";
+    std::string error;
+    if (!emit(module, dest, CodeGenFileType::CGFT_ObjectFile, error)) {
+      errs() << error;
       return false;
     }
 
-    pass.run(module);
     dest.flush();
-
     return true;
   }
 } // namespace verte::codegen
@@ -0,0 +1,126 @@
+/**
+ * @brief C header generation implementation.
+ * @file header.cpp
+ */
+
+#include "verte/backend/codegen/header.hpp"
+#include "verte/errors.hpp"
+
+#include <cctype>
+#include <format>
+
+namespace verte::codegen {
+  using namespace verte::types;
+
+  /**
+   * @brief Get the C spelling of a type.
+   * @param type The type to spell.
+   * @return The C type.
+   */
+  static std::string toCType(const TypeInfo &type) {
+    switch (type.dataType) {
+      case TypeInfo::DataType::INTEGER:
+        return "int32_t";
+      case TypeInfo::DataType::FLOAT:
+        return "float";
+      case TypeInfo::DataType::DOUBLE:
+        return "double";
+      case TypeInfo::DataType::STRING:
+        return "const char *";
+      case TypeInfo::DataType::BOOL:
+        return "bool";
+      case TypeInfo::DataType::VOID:
+        return "void";
+      case TypeInfo::DataType::CHANNEL:
+      case TypeInfo::DataType::UNKNOWN:
+        break;
+    }
+
+    throw errors::CodegenError("Cannot export type to C: " + type.name);
+  }
+
+  /**
+   * @brief Declare a C name of a given type, i.e `int32_t x`/`const char *x`.
+   * @param type The type of the name.
+   * @param name The declared name.
+   * @param constant Whether the name is constant, i.e `const int32_t x`. For
+   * a pointer, the pointer is the constant: `const char *const x`.
+   * @return The declaration.
+   */
+  static std::string declare(const TypeInfo &type, const std::string &name,
+                             bool constant = false) {
+    std::string ctype = toCType(type);
+    if (ctype.ends_with('*'))
+      return ctype + (constant ? "const " : "") + name;
+
+    return (constant ? "const " : "") + ctype + ' ' + name;
+  }
+
+  std::string generateDeclarations(const nodes::ProgramNode &part) {
+    std::string declarations;
+
+    for (const auto &stmt : part.getBody()) {
+      if (auto func = dynamic_cast<const nodes::FuncDeclNode *>(stmt.get())) {
+        const auto &proto = *func->getProto();
+        if (!findAttribute(proto.getAttributes(), "export"))
+          continue;
+
+        std::string params;
+        for (const auto &param : proto.getParams()) {
+          params += params.empty() ? "" : ", ";
+          params += declare(param.type, param.name);
+        }
+
+        declarations += std::format(
+            "{}({});\n", declare(proto.getRetType(), proto.getName()),
+            params.empty() ? "void" : params);
+      }
+
+      else if (auto var = dynamic_cast<const nodes::VarDeclNode *>(stmt.get())) {
+        if (!findAttribute(var->getAttributes(), "export"))
+          continue;
+
+        const char *storage =
+            findAttribute(var->getAttributes(), "thread_local") ? "__thread "
+                                                                : "";
+        declarations += std::format(
+            "extern {}{};\n", storage,
+            declare(var->getType(), var->getName(), var->isConstant()));
+      }
+    }
+
+    return declarations;
+  }
+
+  std::string wrapHeader(std::string_view declarations, std::string_view name) {
+    // Build the include guard from the library name.
+    std::string guard;
+    for (char c : name)
+      guard += std::isalnum(static_cast<unsigned char>(c))
+                   ? static_cast<char>(std::toupper(c))
+                   : '_';
+    guard += "_H";
+
+    return std::format("/* Generated by vertec, do not edit. */\n"
+                       "#ifndef {0}\n#define {0}\n\n"
+                       "#include <stdbool.h>\n"
+                       "#include <stdint.h>\n\n"
+                       "#ifdef __cplusplus\n"
+                       "extern \"C\" {{\n"
+                       "#endif\n\n"
+                       "{1}"
+                       "\n#ifdef __cplusplus\n}}\n#endif\n\n"
+                       "#endif /* {0} */\n",
+                       guard, declarations);
+  }
+
+  std::string
+  generateHeader(const std::vector<const nodes::ProgramNode *> &parts,
+                 std::string_view name) {
+    std::string declarations;
+    for (const auto *part : parts)
+      declarations += generateDeclarations(*part);
+
+    return wrapHeader(declarations, name);
+  }
+} // namespace verte::codegen
@@ -0,0 +1,455 @@
+/**
+ * @brief Throughput estimator implementation.
+ * @file mca.cpp
+ */
+
+#include "verte/backend/codegen/mca.hpp"
+#include "verte/backend/codegen/compiler.hpp"
+
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstrAnalysis.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/MCA/Context.h"
+#include "llvm/MCA/CustomBehaviour.h"
+#include "llvm/MCA/HWEventListener.h"
+#include "llvm/MCA/InstrBuilder.h"
+#include "llvm/MCA/Pipeline.h"
+#include "llvm/MCA/SourceMgr.h"
+#include "llvm/MCA/Support.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+namespace verte::codegen {
+  /**
+   * @struct RecordedFunction
+   * @brief The machine code of a function, as parsed from the assembly.
+   */
+  struct RecordedFunction {
+    std::string name;                  /**< The symbol of the function. */
+    std::vector<MCInst> instructions; /**< Its instructions, in order. */
+    std::unordered_map<const MCSymbol *, size_t>
+        labels; /**< The instruction each local label points at. */
+  };
+
+  /**
+   * @class InstructionRecorder
+   * @brief A streamer keeping the instructions of each function, instead of
+   * encoding them.
+   *
+   * Every non-temporary label starts a function, the temporary ones are the
+   * targets of its branches.
+   */
+  class InstructionRecorder : public MCStreamer {
+  public:
+    explicit InstructionRecorder(MCContext &context) : MCStreamer(context) {}
+
+    void emitLabel(MCSymbol *symbol, SMLoc loc) override {
+      MCStreamer::emitLabel(symbol, loc);
+
+      if (!symbol->isTemporary())
+        functions.push_back({symbol->getName().str(), {}, {}});
+      else if (!functions.empty())
+        functions.back().labels[symbol] = functions.back().instructions.size();
+    }
+
+    void emitInstruction(const MCInst &instruction,
+                         const MCSubtargetInfo &) override {
+      if (!functions.empty())
+        functions.back().instructions.push_back(instruction);
+    }
+
+    bool emitSymbolAttribute(MCSymbol *, MCSymbolAttr) override {
+      return true;
+    }
+
+    void emitCommonSymbol(MCSymbol *, uint64_t, Align) override {}
+
+    void emitZerofill(MCSection *, MCSymbol *, uint64_t, Align,
+                      SMLoc) override {}
+
+    std::vector<RecordedFunction> functions; /**< The functions, in order. */
+  };
+
+  /**
+   * @class PressureListener
+   * @brief Adds up what the simulated pipeline reports, cycle by cycle.
+   */
+  class PressureListener : public mca::HWEventListener {
+  public:
+    /**
+     * @brief Construct a new PressureListener.
+     * @param model The scheduling model of the simulated CPU.
+     */
+    explicit PressureListener(const MCSchedModel &model)
+        : model(model), masks(model.getNumProcResourceKinds()),
+          firstUnit(model.getNumProcResourceKinds()),
+          bottlenecks(model.getNumProcResourceKinds()) {
+      mca::computeProcResourceMasks(model, masks);
+
+      // The units of the resources are numbered one after the other, groups
+      // are only ever used through their units.
+      for (unsigned id = 1; id < model.getNumProcResourceKinds(); ++id) {
+        const MCProcResourceDesc &resource = *model.getProcResource(id);
+        resources[mca::getResourceStateIndex(masks[id])] = id;
+        firstUnit[id] = units.size();
+
+        if (resource.SubUnitsIdxBegin)
+          continue;
+
+        for (unsigned unit = 0; unit < resource.NumUnits; ++unit)
+          units.push_back(resource.NumUnits == 1
+                              ? std::string(resource.Name)
+                              : std::format("{}.{}", resource.Name, unit));
+      }
+
+      usage.resize(units.size());
+    }
+
+    void onEvent(const mca::HWInstructionEvent &event) override {
+      if (event.Type != mca::HWInstructionEvent::Issued)
+        return;
+
+      const auto &issued =
+          static_cast<const mca::HWInstructionIssuedEvent &>(event);
+
+      // The resources are given by id there, their units by mask.
+      for (const auto &[resource, cycles] : issued.UsedResources)
+        usage[firstUnit[resource.first] + std::countr_zero(resource.second)] +=
+            static_cast<double>(cycles);
+    }
+
+    void onEvent(const mca::HWPressureEvent &event) override {
+      if (event.Reason != mca::HWPressureEvent::RESOURCES) {
+        waitingOnDependencies = true;
+        return;
+      }
+
+      // A group is busy when all of its units are.
+      for (uint64_t mask = event.ResourceMask; mask; mask &= mask - 1) {
+        const unsigned id =
+            resources.at(mca::getResourceStateIndex(mask & -mask));
+        const MCProcResourceDesc &resource = *model.getProcResource(id);
+
+        if (!resource.SubUnitsIdxBegin) {
+          busy.insert(id);
+          continue;
+        }
+
+        for (unsigned unit = 0; unit < resource.NumUnits; ++unit)
+          busy.insert(resource.SubUnitsIdxBegin[unit]);
+      }
+    }
+
+    void onCycleEnd() override {
+      for (unsigned id : busy)
+        bottlenecks[id]++;
+
+      dependencyCycles += waitingOnDependencies;
+      busy.clear();
+      waitingOnDependencies = false;
+    }
+
+    /**
+     * @brief Fill the pressure and the bottlenecks of an estimate.
+     * @param estimate The estimate of the region.
+     * @param cycles The cycles the whole simulation took.
+     * @param iterations The iterations simulated.
+     */
+    void summarize(ThroughputEstimate &estimate, unsigned cycles,
+                   unsigned iterations) const {
+      for (size_t unit = 0; unit < units.size(); ++unit)
+        if (usage[unit] >= 0.005 * iterations)
+          estimate.pressure.emplace_back(units[unit],
+                                         usage[unit] / iterations);
+
+      for (unsigned id = 1; id < bottlenecks.size(); ++id)
+        if (bottlenecks[id])
+          estimate.bottlenecks.emplace_back(model.getProcResource(id)->Name,
+                                            double(bottlenecks[id]) / cycles);
+
+      std::stable_sort(
+          estimate.bottlenecks.begin(), estimate.bottlenecks.end(),
+          [](const auto &a, const auto &b) { return a.second > b.second; });
+
+      estimate.dependencyShare = double(dependencyCycles) / cycles;
+    }
+
+  private:
+    const MCSchedModel &model;     /**< The simulated CPU. */
+    SmallVector<uint64_t> masks;   /**< The mask of each resource. */
+    std::vector<unsigned> firstUnit; /**< The first unit of each resource. */
+    std::map<unsigned, unsigned>
+        resources; /**< The resource of each mask, by highest bit. */
+
+    std::vector<std::string> units; /**< The name of each unit. */
+    std::vector<double> usage;      /**< The cycles each unit was used. */
+
+    std::vector<unsigned> bottlenecks; /**< Cycles each resource held up
+                                          ready instructions. */
+    std::set<unsigned> busy; /**< The resources busy in this cycle. */
+    unsigned dependencyCycles = 0; /**< Cycles waiting on dependencies. */
+    bool waitingOnDependencies = false; /**< Whether this cycle waited on
+                                           dependencies. */
+  };
+
+  /**
+   * @struct Region
+   * @brief A run of instructions of a function.
+   */
+  struct Region {
+    const RecordedFunction *function; /**< The function. */
+    std::string label;                /**< The label it starts at. */
+    size_t begin;                     /**< Its first instruction. */
+    size_t end;                       /**< Past its last instruction. */
+  };
+
+  /**
+   * @brief Find the innermost loops of a function.
+   * @param function The function.
+   * @param info The descriptions of the instructions.
+   * @return The loops containing no other loop, in order.
+   */
+  static std::vector<Region> findInnermostLoops(const RecordedFunction &function,
+                                                const MCInstrInfo &info) {
+    // A loop goes from a label to the last branch back to it.
+    std::map<size_t, Region> loops;
+    for (size_t i = 0; i < function.instructions.size(); ++i) {
+      const MCInst &instruction = function.instructions[i];
+      if (!info.get(instruction.getOpcode()).isBranch())
+        continue;
+
+      for (const MCOperand &operand : instruction) {
+        if (!operand.isExpr())
+          continue;
+
+        const auto *target = dyn_cast<MCSymbolRefExpr>(operand.getExpr());
+        if (!target)
+          continue;
+
+        const auto label = function.labels.find(&target->getSymbol());
+        if (label == function.labels.end() || label->second > i)
+          continue;
+
+        loops[label->second] = {&function,
+                                target->getSymbol().getName().str(),
+                                label->second, i + 1};
+      }
+    }
+
+    std::vector<Region> innermost;
+    for (const auto &[begin, loop] : loops) {
+      const bool nested = std::any_of(
+          loops.begin(), loops.end(), [&loop = loop](const auto &other) {
+            return other.second.begin > loop.begin &&
+                   other.second.end <= loop.end;
+          });
+
+      if (!nested)
+        innermost.push_back(loop);
+    }
+
+    return innermost;
+  }
+
+  ThroughputEstimator::ThroughputEstimator(std::string cpu,
+                                           unsigned iterations)
+      : cpu(std::move(cpu)), iterations(iterations) {
+    initializeTargets();
+  }
+
+  bool ThroughputEstimator::estimate(std::string_view assembly,
+                                     const std::string &function,
+                                     std::vector<ThroughputEstimate> &estimates,
+                                     std::string &error) const {
+    const std::string name = resolveCpu(cpu, error);
+    if (name.empty())
+      return false;
+
+    const std::string triple = sys::getDefaultTargetTriple();
+    const Target *target = TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+      return false;
+
+    MCTargetOptions options;
+    std::unique_ptr<MCRegisterInfo> registers(target->createMCRegInfo(triple));
+    std::unique_ptr<MCAsmInfo> asmInfo(
+        target->createMCAsmInfo(*registers, triple, options));
+    std::unique_ptr<MCSubtargetInfo> subtarget(
+        target->createMCSubtargetInfo(triple, name, ""));
+    std::unique_ptr<MCInstrInfo> instrInfo(target->createMCInstrInfo());
+    std::unique_ptr<MCInstrAnalysis> analysis(
+        target->createMCInstrAnalysis(instrInfo.get()));
+
+    const MCSchedModel &model = subtarget->getSchedModel();
+    if (!model.hasInstrSchedModel()) {
+      error = std::format("No scheduling model for the CPU {}, pick one "
+                          "with -mcpu",
+                          name);
+      return false;
+    }
+
+    // Parse the assembly back into instructions, as the assembler would.
+    std::string diagnostics;
+    SourceMgr sources;
+    sources.AddNewSourceBuffer(
+        MemoryBuffer::getMemBuffer(assembly, "assembly", false), SMLoc());
+    sources.setDiagHandler(
+        [](const SMDiagnostic &diagnostic, void *context) {
+          raw_string_ostream out(*static_cast<std::string *>(context));
+          diagnostic.print(nullptr, out, false);
+        },
+        &diagnostics);
+
+    MCContext context(Triple(triple), asmInfo.get(), registers.get(),
+                      subtarget.get(), &sources, &options);
+    std::unique_ptr<MCObjectFileInfo> objectInfo(
+        target->createMCObjectFileInfo(context, false));
+    context.setObjectFileInfo(objectInfo.get());
+
+    InstructionRecorder recorder(context);
+    std::unique_ptr<MCAsmParser> parser(
+        createMCAsmParser(sources, context, recorder, *asmInfo));
+    std::unique_ptr<MCTargetAsmParser> targetParser(
+        target->createMCAsmParser(*subtarget, *parser, *instrInfo, options));
+
+    parser->setTargetParser(*targetParser);
+    if (parser->Run(false) || !diagnostics.empty()) {
+      error = "Invalid assembly: " + diagnostics;
+      return false;
+    }
+
+    std::vector<Region> regions;
+    for (const auto &recorded : recorder.functions) {
+      if (recorded.instructions.empty())
+        continue;
+
+      if (function.empty()) {
+        auto loops = findInnermostLoops(recorded, *instrInfo);
+        regions.insert(regions.end(), loops.begin(), loops.end());
+      } else if (recorded.name == function) {
+        regions.push_back(
+            {&recorded, "", 0, recorded.instructions.size()});
+      }
+    }
+
+    if (!function.empty() && regions.empty()) {
+      error = "No function named " + function + " in the program";
+      return false;
+    }
+
+    for (const Region &region : regions) {
+      mca::InstrumentManager instruments(*subtarget, *instrInfo);
+      mca::InstrBuilder builder(*subtarget, *instrInfo, *registers,
+                                analysis.get(), instruments);
+
+      std::vector<std::unique_ptr<mca::Instruction>> lowered;
+      for (size_t i = region.begin; i < region.end; ++i) {
+        auto instruction = builder.createInstruction(
+            region.function->instructions[i], SmallVector<mca::Instrument *>());
+
+        if (!instruction) {
+          error = std::format("Cannot model an instruction of {}: {}",
+                              region.function->name,
+                              toString(instruction.takeError()));
+          return false;
+        }
+
+        lowered.push_back(std::move(*instruction));
+      }
+
+      // The default widths and buffer sizes are those of the model.
+      mca::CircularSourceMgr source(lowered, iterations);
+      mca::CustomBehaviour behaviour(*subtarget, source, *instrInfo);
+      mca::Context simulation(*registers, *subtarget);
+      mca::PipelineOptions pipelineOptions(0, 0, 0, 0, 0, 0, true, true);
+
+      auto pipeline =
+          model.isOutOfOrder()
+              ? simulation.createDefaultPipeline(pipelineOptions, source,
+                                                 behaviour)
+              : simulation.createInOrderPipeline(pipelineOptions, source,
+                                                 behaviour);
+
+      PressureListener listener(model);
+      pipeline->addEventListener(&listener);
+
+      auto cycles = pipeline->run();
+      if (!cycles) {
+        error = toString(cycles.takeError());
+        return false;
+      }
+
+      ThroughputEstimate estimate;
+      estimate.function = region.function->name;
+      estimate.region = region.label;
+      estimate.instructions = lowered.size();
+      estimate.cycles = double(*cycles) / iterations;
+      estimate.ipc = double(lowered.size()) * iterations / *cycles;
+      listener.summarize(estimate, *cycles, iterations);
+      estimates.push_back(std::move(estimate));
+    }
+
+    return true;
+  }
+
+  std::string ThroughputEstimator::report(
+      const std::vector<ThroughputEstimate> &estimates) const {
+    std::string error;
+    std::string name = resolveCpu(cpu, error);
+    std::string out = std::format("Throughput on {}, {} iterations per "
+                                  "region\n",
+                                  name.empty() ? cpu : name, iterations);
+
+    if (estimates.empty())
+      out += "\nNo loops to estimate, name a function with "
+             "--mca-report=<function>.\n";
+
+    for (const auto &estimate : estimates) {
+      out += std::format("\n{}, {}, {} instructions\n", estimate.function,
+                         estimate.region.empty()
+                             ? "whole function"
+                             : "loop at " + estimate.region,
+                         estimate.instructions);
+
+      out += std::format("  {:<28} {:>8.2f}\n", "Cycles per iteration",
+                         estimate.cycles);
+      out += std::format("  {:<28} {:>8.2f}\n", "Instructions per cycle",
+                         estimate.ipc);
+      out += std::format("  {:<28} {:>7.1f}%\n", "Waiting on dependencies",
+                         estimate.dependencyShare * 100);
+
+      out += "  Resource pressure per iteration:\n";
+      for (const auto &[unit, cycles] : estimate.pressure)
+        out += std::format("    {:<26} {:>8.2f}\n", unit, cycles);
+
+      if (estimate.bottlenecks.empty()) {
+        out += "  No resource held up ready instructions.\n";
+        continue;
+      }
+
+      out += "  Bottlenecks, share of the cycles:\n";
+      for (const auto &[resource, share] : estimate.bottlenecks)
+        out += std::format("    {:<26} {:>7.1f}%\n", resource, share * 100);
+    }
+
+    return out;
+  }
+} // namespace verte::codegen
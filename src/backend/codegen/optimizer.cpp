@@ -0,0 +1,80 @@
+/**
+ * @brief Optimizer implementation.
+ * @file optimizer.cpp
+ */
+
+#include "verte/backend/codegen/optimizer.hpp"
+
+#include "llvm/Pass.h"
+#include "llvm/Passes/OptimizationLevel.h"
+
+namespace verte::codegen {
+  /**
+   * @brief Get the LLVM optimization level of a level.
+   * @param level The level, 1 to 3.
+   * @return The LLVM optimization level.
+   */
+  static llvm::OptimizationLevel toLlvm(unsigned level) {
+    switch (level) {
+      case 1:
+        return llvm::OptimizationLevel::O1;
+
+      case 2:
+        return llvm::OptimizationLevel::O2;
+
+      default:
+        return llvm::OptimizationLevel::O3;
+    }
+  }
+
+  Optimizer::Optimizer(unsigned level) : level(level) {
+    if (level == 0)
+      return;
+
+    builder = std::make_unique<llvm::PassBuilder>();
+    builder->registerModuleAnalyses(modules);
+    builder->registerCGSCCAnalyses(sccs);
+    builder->registerFunctionAnalyses(functions);
+    builder->registerLoopAnalyses(loops);
+    builder->crossRegisterProxies(loops, functions, sccs, modules);
+
+    passes = builder->buildFunctionSimplificationPipeline(
+        toLlvm(level), llvm::ThinOrFullLTOPhase::None);
+
+    // -O1 stays function-local, for the latency of the pipelined and
+    // streaming drivers.
+    if (level >= 2)
+      modulePasses = builder->buildPerModuleDefaultPipeline(toLlvm(level));
+  }
+
+  void Optimizer::run(llvm::Function &function) {
+    if (level == 0 || function.isDeclaration())
+      return;
+
+    passes.run(function, functions);
+
+    // The function is done with, its analyses would only take memory.
+    functions.clear(function, function.getName());
+  }
+
+  void Optimizer::finish(llvm::Module &module) {
+    if (level < 2)
+      return;
+
+    modulePasses.run(module, modules);
+
+    // The next module may be allocated where this one was, no result may
+    // outlive it.
+    loops.clear();
+    functions.clear();
+    sccs.clear();
+    modules.clear();
+  }
+
+  void Optimizer::run(llvm::Module &module) {
+    for (auto &function : module)
+      run(function);
+
+    finish(module);
+  }
+} // namespace verte::codegen
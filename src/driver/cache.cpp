@@ -0,0 +1,321 @@
+/**
+ * @brief Compilation cache implementation.
+ * @file cache.cpp
+ */
+
+#include "verte/driver/cache.hpp"
+#include "verte/driver/remote.hpp"
+#include "verte/errors.hpp"
+#include "verte/version.hpp"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/SHA256.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include <unistd.h>
+
+namespace verte::cache {
+  /**
+   * @brief The largest body accepted, guards against garbage sizes.
+   */
+  static constexpr size_t MAX_BODY = 256u << 20;
+
+  /**
+   * @struct Message
+   * @brief A HTTP request or response.
+   */
+  struct Message {
+    std::string startLine; /**< The request or status line. */
+    std::unordered_map<std::string, std::string>
+        headers;      /**< The headers, names in lowercase. */
+    std::string body; /**< The body. */
+  };
+
+  /**
+   * @brief Read a HTTP message whose body size is given by `Content-Length`.
+   * @param socket The connection.
+   * @return The message, or nothing if the peer closed the connection first.
+   */
+  static std::optional<Message> readMessage(const utils::Socket &socket) {
+    std::string data;
+    size_t end;
+    char buffer[4096];
+
+    // Read up to the end of the headers.
+    while ((end = data.find("\r\n\r\n")) == std::string::npos) {
+      if (data.size() > 64 * 1024)
+        throw errors::NetworkError("HTTP headers too large.");
+
+      size_t count = socket.receive(buffer, sizeof(buffer));
+      if (count == 0)
+        return std::nullopt;
+
+      data.append(buffer, count);
+    }
+
+    Message message;
+    std::istringstream lines(data.substr(0, end));
+    std::getline(lines, message.startLine);
+    if (message.startLine.ends_with('\r'))
+      message.startLine.pop_back();
+
+    for (std::string line; std::getline(lines, line);) {
+      size_t colon = line.find(':');
+      if (colon == std::string::npos)
+        continue;
+
+      std::string name = line.substr(0, colon);
+      std::transform(name.begin(), name.end(), name.begin(),
+                     [](unsigned char c) { return std::tolower(c); });
+
+      std::string value = line.substr(colon + 1);
+      value.erase(0, value.find_first_not_of(' '));
+      value.erase(value.find_last_not_of("\r ") + 1);
+      message.headers[name] = value;
+    }
+
+    size_t length = 0;
+    if (auto it = message.headers.find("content-length");
+        it != message.headers.end()) {
+      const auto &value = it->second;
+      auto [ptr, error] =
+          std::from_chars(value.data(), value.data() + value.size(), length);
+      if (error != std::errc() || length > MAX_BODY)
+        throw errors::NetworkError("Invalid HTTP content length.");
+    }
+
+    // The body may have come with the headers already.
+    message.body = data.substr(end + 4);
+    if (message.body.size() > length)
+      throw errors::NetworkError("HTTP body longer than announced.");
+
+    auto rest = socket.receiveExact(length - message.body.size());
+    if (!rest)
+      throw errors::NetworkError("Connection closed inside a HTTP body.");
+
+    message.body += *rest;
+    return message;
+  }
+
+  std::string computeKey(std::string_view source, const Options &options) {
+    // The job encoding already covers the options and the source.
+    const std::string input =
+        std::format("verte-cache-v1\n{}\n{}\n", VERTE_VERSION,
+                    llvm::sys::getDefaultTargetTriple()) +
+        remote::encodeJob(source, options);
+
+    const auto digest = llvm::SHA256::hash(llvm::arrayRefFromStringRef(input));
+    return llvm::toHex(digest, true);
+  }
+
+  bool isKey(std::string_view key) noexcept {
+    return key.size() == 64 && std::all_of(key.begin(), key.end(), [](char c) {
+             return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+           });
+  }
+
+  Client::Client(utils::Endpoint endpoint, std::string prefix)
+      : endpoint(std::move(endpoint)), prefix(std::move(prefix)),
+        logger("cache") {}
+
+  std::optional<Client> Client::fromUrl(std::string_view url) {
+    constexpr std::string_view scheme = "http://";
+    if (!url.starts_with(scheme))
+      return std::nullopt;
+
+    url.remove_prefix(scheme.size());
+    const size_t slash = url.find('/');
+    std::string_view authority = url.substr(0, slash);
+    std::string path = slash == std::string_view::npos
+                           ? "/v1/cache"
+                           : std::string(url.substr(slash));
+
+    while (path.size() > 1 && path.ends_with('/'))
+      path.pop_back();
+
+    // The port defaults to 80, as any HTTP URL.
+    auto endpoint = authority.find(':') == std::string_view::npos
+                        ? utils::Endpoint{std::string(authority), 80}
+                        : utils::Endpoint::parse(authority);
+
+    if (!endpoint || endpoint->host.empty())
+      return std::nullopt;
+
+    return Client(std::move(*endpoint), std::move(path));
+  }
+
+  std::optional<Result> Client::get(const std::string &key) const {
+    try {
+      auto [status, body] = request("GET", key);
+      if (status == 200) {
+        logger.info("Cache hit: {}", key);
+        return remote::decodeResult(body);
+      }
+
+      if (status != 404)
+        logger.warn("Unexpected cache answer {} for {}", status, key);
+    }
+
+    catch (const errors::VerteError &e) {
+      logger.warn("Cache lookup failed: {}", e.what());
+    }
+
+    logger.info("Cache miss: {}", key);
+    return std::nullopt;
+  }
+
+  bool Client::put(const std::string &key, const Result &result) const {
+    try {
+      auto [status, body] = request("PUT", key, remote::encodeResult(result));
+      if (status == 200 || status == 201 || status == 204)
+        return true;
+
+      logger.warn("Unexpected cache answer {} for {}", status, key);
+    }
+
+    catch (const errors::VerteError &e) {
+      logger.warn("Cache upload failed: {}", e.what());
+    }
+
+    return false;
+  }
+
+  std::pair<int, std::string> Client::request(std::string_view method,
+                                              const std::string &key,
+                                              std::string_view body) const {
+    auto connection = utils::Socket::connect(endpoint, timeout);
+    connection.setTimeout(timeout);
+
+    connection.sendAll(std::format("{} {}/{} HTTP/1.1\r\n"
+                                   "Host: {}\r\n"
+                                   "Content-Length: {}\r\n"
+                                   "Connection: close\r\n\r\n",
+                                   method, prefix, key, endpoint.toString(),
+                                   body.size()));
+    connection.sendAll(body);
+
+    auto response = readMessage(connection);
+    if (!response)
+      throw errors::NetworkError("Connection closed before the answer.");
+
+    // Status line, i.e `HTTP/1.1 200 OK`.
+    int status = 0;
+    const std::string &line = response->startLine;
+    const size_t space = line.find(' ');
+    if (space != std::string::npos)
+      std::from_chars(line.data() + space + 1, line.data() + line.size(),
+                      status);
+
+    return {status, std::move(response->body)};
+  }
+
+  Server::Server(const utils::Endpoint &endpoint,
+                 std::filesystem::path directory, std::string prefix)
+      : server(endpoint), directory(std::move(directory)),
+        prefix(std::move(prefix)), logger("cache-server") {
+    std::filesystem::create_directories(this->directory);
+  }
+
+  Server::~Server() { stop(); }
+
+  void Server::run() {
+    logger.info("Serving {} on port {}", directory.string(),
+                server.getPort());
+    server.run([this](utils::Socket &connection) { serve(connection); });
+  }
+
+  void Server::stop() { server.stop(); }
+
+  std::filesystem::path Server::entryPath(std::string_view key) const {
+    // Spread the entries over 256 directories.
+    return directory / key.substr(0, 2) / key;
+  }
+
+  void Server::serve(const utils::Socket &connection) {
+    auto respond = [&](int status, std::string_view reason,
+                       std::string_view body = {}, bool withBody = true) {
+      connection.sendAll(std::format("HTTP/1.1 {} {}\r\n"
+                                     "Content-Type: application/octet-stream\r\n"
+                                     "Content-Length: {}\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     status, reason, body.size()));
+      if (withBody)
+        connection.sendAll(body);
+    };
+
+    try {
+      connection.setTimeout(std::chrono::seconds(30));
+      auto request = readMessage(connection);
+      if (!request)
+        return;
+
+      // Request line, i.e `GET /v1/cache/<key> HTTP/1.1`.
+      std::istringstream line(request->startLine);
+      std::string method, target;
+      line >> method >> target;
+
+      const std::string base = prefix + "/";
+      if (!target.starts_with(base) || !isKey(target.substr(base.size())))
+        return respond(404, "Not Found");
+
+      const std::string key = target.substr(base.size());
+      const auto path = entryPath(key);
+
+      if (method == "GET" || method == "HEAD") {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+          return respond(404, "Not Found");
+
+        std::string entry((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+
+        logger.debug("{} {}: hit", method, key);
+        return respond(200, "OK", entry, method == "GET");
+      }
+
+      if (method == "PUT") {
+        std::filesystem::create_directories(path.parent_path());
+
+        // Write aside then rename, readers never see partial entries.
+        const uint64_t upload = uploads++;
+
+        auto temporary = path;
+        temporary += std::format(".{}.{}.tmp", getpid(), upload);
+
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(request->body.data(),
+                   static_cast<std::streamsize>(request->body.size()));
+        file.close();
+
+        // A short write must not be published, every later hit would serve
+        // the truncated entry.
+        std::error_code error;
+        if (file)
+          std::filesystem::rename(temporary, path, error);
+
+        if (!file || error) {
+          std::filesystem::remove(temporary, error);
+          logger.warn("PUT {}: failed to store the entry", key);
+          return respond(500, "Internal Server Error");
+        }
+
+        logger.debug("PUT {}: {} bytes", key, request->body.size());
+        return respond(201, "Created");
+      }
+
+      respond(405, "Method Not Allowed");
+    }
+
+    catch (const std::exception &e) {
+      logger.warn("Dropping connection: {}", e.what());
+    }
+  }
+} // namespace verte::cache
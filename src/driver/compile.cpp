@@ -0,0 +1,208 @@
+/**
+ * @brief Library entry point implementation.
+ * @file compile.cpp
+ */
+
+#include "verte/driver/compile.hpp"
+#include "verte/backend/codegen/header.hpp"
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/backend/codegen/optimizer.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Verifier.h"
+
+namespace verte {
+  /**
+   * @brief Run a step of the compilation, reporting its errors.
+   * @param result Receives the diagnostics.
+   * @param step The step to run.
+   * @return The module returned by the step, or null if it failed.
+   */
+  template <typename Step>
+  static codegen::ModulePtr report(Result &result, Step &&step) {
+    // Report an error diagnostic.
+    auto fail = [&](const std::string &message, uint32_t line = 0,
+                    uint32_t column = 0) -> codegen::ModulePtr {
+      result.diagnostics.push_back(
+          {Diagnostic::Severity::ERROR, message, line, column});
+
+      return nullptr;
+    };
+
+    try {
+      return step();
+    }
+
+    // Parser errors are lexical errors, both carry a location.
+    catch (const errors::LexicalError &e) {
+      return fail(e.what(), e.getLine(), e.getColumn());
+    }
+
+    catch (const errors::VerteError &e) {
+      return fail(e.what());
+    }
+
+    // Malformed programs may still trip the standard library, i.e `stoi`.
+    catch (const std::exception &e) {
+      return fail(e.what());
+    }
+  }
+
+  /**
+   * @brief Generate the module of parsed programs.
+   * @param parts The programs, generated as one in the given order.
+   * @param context The LLVM context owning the module.
+   * @param options The options of the compilation.
+   * @param result Receives the diagnostics, and the header if any.
+   * @param declarations Prototypes declared ahead of the programs.
+   * @param source The source of the programs, to annotate the assembly with.
+   * Empty if they were not parsed from one source.
+   * @return The module, or null if the compilation failed.
+   */
+  static codegen::ModulePtr
+  generateModule(const std::vector<const nodes::ProgramNode *> &parts,
+                 llvm::LLVMContext &context, const Options &options,
+                 Result &result,
+                 const std::vector<const nodes::ProtoNode *> &declarations,
+                 std::string_view source) {
+    return report(result, [&]() -> codegen::ModulePtr {
+      codegen::Codegen codegen(
+          context, std::make_unique<llvm::Module>(options.moduleName, context),
+          options.codegen);
+
+      if (options.annotate && !source.empty())
+        codegen.attachLines(source, options.moduleName + ".vt");
+
+      for (const auto *proto : declarations)
+        proto->accept(codegen);
+
+      codegen.generate(parts);
+      auto module = codegen.takeModule();
+
+      std::string error;
+      llvm::raw_string_ostream errorStream(error);
+      if (options.verify && llvm::verifyModule(*module, &errorStream)) {
+        result.diagnostics.push_back(
+            {Diagnostic::Severity::ERROR,
+             "Invalid module generated: " + errorStream.str(), 0, 0});
+
+        return nullptr;
+      }
+
+      if (options.codegen.shared)
+        result.header = codegen::generateHeader(parts, options.moduleName);
+
+      return module;
+    });
+  }
+
+  codegen::ModulePtr
+  generate(std::string_view source, llvm::LLVMContext &context,
+           const Options &options, Result &result,
+           const std::vector<const nodes::ProtoNode *> &declarations) {
+    utils::logging::ScopedLevel level(options.logLevel);
+
+    std::unique_ptr<nodes::ProgramNode> ast;
+    report(result, [&] {
+      lexer::Lexer lexer(source);
+      nodes::Parser parser(lexer.allTokens());
+      ast = parser.parse();
+      return nullptr;
+    });
+
+    if (!ast)
+      return nullptr;
+
+    return generateModule({ast.get()}, context, options, result, declarations,
+                          source);
+  }
+
+  codegen::ModulePtr
+  generate(const std::vector<const nodes::ProgramNode *> &parts,
+           llvm::LLVMContext &context, const Options &options, Result &result,
+           const std::vector<const nodes::ProtoNode *> &declarations) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    return generateModule(parts, context, options, result, declarations, {});
+  }
+
+  void optimize(llvm::Module &module, const Options &options) {
+    codegen::Optimizer optimizer(options.optLevel);
+    optimizer.run(module);
+  }
+
+  void emit(llvm::Module &module, const Options &options, Result &result) {
+    switch (options.output) {
+      case OutputKind::IR: {
+        llvm::raw_string_ostream out(result.output);
+        module.print(out, nullptr);
+        break;
+      }
+
+      case OutputKind::BITCODE: {
+        llvm::raw_string_ostream out(result.output);
+        llvm::WriteBitcodeToFile(module, out);
+        break;
+      }
+
+      case OutputKind::OBJECT: {
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream out(buffer);
+
+        std::string error;
+        codegen::Compiler compiler(options.optLevel, options.cpu);
+        if (!compiler.emit(module, out, llvm::CGFT_ObjectFile, error)) {
+          result.diagnostics.push_back(
+              {Diagnostic::Severity::ERROR, error, 0, 0});
+
+          return;
+        }
+
+        result.output.assign(buffer.begin(), buffer.end());
+        break;
+      }
+
+      case OutputKind::ASSEMBLY: {
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream out(buffer);
+
+        std::string error;
+        codegen::Compiler compiler(options.optLevel, options.cpu);
+        const bool emitted =
+            options.annotate
+                ? compiler.annotate(module, result.output, error)
+                : compiler.emit(module, out, llvm::CGFT_AssemblyFile, error);
+
+        if (!emitted) {
+          result.output.clear();
+          result.diagnostics.push_back(
+              {Diagnostic::Severity::ERROR, error, 0, 0});
+
+          return;
+        }
+
+        if (!options.annotate)
+          result.output.assign(buffer.begin(), buffer.end());
+
+        break;
+      }
+    }
+  }
+
+  Result compile(std::string_view source, const Options &options) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    Result result;
+
+    llvm::LLVMContext context;
+    auto module = generate(source, context, options, result);
+    if (module) {
+      optimize(*module, options);
+      emit(*module, options, result);
+    }
+
+    return result;
+  }
+} // namespace verte
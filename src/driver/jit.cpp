@@ -0,0 +1,183 @@
+/**
+ * @brief JIT session implementation.
+ * @file jit.cpp
+ */
+
+#include "verte/driver/jit.hpp"
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+
+#include <utility>
+
+namespace verte::jit {
+  /**
+   * @brief Get the data type an LLVM type was generated from.
+   * @param type The LLVM type.
+   * @return The data type.
+   */
+  static DataType toDataType(const llvm::Type *type) {
+    if (type->isVoidTy())
+      return DataType::VOID;
+
+    else if (type->isIntegerTy(1))
+      return DataType::BOOL;
+
+    else if (type->isIntegerTy(32))
+      return DataType::INTEGER;
+
+    else if (type->isFloatTy())
+      return DataType::FLOAT;
+
+    else if (type->isDoubleTy())
+      return DataType::DOUBLE;
+
+    else if (type->isPointerTy())
+      return DataType::STRING;
+
+    return DataType::UNKNOWN;
+  }
+
+  Session::Session(Options options) : options(std::move(options)) {
+    codegen::initializeTargets();
+
+    auto jitOrErr = llvm::orc::LLJITBuilder().create();
+    if (!jitOrErr)
+      throw errors::JitError(llvm::toString(jitOrErr.takeError()));
+
+    jit = std::move(*jitOrErr);
+
+    // Resolve the remaining externs, i.e `printf`, from the host process.
+    auto generator =
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            jit->getDataLayout().getGlobalPrefix());
+
+    if (!generator)
+      throw errors::JitError(llvm::toString(generator.takeError()));
+
+    jit->getMainJITDylib().addGenerator(std::move(*generator));
+  }
+
+  Session::~Session() = default;
+
+  void Session::define(nodes::ProtoPtr proto, void *address) {
+    const std::string &name = proto->getName();
+    if (signatures.contains(name))
+      throw errors::JitError("Function already defined: " + name);
+
+    llvm::orc::SymbolMap symbols;
+    symbols[jit->mangleAndIntern(name)] = {
+        llvm::orc::ExecutorAddr::fromPtr(address),
+        llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+
+    auto &dylib = jit->getMainJITDylib();
+    if (auto err = dylib.define(llvm::orc::absoluteSymbols(symbols)))
+      throw errors::JitError(llvm::toString(std::move(err)));
+
+    signatures[name] = signatureOf(*proto);
+    declarations.push_back(std::move(proto));
+  }
+
+  Result Session::compile(std::string_view source) {
+    Result result;
+
+    std::vector<const nodes::ProtoNode *> visible;
+    for (const auto &proto : declarations)
+      visible.push_back(proto.get());
+
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = generate(source, *context, options, result, visible);
+    if (!module)
+      return result;
+
+    // Collect the functions defined by the module, later sources may call
+    // them through their prototypes.
+    std::vector<nodes::ProtoPtr> defined;
+    for (const llvm::Function &func : *module) {
+      if (func.isDeclaration() || func.hasLocalLinkage())
+        continue;
+
+      std::vector<types::Parameter> params;
+      for (const llvm::Argument &arg : func.args()) {
+        params.emplace_back(arg.getName().str(),
+                            types::TypeInfo(toDataType(arg.getType())));
+      }
+
+      defined.push_back(std::make_unique<nodes::ProtoNode>(
+          func.getName().str(), std::move(params),
+          types::TypeInfo(toDataType(func.getReturnType()))));
+    }
+
+    // The functions are only compiled on lookup, so are their errors.
+    context->setDiagnosticHandler(
+        std::make_unique<codegen::BackendDiagnostics>(backendErrors));
+
+    module->setDataLayout(jit->getDataLayout());
+    llvm::orc::ThreadSafeModule tsm(std::move(module), std::move(context));
+
+    if (auto err = jit->addIRModule(std::move(tsm))) {
+      result.diagnostics.push_back({Diagnostic::Severity::ERROR,
+                                    llvm::toString(std::move(err)), 0, 0});
+      return result;
+    }
+
+    for (auto &proto : defined) {
+      signatures[proto->getName()] = signatureOf(*proto);
+      declarations.push_back(std::move(proto));
+    }
+
+    return result;
+  }
+
+  nodes::ProtoPtr Session::parsePrototype(std::string_view prototype) {
+    const std::string source = "fn " + std::string(prototype) + ";";
+
+    lexer::Lexer lexer(source);
+    nodes::Parser parser(lexer.allTokens());
+    auto ast = parser.parse();
+
+    const auto &body = ast->getBody();
+    auto proto = body.size() == 1
+                     ? dynamic_cast<const nodes::ProtoNode *>(body[0].get())
+                     : nullptr;
+
+    if (!proto)
+      throw errors::JitError("Invalid prototype: " + std::string(prototype));
+
+    return std::make_unique<nodes::ProtoNode>(
+        proto->getName(), proto->getParams(), proto->getRetType());
+  }
+
+  Signature Session::signatureOf(const nodes::ProtoNode &proto) {
+    Signature signature{proto.getRetType().dataType};
+    for (const auto &param : proto.getParams())
+      signature.push_back(param.type.dataType);
+
+    return signature;
+  }
+
+  void *Session::lookupAddress(std::string_view name,
+                               const Signature &signature) {
+    const std::string key(name);
+
+    auto it = signatures.find(key);
+    if (it == signatures.end())
+      throw errors::JitError("Unknown function: " + key);
+
+    if (it->second != signature)
+      throw errors::JitError("Signature does not match the function: " + key);
+
+    auto symbol = jit->lookup(key);
+    if (!symbol)
+      throw errors::JitError(llvm::toString(symbol.takeError()));
+
+    if (!backendErrors.empty())
+      throw errors::JitError(std::exchange(backendErrors, {}));
+
+    return symbol->toPtr<void *>();
+  }
+} // namespace verte::jit
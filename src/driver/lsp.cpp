@@ -0,0 +1,1000 @@
+/**
+ * @brief Language server implementation.
+ * @file lsp.cpp
+ */
+
+#include "verte/driver/lsp.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/base.hpp"
+#include "verte/version.hpp"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <istream>
+#include <ostream>
+
+namespace verte::lsp {
+  using namespace verte::visitors;
+  using lexer::Token;
+  namespace json = llvm::json;
+
+  /**
+   * @struct Occurrence
+   * @brief A name used or declared in an item.
+   */
+  struct Occurrence {
+    Location location; /**< The span of the name. */
+    int32_t symbol;    /**< The declaration in the item, -1 for globals. */
+    std::string name;  /**< The name, for the lookup among the globals. */
+    bool call;         /**< Whether the name is called. */
+  };
+
+  /**
+   * @struct Document::Item
+   * @brief A top-level item and its analysis.
+   *
+   * The analysis keeps the offsets of the text it was made on, `shift` moves
+   * them to the current text.
+   */
+  struct Document::Item {
+    uint32_t begin = 0; /**< The offset of the first token. */
+    uint32_t end = 0;   /**< The offset past the last token. */
+    int64_t shift = 0;  /**< The shift since the analysis. */
+
+    std::unique_ptr<nodes::ProgramNode> ast; /**< The syntax tree. */
+    std::optional<Diagnostic> error;         /**< The syntax error, if any. */
+    std::vector<Symbol> symbols;             /**< The declarations. */
+    std::vector<Occurrence> occurrences;     /**< The names, by offset. */
+  };
+
+  /**
+   * @class Resolver
+   * @brief Collects the declarations of an item and binds the names it uses.
+   *
+   * Locals are visible from their declaration to the end of the function,
+   * other names are left to the globals of the document.
+   */
+  class Resolver : public visitors::ASTVisitor {
+  public:
+    /**
+     * @brief Construct a new Resolver.
+     * @param symbols The declarations to fill.
+     * @param occurrences The names to fill.
+     */
+    explicit Resolver(std::vector<Symbol> &symbols,
+                      std::vector<Occurrence> &occurrences)
+        : symbols(symbols), occurrences(occurrences) {}
+
+    auto visit(const ProgramNode &node) -> RetT override {
+      for (const auto &stmt : node.getBody())
+        stmt->accept(*this);
+
+      return {};
+    }
+
+    auto visit(const LiteralNode &) -> RetT override { return {}; }
+
+    auto visit(const VarDeclNode &node) -> RetT override {
+      node.getValue()->accept(*this);
+
+      const bool constant = node.isConstant();
+      declare({constant ? Symbol::Kind::CONSTANT : Symbol::Kind::VARIABLE,
+               node.getName(),
+               std::format("{}{}: {}", constant ? "const " : "",
+                           node.getName(), node.getType().name),
+               node.getNameLocation(), node.getLocation(), !inFunction});
+      return {};
+    }
+
+    auto visit(const AssignNode &node) -> RetT override {
+      use(node.getName(), node.getNameLocation(), false);
+      node.getValue()->accept(*this);
+      return {};
+    }
+
+    auto visit(const IfNode &node) -> RetT override {
+      node.getCond()->accept(*this);
+      node.getBlock()->accept(*this);
+      return {};
+    }
+
+    auto visit(const IfElseNode &node) -> RetT override {
+      node.getIfNode()->accept(*this);
+      node.getElseBlock()->accept(*this);
+      return {};
+    }
+
+    auto visit(const VariableNode &node) -> RetT override {
+      use(node.getName(), node.getNameLocation(), false);
+      return {};
+    }
+
+    auto visit(const BinaryNode &node) -> RetT override {
+      node.getLHS()->accept(*this);
+      node.getRHS()->accept(*this);
+      return {};
+    }
+
+    auto visit(const UnaryNode &node) -> RetT override {
+      node.getOperand()->accept(*this);
+      return {};
+    }
+
+    auto visit(const ProtoNode &node) -> RetT override {
+      declareFunction(node, node.getLocation());
+      return {};
+    }
+
+    auto visit(const BlockNode &node) -> RetT override {
+      for (const auto &stmt : node.getBody())
+        stmt->accept(*this);
+
+      return {};
+    }
+
+    auto visit(const FuncDeclNode &node) -> RetT override {
+      const auto &proto = *node.getProto();
+      declareFunction(proto, node.getLocation());
+
+      enter();
+      for (const auto &param : proto.getParams()) {
+        declare({Symbol::Kind::PARAMETER, param.name,
+                 std::format("{}: {}", param.name, param.type.name),
+                 param.location, param.location, false});
+      }
+
+      node.getBody()->accept(*this);
+      leave();
+      return {};
+    }
+
+    auto visit(const CallNode &node) -> RetT override {
+      const auto &callee = *node.getCallee();
+
+      if (!types::isBuiltin(callee.getName()))
+        use(callee.getName(), callee.getNameLocation(), true);
+
+      for (const auto &arg : node.getArgs())
+        arg->accept(*this);
+
+      return {};
+    }
+
+    auto visit(const ReturnNode &node) -> RetT override {
+      node.getValue()->accept(*this);
+      return {};
+    }
+
+    auto visit(const AsmNode &node) -> RetT override {
+      for (const auto &operand : node.getOperands())
+        operand->accept(*this);
+
+      return {};
+    }
+
+    auto visit(const BenchNode &node) -> RetT override {
+      declare({Symbol::Kind::BENCH, node.getName(),
+               std::format("bench {}", node.getName()),
+               node.getNameLocation(), node.getLocation(), true});
+
+      enter();
+      node.getBody()->accept(*this);
+      leave();
+      return {};
+    }
+
+  private:
+    /**
+     * @brief Declare a function.
+     * @param proto The prototype of the function.
+     * @param extent The span of the declaration.
+     */
+    void declareFunction(const ProtoNode &proto, Location extent) {
+      std::string detail = std::format("fn {}(", proto.getName());
+      for (const auto &param : proto.getParams()) {
+        if (&param != &proto.getParams().front())
+          detail += ", ";
+
+        detail += std::format("{}: {}", param.name, param.type.name);
+      }
+
+      detail += std::format(") -> {}", proto.getRetType().name);
+      declare({Symbol::Kind::FUNCTION, proto.getName(), std::move(detail),
+               proto.getNameLocation(), extent, true});
+    }
+
+    /**
+     * @brief Declare a symbol, its name being an occurrence of itself.
+     * @param symbol The symbol.
+     */
+    void declare(Symbol symbol) {
+      const auto index = static_cast<int32_t>(symbols.size());
+      occurrences.push_back({symbol.selection, index, {}, false});
+
+      if (!symbol.global)
+        locals[symbol.name] = index;
+
+      symbols.push_back(std::move(symbol));
+    }
+
+    /**
+     * @brief Record the use of a name.
+     * @param name The name.
+     * @param location The span of the name.
+     * @param call Whether the name is called.
+     */
+    void use(const std::string &name, Location location, bool call) {
+      auto it = locals.find(name);
+      if (it != locals.end() && !call)
+        occurrences.push_back({location, it->second, {}, call});
+      else
+        occurrences.push_back({location, -1, name, call});
+    }
+
+    /**
+     * @brief Enter the body of a function.
+     */
+    void enter() {
+      inFunction = true;
+      locals.clear();
+    }
+
+    /**
+     * @brief Leave the body of a function.
+     */
+    void leave() {
+      inFunction = false;
+      locals.clear();
+    }
+
+    std::vector<Symbol> &symbols;          /**< The declarations. */
+    std::vector<Occurrence> &occurrences;  /**< The names. */
+    std::unordered_map<std::string, int32_t>
+        locals;                            /**< The visible locals. */
+    bool inFunction = false;               /**< Whether inside a function. */
+  };
+
+  /**
+   * @brief Drop the `line:column: ` prefix of an error message.
+   * @param message The message.
+   * @return The message alone.
+   */
+  static std::string stripPosition(std::string_view message) {
+    size_t index = 0;
+    for (int part = 0; part < 2; ++part) {
+      const size_t start = index;
+      while (index < message.size() && std::isdigit(message[index]))
+        index++;
+
+      if (index == start || index >= message.size() || message[index] != ':')
+        return std::string(message);
+
+      index++;
+    }
+
+    if (index < message.size() && message[index] == ' ')
+      index++;
+
+    return std::string(message.substr(index));
+  }
+
+  /**
+   * @brief Count the UTF-16 code units of an UTF-8 text.
+   * @param text The text.
+   * @return The number of code units.
+   */
+  static uint32_t utf16Length(std::string_view text) {
+    uint32_t units = 0;
+    for (unsigned char c : text) {
+      // Continuation bytes add nothing, 4-byte sequences are surrogate pairs.
+      if ((c & 0xC0) != 0x80)
+        units += c >= 0xF0 ? 2 : 1;
+    }
+
+    return units;
+  }
+
+  Document::Document(std::string text) { update(std::move(text)); }
+
+  Document::~Document() = default;
+  Document::Document(Document &&) noexcept = default;
+  Document &Document::operator=(Document &&) noexcept = default;
+
+  void Document::update(std::string newText) {
+    // Parse errors become diagnostics, keep them out of the logs.
+    utils::logging::ScopedLevel level(utils::LogLevel::NONE);
+    stats.reparsed = 0;
+
+    // Find the changed range, from the common prefix and suffix.
+    const size_t limit = std::min(text.size(), newText.size());
+    const size_t prefix =
+        std::mismatch(text.begin(), text.begin() + limit, newText.begin())
+            .first -
+        text.begin();
+
+    const size_t suffix =
+        std::mismatch(text.rbegin(), text.rbegin() + (limit - prefix),
+                      newText.rbegin())
+            .first -
+        text.rbegin();
+
+    if (prefix == text.size() && prefix == newText.size() && !lines.empty())
+      return;
+
+    const auto previousEnd = static_cast<uint32_t>(text.size() - suffix);
+    const auto changed = static_cast<uint32_t>(newText.size() - suffix);
+    const int64_t delta = static_cast<int64_t>(newText.size()) -
+                          static_cast<int64_t>(text.size());
+
+    text = std::move(newText);
+    lines.assign(1, 0);
+    for (size_t i = 0; (i = text.find('\n', i)) != std::string::npos;)
+      lines.push_back(static_cast<uint32_t>(++i));
+
+    // Start at the first item reaching the change, or at the one before, as
+    // the change may continue it, i.e with an `else`.
+    auto first = std::lower_bound(
+        items.begin(), items.end(), prefix,
+        [](const auto &item, size_t offset) { return item->end < offset; });
+
+    size_t start = first - items.begin();
+    if (start > 0)
+      start--;
+
+    const uint32_t begin = start == 0 ? 0 : items[start]->begin;
+
+    // The items after the change may be reused, if the lexer comes back to
+    // one of them.
+    std::vector<std::unique_ptr<Item>> previous;
+    for (size_t i = start; i < items.size(); ++i) {
+      if (items[i]->begin >= previousEnd)
+        previous.push_back(std::move(items[i]));
+    }
+
+    items.resize(start);
+    reparse(begin, changed, std::move(previous), delta);
+    indexGlobals();
+    stats.items = items.size();
+  }
+
+  void Document::edit(Position start, Position end, std::string_view text) {
+    const uint32_t from = toOffset(start);
+    const uint32_t to = std::max(from, toOffset(end));
+
+    std::string edited = this->text;
+    edited.replace(from, to - from, text);
+    update(std::move(edited));
+  }
+
+  void Document::reparse(uint32_t begin, uint32_t changed,
+                         std::vector<std::unique_ptr<Item>> previous,
+                         int64_t delta) {
+    auto toOffset = [this](uint32_t line, uint32_t column) {
+      line = std::clamp<uint32_t>(line, 1, lines.size());
+      return std::min<uint32_t>(lines[line - 1] + column - 1, text.size());
+    };
+
+    std::optional<lexer::Lexer> lexer;
+    auto restart = [&](uint32_t offset) {
+      const auto line = static_cast<uint32_t>(
+          std::upper_bound(lines.begin(), lines.end(), offset) - lines.begin());
+      lexer.emplace(text, offset, line, offset - lines[line - 1] + 1);
+    };
+
+    std::vector<Token> tokens;
+    int depth = 0;
+
+    // Parse and resolve the tokens of an item.
+    auto finish = [&] {
+      auto item = std::make_unique<Item>();
+      item->begin = tokens.front().meta.offset;
+      item->end = tokens.back().meta.offset + tokens.back().meta.length;
+      tokens.emplace_back("END", Token::Type::EOS, tokens.back().meta);
+
+      try {
+        nodes::Parser parser(std::move(tokens));
+        item->ast = parser.parse();
+
+        Resolver resolver(item->symbols, item->occurrences);
+        item->ast->accept(resolver);
+
+        std::sort(item->occurrences.begin(), item->occurrences.end(),
+                  [](const auto &a, const auto &b) {
+                    return a.location.offset < b.location.offset;
+                  });
+      }
+
+      catch (const errors::LexicalError &e) {
+        item->symbols.clear();
+        item->occurrences.clear();
+
+        // Underline the word the parser stopped at.
+        const uint32_t offset = toOffset(e.getLine(), e.getColumn());
+        uint32_t end = offset;
+        while (end < text.size() &&
+               (std::isalnum(text[end]) || text[end] == '_'))
+          end++;
+
+        item->error = Diagnostic{{offset, std::max<uint32_t>(end - offset, 1)},
+                                 stripPosition(e.what())};
+      }
+
+      tokens.clear();
+      depth = 0;
+      stats.reparsed++;
+      items.push_back(std::move(item));
+    };
+
+    // Lex a token, a lexical error becomes an item up to the end of its line.
+    bool complete = false;
+    auto next = [&]() -> Token {
+      while (true) {
+        try {
+          return lexer->nextToken();
+        }
+
+        catch (const errors::LexicalError &e) {
+          // Keep the item waiting for the token after it.
+          if (complete && !tokens.empty())
+            finish();
+
+          const uint32_t offset = toOffset(e.getLine(), e.getColumn());
+          const uint32_t resume = e.getLine() < lines.size()
+                                      ? lines[e.getLine()]
+                                      : static_cast<uint32_t>(text.size());
+
+          auto item = std::make_unique<Item>();
+          item->begin = tokens.empty() ? offset : tokens.front().meta.offset;
+          item->end = std::max(resume, item->begin);
+          item->error = Diagnostic{{offset, 1}, stripPosition(e.what())};
+
+          tokens.clear();
+          depth = 0;
+          stats.reparsed++;
+          items.push_back(std::move(item));
+          restart(resume);
+        }
+      }
+    };
+
+    restart(begin);
+    auto reused = previous.begin();
+    std::optional<Token> pending;
+
+    while (true) {
+      Token token = pending ? std::move(*pending) : next();
+      pending.reset();
+
+      if (token.is(Token::Type::EOS))
+        break;
+
+      tokens.push_back(token);
+      if (token.isOneOf({Token::Type::LBRACE, Token::Type::LPAREN}))
+        depth++;
+
+      // A stray closing token ends its item rather than the whole document.
+      else if (token.isOneOf({Token::Type::RBRACE, Token::Type::RPAREN}))
+        depth = std::max(depth - 1, 0);
+
+      if (depth != 0 ||
+          !token.isOneOf({Token::Type::SEMICOLON, Token::Type::RBRACE}))
+        continue;
+
+      complete = true;
+      pending = next();
+      complete = false;
+
+      if (token.is(Token::Type::RBRACE) && pending->is(Token::Type::ELSE))
+        continue;
+
+      if (!tokens.empty())
+        finish();
+
+      // Past the change, the lexer is in step again once the next token
+      // starts a previous item: the text from there on did not change.
+      if (items.back()->end < changed || pending->is(Token::Type::EOS))
+        continue;
+
+      const int64_t offset = pending->meta.offset;
+      while (reused != previous.end() && (*reused)->begin + delta < offset)
+        ++reused;
+
+      if (reused != previous.end() && (*reused)->begin + delta == offset) {
+        for (; reused != previous.end(); ++reused) {
+          auto &item = **reused;
+          item.begin += delta;
+          item.end += delta;
+          item.shift += delta;
+          items.push_back(std::move(*reused));
+        }
+
+        return;
+      }
+    }
+
+    // An unterminated item still gets parsed, to report its error.
+    if (!tokens.empty())
+      finish();
+  }
+
+  void Document::indexGlobals() {
+    globals.clear();
+
+    for (const auto &item : items) {
+      for (size_t i = 0; i < item->symbols.size(); ++i) {
+        const auto &symbol = item->symbols[i];
+        if (symbol.global && symbol.kind != Symbol::Kind::BENCH)
+          globals.try_emplace(symbol.name, item.get(), i);
+      }
+    }
+  }
+
+  const Document::Item *Document::findItem(uint32_t offset) const {
+    auto it = std::upper_bound(
+        items.begin(), items.end(), offset,
+        [](uint32_t offset, const auto &item) { return offset < item->begin; });
+
+    if (it == items.begin())
+      return nullptr;
+
+    const Item *item = std::prev(it)->get();
+    return offset <= item->end ? item : nullptr;
+  }
+
+  Symbol Document::place(const Item &item, const Symbol &symbol) {
+    Symbol placed = symbol;
+    placed.selection.offset += item.shift;
+    placed.extent.offset += item.shift;
+    return placed;
+  }
+
+  uint32_t Document::toOffset(Position position) const {
+    if (position.line >= lines.size())
+      return static_cast<uint32_t>(text.size());
+
+    uint32_t offset = lines[position.line];
+    const uint32_t end = position.line + 1 < lines.size()
+                             ? lines[position.line + 1] - 1
+                             : static_cast<uint32_t>(text.size());
+
+    for (uint32_t units = 0; offset < end && units < position.character;) {
+      const auto c = static_cast<unsigned char>(text[offset++]);
+      units += c >= 0xF0 ? 2 : 1;
+
+      while (offset < end && (text[offset] & 0xC0) == 0x80)
+        offset++;
+    }
+
+    return offset;
+  }
+
+  Position Document::toPosition(uint32_t offset) const {
+    offset = std::min<uint32_t>(offset, text.size());
+    const size_t line =
+        std::upper_bound(lines.begin(), lines.end(), offset) - lines.begin() -
+        1;
+
+    const std::string_view prefix(text.data() + lines[line],
+                                  offset - lines[line]);
+    return {static_cast<uint32_t>(line), utf16Length(prefix)};
+  }
+
+  std::vector<Diagnostic> Document::getDiagnostics() const {
+    std::vector<Diagnostic> diagnostics;
+
+    for (const auto &item : items) {
+      if (item->error) {
+        Diagnostic diagnostic = *item->error;
+        diagnostic.location.offset += item->shift;
+        diagnostics.push_back(std::move(diagnostic));
+        continue;
+      }
+
+      for (const auto &occurrence : item->occurrences) {
+        if (occurrence.symbol >= 0 || globals.contains(occurrence.name))
+          continue;
+
+        Location location = occurrence.location;
+        location.offset += item->shift;
+        diagnostics.push_back(
+            {location, std::format("Unknown {} referenced: {}",
+                                   occurrence.call ? "function" : "variable",
+                                   occurrence.name)});
+      }
+    }
+
+    return diagnostics;
+  }
+
+  std::optional<Reference> Document::lookup(uint32_t offset) const {
+    const Item *item = findItem(offset);
+    if (!item)
+      return std::nullopt;
+
+    // The last name starting at or before the offset.
+    const int64_t local = offset - item->shift;
+    const auto &occurrences = item->occurrences;
+    auto it = std::upper_bound(occurrences.begin(), occurrences.end(), local,
+                               [](int64_t offset, const auto &occurrence) {
+                                 return offset < occurrence.location.offset;
+                               });
+
+    if (it == occurrences.begin())
+      return std::nullopt;
+
+    const Occurrence &occurrence = *std::prev(it);
+    if (local > occurrence.location.end())
+      return std::nullopt;
+
+    Location location = occurrence.location;
+    location.offset += item->shift;
+
+    if (occurrence.symbol >= 0) {
+      const auto &symbol = item->symbols[occurrence.symbol];
+      return Reference{location, place(*item, symbol)};
+    }
+
+    auto global = globals.find(occurrence.name);
+    if (global == globals.end())
+      return std::nullopt;
+
+    const auto &[owner, index] = global->second;
+    return Reference{location, place(*owner, owner->symbols[index])};
+  }
+
+  std::vector<Symbol> Document::getSymbols() const {
+    std::vector<Symbol> symbols;
+
+    for (const auto &item : items) {
+      for (const auto &symbol : item->symbols) {
+        if (symbol.global)
+          symbols.push_back(place(*item, symbol));
+      }
+    }
+
+    return symbols;
+  }
+
+  std::optional<std::string> readMessage(std::istream &in) {
+    std::optional<size_t> length;
+    std::string line;
+
+    // Headers, up to an empty line.
+    while (std::getline(in, line)) {
+      if (line.ends_with('\r'))
+        line.pop_back();
+
+      if (line.empty()) {
+        if (length)
+          break;
+
+        continue;
+      }
+
+      constexpr std::string_view header = "content-length:";
+      if (line.size() <= header.size() ||
+          !std::equal(header.begin(), header.end(), line.begin(),
+                      [](char a, char b) { return a == std::tolower(b); }))
+        continue;
+
+      const char *begin = line.data() + header.size();
+      const char *end = line.data() + line.size();
+      while (begin < end && *begin == ' ')
+        begin++;
+
+      size_t value = 0;
+      if (std::from_chars(begin, end, value).ec == std::errc())
+        length = value;
+    }
+
+    if (!in || !length)
+      return std::nullopt;
+
+    std::string body(*length, '\0');
+    if (!in.read(body.data(), static_cast<std::streamsize>(*length)))
+      return std::nullopt;
+
+    return body;
+  }
+
+  void writeMessage(std::ostream &out, const json::Value &message) {
+    std::string body;
+    llvm::raw_string_ostream stream(body);
+    stream << message;
+    stream.flush();
+
+    out << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+    out.flush();
+  }
+
+  /**
+   * @class ResponseError
+   * @brief A request which cannot be answered.
+   */
+  class ResponseError : public errors::VerteError {
+  public:
+    /**
+     * @brief Construct a new ResponseError.
+     * @param code The JSON-RPC error code.
+     * @param message The error message.
+     */
+    ResponseError(int code, const std::string &message)
+        : VerteError(message), code(code) {}
+
+    /**
+     * @brief Get the JSON-RPC error code.
+     * @return The error code.
+     */
+    int getCode() const { return code; }
+
+  private:
+    int code; /**< The JSON-RPC error code. */
+  };
+
+  /**
+   * @brief Get the URI of the document of a request.
+   * @param params The parameters of the request.
+   * @return The URI.
+   */
+  static std::string getUri(const json::Object &params) {
+    const auto *document = params.getObject("textDocument");
+    if (!document || !document->getString("uri"))
+      throw ResponseError(-32602, "Missing text document.");
+
+    return document->getString("uri")->str();
+  }
+
+  /**
+   * @brief Get a position of the parameters of a request.
+   * @param params The parameters.
+   * @param key The name of the position.
+   * @return The position.
+   */
+  static Position getPosition(const json::Object &params,
+                              llvm::StringRef key = "position") {
+    const auto *position = params.getObject(key);
+    if (!position || !position->getInteger("line") ||
+        !position->getInteger("character"))
+      throw ResponseError(-32602, "Missing position.");
+
+    return {static_cast<uint32_t>(*position->getInteger("line")),
+            static_cast<uint32_t>(*position->getInteger("character"))};
+  }
+
+  /**
+   * @brief Convert a span of a document to a protocol range.
+   * @param document The document.
+   * @param location The span.
+   * @return The range.
+   */
+  static json::Value toRange(const Document &document, Location location) {
+    auto toJson = [](Position position) {
+      return json::Object{{"line", position.line},
+                          {"character", position.character}};
+    };
+
+    return json::Object{
+        {"start", toJson(document.toPosition(location.offset))},
+        {"end", toJson(document.toPosition(location.end()))}};
+  }
+
+  /**
+   * @brief Get the protocol kind of a symbol.
+   * @param kind The kind of the symbol.
+   * @return The `SymbolKind` number.
+   */
+  static int toSymbolKind(Symbol::Kind kind) {
+    switch (kind) {
+      case Symbol::Kind::FUNCTION:
+      case Symbol::Kind::BENCH:
+        return 12;
+      case Symbol::Kind::CONSTANT:
+        return 14;
+      case Symbol::Kind::VARIABLE:
+      case Symbol::Kind::PARAMETER:
+      default:
+        return 13;
+    }
+  }
+
+  int Server::run(std::istream &in) {
+    while (auto body = readMessage(in)) {
+      auto message = json::parse(*body);
+      if (!message) {
+        logger.warn("Ignoring malformed message: {}",
+                    llvm::toString(message.takeError()));
+        continue;
+      }
+
+      if (!handle(*message))
+        return shutdown ? 0 : 1;
+    }
+
+    return 1;
+  }
+
+  bool Server::handle(const json::Value &message) {
+    const auto *object = message.getAsObject();
+    if (!object)
+      return true;
+
+    // Answers to requests of ours, there are none.
+    const auto method = object->getString("method");
+    if (!method)
+      return true;
+
+    const json::Object none;
+    const auto *params = object->getObject("params");
+    const auto *id = object->get("id");
+
+    if (!id) {
+      if (*method == "exit")
+        return false;
+
+      notification(*method, params ? *params : none);
+      return true;
+    }
+
+    json::Object response{{"jsonrpc", "2.0"}, {"id", *id}};
+    try {
+      response["result"] = request(*method, params ? *params : none);
+    }
+
+    catch (const ResponseError &e) {
+      // The message must outlive the exception.
+      response["error"] = json::Object{{"code", e.getCode()},
+                                       {"message", std::string(e.what())}};
+    }
+
+    writeMessage(out, std::move(response));
+    return true;
+  }
+
+  const Document *Server::getDocument(const std::string &uri) const {
+    auto it = documents.find(uri);
+    return it == documents.end() ? nullptr : &it->second;
+  }
+
+  json::Value Server::request(llvm::StringRef method,
+                              const json::Object &params) {
+    if (method == "initialize") {
+      return json::Object{
+          {"capabilities",
+           json::Object{
+               {"textDocumentSync",
+                json::Object{{"openClose", true}, {"change", 2}}},
+               {"definitionProvider", true},
+               {"hoverProvider", true},
+               {"documentSymbolProvider", true}}},
+          {"serverInfo",
+           json::Object{{"name", "vertec"}, {"version", VERTE_VERSION}}}};
+    }
+
+    if (method == "shutdown") {
+      shutdown = true;
+      return nullptr;
+    }
+
+    if (method == "textDocument/definition" ||
+        method == "textDocument/hover") {
+      const std::string uri = getUri(params);
+      const Document *document = getDocument(uri);
+      if (!document)
+        return nullptr;
+
+      auto reference =
+          document->lookup(document->toOffset(getPosition(params)));
+      if (!reference)
+        return nullptr;
+
+      if (method == "textDocument/definition") {
+        return json::Object{
+            {"uri", uri},
+            {"range", toRange(*document, reference->symbol.selection)}};
+      }
+
+      return json::Object{
+          {"contents",
+           json::Object{{"kind", "markdown"},
+                        {"value", std::format("```verte\n{}\n```",
+                                              reference->symbol.detail)}}},
+          {"range", toRange(*document, reference->location)}};
+    }
+
+    if (method == "textDocument/documentSymbol") {
+      const Document *document = getDocument(getUri(params));
+      json::Array symbols;
+
+      if (document) {
+        for (const auto &symbol : document->getSymbols()) {
+          symbols.push_back(json::Object{
+              {"name", symbol.name},
+              {"detail", symbol.detail},
+              {"kind", toSymbolKind(symbol.kind)},
+              {"range", toRange(*document, symbol.extent)},
+              {"selectionRange", toRange(*document, symbol.selection)}});
+        }
+      }
+
+      return symbols;
+    }
+
+    throw ResponseError(-32601, "Unknown method: " + method.str());
+  }
+
+  void Server::notification(llvm::StringRef method,
+                            const json::Object &params) {
+    try {
+      if (method == "textDocument/didOpen") {
+        const std::string uri = getUri(params);
+        const auto text = params.getObject("textDocument")->getString("text");
+
+        documents.insert_or_assign(uri, Document(text ? text->str() : ""));
+        publishDiagnostics(uri);
+      }
+
+      else if (method == "textDocument/didChange") {
+        const std::string uri = getUri(params);
+        auto it = documents.find(uri);
+        const auto *changes = params.getArray("contentChanges");
+        if (it == documents.end() || !changes)
+          return;
+
+        for (const auto &change : *changes) {
+          const auto *object = change.getAsObject();
+          if (!object || !object->getString("text"))
+            continue;
+
+          const auto text = *object->getString("text");
+
+          // Changes without a range replace the whole text.
+          if (const auto *range = object->getObject("range"))
+            it->second.edit(getPosition(*range, "start"),
+                            getPosition(*range, "end"), text);
+          else
+            it->second.update(text.str());
+        }
+
+        publishDiagnostics(uri);
+      }
+
+      else if (method == "textDocument/didClose") {
+        const std::string uri = getUri(params);
+        documents.erase(uri);
+        publishDiagnostics(uri);
+      }
+    }
+
+    catch (const ResponseError &e) {
+      logger.warn("Ignoring {}: {}", method.str(), e.what());
+    }
+  }
+
+  void Server::publishDiagnostics(const std::string &uri) {
+    json::Array diagnostics;
+
+    if (const Document *document = getDocument(uri)) {
+      for (const auto &diagnostic : document->getDiagnostics()) {
+        diagnostics.push_back(
+            json::Object{{"range", toRange(*document, diagnostic.location)},
+                         {"severity", 1},
+                         {"source", "vertec"},
+                         {"message", diagnostic.message}});
+      }
+    }
+
+    writeMessage(
+        out, json::Object{
+                 {"jsonrpc", "2.0"},
+                 {"method", "textDocument/publishDiagnostics"},
+                 {"params", json::Object{{"uri", uri},
+                                         {"diagnostics",
+                                          std::move(diagnostics)}}}});
+  }
+} // namespace verte::lsp
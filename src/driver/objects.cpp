@@ -0,0 +1,385 @@
+/**
+ * @brief Function-granular object reuse implementation.
+ * @file objects.cpp
+ */
+
+#include "verte/driver/objects.hpp"
+#include "verte/backend/codegen/header.hpp"
+#include "verte/backend/codegen/optimizer.hpp"
+#include "verte/driver/remote.hpp"
+#include "verte/driver/watch.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/version.hpp"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/SHA256.h"
+
+#include <format>
+#include <fstream>
+#include <optional>
+#include <unordered_set>
+
+#include <unistd.h>
+
+namespace verte::objects {
+  using lexer::Token;
+
+  /**
+   * @brief Hash the input of an object into its key.
+   * @param input The source and the interfaces the object depends on.
+   * @param options The options of the compilation.
+   * @return The lowercase hex SHA-256 of the input.
+   */
+  static std::string computeKey(std::string_view input,
+                                const Options &options) {
+    const std::string keyed =
+        std::format("verte-object-v1\n{}\n{}\n", VERTE_VERSION,
+                    llvm::sys::getDefaultTargetTriple()) +
+        remote::encodeJob(input, options);
+
+    const auto digest = llvm::SHA256::hash(llvm::arrayRefFromStringRef(keyed));
+    return llvm::toHex(digest, true);
+  }
+
+  /**
+   * @brief Describe what a reference to a top-level declaration depends on.
+   * @param node The declaration.
+   * @return The interface, empty if the node declares nothing.
+   */
+  static std::string describeInterface(const nodes::ASTNode &node) {
+    const nodes::ProtoNode *proto = nullptr;
+    if (auto func = dynamic_cast<const nodes::FuncDeclNode *>(&node))
+      proto = func->getProto().get();
+
+    else
+      proto = dynamic_cast<const nodes::ProtoNode *>(&node);
+
+    if (proto) {
+      std::string interface = "fn(";
+      for (const auto &param : proto->getParams())
+        interface += param.type.name + ",";
+
+      return interface + ")" + proto->getRetType().name;
+    }
+
+    // The uses of a global depend on its storage as well as on its type.
+    if (auto var = dynamic_cast<const nodes::VarDeclNode *>(&node)) {
+      if (var->isConstant())
+        return "const " + var->getType().name;
+
+      return types::findAttribute(var->getAttributes(), "thread_local")
+                 ? "thread_local " + var->getType().name
+                 : "var " + var->getType().name;
+    }
+
+    return {};
+  }
+
+  /**
+   * @brief Get the name of a top-level declaration.
+   * @param node The declaration.
+   * @return The name, empty if the node declares nothing.
+   */
+  static std::string declaredName(const nodes::ASTNode &node) {
+    if (auto func = dynamic_cast<const nodes::FuncDeclNode *>(&node))
+      return func->getProto()->getName();
+
+    if (auto proto = dynamic_cast<const nodes::ProtoNode *>(&node))
+      return proto->getName();
+
+    if (auto var = dynamic_cast<const nodes::VarDeclNode *>(&node))
+      return var->getName();
+
+    return {};
+  }
+
+  /**
+   * @brief Check if a module defines anything.
+   * @param module The module.
+   * @return True if a function or a global has a body.
+   */
+  static bool hasDefinitions(const llvm::Module &module) {
+    for (const auto &function : module) {
+      if (!function.isDeclaration())
+        return true;
+    }
+
+    for (const auto &global : module.globals()) {
+      if (!global.isDeclaration())
+        return true;
+    }
+
+    return false;
+  }
+
+  ObjectStore::ObjectStore(std::filesystem::path directory)
+      : directory(std::move(directory)) {
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+    if (error)
+      throw errors::IOError("Failed to create the object store: " +
+                                error.message(),
+                            this->directory);
+  }
+
+  std::filesystem::path ObjectStore::path(std::string_view key) const {
+    return directory / (std::string(key) + ".o");
+  }
+
+  bool ObjectStore::contains(std::string_view key) const {
+    std::error_code error;
+    return std::filesystem::exists(path(key), error);
+  }
+
+  std::filesystem::path ObjectStore::put(std::string_view key,
+                                         std::string_view object) {
+    const auto target = path(key);
+    auto temporary = target;
+    temporary += std::format(".{}.tmp", getpid());
+
+    {
+      std::ofstream out(temporary, std::ios::binary);
+      out.write(object.data(), static_cast<std::streamsize>(object.size()));
+      if (!out)
+        throw errors::IOError("Failed to write an object.", temporary);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+      std::filesystem::remove(temporary, error);
+      throw errors::IOError("Failed to store an object.", target);
+    }
+
+    return target;
+  }
+
+  FunctionCompiler::FunctionCompiler(Options options,
+                                     std::filesystem::path store)
+      : options(std::move(options)), store(std::move(store)) {
+    this->options.output = OutputKind::OBJECT;
+  }
+
+  Result FunctionCompiler::compile(std::string_view source) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    Result result;
+    stats = {};
+    objects.clear();
+
+    /**
+     * @struct Part
+     * @brief An item of the source.
+     */
+    struct Part {
+      const nodes::ProgramNode *program; /**< The parsed item. */
+      const std::string *key;            /**< The tokens of the item. */
+      std::vector<std::string> names;    /**< The identifiers it references. */
+    };
+
+    std::vector<Part> parts;
+    std::unordered_set<std::string> used;
+
+    auto fail = [&](const std::string &message, uint32_t line = 0,
+                    uint32_t column = 0) {
+      result.diagnostics.push_back(
+          {Diagnostic::Severity::ERROR, message, line, column});
+    };
+
+    // Parse the new items, as the incremental compiler does.
+    try {
+      lexer::Lexer lexer(source);
+      const auto tokens = lexer.allTokens();
+
+      for (const auto &[begin, end] : watch::splitItems(tokens)) {
+        std::string key;
+        std::vector<std::string> names;
+
+        for (size_t i = begin; i < end; ++i) {
+          key += static_cast<char>(tokens[i].type);
+          key += tokens[i].getValue();
+          key += '\0';
+
+          if (tokens[i].is(Token::Type::IDENTIFIER))
+            names.push_back(tokens[i].getValue());
+        }
+
+        const auto entry = items.try_emplace(std::move(key)).first;
+        if (!entry->second) {
+          std::vector<Token> itemTokens(tokens.begin() + begin,
+                                        tokens.begin() + end);
+          itemTokens.emplace_back("END", Token::Type::EOS,
+                                  tokens[end - 1].meta);
+
+          nodes::Parser parser(std::move(itemTokens));
+          entry->second = parser.parse();
+        }
+
+        used.insert(entry->first);
+        parts.push_back({entry->second.get(), &entry->first, std::move(names)});
+      }
+    }
+
+    catch (const errors::LexicalError &e) {
+      fail(e.what(), e.getLine(), e.getColumn());
+    }
+
+    catch (const std::exception &e) {
+      fail(e.what());
+    }
+
+    // Forget the items gone from the source, and the one which failed.
+    std::erase_if(items, [&](const auto &entry) {
+      return !entry.second || !used.contains(entry.first);
+    });
+
+    if (!result.success())
+      return result;
+
+    llvm::LLVMContext context;
+    codegen::Codegen codegen(
+        context, std::make_unique<llvm::Module>(options.moduleName, context),
+        options.codegen);
+    codegen::Optimizer optimizer(options.optLevel);
+
+    // Verify, optimize then emit a module as an object.
+    auto build = [&](llvm::Module &module) -> std::optional<std::string> {
+      std::string error;
+      llvm::raw_string_ostream errorStream(error);
+      if (options.verify && llvm::verifyModule(module, &errorStream))
+        throw errors::CodegenError("Invalid module generated: " +
+                                   errorStream.str());
+
+      optimizer.run(module);
+
+      Result emitted;
+      emit(module, options, emitted);
+      if (!emitted.success()) {
+        result.diagnostics = std::move(emitted.diagnostics);
+        return std::nullopt;
+      }
+
+      return std::move(emitted.output);
+    };
+
+    // The interfaces of the symbols declared so far, by name.
+    std::unordered_map<std::string, std::string> interfaces;
+    std::unordered_set<std::string> defined;
+    std::vector<codegen::ModulePtr> rest;
+    std::string declarations;
+
+    try {
+      for (const auto &part : parts) {
+        for (const auto &child : part.program->getBody()) {
+          const std::string name = declaredName(*child);
+          const auto *func =
+              dynamic_cast<const nodes::FuncDeclNode *>(child.get());
+
+          // The benchmark harness replaces `main`, codegen skips it.
+          if (!func || (options.codegen.bench && name == "main")) {
+            child->accept(codegen);
+            if (!name.empty())
+              interfaces[name] = describeInterface(*child);
+
+            continue;
+          }
+
+          // Reused functions are only declared, the check is done here.
+          if (!defined.insert(name).second)
+            throw errors::CodegenError("Redefinition of function: " + name);
+
+          // The function may call itself.
+          interfaces[name] = describeInterface(*child);
+
+          std::string input = name + '\n' + *part.key + '\n';
+          for (const auto &reference : part.names) {
+            const auto interface = interfaces.find(reference);
+            input += reference + ':' +
+                     (interface != interfaces.end() ? interface->second : "?") +
+                     '\n';
+          }
+
+          const std::string key = computeKey(input, options);
+          stats.functions++;
+
+          if (store.contains(key)) {
+            stats.reused++;
+            func->getProto()->accept(codegen);
+            objects.push_back(store.path(key));
+            continue;
+          }
+
+          // Generate the function alone in its module.
+          rest.push_back(codegen.split());
+          child->accept(codegen);
+          auto module = codegen.split();
+
+          const auto object = build(*module);
+          if (!object)
+            return result;
+
+          objects.push_back(store.put(key, *object));
+        }
+
+        if (options.codegen.shared)
+          declarations += codegen::generateDeclarations(*part.program);
+      }
+
+      codegen.finalize();
+      rest.push_back(codegen.split());
+
+      // Gather what is not a function into one object.
+      codegen::ModulePtr globals;
+      for (auto &module : rest) {
+        if (!hasDefinitions(*module))
+          continue;
+
+        if (!globals)
+          globals = std::move(module);
+
+        else if (llvm::Linker::linkModules(*globals, std::move(module)))
+          throw errors::CodegenError("Failed to link the global definitions.");
+      }
+
+      if (globals) {
+        // Reused functions leave declarations behind, which would change the
+        // key.
+        for (auto &function : llvm::make_early_inc_range(*globals)) {
+          if (function.isDeclaration() && function.use_empty())
+            function.eraseFromParent();
+        }
+
+        std::string bitcode;
+        llvm::raw_string_ostream out(bitcode);
+        llvm::WriteBitcodeToFile(*globals, out);
+        out.flush();
+
+        const std::string key = computeKey(bitcode, options);
+        if (!store.contains(key)) {
+          const auto object = build(*globals);
+          if (!object)
+            return result;
+
+          store.put(key, *object);
+        }
+
+        objects.push_back(store.path(key));
+      }
+    }
+
+    catch (const std::exception &e) {
+      fail(e.what());
+      return result;
+    }
+
+    if (options.codegen.shared)
+      result.header = codegen::wrapHeader(declarations, options.moduleName);
+
+    return result;
+  }
+} // namespace verte::objects
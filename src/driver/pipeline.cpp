@@ -0,0 +1,229 @@
+/**
+ * @brief Pipelined compilation implementation.
+ * @file pipeline.cpp
+ */
+
+#include "verte/driver/pipeline.hpp"
+#include "verte/backend/codegen/header.hpp"
+#include "verte/backend/codegen/optimizer.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/items.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/utils/queue.hpp"
+
+#include "llvm/IR/Verifier.h"
+
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace verte::pipeline {
+  using lexer::Token;
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @class StageTimer
+   * @brief Measures the time a stage works, without its waits.
+   */
+  class StageTimer {
+  public:
+    /**
+     * @brief Run a wait on a queue, not counted.
+     * @param wait The wait.
+     * @return The result of the wait.
+     */
+    template <typename Wait> decltype(auto) wait(Wait &&wait) {
+      const Waiting waiting(*this);
+      return wait();
+    }
+
+    /**
+     * @brief Get the time worked since the construction.
+     * @return The time.
+     */
+    [[nodiscard]] std::chrono::nanoseconds elapsed() const {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::now() - start - waited);
+    }
+
+  private:
+    /**
+     * @struct Waiting
+     * @brief Counts the lifetime of a scope as waited.
+     */
+    struct Waiting {
+      explicit Waiting(StageTimer &timer) : timer(timer) {}
+      ~Waiting() { timer.waited += Clock::now() - since; }
+
+      StageTimer &timer;                     /**< The timer to update. */
+      Clock::time_point since = Clock::now(); /**< The start of the wait. */
+    };
+
+    Clock::time_point start = Clock::now(); /**< The start of the stage. */
+    Clock::duration waited{};                /**< The time spent waiting. */
+  };
+
+  /**
+   * @brief Run a step of a stage, keeping its error.
+   * @param failure Receives the error of the step, if any.
+   * @param step The step to run.
+   */
+  template <typename Step>
+  static void attempt(std::optional<Diagnostic> &failure, Step &&step) {
+    try {
+      step();
+    }
+
+    // Parser errors are lexical errors, both carry a location.
+    catch (const errors::LexicalError &e) {
+      failure = {Diagnostic::Severity::ERROR, e.what(), e.getLine(),
+                 e.getColumn()};
+    }
+
+    // Malformed programs may still trip the standard library, i.e `stoi`.
+    catch (const std::exception &e) {
+      failure = {Diagnostic::Severity::ERROR, e.what(), 0, 0};
+    }
+  }
+
+  /**
+   * @brief Verify a generated function.
+   * @param function The function.
+   * @throws errors::CodegenError If the function is invalid.
+   */
+  static void verify(const llvm::Function &function) {
+    std::string error;
+    llvm::raw_string_ostream errorStream(error);
+    if (llvm::verifyFunction(function, &errorStream))
+      throw errors::CodegenError("Invalid module generated: " +
+                               errorStream.str());
+  }
+
+  Result PipelinedCompiler::compile(std::string_view source) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    Result result;
+    stats = {};
+
+    utils::SpscQueue<std::vector<Token>> items(capacity);
+    utils::SpscQueue<std::unique_ptr<nodes::ProgramNode>> programs(capacity);
+    std::optional<Diagnostic> lexFailure, parseFailure, generateFailure;
+
+    // Split the tokens into items as they are lexed.
+    std::jthread lexing([&] {
+      utils::logging::ScopedLevel stageLevel(options.logLevel);
+      StageTimer timer;
+
+      attempt(lexFailure, [&] {
+        lexer::ItemSplitter splitter([&](std::vector<Token> item) {
+          timer.wait([&] { items.push(std::move(item)); });
+          stats.items++;
+        });
+
+        lexer::Lexer lexer(source);
+        for (bool end = false; !end;) {
+          Token token = lexer.nextToken();
+          end = token.is(Token::Type::EOS);
+          splitter.feed(std::move(token));
+        }
+      });
+
+      items.close();
+      stats.lex = timer.elapsed();
+    });
+
+    // Parse the items on their own, draining them after a failure.
+    std::jthread parsing([&] {
+      utils::logging::ScopedLevel stageLevel(options.logLevel);
+      StageTimer timer;
+
+      while (auto tokens = timer.wait([&] { return items.pop(); })) {
+        if (parseFailure)
+          continue;
+
+        std::unique_ptr<nodes::ProgramNode> program;
+        attempt(parseFailure, [&] {
+          nodes::Parser parser(std::move(*tokens));
+          program = parser.parse();
+        });
+
+        if (program)
+          timer.wait([&] { programs.push(std::move(program)); });
+      }
+
+      programs.close();
+      stats.parse = timer.elapsed();
+    });
+
+    // Generate then optimize every function on this thread, which owns the
+    // LLVM context.
+    llvm::LLVMContext context;
+    codegen::Codegen codegen(
+        context, std::make_unique<llvm::Module>(options.moduleName, context),
+        options.codegen);
+    codegen::Optimizer optimizer(options.optLevel);
+
+    std::vector<std::unique_ptr<nodes::ProgramNode>> parts;
+
+    auto optimize = [&](const std::vector<llvm::Function *> &functions) {
+      for (auto *function : functions) {
+        if (options.verify)
+          verify(*function);
+
+        optimizer.run(*function);
+      }
+    };
+
+    StageTimer timer;
+    while (auto program = timer.wait([&] { return programs.pop(); })) {
+      if (generateFailure)
+        continue;
+
+      attempt(generateFailure, [&] { optimize(codegen.append(**program)); });
+      parts.push_back(std::move(*program));
+    }
+
+    if (!generateFailure) {
+      attempt(generateFailure, [&] {
+        optimize(codegen.finalize());
+        optimizer.finish(codegen.getModule());
+
+        std::string error;
+        llvm::raw_string_ostream errorStream(error);
+        if (options.verify &&
+            llvm::verifyModule(codegen.getModule(), &errorStream))
+          throw errors::CodegenError("Invalid module generated: " +
+                                     errorStream.str());
+      });
+    }
+
+    stats.generate = timer.elapsed();
+    lexing.join();
+    parsing.join();
+
+    // Report the error of the earliest stage, the later ones may follow from
+    // it.
+    for (const auto &failure : {lexFailure, parseFailure, generateFailure}) {
+      if (failure) {
+        result.diagnostics.push_back(*failure);
+        return result;
+      }
+    }
+
+    if (options.codegen.shared) {
+      std::vector<const nodes::ProgramNode *> views;
+      for (const auto &part : parts)
+        views.push_back(part.get());
+
+      result.header = codegen::generateHeader(views, options.moduleName);
+    }
+
+    const auto start = Clock::now();
+    auto module = codegen.takeModule();
+    emit(*module, options, result);
+    stats.emit = Clock::now() - start;
+
+    return result;
+  }
+} // namespace verte::pipeline
@@ -0,0 +1,374 @@
+/**
+ * @brief Distributed compilation implementation.
+ * @file remote.cpp
+ */
+
+#include "verte/driver/remote.hpp"
+#include "verte/errors.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace verte::remote {
+  /**
+   * @brief The largest payload accepted, guards against garbage sizes.
+   */
+  static constexpr uint32_t MAX_PAYLOAD = 256u << 20;
+
+  /**
+   * @class Writer
+   * @brief Appends little endian fields to a payload.
+   */
+  class Writer {
+  public:
+    void u8(uint8_t value) { data += static_cast<char>(value); }
+
+    void u32(uint32_t value) {
+      for (int shift = 0; shift < 32; shift += 8)
+        u8(static_cast<uint8_t>(value >> shift));
+    }
+
+    void str(std::string_view value) {
+      u32(static_cast<uint32_t>(value.size()));
+      data += value;
+    }
+
+    std::string data; /**< The payload written so far. */
+  };
+
+  /**
+   * @class Reader
+   * @brief Reads little endian fields from a payload.
+   */
+  class Reader {
+  public:
+    explicit Reader(std::string_view data) : data(data) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(take(1)[0]); }
+
+    uint32_t u32() {
+      std::string_view bytes = take(4);
+      uint32_t value = 0;
+      for (int i = 3; i >= 0; --i)
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+
+      return value;
+    }
+
+    std::string str() { return std::string(take(u32())); }
+
+  private:
+    std::string_view take(size_t size) {
+      if (data.size() < size)
+        throw errors::NetworkError("Truncated frame payload.");
+
+      std::string_view bytes = data.substr(0, size);
+      data.remove_prefix(size);
+      return bytes;
+    }
+
+    std::string_view data; /**< The payload left to read. */
+  };
+
+  /**
+   * @brief Send a frame.
+   * @param socket The connection.
+   * @param kind The kind of the frame.
+   * @param payload The payload of the frame.
+   */
+  static void sendFrame(const utils::Socket &socket, FrameKind kind,
+                        std::string_view payload) {
+    Writer header;
+    header.u32(static_cast<uint32_t>(payload.size()));
+    header.u8(static_cast<uint8_t>(kind));
+
+    socket.sendAll(header.data + std::string(payload));
+  }
+
+  /**
+   * @brief Receive a frame.
+   * @param socket The connection.
+   * @return The kind and the payload, or nothing once the peer is gone.
+   */
+  static std::optional<std::pair<FrameKind, std::string>>
+  receiveFrame(const utils::Socket &socket) {
+    auto header = socket.receiveExact(5);
+    if (!header)
+      return std::nullopt;
+
+    Reader reader(*header);
+    uint32_t size = reader.u32();
+    auto kind = static_cast<FrameKind>(reader.u8());
+
+    if (size > MAX_PAYLOAD)
+      throw errors::NetworkError("Frame payload too large.");
+
+    auto payload = socket.receiveExact(size);
+    if (!payload)
+      throw errors::NetworkError("Connection closed inside a frame.");
+
+    return std::make_pair(kind, std::move(*payload));
+  }
+
+  std::string encodeJob(std::string_view source, const Options &options) {
+    Writer writer;
+    writer.u8(static_cast<uint8_t>(options.output));
+    writer.str(options.moduleName);
+    writer.u8(options.verify);
+    writer.u8(static_cast<uint8_t>(options.optLevel));
+    writer.u8(options.annotate);
+    writer.str(options.cpu);
+    writer.u8(options.codegen.bench);
+    writer.u8(options.codegen.shared);
+    writer.u8(options.codegen.framePointers);
+    writer.u8(static_cast<uint8_t>(options.codegen.overflow));
+    writer.str(source);
+    return std::move(writer.data);
+  }
+
+  void decodeJob(std::string_view payload, std::string &source,
+                 Options &options) {
+    Reader reader(payload);
+    uint8_t output = reader.u8();
+    if (output > static_cast<uint8_t>(OutputKind::ASSEMBLY))
+      throw errors::NetworkError("Unknown output kind in job.");
+
+    options.output = static_cast<OutputKind>(output);
+    options.moduleName = reader.str();
+    options.verify = reader.u8();
+    options.optLevel = reader.u8();
+    if (options.optLevel > 3)
+      throw errors::NetworkError("Unknown optimization level in job.");
+
+    options.annotate = reader.u8();
+    options.cpu = reader.str();
+
+    options.codegen.bench = reader.u8();
+    options.codegen.shared = reader.u8();
+    options.codegen.framePointers = reader.u8();
+
+    uint8_t overflow = reader.u8();
+    if (overflow > static_cast<uint8_t>(codegen::Overflow::SATURATE))
+      throw errors::NetworkError("Unknown overflow behavior in job.");
+
+    options.codegen.overflow = static_cast<codegen::Overflow>(overflow);
+    source = reader.str();
+  }
+
+  std::string encodeResult(const Result &result) {
+    Writer writer;
+    writer.u32(static_cast<uint32_t>(result.diagnostics.size()));
+
+    for (const auto &diagnostic : result.diagnostics) {
+      writer.u8(static_cast<uint8_t>(diagnostic.severity));
+      writer.str(diagnostic.message);
+      writer.u32(diagnostic.line);
+      writer.u32(diagnostic.column);
+    }
+
+    writer.str(result.output);
+    writer.str(result.header);
+    return std::move(writer.data);
+  }
+
+  Result decodeResult(std::string_view payload) {
+    Reader reader(payload);
+    Result result;
+
+    uint32_t count = reader.u32();
+    for (uint32_t i = 0; i < count; ++i) {
+      Diagnostic diagnostic;
+      diagnostic.severity = reader.u8() == 0 ? Diagnostic::Severity::WARNING
+                                             : Diagnostic::Severity::ERROR;
+      diagnostic.message = reader.str();
+      diagnostic.line = reader.u32();
+      diagnostic.column = reader.u32();
+      result.diagnostics.push_back(std::move(diagnostic));
+    }
+
+    result.output = reader.str();
+    result.header = reader.str();
+    return result;
+  }
+
+  Worker::Worker(const utils::Endpoint &endpoint, uint32_t jobs)
+      : server(endpoint),
+        jobs(jobs ? jobs : std::max(1u, std::thread::hardware_concurrency())),
+        logger("worker") {}
+
+  Worker::~Worker() { stop(); }
+
+  void Worker::run() {
+    logger.info("Listening on port {} with {} job slots.", server.getPort(),
+                jobs);
+    server.run([this](utils::Socket &connection) { serve(connection); });
+  }
+
+  void Worker::stop() { server.stop(); }
+
+  void Worker::serve(utils::Socket &connection) {
+    try {
+      while (auto frame = receiveFrame(connection)) {
+        auto &[kind, payload] = *frame;
+
+        switch (kind) {
+          case FrameKind::PING: {
+            Writer pong;
+            pong.u32(PROTOCOL_VERSION);
+            pong.u32(jobs);
+            sendFrame(connection, FrameKind::PONG, pong.data);
+            break;
+          }
+
+          case FrameKind::COMPILE:
+            sendFrame(connection, FrameKind::RESULT, compileJob(payload));
+            break;
+
+          default:
+            logger.warn("Dropping connection after an unexpected frame.");
+            return;
+        }
+      }
+    }
+
+    catch (const errors::VerteError &e) {
+      logger.warn("Dropping connection: {}", e.what());
+    }
+  }
+
+  std::string Worker::compileJob(std::string_view payload) {
+    std::string source;
+    Options options;
+    decodeJob(payload, source, options);
+
+    // Wait for a free job slot.
+    {
+      std::unique_lock lock(mutex);
+      changed.wait(lock, [this] { return running < jobs; });
+      running++;
+    }
+
+    Result result = verte::compile(source, options);
+
+    {
+      std::lock_guard lock(mutex);
+      running--;
+      changed.notify_all();
+    }
+
+    return encodeResult(result);
+  }
+
+  Scheduler::Scheduler(std::vector<utils::Endpoint> endpoints,
+                       SchedulerOptions options)
+      : options(options), logger("scheduler") {
+    for (auto &endpoint : endpoints)
+      workers.push_back({std::move(endpoint)});
+  }
+
+  Result Scheduler::compile(std::string_view source,
+                            const Options &compileOptions) {
+    const std::string job = encodeJob(source, compileOptions);
+    const size_t start = next.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+      WorkerState &worker = workers[(start + i) % workers.size()];
+      if (!available(worker))
+        continue;
+
+      try {
+        auto connection =
+            utils::Socket::connect(worker.endpoint, options.connectTimeout);
+        connection.setTimeout(options.jobTimeout);
+        sendFrame(connection, FrameKind::COMPILE, job);
+
+        auto frame = receiveFrame(connection);
+        if (!frame || frame->first != FrameKind::RESULT)
+          throw errors::NetworkError("Unexpected answer to a job.");
+
+        return decodeResult(frame->second);
+      }
+
+      catch (const errors::VerteError &e) {
+        markFailed(worker, e.what());
+      }
+    }
+
+    Result result;
+    if (!options.localFallback) {
+      result.diagnostics.push_back({Diagnostic::Severity::ERROR,
+                                    "No compile worker available.", 0, 0});
+      return result;
+    }
+
+    result = verte::compile(source, compileOptions);
+    result.diagnostics.insert(
+        result.diagnostics.begin(),
+        Diagnostic{Diagnostic::Severity::WARNING,
+                   "No compile worker available, compiled locally.", 0, 0});
+
+    return result;
+  }
+
+  bool Scheduler::ping(const utils::Endpoint &endpoint) const {
+    try {
+      auto connection =
+          utils::Socket::connect(endpoint, options.connectTimeout);
+      connection.setTimeout(options.connectTimeout);
+      sendFrame(connection, FrameKind::PING, {});
+
+      auto frame = receiveFrame(connection);
+      if (!frame || frame->first != FrameKind::PONG)
+        return false;
+
+      Reader pong(frame->second);
+      return pong.u32() == PROTOCOL_VERSION;
+    }
+
+    catch (const errors::VerteError &e) {
+      logger.debug("Ping of {} failed: {}", endpoint.toString(), e.what());
+      return false;
+    }
+  }
+
+  size_t Scheduler::healthyWorkers() {
+    size_t count = 0;
+    for (auto &worker : workers)
+      count += available(worker);
+
+    return count;
+  }
+
+  bool Scheduler::available(WorkerState &worker) {
+    {
+      std::lock_guard lock(mutex);
+      if (worker.checked && !worker.failed)
+        return true;
+
+      auto elapsed = std::chrono::steady_clock::now() - worker.failedAt;
+      if (worker.failed && elapsed < options.retryAfter)
+        return false;
+    }
+
+    // Unknown or failed a while ago, check it again.
+    const bool healthy = ping(worker.endpoint);
+
+    std::lock_guard lock(mutex);
+    worker.checked = true;
+    worker.failed = !healthy;
+    if (!healthy)
+      worker.failedAt = std::chrono::steady_clock::now();
+
+    return healthy;
+  }
+
+  void Scheduler::markFailed(WorkerState &worker, const std::string &reason) {
+    logger.warn("Worker {} failed: {}", worker.endpoint.toString(), reason);
+
+    std::lock_guard lock(mutex);
+    worker.failed = true;
+    worker.failedAt = std::chrono::steady_clock::now();
+  }
+} // namespace verte::remote
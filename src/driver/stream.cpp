@@ -0,0 +1,254 @@
+/**
+ * @brief Streaming compilation implementation.
+ * @file stream.cpp
+ */
+
+#include "verte/driver/stream.hpp"
+#include "verte/backend/codegen/header.hpp"
+#include "verte/backend/codegen/optimizer.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/items.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+
+#include "llvm/IR/Verifier.h"
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace verte::stream {
+  using lexer::Token;
+
+  /**
+   * @class ItemReader
+   * @brief Lexes a stream into top-level items, reading it chunk by chunk.
+   *
+   * A token is only taken once two characters follow it, the most the lexer
+   * looks ahead, or at the end of the stream. Otherwise, or when the lexer
+   * fails within two characters of the end of the chunk, i.e in a comment
+   * cut by it, the next chunk is read and the lexer starts again after the
+   * last token. An error further from the end is reported at once.
+   */
+  class ItemReader {
+  public:
+    /**
+     * @brief Construct a new ItemReader.
+     * @param in The stream to read.
+     * @param chunk The bytes read at once.
+     * @param stats Receives the size of the buffer.
+     */
+    ItemReader(std::istream &in, size_t chunk,
+               StreamingCompiler::Stats &stats)
+        : in(in), chunk(chunk), stats(stats),
+          splitter([this](std::vector<Token> item) {
+            ready.push_back(std::move(item));
+          }) {}
+
+    /**
+     * @brief Read the next item.
+     * @return The tokens of the item, ending with the end of stream, or
+     * nothing at the end of the source.
+     * @throws errors::LexicalError If the source is malformed.
+     */
+    std::optional<std::vector<Token>> next() {
+      while (ready.empty() && !done)
+        lex();
+
+      if (ready.empty())
+        return std::nullopt;
+
+      auto item = std::move(ready.front());
+      ready.pop_front();
+      return item;
+    }
+
+  private:
+    /**
+     * @brief Lex from the last token, until an item is ready or more of the
+     * stream is needed.
+     */
+    void lex() {
+      lexer::Lexer lexer(buffer, position, line, column);
+
+      try {
+        while (ready.empty()) {
+          Token token = lexer.nextToken();
+          const size_t end = token.meta.offset + token.meta.length;
+
+          const bool cut = token.is(Token::Type::EOS) || end + 2 > buffer.size();
+          if (cut && !ended)
+            break;
+
+          advance(end);
+          token.meta.offset += static_cast<uint32_t>(base);
+
+          const bool last = token.is(Token::Type::EOS);
+          splitter.feed(std::move(token));
+
+          if (last) {
+            done = true;
+            return;
+          }
+        }
+      }
+
+      // The error may only be the end of the chunk, if it got that far.
+      catch (const errors::LexicalError &) {
+        if (ended || lexer.getIndex() + 2 <= buffer.size())
+          throw;
+      }
+
+      if (ready.empty())
+        fill();
+    }
+
+    /**
+     * @brief Move past the taken text.
+     * @param end The end of the last token taken.
+     */
+    void advance(size_t end) {
+      for (; position < end; ++position) {
+        if (buffer[position] == '\n') {
+          line++;
+          column = 1;
+        }
+
+        else
+          column++;
+      }
+    }
+
+    /**
+     * @brief Drop the taken text and read a chunk.
+     */
+    void fill() {
+      buffer.erase(0, position);
+      base += position;
+      position = 0;
+
+      const size_t size = buffer.size();
+      buffer.resize(size + chunk);
+      in.read(buffer.data() + size, static_cast<std::streamsize>(chunk));
+      buffer.resize(size + static_cast<size_t>(in.gcount()));
+
+      ended = !in;
+      stats.maxBuffer = std::max(stats.maxBuffer, buffer.size());
+    }
+
+    std::istream &in;                /**< The stream read. */
+    size_t chunk;                    /**< The bytes read at once. */
+    StreamingCompiler::Stats &stats; /**< Receives the size of the buffer. */
+
+    std::string buffer;  /**< The text read and not taken yet. */
+    size_t base = 0;     /**< The offset of the buffer in the stream. */
+    size_t position = 0; /**< The end of the last token taken. */
+    uint32_t line = 1;   /**< The line at the position. */
+    uint32_t column = 1; /**< The column at the position. */
+    bool ended = false;  /**< Whether the stream was read entirely. */
+    bool done = false;   /**< Whether the end of stream was taken. */
+
+    lexer::ItemSplitter splitter;         /**< Splits the tokens. */
+    std::deque<std::vector<Token>> ready; /**< The items split. */
+  };
+
+  Result StreamingCompiler::compile(std::istream &in, const Sink &sink) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    Result result;
+    stats = {};
+
+    llvm::LLVMContext context;
+    codegen::Codegen codegen(
+        context, std::make_unique<llvm::Module>(options.moduleName, context),
+        options.codegen);
+    codegen::Optimizer optimizer(options.optLevel);
+
+    std::string declarations;
+    size_t pending = 0; // The instructions generated since the last flush.
+
+    // Verify then optimize the generated functions.
+    auto optimize = [&](const std::vector<llvm::Function *> &functions) {
+      for (auto *function : functions) {
+        std::string error;
+        llvm::raw_string_ostream errorStream(error);
+        if (options.verify && llvm::verifyFunction(*function, &errorStream))
+          throw errors::CodegenError("Invalid module generated: " +
+                                     errorStream.str());
+
+        optimizer.run(*function);
+        pending += function->getInstructionCount();
+      }
+    };
+
+    // Emit the module so far to the sink, the next items go to a new one.
+    auto flush = [&] {
+      auto module = codegen.split();
+      optimizer.finish(*module);
+
+      std::string error;
+      llvm::raw_string_ostream errorStream(error);
+      if (options.verify && llvm::verifyModule(*module, &errorStream))
+        throw errors::CodegenError("Invalid module generated: " +
+                                   errorStream.str());
+
+      Result emitted;
+      emit(*module, options, emitted);
+      if (!emitted.success()) {
+        result.diagnostics = std::move(emitted.diagnostics);
+        return false;
+      }
+
+      sink(emitted.output);
+      stats.modules++;
+      pending = 0;
+      return true;
+    };
+
+    auto fail = [&](const std::string &message, uint32_t line = 0,
+                    uint32_t column = 0) {
+      result.diagnostics.push_back(
+          {Diagnostic::Severity::ERROR, message, line, column});
+      return result;
+    };
+
+    try {
+      ItemReader reader(in, chunk, stats);
+
+      while (auto tokens = reader.next()) {
+        stats.items++;
+        stats.maxTokens = std::max(stats.maxTokens, tokens->size());
+
+        // The tokens and the tree of the item are freed at the end of the
+        // iteration.
+        nodes::Parser parser(std::move(*tokens));
+        const auto item = parser.parse();
+        optimize(codegen.append(*item));
+
+        if (options.codegen.shared)
+          declarations += codegen::generateDeclarations(*item);
+
+        if (pending >= threshold && !flush())
+          return result;
+      }
+
+      optimize(codegen.finalize());
+      if (!flush())
+        return result;
+    }
+
+    catch (const errors::LexicalError &e) {
+      return fail(e.what(), e.getLine(), e.getColumn());
+    }
+
+    catch (const std::exception &e) {
+      return fail(e.what());
+    }
+
+    if (options.codegen.shared)
+      result.header = codegen::wrapHeader(declarations, options.moduleName);
+
+    return result;
+  }
+} // namespace verte::stream
@@ -0,0 +1,184 @@
+/**
+ * @brief Incremental rebuilds implementation.
+ * @file watch.cpp
+ */
+
+#include "verte/driver/watch.hpp"
+#include "verte/errors.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <unordered_set>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace verte::watch {
+  using lexer::Token;
+
+  std::vector<std::pair<size_t, size_t>>
+  splitItems(const std::vector<Token> &tokens) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t begin = 0;
+    int depth = 0;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      const Token &token = tokens[i];
+      if (token.is(Token::Type::EOS))
+        break;
+
+      if (token.isOneOf({Token::Type::LBRACE, Token::Type::LPAREN}))
+        depth++;
+
+      else if (token.isOneOf({Token::Type::RBRACE, Token::Type::RPAREN}))
+        depth--;
+
+      // Only `;` and `}` end items, an unbalanced `)` is left to the parser.
+      const bool ends =
+          depth == 0 &&
+          (token.is(Token::Type::SEMICOLON) ||
+           (token.is(Token::Type::RBRACE) &&
+            !(i + 1 < tokens.size() && tokens[i + 1].is(Token::Type::ELSE))));
+
+      if (ends) {
+        ranges.emplace_back(begin, i + 1);
+        begin = i + 1;
+      }
+    }
+
+    // An unterminated item still gets parsed, to report its error.
+    if (begin + 1 < tokens.size())
+      ranges.emplace_back(begin, tokens.size() - 1);
+
+    return ranges;
+  }
+
+  Result IncrementalCompiler::compile(std::string_view source) {
+    utils::logging::ScopedLevel level(options.logLevel);
+    Result result;
+    stats = {};
+
+    std::vector<const nodes::ProgramNode *> parts;
+    std::unordered_set<std::string> used;
+
+    try {
+      lexer::Lexer lexer(source);
+      const auto tokens = lexer.allTokens();
+
+      for (const auto &[begin, end] : splitItems(tokens)) {
+        // Key the item by its tokens, ignoring their position.
+        std::string key;
+        for (size_t i = begin; i < end; ++i) {
+          key += static_cast<char>(tokens[i].type);
+          key += tokens[i].getValue();
+          key += '\0';
+        }
+
+        stats.items++;
+        auto &item = items[key];
+        if (item)
+          stats.reused++;
+
+        // Parse the new items on their own.
+        else {
+          std::vector<Token> itemTokens(tokens.begin() + begin,
+                                        tokens.begin() + end);
+          itemTokens.emplace_back("END", Token::Type::EOS,
+                                  tokens[end - 1].meta);
+
+          nodes::Parser parser(std::move(itemTokens));
+          item = parser.parse();
+        }
+
+        parts.push_back(item.get());
+        used.insert(std::move(key));
+      }
+    }
+
+    catch (const errors::LexicalError &e) {
+      result.diagnostics.push_back({Diagnostic::Severity::ERROR, e.what(),
+                                    e.getLine(), e.getColumn()});
+    }
+
+    // Forget the items gone from the source, and the one which failed.
+    std::erase_if(items, [&](const auto &entry) {
+      return !entry.second || !used.contains(entry.first);
+    });
+
+    if (!result.success())
+      return result;
+
+    llvm::LLVMContext context;
+    auto module = generate(parts, context, options, result);
+    if (module) {
+      optimize(*module, options);
+      emit(*module, options, result);
+    }
+
+    return result;
+  }
+
+  Watcher::Watcher(std::filesystem::path file,
+                   std::chrono::milliseconds debounce)
+      : file(std::move(file)), debounce(debounce) {
+    fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0)
+      throw errors::IOError(std::string("Failed to watch: ") +
+                                std::strerror(errno),
+                            this->file);
+
+    auto directory = this->file.parent_path();
+    if (directory.empty())
+      directory = ".";
+
+    constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    if (inotify_add_watch(fd, directory.c_str(), mask) < 0) {
+      const std::string error = std::strerror(errno);
+      close(fd);
+      throw errors::IOError("Failed to watch: " + error, this->file);
+    }
+  }
+
+  Watcher::~Watcher() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  void Watcher::wait() {
+    // Wait for a save, then for the end of the burst, i.e swap files.
+    while (readEvents(-1) != true)
+      ;
+
+    while (readEvents(static_cast<int>(debounce.count())))
+      ;
+  }
+
+  std::optional<bool> Watcher::readEvents(int timeout) {
+    pollfd pending{fd, POLLIN, 0};
+    if (poll(&pending, 1, timeout) <= 0)
+      return std::nullopt;
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t size = read(fd, buffer, sizeof(buffer));
+    if (size <= 0)
+      return std::nullopt;
+
+    const std::string name = file.filename().string();
+    bool changed = false;
+
+    for (ssize_t offset = 0; offset < size;) {
+      const auto *event =
+          reinterpret_cast<const inotify_event *>(buffer + offset);
+      if (event->len > 0 && name == event->name)
+        changed = true;
+
+      offset += sizeof(inotify_event) + event->len;
+    }
+
+    return changed;
+  }
+} // namespace verte::watch
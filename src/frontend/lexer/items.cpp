@@ -0,0 +1,43 @@
+/**
+ * @brief Item splitter implementation.
+ * @file items.cpp
+ */
+
+#include "verte/frontend/lexer/items.hpp"
+
+namespace verte::lexer {
+  void ItemSplitter::feed(Token token) {
+    // A `}` closing an item only ends it if no `else` follows.
+    if (closed && !token.is(Token::Type::ELSE))
+      flush();
+
+    closed = false;
+
+    // An unterminated item still gets handed out, to report its error.
+    if (token.is(Token::Type::EOS)) {
+      if (!item.empty())
+        flush();
+
+      return;
+    }
+
+    if (token.isOneOf({Token::Type::LBRACE, Token::Type::LPAREN}))
+      depth++;
+
+    else if (token.isOneOf({Token::Type::RBRACE, Token::Type::RPAREN}))
+      depth--;
+
+    const bool semicolon = token.is(Token::Type::SEMICOLON);
+    closed = depth == 0 && token.is(Token::Type::RBRACE);
+    item.push_back(std::move(token));
+
+    if (depth == 0 && semicolon)
+      flush();
+  }
+
+  void ItemSplitter::flush() {
+    item.emplace_back("END", Token::Type::EOS, item.back().meta);
+    handler(std::move(item));
+    item.clear();
+  }
+} // namespace verte::lexer
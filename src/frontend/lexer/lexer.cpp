@@ -9,9 +9,10 @@
 namespace verte::lexer {
   [[nodiscard]] Token Lexer::nextToken() {
     char current_char = skip();
+    start = {line, column, static_cast<uint32_t>(index)};
 
     if (current_char == '\0')
-      return Token("\0", Token::Type::EOS, {line, column});
+      return Token("\0", Token::Type::EOS, meta());
 
     else if (std::isdigit(current_char))
       return parseNumber();
@@ -34,8 +35,9 @@ namespace verte::lexer {
       tokens.emplace_back(std::move(token));
     }
 
-    tokens.push_back(
-        Token("END", Token::Type::EOS, {line, column})); // Padding for EOF.
+    // Padding for EOF.
+    tokens.push_back(Token("END", Token::Type::EOS,
+                           {line, column, static_cast<uint32_t>(index)}));
 
     return tokens;
   }
@@ -70,7 +72,7 @@ namespace verte::lexer {
     return source[index + offset];
   }
 
-  char Lexer::skip() noexcept {
+  char Lexer::skip() {
     skipWs();
     return skipComments();
   }
@@ -83,7 +85,7 @@ namespace verte::lexer {
     return currentChar();
   }
 
-  char Lexer::skipComments() noexcept {
+  char Lexer::skipComments() {
     if (currentChar() == '/' && peekChar() == '/') {
       // Single-line comment.
       while (currentChar() != '\n' && !atEof()) {
@@ -155,7 +157,7 @@ namespace verte::lexer {
       error("Unterminated string.");
 
     nextChar(); // Skip the closing quote.
-    return Token(value, Token::Type::STRING, {line, column});
+    return Token(value, Token::Type::STRING, meta());
   }
 
   [[nodiscard]] Token Lexer::parseNumber() {
@@ -167,7 +169,7 @@ namespace verte::lexer {
       value += walk([](char c) { return std::isdigit(c); });
     }
 
-    return Token(value, Token::Type::NUMBER, {line, column});
+    return Token(value, Token::Type::NUMBER, meta());
   }
 
   [[nodiscard]] Token Lexer::parseIdentifier() {
@@ -175,11 +177,11 @@ namespace verte::lexer {
         walk([](char c) { return std::isalnum(c) || c == '_'; });
 
     // Check for keywords.
-    if (tokens::RESERVED.find(value) != tokens::RESERVED.end()) {
-      return Token(value, tokens::RESERVED.at(value), {line, column});
-    }
+    if (const auto keyword = tokens::RESERVED.find(value);
+        keyword != tokens::RESERVED.end())
+      return Token(value, keyword->second, meta());
 
-    return Token(value, Token::Type::IDENTIFIER, {line, column});
+    return Token(value, Token::Type::IDENTIFIER, meta());
   }
 
   [[nodiscard]] Token Lexer::parseSymbol() {
@@ -191,13 +193,19 @@ namespace verte::lexer {
       value += currentChar();
     }
 
-    if (tokens::ATOMIC.find(value) != tokens::ATOMIC.end()) {
+    if (const auto symbol = tokens::ATOMIC.find(value);
+        symbol != tokens::ATOMIC.end()) {
       nextChar(); // Go to the next character.
-      return Token(value, tokens::ATOMIC.at(value), {line, column});
+      return Token(value, symbol->second, meta());
     }
 
     nextChar(); // Go to the next character.
-    return Token(value, Token::Type::INVALID, {line, column});
+    return Token(value, Token::Type::INVALID, meta());
+  }
+
+  [[nodiscard]] Token::Meta Lexer::meta() const noexcept {
+    return {start.line, start.column, start.offset,
+            static_cast<uint32_t>(index - start.offset)};
   }
 
   [[noreturn]] void Lexer::error(const std::string &message) {
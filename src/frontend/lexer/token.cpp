@@ -50,7 +50,8 @@ namespace verte::lexer {
       Token::Type::OR, Token::Type::AND,
       Token::Type::TRUE, Token::Type::FALSE,
       Token::Type::FOR, Token::Type::WHILE,
-      Token::Type::FN, Token::Type::RETURN
+      Token::Type::FN, Token::Type::RETURN,
+      Token::Type::BENCH, Token::Type::ASM
     });
     // clang-format on
   }
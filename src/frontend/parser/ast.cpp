@@ -64,4 +64,12 @@ namespace verte::nodes {
   auto ReturnNode::accept(ASTVisitor &visitor) const -> RetT {
     return visitor.visit(*this);
   }
+
+  auto BenchNode::accept(ASTVisitor &visitor) const -> RetT {
+    return visitor.visit(*this);
+  }
+
+  auto AsmNode::accept(ASTVisitor &visitor) const -> RetT {
+    return visitor.visit(*this);
+  }
 } // namespace verte::nodes
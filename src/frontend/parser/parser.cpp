@@ -5,6 +5,7 @@
 
 #include "verte/frontend/parser/parser.hpp"
 #include "verte/errors.hpp"
+#include <algorithm>
 #include <memory>
 
 namespace verte::nodes {
@@ -24,6 +25,10 @@ namespace verte::nodes {
     auto token = currentToken();
     auto next = peekToken();
 
+    // Check if the current token starts the attributes of a declaration.
+    if (token.is(Token::Type::HASH))
+      return parseAttributed();
+
     // Check if the current token is a variable declaration.
     if ((token.is(Token::Type::IDENTIFIER) || token.is(Token::Type::CONST)) &&
         (next.is(Token::Type::IDENTIFIER) || next.is(Token::Type::COLON)))
@@ -56,12 +61,17 @@ namespace verte::nodes {
     else if (token.is(Token::Type::RETURN))
       return parseReturn();
 
+    // Check if the current token is a benchmark block.
+    else if (token.is(Token::Type::BENCH))
+      return parseBench();
+
     // Default to an expression statement.
     return parseExprStmt();
   }
 
-  [[nodiscard]] NodePtr Parser::parseVarDecl() {
+  [[nodiscard]] NodePtr Parser::parseVarDecl(Attributes attributes) {
     // VAR_DECL -> (CONST)? IDENTIFIER ':' TYPE '=' EXPR ';'
+    size_t begin = index;
     bool isConst = false;
     if (match(Token::Type::CONST))
       isConst = true;
@@ -84,10 +94,14 @@ namespace verte::nodes {
       error("Expected a `;` after the expression.");
 
     auto value = ident.getValue();
-    return create<VarDeclNode>(value, type, std::move(expr), isConst);
+    auto node = create<VarDeclNode>(value, type, std::move(expr), isConst,
+                                    std::move(attributes));
+    node->setLocation(span(begin), locate(ident));
+    return node;
   }
 
   [[nodiscard]] NodePtr Parser::parseAssign() {
+    size_t begin = index;
     auto ident = currentToken();
 
     if (!match(Token::Type::IDENTIFIER))
@@ -100,11 +114,14 @@ namespace verte::nodes {
     if (!match(Token::Type::SEMICOLON))
       error("Expected a `;` after the expression.");
 
-    return create<AssignNode>(ident.getValue(), std::move(expr));
+    auto node = create<AssignNode>(ident.getValue(), std::move(expr));
+    node->setLocation(span(begin), locate(ident));
+    return node;
   }
 
   [[nodiscard]] IfNodePtr Parser::parseIf() {
     // IF_STMT -> IF '[' EXPR ']' THEN '{' STMT* '}'
+    size_t begin = index;
     if (!match(Token::Type::IF))
       error("Expected an `if` for the if statement.");
 
@@ -119,7 +136,9 @@ namespace verte::nodes {
       error("Expected a `then` after the condition.");
 
     auto then = parseBlock();
-    return std::make_unique<IfNode>(std::move(condition), std::move(then));
+    auto node = std::make_unique<IfNode>(std::move(condition), std::move(then));
+    node->setLocation(span(begin));
+    return node;
   }
 
   [[nodiscard]] NodePtr Parser::parseIfElse(IfNodePtr ifStmt) {
@@ -128,27 +147,38 @@ namespace verte::nodes {
       error("Expected an `else` after the if statement.");
 
     auto elseStmt = parseBlock();
-    return create<IfElseNode>(std::move(ifStmt), std::move(elseStmt));
+    auto location = spanFrom(ifStmt->getLocation().offset);
+    auto node = create<IfElseNode>(std::move(ifStmt), std::move(elseStmt));
+    node->setLocation(location);
+    return node;
   }
 
-  [[nodiscard]] NodePtr Parser::parseFuncDecl() {
+  [[nodiscard]] NodePtr Parser::parseFuncDecl(Attributes attributes) {
     // FUNC_DECL -> FN IDENTIFIER '(' PARAMS ')' '->' TYPE (';' | '{' STMT* '}')
+    size_t begin = index;
     if (!match(Token::Type::FN))
       error("Expected a `fn` for the function declaration.");
 
-    auto proto = parseProto();
+    auto proto = parseProto(std::move(attributes));
 
-    if (match(Token::Type::SEMICOLON))
+    if (match(Token::Type::SEMICOLON)) {
+      proto->setLocation(span(begin), proto->getNameLocation());
       return proto;
+    }
 
-    else if (currentToken().is(Token::Type::LBRACE))
-      return create<FuncDeclNode>(std::move(proto), parseBlock());
+    else if (currentToken().is(Token::Type::LBRACE)) {
+      auto name = proto->getNameLocation();
+      auto node = create<FuncDeclNode>(std::move(proto), parseBlock());
+      node->setLocation(span(begin), name);
+      return node;
+    }
 
     error("Expected a `;` or `{` after the function prototype.");
   }
 
-  [[nodiscard]] ProtoPtr Parser::parseProto() {
+  [[nodiscard]] ProtoPtr Parser::parseProto(Attributes attributes) {
     // PROTO -> IDENTIFIER '(' PARAMS ')' '->' TYPE
+    size_t begin = index;
     auto ident = currentToken();
     if (!match(Token::Type::IDENTIFIER))
       error("Expected an identifier for the function name.");
@@ -164,7 +194,67 @@ namespace verte::nodes {
     }
 
     index += 2; // Skip the `->` token.
-    return std::make_unique<ProtoNode>(ident.getValue(), params, parseType());
+    auto node = std::make_unique<ProtoNode>(ident.getValue(), params,
+                                            parseType(), std::move(attributes));
+    node->setLocation(span(begin), locate(ident));
+    return node;
+  }
+
+  [[nodiscard]] NodePtr Parser::parseAttributed() {
+    // ATTRIBUTED -> ATTRIBUTES (FUNC_DECL | VAR_DECL)
+    auto attributes = parseAttributes();
+    auto token = currentToken();
+    auto next = peekToken();
+
+    if (token.is(Token::Type::FN))
+      return parseFuncDecl(std::move(attributes));
+
+    else if ((token.is(Token::Type::IDENTIFIER) ||
+              token.is(Token::Type::CONST)) &&
+             (next.is(Token::Type::IDENTIFIER) || next.is(Token::Type::COLON)))
+      return parseVarDecl(std::move(attributes));
+
+    error("Expected a function or variable declaration after the attributes.");
+  }
+
+  [[nodiscard]] Attributes Parser::parseAttributes() {
+    // ATTRIBUTES -> ('#' '[' ATTRIBUTE (',' ATTRIBUTE)* ']')+
+    // ATTRIBUTE -> IDENTIFIER ('(' ARG (',' ARG)* ')')?
+    Attributes attributes;
+
+    while (match(Token::Type::HASH)) {
+      if (!match(Token::Type::LBRACKET))
+        error("Expected a `[` after the `#`.");
+
+      do {
+        auto ident = currentToken();
+        if (!match(Token::Type::IDENTIFIER))
+          error("Expected an identifier for the attribute name.");
+
+        Attribute attribute{ident.getValue(), {}};
+
+        // Parse the arguments of the attribute, if any.
+        if (match(Token::Type::LPAREN)) {
+          do {
+            auto arg = currentToken();
+            if (!match({Token::Type::IDENTIFIER, Token::Type::NUMBER}))
+              error("Expected an identifier or number as attribute argument.");
+
+            attribute.args.push_back(arg.getValue());
+          } while (match(Token::Type::COMMA));
+
+          if (!match(Token::Type::RPAREN))
+            error("Expected a `)` after the attribute arguments.");
+        }
+
+        attributes.push_back(std::move(attribute));
+      } while (match(Token::Type::COMMA));
+
+      if (!match(Token::Type::RBRACKET))
+        error("Expected a `]` after the attributes.");
+    }
+
+    return attributes;
   }
 
   [[nodiscard]] std::vector<Parameter> Parser::parseParams() {
@@ -199,20 +289,37 @@ namespace verte::nodes {
       error("Expected a `:` after the parameter name.");
 
     auto type = parseType();
-    return Parameter(ident.getValue(), type);
+    return Parameter(ident.getValue(), type, locate(ident));
   }
 
   [[nodiscard]] TypeInfo Parser::parseType() {
-    // TYPE -> IDENTIFIER
+    // TYPE -> IDENTIFIER | 'chan' '<' IDENTIFIER '>'
     auto token = currentToken();
     if (!match(Token::Type::IDENTIFIER))
       error("Expected a type identifier.");
 
-    return TypeInfo(TypeInfo::toEnum(token.getValue()), token.getValue());
+    if (token.getValue() != "chan")
+      return TypeInfo(TypeInfo::toEnum(token.getValue()), token.getValue());
+
+    auto element = peekToken();
+    if (!match(Token::Type::LESS) || !match(Token::Type::IDENTIFIER))
+      error("Expected the element type of the channel, i.e `chan<int>`.");
+
+    const auto elementType = TypeInfo::toEnum(element.getValue());
+    if (elementType == TypeInfo::DataType::VOID ||
+        elementType == TypeInfo::DataType::UNKNOWN)
+      error("Channels carry `int`, `float`, `double`, `str` or `bool` values.");
+
+    if (!match(Token::Type::GREATER))
+      error("Expected a `>` after the element type of the channel.");
+
+    return TypeInfo(TypeInfo::DataType::CHANNEL,
+                    "chan<" + element.getValue() + ">");
   }
 
   [[nodiscard]] NodePtr Parser::parseReturn() {
     // RETURN_STMT -> RETURN EXPR ';'
+    size_t begin = index;
     if (!match(Token::Type::RETURN))
       error("Expected a `return` for the return statement.");
 
@@ -220,7 +327,24 @@ namespace verte::nodes {
     if (!match(Token::Type::SEMICOLON))
       error("Expected a `;` after the expression.");
 
-    return create<ReturnNode>(std::move(expr));
+    auto node = create<ReturnNode>(std::move(expr));
+    node->setLocation(span(begin));
+    return node;
+  }
+
+  [[nodiscard]] NodePtr Parser::parseBench() {
+    // BENCH -> BENCH IDENTIFIER '{' STMT* '}'
+    size_t begin = index;
+    if (!match(Token::Type::BENCH))
+      error("Expected a `bench` for the benchmark block.");
+
+    auto ident = currentToken();
+    if (!match(Token::Type::IDENTIFIER))
+      error("Expected an identifier for the benchmark name.");
+
+    auto node = create<BenchNode>(ident.getValue(), parseBlock());
+    node->setLocation(span(begin), locate(ident));
+    return node;
   }
 
   [[nodiscard]] NodePtr Parser::parseExprStmt() {
@@ -234,6 +358,7 @@ namespace verte::nodes {
 
   [[nodiscard]] BlockPtr Parser::parseBlock() {
     // BLOCK -> '{' STMT* '}'
+    size_t begin = index;
     std::vector<NodePtr> body;
     if (!match(Token::Type::LBRACE))
       error("Expected a `{` to start a block.");
@@ -242,7 +367,9 @@ namespace verte::nodes {
     while (!match(Token::Type::RBRACE))
       body.push_back(parseStmt());
 
-    return std::make_unique<BlockNode>(std::move(body));
+    auto node = std::make_unique<BlockNode>(std::move(body));
+    node->setLocation(span(begin));
+    return node;
   }
 
   [[nodiscard]] NodePtr Parser::parseExpr() {
@@ -263,7 +390,9 @@ namespace verte::nodes {
         // Parse the right-hand side of the binary expression with higher
         // precedence.
         auto rhs = parseBinary(currentPrec + 1);
+        auto location = spanFrom(lhs->getLocation().offset);
         lhs = create<BinaryNode>(std::move(lhs), std::move(rhs), op.getValue());
+        lhs->setLocation(location);
         currentPrec = getPrecedence(currentToken().type);
       } else {
         break;
@@ -276,11 +405,14 @@ namespace verte::nodes {
   [[nodiscard]] NodePtr Parser::parseUnary() {
     // UNARY -> (UNARY_OP UNARY | PRIMARY)
     if (currentToken().isOneOf(tokens::UNARY_OPERATOR_TYPES)) {
+      size_t begin = index;
       auto op = currentToken();
       index++; // Consume the operator.
 
       auto expr = parseUnary();
-      return create<UnaryNode>(std::move(expr), op.getValue());
+      auto node = create<UnaryNode>(std::move(expr), op.getValue());
+      node->setLocation(span(begin));
+      return node;
     }
 
     // If it's not a unary operator, parse the primary expression.
@@ -288,28 +420,50 @@ namespace verte::nodes {
   }
 
   [[nodiscard]] NodePtr Parser::parsePrimary() {
-    // PRIMARY -> LITERAL | IDENTIFIER | '(' EXPR ')'
+    // PRIMARY -> LITERAL | IDENTIFIER | ASM | '(' EXPR ')'
     auto token = currentToken();
 
+    if (token.is(Token::Type::ASM))
+      return parseAsm();
+
     // Check for literals.
     if (match(Token::Type::STRING)) {
       TypeInfo type(TypeInfo::DataType::STRING);
-      return create<LiteralNode>(token.getValue(), type);
+      auto node = create<LiteralNode>(token.getValue(), type);
+      node->setLocation(locate(token));
+      return node;
     }
 
     else if (match(Token::Type::NUMBER)) {
       TypeInfo type(TypeInfo::DataType::INTEGER);
-      return create<LiteralNode>(token.getValue(), type);
+      auto node = create<LiteralNode>(token.getValue(), type);
+      node->setLocation(locate(token));
+      return node;
     }
 
     else if (match(Token::Type::TRUE) || match(Token::Type::FALSE)) {
       TypeInfo type(TypeInfo::DataType::BOOL);
-      return create<LiteralNode>(token.getValue(), type);
+      auto node = create<LiteralNode>(token.getValue(), type);
+      node->setLocation(locate(token));
+      return node;
     }
 
     else if (match(Token::Type::IDENTIFIER)) {
       TypeInfo type(TypeInfo::DataType::UNKNOWN);
       auto ident = std::make_unique<VariableNode>(token.getValue());
+      ident->setLocation(locate(token), locate(token));
+
+      // A channel is created by calling its type, i.e `chan<int>(64)`.
+      if (token.getValue() == "chan" && currentToken().is(Token::Type::LESS) &&
+          peekToken(2).is(Token::Type::GREATER)) {
+        const size_t begin = --index;
+        auto type = parseType();
+        ident = std::make_unique<VariableNode>(type.name);
+        ident->setLocation(span(begin), span(begin));
+
+        if (!currentToken().is(Token::Type::LPAREN))
+          error("Expected a `(` after the channel type.");
+      }
 
       // Check if it's a function call.
       if (currentToken().is(Token::Type::LPAREN))
@@ -357,7 +511,61 @@ namespace verte::nodes {
     if (!match(Token::Type::RPAREN))
       error("Expected a `)` after the argument list.");
 
-    return create<CallNode>(std::move(callee), std::move(args));
+    auto name = callee->getNameLocation();
+    auto node = create<CallNode>(std::move(callee), std::move(args));
+    node->setLocation(spanFrom(name.offset), name);
+    return node;
+  }
+
+  [[nodiscard]] NodePtr Parser::parseAsm() {
+    // ASM -> ASM ('volatile')? '(' STRING ',' STRING (',' EXPR)* ')'
+    //        ('->' TYPE)?
+    size_t begin = index;
+    if (!match(Token::Type::ASM))
+      error("Expected an `asm` for the inline assembly.");
+
+    // `volatile` is only a keyword here.
+    bool isVolatile = false;
+    if (currentToken().is(Token::Type::IDENTIFIER) &&
+        currentToken().getValue() == "volatile") {
+      isVolatile = true;
+      index++;
+    }
+
+    if (!match(Token::Type::LPAREN))
+      error("Expected a `(` after `asm`.");
+
+    auto code = currentToken();
+    if (!match(Token::Type::STRING))
+      error("Expected the assembly template string.");
+
+    if (!match(Token::Type::COMMA))
+      error("Expected a `,` after the assembly template.");
+
+    auto constraints = currentToken();
+    if (!match(Token::Type::STRING))
+      error("Expected the assembly constraints string.");
+
+    std::vector<NodePtr> operands;
+    while (match(Token::Type::COMMA))
+      operands.push_back(parseExpr());
+
+    if (!match(Token::Type::RPAREN))
+      error("Expected a `)` after the assembly operands.");
+
+    // Without an output, the assembly is a statement.
+    const bool hasOutput = currentToken().is(Token::Type::MINUS) &&
+                           peekToken().is(Token::Type::GREATER);
+    if (hasOutput)
+      index += 2; // Skip the `->` token.
+
+    TypeInfo type =
+        hasOutput ? parseType() : TypeInfo(TypeInfo::DataType::VOID);
+
+    auto node = create<AsmNode>(code.getValue(), constraints.getValue(),
+                                std::move(operands), type, isVolatile);
+    node->setLocation(span(begin));
+    return node;
   }
 
   [[nodiscard]] Token Parser::currentToken() const {
@@ -407,13 +615,28 @@ namespace verte::nodes {
   }
 
   [[noreturn]] void Parser::error(const std::string &message) {
-    auto [line, column] = currentToken().meta;
+    auto [line, column, offset, length] = currentToken().meta;
     std::string error = std::format("{}:{}: {}", line, column, message);
 
     logger.error(error);
     throw errors::ParserError(error, line, column);
   }
 
+  [[nodiscard]] Location Parser::locate(const Token &token) noexcept {
+    return {token.meta.offset, token.meta.length};
+  }
+
+  [[nodiscard]] Location Parser::span(size_t begin) const {
+    return spanFrom(tokens[std::min(begin, tokens.size() - 1)].meta.offset);
+  }
+
+  [[nodiscard]] Location Parser::spanFrom(uint32_t offset) const {
+    // Up to the end of the last consumed token.
+    const auto &last = tokens[std::min(index, tokens.size()) - 1].meta;
+    const uint32_t end = last.offset + last.length;
+    return {offset, end > offset ? end - offset : 0};
+  }
+
   template <typename T, typename... Args> NodePtr Parser::create(Args... args) {
     return std::make_unique<T>(std::forward<Args>(args)...);
   }
@@ -0,0 +1,261 @@
+/**
+ * @brief JSON dump implementation.
+ * @file json.cpp
+ */
+
+#include "verte/frontend/visitors/json.hpp"
+
+namespace verte::visitors {
+  auto JsonPrinter::visit(const ProgramNode &node) -> RetT {
+    for (const auto &stmt : node.getBody()) {
+      stmt->accept(*this);
+      writer.put('\n');
+    }
+
+    writer.flush();
+    return {};
+  }
+
+  auto JsonPrinter::visit(const LiteralNode &node) -> RetT {
+    open("Literal", node);
+    field("type", node.getType().name);
+    field("value", node.getValue());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const VarDeclNode &node) -> RetT {
+    open("VarDecl", node);
+    field("name", node.getName());
+    field("type", node.getType().name);
+    key("constant");
+    writer << (node.isConstant() ? "true" : "false");
+    attributes(node.getAttributes());
+    field("value", node.getValue().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const AssignNode &node) -> RetT {
+    open("Assign", node);
+    field("name", node.getName());
+    field("value", node.getValue().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const VariableNode &node) -> RetT {
+    open("Variable", node);
+    field("name", node.getName());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const IfNode &node) -> RetT {
+    open("If", node);
+    field("cond", node.getCond().get());
+    field("body", node.getBlock().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const IfElseNode &node) -> RetT {
+    open("IfElse", node);
+    field("if", node.getIfNode().get());
+    field("else", node.getElseBlock().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const BinaryNode &node) -> RetT {
+    open("Binary", node);
+    field("op", node.getOp());
+    field("lhs", node.getLHS().get());
+    field("rhs", node.getRHS().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const UnaryNode &node) -> RetT {
+    open("Unary", node);
+    field("op", node.getOp());
+    field("operand", node.getOperand().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const ProtoNode &node) -> RetT {
+    open("Proto", node);
+    field("name", node.getName());
+    attributes(node.getAttributes());
+
+    key("params");
+    writer.put('[');
+    for (size_t i = 0; i < node.getParams().size(); ++i) {
+      const auto &param = node.getParams()[i];
+      writer << (i == 0 ? "{\"name\":" : ",{\"name\":");
+      string(param.name);
+      writer << ",\"type\":";
+      string(param.type.name);
+      writer.put('}');
+    }
+
+    writer.put(']');
+    field("returns", node.getRetType().name);
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const BlockNode &node) -> RetT {
+    open("Block", node);
+    field("body", node.getBody());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const FuncDeclNode &node) -> RetT {
+    open("FuncDecl", node);
+    field("proto", node.getProto().get());
+    field("body", node.getBody().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const CallNode &node) -> RetT {
+    open("Call", node);
+    field("callee", node.getCallee()->getName());
+    field("args", node.getArgs());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const ReturnNode &node) -> RetT {
+    open("Return", node);
+    field("value", node.getValue().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const BenchNode &node) -> RetT {
+    open("Bench", node);
+    field("name", node.getName());
+    field("body", node.getBody().get());
+    writer.put('}');
+    return {};
+  }
+
+  auto JsonPrinter::visit(const AsmNode &node) -> RetT {
+    open("Asm", node);
+    field("code", node.getCode());
+    field("constraints", node.getConstraints());
+    field("type", node.getType().name);
+    key("volatile");
+    writer << (node.hasSideEffects() ? "true" : "false");
+    field("operands", node.getOperands());
+    writer.put('}');
+    return {};
+  }
+
+  void JsonPrinter::open(std::string_view kind, const ASTNode &node) {
+    writer << "{\"kind\":\"" << kind << "\",\"offset\":";
+    writer.number(node.getLocation().offset) << ",\"length\":";
+    writer.number(node.getLocation().length);
+  }
+
+  void JsonPrinter::key(std::string_view name) {
+    writer << ",\"" << name << "\":";
+  }
+
+  void JsonPrinter::field(std::string_view name, std::string_view value) {
+    key(name);
+    string(value);
+  }
+
+  void JsonPrinter::field(std::string_view name, const ASTNode *child) {
+    key(name);
+    if (child)
+      child->accept(*this);
+    else
+      writer << "null";
+  }
+
+  void JsonPrinter::field(std::string_view name,
+                          const std::vector<NodePtr> &children) {
+    key(name);
+    writer.put('[');
+
+    for (size_t i = 0; i < children.size(); ++i) {
+      if (i > 0)
+        writer.put(',');
+
+      children[i]->accept(*this);
+    }
+
+    writer.put(']');
+  }
+
+  void JsonPrinter::attributes(const Attributes &attributes) {
+    if (attributes.empty())
+      return;
+
+    key("attributes");
+    writer.put('[');
+
+    for (size_t i = 0; i < attributes.size(); ++i) {
+      writer << (i == 0 ? "{\"name\":" : ",{\"name\":");
+      string(attributes[i].name);
+      writer << ",\"args\":[";
+
+      for (size_t j = 0; j < attributes[i].args.size(); ++j) {
+        if (j > 0)
+          writer.put(',');
+
+        string(attributes[i].args[j]);
+      }
+
+      writer << "]}";
+    }
+
+    writer.put(']');
+  }
+
+  void JsonPrinter::string(std::string_view value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    writer.put('"');
+
+    // Copy the runs needing no escape at once.
+    size_t run = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+      const auto c = static_cast<unsigned char>(value[i]);
+      if (c >= 0x20 && c != '"' && c != '\\')
+        continue;
+
+      writer.write(value.substr(run, i - run));
+      run = i + 1;
+
+      switch (c) {
+        case '"':
+          writer << "\\\"";
+          break;
+
+        case '\\':
+          writer << "\\\\";
+          break;
+
+        case '\n':
+          writer << "\\n";
+          break;
+
+        case '\t':
+          writer << "\\t";
+          break;
+
+        default:
+          writer << "\\u00" << HEX[c >> 4] << HEX[c & 0xf];
+      }
+    }
+
+    writer.write(value.substr(run));
+    writer.put('"');
+  }
+} // namespace verte::visitors
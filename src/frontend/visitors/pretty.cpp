@@ -10,12 +10,15 @@
 namespace verte::visitors {
   auto PrettyPrinter::visit(const ProgramNode &node) -> RetT {
     printIndent() << "Program Node:\n";
-    IndentGuard guard(*this);
 
-    for (const auto &stmt : node.getBody()) {
-      stmt->accept(*this);
+    {
+      IndentGuard guard(*this);
+      for (const auto &stmt : node.getBody()) {
+        stmt->accept(*this);
+      }
     }
 
+    writer.flush();
     return {};
   }
 
@@ -29,6 +32,7 @@ namespace verte::visitors {
                   << node.getType().name << '\n';
 
     IndentGuard guard(*this);
+    printAttributes(node.getAttributes());
     node.getValue()->accept(*this);
     printIndent() << "Constant: " << (node.isConstant() ? "true" : "false")
                   << '\n';
@@ -96,6 +100,7 @@ namespace verte::visitors {
   auto PrettyPrinter::visit(const ProtoNode &node) -> RetT {
     printIndent() << "Proto Node: " << node.getName() << '\n';
     IndentGuard guard(*this);
+    printAttributes(node.getAttributes());
 
     for (const auto &param : node.getParams()) {
       printIndent() << "Arg: " << param.name << " : " << param.type.name
@@ -148,4 +153,37 @@ namespace verte::visitors {
     node.getValue()->accept(*this);
     return {};
   }
+
+  auto PrettyPrinter::visit(const BenchNode &node) -> RetT {
+    printIndent() << "Bench Node: " << node.getName() << '\n';
+    IndentGuard guard(*this);
+
+    node.getBody()->accept(*this);
+    return {};
+  }
+
+  auto PrettyPrinter::visit(const AsmNode &node) -> RetT {
+    printIndent() << "Asm Node: " << node.getType().name
+                  << (node.hasSideEffects() ? " (volatile)\n" : "\n");
+    IndentGuard guard(*this);
+
+    printIndent() << "Code: " << node.getCode() << '\n';
+    printIndent() << "Constraints: " << node.getConstraints() << '\n';
+    for (const auto &operand : node.getOperands())
+      operand->accept(*this);
+
+    return {};
+  }
+
+  void PrettyPrinter::printAttributes(const Attributes &attributes) {
+    for (const auto &attribute : attributes) {
+      printIndent() << "Attribute: " << attribute.name;
+
+      for (size_t i = 0; i < attribute.args.size(); ++i) {
+        writer << (i == 0 ? "(" : ", ") << attribute.args[i];
+      }
+
+      writer << (attribute.args.empty() ? "\n" : ")\n");
+    }
+  }
 } // namespace verte::visitors
@@ -0,0 +1,192 @@
+/**
+ * @brief S-expression dump implementation.
+ * @file sexpr.cpp
+ */
+
+#include "verte/frontend/visitors/sexpr.hpp"
+
+namespace verte::visitors {
+  auto SexprPrinter::visit(const ProgramNode &node) -> RetT {
+    for (const auto &stmt : node.getBody()) {
+      stmt->accept(*this);
+      writer.put('\n');
+    }
+
+    writer.flush();
+    return {};
+  }
+
+  auto SexprPrinter::visit(const LiteralNode &node) -> RetT {
+    if (node.getType().dataType == TypeInfo::DataType::STRING)
+      string(node.getValue());
+    else
+      writer << node.getValue();
+
+    return {};
+  }
+
+  auto SexprPrinter::visit(const VarDeclNode &node) -> RetT {
+    writer << (node.isConstant() ? "(const " : "(var ") << node.getName()
+           << ' ' << node.getType().name << ' ';
+    node.getValue()->accept(*this);
+    attributes(node.getAttributes());
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const AssignNode &node) -> RetT {
+    writer << "(set " << node.getName() << ' ';
+    node.getValue()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const VariableNode &node) -> RetT {
+    writer << node.getName();
+    return {};
+  }
+
+  auto SexprPrinter::visit(const IfNode &node) -> RetT {
+    writer << "(if ";
+    node.getCond()->accept(*this);
+    writer.put(' ');
+    node.getBlock()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const IfElseNode &node) -> RetT {
+    const auto &ifNode = *node.getIfNode();
+    writer << "(if ";
+    ifNode.getCond()->accept(*this);
+    writer.put(' ');
+    ifNode.getBlock()->accept(*this);
+    writer.put(' ');
+    node.getElseBlock()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const BinaryNode &node) -> RetT {
+    writer << '(' << node.getOp() << ' ';
+    node.getLHS()->accept(*this);
+    writer.put(' ');
+    node.getRHS()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const UnaryNode &node) -> RetT {
+    writer << '(' << node.getOp() << ' ';
+    node.getOperand()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const ProtoNode &node) -> RetT {
+    writer << "(proto ";
+    signature(node);
+    attributes(node.getAttributes());
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const BlockNode &node) -> RetT {
+    writer << "(block";
+    for (const auto &stmt : node.getBody()) {
+      writer.put(' ');
+      stmt->accept(*this);
+    }
+
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const FuncDeclNode &node) -> RetT {
+    writer << "(fn ";
+    signature(*node.getProto());
+    writer.put(' ');
+    node.getBody()->accept(*this);
+    attributes(node.getProto()->getAttributes());
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const CallNode &node) -> RetT {
+    writer << "(call " << node.getCallee()->getName();
+    for (const auto &arg : node.getArgs()) {
+      writer.put(' ');
+      arg->accept(*this);
+    }
+
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const ReturnNode &node) -> RetT {
+    writer << "(return ";
+    node.getValue()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const BenchNode &node) -> RetT {
+    writer << "(bench " << node.getName() << ' ';
+    node.getBody()->accept(*this);
+    writer.put(')');
+    return {};
+  }
+
+  auto SexprPrinter::visit(const AsmNode &node) -> RetT {
+    writer << (node.hasSideEffects() ? "(asm-volatile " : "(asm ")
+           << node.getType().name << ' ';
+    string(node.getCode());
+    writer.put(' ');
+    string(node.getConstraints());
+    for (const auto &operand : node.getOperands()) {
+      writer.put(' ');
+      operand->accept(*this);
+    }
+
+    writer.put(')');
+    return {};
+  }
+
+  void SexprPrinter::signature(const ProtoNode &node) {
+    writer << node.getName() << " (";
+
+    for (size_t i = 0; i < node.getParams().size(); ++i) {
+      const auto &param = node.getParams()[i];
+      writer << (i == 0 ? "(" : " (") << param.name << ' ' << param.type.name
+             << ')';
+    }
+
+    writer << ") " << node.getRetType().name;
+  }
+
+  void SexprPrinter::attributes(const Attributes &attributes) {
+    for (const auto &attribute : attributes) {
+      writer << " (attr " << attribute.name;
+      for (const auto &arg : attribute.args)
+        writer << ' ' << arg;
+
+      writer.put(')');
+    }
+  }
+
+  void SexprPrinter::string(std::string_view value) {
+    writer.put('"');
+
+    for (const char c : value) {
+      if (c == '"' || c == '\\')
+        writer.put('\\');
+
+      if (c == '\n')
+        writer << "\\n";
+      else
+        writer.put(c);
+    }
+
+    writer.put('"');
+  }
+} // namespace verte::visitors
@@ -1,27 +1,297 @@
-#include "verte/backend/codegen/codegen.hpp"
 #include "verte/backend/codegen/compiler.hpp"
+#include "verte/backend/codegen/mca.hpp"
+#include "verte/driver/cache.hpp"
+#include "verte/driver/compile.hpp"
+#include "verte/driver/lsp.hpp"
+#include "verte/driver/objects.hpp"
+#include "verte/driver/pipeline.hpp"
+#include "verte/driver/stream.hpp"
+#include "verte/driver/remote.hpp"
+#include "verte/driver/watch.hpp"
 
 #include "verte/frontend/lexer/lexer.hpp"
 #include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/json.hpp"
 #include "verte/frontend/visitors/pretty.hpp"
+#include "verte/frontend/visitors/sexpr.hpp"
 
 #include "verte/utils/argparser.hpp"
 #include "verte/utils/logger.hpp"
 
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace verte;
 using namespace verte::codegen;
 using namespace verte::visitors;
 
+/**
+ * @brief Write a whole file.
+ * @param path The path of the file.
+ * @param contents The contents of the file.
+ * @return True if every byte reached the file, false otherwise.
+ */
+static bool writeFile(const std::string &path, std::string_view contents) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  out.close();
+  return static_cast<bool>(out);
+}
+
 int main(int argc, char **argv) {
   const utils::Logger logger("main");
   const utils::ArgParser args(argc, argv);
   utils::logging::setLevel(args.getLogLevel());
 
+  // Serve compile jobs until killed, if requested.
+  if (!args.getWorkerEndpoint().empty()) {
+    const auto endpoint = utils::Endpoint::parse(args.getWorkerEndpoint());
+    if (!endpoint) {
+      llvm::errs() << "vertec: error: invalid worker endpoint, expected "
+                      "`host:port`\n";
+      return -1;
+    }
+
+    remote::Worker worker(*endpoint);
+    worker.run();
+    return 0;
+  }
+
+  // Answer an editor over stdio, the logs would corrupt the messages.
+  if (args.shouldServeLsp()) {
+    utils::logging::setLevel(utils::LogLevel::NONE);
+
+    lsp::Server server(std::cout);
+    return server.run(std::cin);
+  }
+
+  if (args.getInputFile().empty()) {
+    llvm::errs() << "vertec: error: no input file\n";
+    return -1;
+  }
+
   const std::string inputFile = args.getInputFile();
+  const bool shared = args.shouldBuildShared();
   const std::string outputFile =
-      args.getOutputFile().empty() ? "a.out" : args.getOutputFile();
+      !args.getOutputFile().empty() ? args.getOutputFile().string()
+      : shared                      ? "a.so"
+                                    : "a.out";
+
+  if (args.getOptLevel() > 3) {
+    llvm::errs() << "vertec: error: invalid optimization level, expected 0 "
+                    "to 3\n";
+    return -1;
+  }
+
+  const bool emitAssembly = args.getEmit() == utils::Emit::ASSEMBLY;
+  if (args.shouldAnnotate() && !emitAssembly) {
+    llvm::errs() << "vertec: error: --annotate only applies to --emit=asm\n";
+    return -1;
+  }
+
+  if (emitAssembly && (args.shouldStream() || args.shouldWatch() ||
+                       !args.getObjectStore().empty())) {
+    llvm::errs() << "vertec: error: --emit=asm compiles the whole input at "
+                    "once, it cannot be combined with --stream, --watch or "
+                    "--object-store\n";
+    return -1;
+  }
+
+  // The report is estimated on the assembly, for the CPU it was emitted for.
+  const auto mcaReport = args.getMcaReport();
+  if (mcaReport && (emitAssembly || args.shouldPrintIr())) {
+    llvm::errs() << "vertec: error: --mca-report prints a report, it cannot "
+                    "be combined with --emit=asm or --print-ir\n";
+    return -1;
+  }
+
+  if (mcaReport && (args.shouldStream() || args.shouldWatch() ||
+                    !args.getObjectStore().empty())) {
+    llvm::errs() << "vertec: error: --mca-report compiles the whole input at "
+                    "once, it cannot be combined with --stream, --watch or "
+                    "--object-store\n";
+    return -1;
+  }
+
+  std::string cpuError;
+  const std::string cpu = codegen::resolveCpu(args.getCpu(), cpuError);
+  if (cpu.empty()) {
+    llvm::errs() << "vertec: error: " << cpuError << "\n";
+    return -1;
+  }
+
+  const bool profileAllocations =
+      args.getInstrumentation() == utils::Instrumentation::ALLOC;
+
+  if (profileAllocations && shared) {
+    llvm::errs() << "vertec: error: the allocation profiler replaces the "
+                    "allocator of an executable, it cannot be used with "
+                    "--shared\n";
+    return -1;
+  }
+
+  // Compile the source code, to LLVM IR if requested.
+  verte::Options options;
+  options.optLevel = args.getOptLevel();
+
+  // Debug builds are about latency, the verifier only runs when asked.
+  options.verify = args.shouldVerify() || options.optLevel > 0;
+  options.output = args.shouldPrintIr()      ? OutputKind::IR
+                   : emitAssembly || mcaReport ? OutputKind::ASSEMBLY
+                                               : OutputKind::OBJECT;
+  options.annotate = args.shouldAnnotate();
+  options.cpu = cpu;
+  options.codegen.bench = args.shouldBench();
+  options.codegen.shared = shared;
+  options.codegen.framePointers = profileAllocations;
+  options.codegen.overflow = args.getOverflow();
+
+  // Name the module after the library, it also names the header guard.
+  if (shared)
+    options.moduleName = std::filesystem::path(outputFile).stem().string();
+
+  // Report the diagnostics then link the objects, true if it succeeded. The
+  // output of the result is the object, unless objects are given. Owned
+  // objects are removed once linked.
+  auto deliver = [&](const Result &result,
+                     std::vector<std::string> objectFiles = {},
+                     bool owned = true) {
+    for (const auto &diagnostic : result.diagnostics) {
+      const bool isError = diagnostic.severity == Diagnostic::Severity::ERROR;
+      llvm::errs() << inputFile << (isError ? ": error: " : ": warning: ")
+                   << diagnostic.message << "\n";
+    }
+
+    auto removeObjects = [&] {
+      if (!owned)
+        return;
+
+      for (const auto &objectFile : objectFiles)
+        std::remove(objectFile.c_str());
+    };
+
+    if (!result.success()) {
+      removeObjects();
+      return false;
+    }
+
+    // Print the LLVM IR if requested.
+    if (args.shouldPrintIr()) {
+      llvm::outs() << result.output;
+      llvm::outs().flush();
+      return true;
+    }
+
+    // Report the throughput of the assembly, nothing is linked.
+    if (mcaReport) {
+      std::string error;
+      std::vector<codegen::ThroughputEstimate> estimates;
+      codegen::ThroughputEstimator estimator(cpu);
+
+      if (!estimator.estimate(result.output, *mcaReport, estimates, error)) {
+        llvm::errs() << "vertec: error: " << error << "\n";
+        return false;
+      }
+
+      llvm::outs() << estimator.report(estimates);
+      llvm::outs().flush();
+      return true;
+    }
+
+    // The assembly is the output, nothing is linked.
+    if (emitAssembly) {
+      if (args.getOutputFile().empty()) {
+        llvm::outs() << result.output;
+        llvm::outs().flush();
+      } else if (!writeFile(outputFile, result.output)) {
+        llvm::errs() << "vertec: error: cannot write " << outputFile << "\n";
+        return false;
+      }
+
+      return true;
+    }
+
+    // Link the objects into an executable.
+    if (objectFiles.empty()) {
+      objectFiles.push_back(outputFile + ".o");
+      if (!writeFile(objectFiles.back(), result.output)) {
+        llvm::errs() << "vertec: error: cannot write " << objectFiles.back()
+                     << "\n";
+        removeObjects();
+        return false;
+      }
+    }
+
+    codegen::Compiler compiler;
+    const bool linked = compiler.link(objectFiles, outputFile, shared,
+                                      profileAllocations);
+    removeObjects();
+
+    if (!linked) {
+      logger.error("Failed to compile the module to native code.");
+      return false;
+    }
+
+    // Write the C header next to the shared library.
+    if (shared) {
+      auto headerFile = std::filesystem::path(outputFile);
+      headerFile.replace_extension(".h");
+      if (!writeFile(headerFile.string(), result.header)) {
+        llvm::errs() << "vertec: error: cannot write " << headerFile.string()
+                     << "\n";
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  // Compile one item at a time, the input is never held in memory at once.
+  if (args.shouldStream()) {
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input) {
+      logger.error("Failed to read the input file.");
+      return -1;
+    }
+
+    std::vector<std::string> objectFiles;
+    stream::StreamingCompiler compiler(options);
+    bool written = true;
+
+    const Result result =
+        compiler.compile(input, [&](std::string_view output) {
+          if (args.shouldPrintIr()) {
+            llvm::outs() << output;
+            return;
+          }
+
+          objectFiles.push_back(
+              std::format("{}.{}.o", outputFile, objectFiles.size()));
+          if (written && !writeFile(objectFiles.back(), output)) {
+            llvm::errs() << "vertec: error: cannot write "
+                         << objectFiles.back() << "\n";
+            written = false;
+          }
+        });
+
+    if (!written) {
+      for (const auto &objectFile : objectFiles)
+        std::remove(objectFile.c_str());
+
+      return -1;
+    }
+
+    return deliver(result, std::move(objectFiles)) ? 0 : -1;
+  }
 
   // Read the source code from the input file.
   const auto sourceOrEmpty = args.readInputFile();
@@ -30,37 +300,130 @@ int main(int argc, char **argv) {
     return -1;
   }
 
-  // Lex and parse the source code.
   const std::string source = sourceOrEmpty.value();
-  lexer::Lexer lexer(source);
-  nodes::Parser parser(lexer.allTokens());
 
   // Print the AST if requested.
-  const auto ast = parser.parse();
-  if (args.shouldPrintAst()) {
-    PrettyPrinter printer;
-    ast->accept(printer);
+  if (args.getAstFormat() != utils::AstFormat::NONE) {
+    lexer::Lexer lexer(source);
+    nodes::Parser parser(lexer.allTokens());
+    const auto ast = parser.parse();
+
+    switch (args.getAstFormat()) {
+      case utils::AstFormat::JSON: {
+        JsonPrinter printer(std::cout);
+        ast->accept(printer);
+        break;
+      }
+
+      case utils::AstFormat::SEXPR: {
+        SexprPrinter printer(std::cout);
+        ast->accept(printer);
+        break;
+      }
+
+      default: {
+        PrettyPrinter printer;
+        ast->accept(printer);
+      }
+    }
 
     return 0;
   }
 
-  // Generate target code.
-  llvm::LLVMContext context;
-  Codegen codegen(context, std::make_unique<llvm::Module>("main", context));
-  ast->accept(codegen);
+  // Reuse the objects of the unchanged functions, if a store is given.
+  std::optional<objects::FunctionCompiler> functions;
+  if (!args.getObjectStore().empty() && !args.shouldPrintIr()) {
+    try {
+      functions.emplace(options, args.getObjectStore());
+    } catch (const std::exception &e) {
+      llvm::errs() << "vertec: error: " << e.what() << "\n";
+      return -1;
+    }
+  }
 
-  // Print the LLVM IR if requested.
-  if (args.shouldPrintIr()) {
-    codegen.getModule().print(llvm::outs(), nullptr);
-    return 0;
+  auto deliverFunctions = [&](std::string_view source) {
+    const Result result = functions->compile(source);
+
+    std::vector<std::string> objectFiles;
+    for (const auto &object : functions->getObjects())
+      objectFiles.push_back(object.string());
+
+    return deliver(result, std::move(objectFiles), false);
+  };
+
+  // Rebuild on every save, keeping the unchanged items in memory.
+  if (args.shouldWatch()) {
+    watch::IncrementalCompiler incremental(options);
+    watch::Watcher watcher(inputFile);
+    std::string current = source;
+
+    while (true) {
+      const auto start = std::chrono::steady_clock::now();
+      const bool built = functions ? deliverFunctions(current)
+                                   : deliver(incremental.compile(current));
+      const auto elapsed = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start);
+
+      const auto [reused, total] =
+          functions ? std::pair(functions->getStats().reused,
+                                functions->getStats().functions)
+                    : std::pair(incremental.getStats().reused,
+                                incremental.getStats().items);
+
+      llvm::errs() << std::format("vertec: {} in {:.1f} ms, {}/{} {} "
+                                  "reused, watching for changes\n",
+                                  built ? "built" : "failed", elapsed.count(),
+                                  reused, total,
+                                  functions ? "functions" : "items");
+
+      // The file may briefly be missing while an editor replaces it.
+      do {
+        watcher.wait();
+      } while (!std::filesystem::exists(inputFile));
+
+      current = args.readInputFile().value_or("");
+    }
+  }
+
+  if (functions)
+    return deliverFunctions(source) ? 0 : -1;
+
+  // Ship the job to the workers if any, they compile locally otherwise.
+  std::vector<utils::Endpoint> workers;
+  for (const auto &worker : args.getRemoteWorkers()) {
+    const auto endpoint = utils::Endpoint::parse(worker);
+    if (!endpoint) {
+      llvm::errs() << "vertec: error: invalid remote worker `" << worker
+                   << "`, expected `host:port`\n";
+      return -1;
+    }
+
+    workers.push_back(*endpoint);
   }
 
-  // Compile the module to native code.
-  codegen::Compiler compiler;
-  if (!compiler.compile(codegen.getModule(), outputFile)) {
-    logger.error("Failed to compile the module to native code.");
+  auto build = [&](std::string_view source, const verte::Options &options) {
+    if (!workers.empty())
+      return remote::Scheduler(workers).compile(source, options);
+
+    return args.shouldPipeline()
+               ? pipeline::PipelinedCompiler(options).compile(source)
+               : compile(source, options);
+  };
+
+  // Look the compilation up in the shared cache first, if any.
+  const bool useCache = !args.getCacheUrl().empty();
+  const auto sharedCache =
+      useCache ? cache::Client::fromUrl(args.getCacheUrl()) : std::nullopt;
+
+  if (useCache && !sharedCache) {
+    llvm::errs() << "vertec: error: invalid cache URL, expected "
+                    "`http://host:port[/prefix]`\n";
     return -1;
   }
 
-  return 0;
+  const Result result =
+      sharedCache ? sharedCache->compile(source, options, build)
+                  : build(source, options);
+
+  return deliver(result) ? 0 : -1;
 }
@@ -0,0 +1,59 @@
+/**
+ * @brief TCP server implementation.
+ * @file server.cpp
+ */
+
+#include "verte/utils/server.hpp"
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace verte::utils {
+  ConnectionServer::ConnectionServer(const Endpoint &endpoint)
+      : listener(Socket::listen(endpoint)), port(listener.localPort()) {}
+
+  ConnectionServer::~ConnectionServer() { stop(); }
+
+  void ConnectionServer::run(const Handler &handler) {
+    while (true) {
+      Socket connection = listener.accept();
+      if (!connection.valid())
+        break;
+
+      std::lock_guard lock(mutex);
+      if (stopping)
+        break;
+
+      // Every connection is served on its own thread, until the peer leaves.
+      auto socket = std::make_unique<Socket>(std::move(connection));
+      open.insert(socket.get());
+
+      std::thread([this, &handler, socket = std::move(socket)] {
+        handler(*socket);
+
+        std::lock_guard lock(mutex);
+        open.erase(socket.get());
+        changed.notify_all();
+      }).detach();
+    }
+
+    // Wait for the connections to wind down.
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [this] { return open.empty(); });
+  }
+
+  void ConnectionServer::stop() {
+    std::unique_lock lock(mutex);
+    if (!stopping) {
+      stopping = true;
+      listener.shutdown();
+
+      // Unblock the connections waiting for the peer.
+      for (auto *connection : open)
+        connection->shutdown();
+    }
+
+    changed.wait(lock, [this] { return open.empty(); });
+  }
+} // namespace verte::utils
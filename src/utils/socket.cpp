@@ -0,0 +1,266 @@
+/**
+ * @brief TCP socket implementation.
+ * @file socket.cpp
+ */
+
+#include "verte/utils/socket.hpp"
+#include "verte/errors.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <utility>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace verte::utils {
+  /**
+   * @brief Throw an error describing the last system error.
+   * @param what The failed operation.
+   */
+  [[noreturn]] static void fail(const std::string &what) {
+    throw errors::NetworkError(what + ": " + std::strerror(errno));
+  }
+
+  /**
+   * @brief Resolve an endpoint into TCP addresses.
+   * @param endpoint The endpoint to resolve.
+   * @param passive Resolve an address to bind to.
+   * @return The addresses, to free with `freeaddrinfo`.
+   */
+  static addrinfo *resolve(const Endpoint &endpoint, bool passive) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    addrinfo *addresses = nullptr;
+    const std::string port = std::to_string(endpoint.port);
+    const char *host = endpoint.host.empty() ? nullptr : endpoint.host.c_str();
+
+    if (int error = getaddrinfo(host, port.c_str(), &hints, &addresses))
+      throw errors::NetworkError("Failed to resolve " + endpoint.toString() +
+                                 ": " + gai_strerror(error));
+
+    return addresses;
+  }
+
+  std::optional<Endpoint> Endpoint::parse(std::string_view text) {
+    const size_t colon = text.rfind(':');
+    if (colon == std::string_view::npos || colon + 1 == text.size())
+      return std::nullopt;
+
+    uint16_t port = 0;
+    const char *begin = text.data() + colon + 1;
+    const char *end = text.data() + text.size();
+    auto [ptr, error] = std::from_chars(begin, end, port);
+    if (error != std::errc() || ptr != end)
+      return std::nullopt;
+
+    return Endpoint{std::string(text.substr(0, colon)), port};
+  }
+
+  std::string Endpoint::toString() const {
+    return std::format("{}:{}", host, port);
+  }
+
+  Socket::~Socket() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  Socket::Socket(Socket &&other) noexcept
+      : fd(std::exchange(other.fd, -1)) {}
+
+  Socket &Socket::operator=(Socket &&other) noexcept {
+    if (this != &other) {
+      if (fd >= 0)
+        ::close(fd);
+
+      fd = std::exchange(other.fd, -1);
+    }
+
+    return *this;
+  }
+
+  Socket Socket::connect(const Endpoint &endpoint,
+                         std::chrono::milliseconds timeout) {
+    addrinfo *addresses = resolve(endpoint, false);
+    std::string error = "no address";
+
+    for (addrinfo *address = addresses; address; address = address->ai_next) {
+      Socket socket(::socket(address->ai_family,
+                             address->ai_socktype | SOCK_CLOEXEC,
+                             address->ai_protocol));
+      if (!socket.valid())
+        continue;
+
+      // Connect without blocking, so that dead hosts fail within the timeout.
+      int flags = fcntl(socket.fd, F_GETFL);
+      fcntl(socket.fd, F_SETFL, flags | O_NONBLOCK);
+
+      int result = ::connect(socket.fd, address->ai_addr, address->ai_addrlen);
+      if (result < 0 && errno == EINPROGRESS) {
+        pollfd pending{socket.fd, POLLOUT, 0};
+        result = poll(&pending, 1, static_cast<int>(timeout.count()));
+
+        int status = 0;
+        socklen_t length = sizeof(status);
+        getsockopt(socket.fd, SOL_SOCKET, SO_ERROR, &status, &length);
+
+        if (result == 0)
+          errno = ETIMEDOUT;
+        else if (result > 0)
+          errno = status;
+
+        result = (result > 0 && status == 0) ? 0 : -1;
+      }
+
+      if (result < 0) {
+        error = std::strerror(errno);
+        continue;
+      }
+
+      fcntl(socket.fd, F_SETFL, flags);
+
+      // Jobs are small request/response exchanges, do not delay them.
+      int enable = 1;
+      setsockopt(socket.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+      freeaddrinfo(addresses);
+      return socket;
+    }
+
+    freeaddrinfo(addresses);
+    throw errors::NetworkError("Failed to connect to " + endpoint.toString() +
+                               ": " + error);
+  }
+
+  Socket Socket::listen(const Endpoint &endpoint) {
+    addrinfo *addresses = resolve(endpoint, true);
+
+    for (addrinfo *address = addresses; address; address = address->ai_next) {
+      Socket socket(::socket(address->ai_family,
+                             address->ai_socktype | SOCK_CLOEXEC,
+                             address->ai_protocol));
+      if (!socket.valid())
+        continue;
+
+      int enable = 1;
+      setsockopt(socket.fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+      if (::bind(socket.fd, address->ai_addr, address->ai_addrlen) == 0 &&
+          ::listen(socket.fd, SOMAXCONN) == 0) {
+        freeaddrinfo(addresses);
+        return socket;
+      }
+    }
+
+    freeaddrinfo(addresses);
+    fail("Failed to listen on " + endpoint.toString());
+  }
+
+  Socket Socket::accept() const {
+    while (true) {
+      int client = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client >= 0) {
+        int enable = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        return Socket(client);
+      }
+
+      // Transient errors of the accepted connection, keep listening.
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+
+      // The socket was shut down.
+      if (errno == EINVAL || errno == EBADF)
+        return Socket();
+
+      fail("Failed to accept a connection");
+    }
+  }
+
+  uint16_t Socket::localPort() const {
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+
+    if (getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) < 0)
+      fail("Failed to get the socket address");
+
+    if (address.ss_family == AF_INET6)
+      return ntohs(reinterpret_cast<sockaddr_in6 *>(&address)->sin6_port);
+
+    return ntohs(reinterpret_cast<sockaddr_in *>(&address)->sin_port);
+  }
+
+  void Socket::setTimeout(std::chrono::milliseconds timeout) const {
+    timeval value{};
+    value.tv_sec = timeout.count() / 1000;
+    value.tv_usec = (timeout.count() % 1000) * 1000;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+  }
+
+  void Socket::sendAll(std::string_view data) const {
+    while (!data.empty()) {
+      ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR)
+          continue;
+
+        fail("Failed to send");
+      }
+
+      data.remove_prefix(static_cast<size_t>(sent));
+    }
+  }
+
+  size_t Socket::receive(char *buffer, size_t size) const {
+    while (true) {
+      ssize_t count = ::recv(fd, buffer, size, 0);
+      if (count >= 0)
+        return static_cast<size_t>(count);
+
+      if (errno != EINTR)
+        fail("Failed to receive");
+    }
+  }
+
+  std::optional<std::string> Socket::receiveExact(size_t size) const {
+    std::string data(size, '\0');
+
+    for (size_t received = 0; received < size;) {
+      size_t count = receive(data.data() + received, size - received);
+      if (count == 0)
+        return std::nullopt;
+
+      received += count;
+    }
+
+    return data;
+  }
+
+  std::string Socket::receiveAll() const {
+    std::string data;
+    char buffer[16 * 1024];
+
+    while (size_t count = receive(buffer, sizeof(buffer)))
+      data.append(buffer, count);
+
+    return data;
+  }
+
+  void Socket::shutdown() const noexcept {
+    if (fd >= 0)
+      ::shutdown(fd, SHUT_RDWR);
+  }
+} // namespace verte::utils
@@ -0,0 +1,31 @@
+/**
+ * @brief Buffered writer implementation.
+ * @file writer.cpp
+ */
+
+#include "verte/utils/writer.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace verte::utils {
+  BufferedWriter &BufferedWriter::fill(char c, size_t count) {
+    while (count > 0) {
+      if (size == capacity)
+        flush();
+
+      const size_t chunk = std::min(count, capacity - size);
+      std::memset(buffer.get() + size, c, chunk);
+      size += chunk;
+      count -= chunk;
+    }
+
+    return *this;
+  }
+
+  BufferedWriter &BufferedWriter::number(size_t value) {
+    char digits[20];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    return write(std::string_view(digits, static_cast<size_t>(end - digits)));
+  }
+} // namespace verte::utils
@@ -0,0 +1,142 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+// Writes two halves in one batch, then reads them back through a registered
+// file and buffer, and writes a second file once the first one is closed. The
+// exit code tells the first check that failed.
+static std::string program(const std::string &path) {
+  return R"(fn open(path: str, flags: int, mode: int) -> int;
+fn close(fd: int) -> int;
+fn puts(s: str) -> int;
+fn strcpy(dest: str, src: str) -> str;
+
+fn main() -> int {
+  fd: int = open(")" +
+         path + R"(", 578, 420);
+  if [fd < 0] then { return 1; }
+
+  a: int = write_at_async(fd, strcpy(node_alloc(8), "hello "), 6, 0);
+  b: int = write_at_async(fd, strcpy(node_alloc(8), "world"), 5, 6);
+  if [submit() != 2] then { return 2; }
+  if [wait(b) != 5] then { return 3; }
+  if [wait(a) != 6] then { return 3; }
+
+  whole: str = strcpy(node_alloc(64), "xxxxxxxxxxx");
+  half: str = strcpy(node_alloc(64), "xxxxx");
+  if [register_file(fd) != 0] then { return 4; }
+  if [register_buffer(whole, 64) != 0] then { return 4; }
+
+  c: int = read_at_async(fd, whole, 11, 0);
+  d: int = read_at_async(fd, half, 16, 6);
+  if [wait(c) != 11] then { return 5; }
+  if [wait(d) != 5] then { return 6; }
+
+  // EBADF, the errors are negated.
+  if [wait(read_at_async(999, half, 1, 0)) != -9] then { return 7; }
+  if [wait(c) != -22] then { return 8; }
+
+  puts(whole);
+  puts(half);
+  if [unregister_file(fd) != 0] then { return 9; }
+  if [close(fd) != 0] then { return 9; }
+
+  // The next file reuses the descriptor, it must not reach the closed one.
+  other: int = open(")" +
+         path + R"(.2", 578, 420);
+  if [wait(write_at_async(other, "again", 5, 0)) != 5] then { return 10; }
+  return close(other);
+}
+)";
+}
+
+TEST(AioTest, TestLowersBuiltins) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  const Result result = compile(program("/dev/null"), options);
+  ASSERT_TRUE(result.success());
+
+  const std::string &ir = result.output;
+  ASSERT_THAT(ir, HasSubstr("call i32 @verte_write_at_async(i32 %fd"));
+  ASSERT_THAT(ir, HasSubstr("i64 6, i64 0)"));
+  ASSERT_THAT(ir, HasSubstr("call i32 @verte_submit()"));
+  ASSERT_THAT(ir, HasSubstr("call i64 @verte_wait(i32"));
+  ASSERT_THAT(ir, HasSubstr("call i32 @verte_register_buffer(ptr"));
+  ASSERT_THAT(ir, HasSubstr("call i32 @verte_unregister_file(i32"));
+}
+
+TEST(AioTest, TestRejectsInvalidCalls) {
+  Result result = compile("fn f() -> int { return wait(); }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("`wait` expects 1 argument(s)"));
+
+  result = compile("fn f() -> int { return read_at_async(0, 1, 1, 0); }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("`read_at_async` expects a `str` argument 2"));
+
+  // A function of the program is called as is.
+  Options options;
+  options.output = OutputKind::IR;
+  result = compile("fn wait(status: str) -> int;\n"
+                   "fn f() -> int { return wait(\"\"); }",
+                   options);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, HasSubstr("call i32 @wait(ptr"));
+}
+
+TEST(AioTest, TestRunsBothBackends) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-aio-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  const auto data = directory / "data.txt";
+  const Result result = compile(program(data.string()));
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  for (const char *backend : {"uring", "threads"}) {
+    const auto command =
+        std::format("VERTE_AIO={} {}", backend, executable.string());
+    FILE *pipe = popen(command.c_str(), "r");
+    ASSERT_NE(pipe, nullptr);
+
+    std::string output;
+    for (int c; (c = std::fgetc(pipe)) != EOF;)
+      output += static_cast<char>(c);
+
+    const int status = pclose(pipe);
+    ASSERT_TRUE(WIFEXITED(status)) << backend;
+    ASSERT_EQ(WEXITSTATUS(status), 0) << backend;
+    ASSERT_EQ(output, "hello world\nworld\n") << backend;
+
+    std::ifstream second(data.string() + ".2");
+    ASSERT_EQ(std::string(std::istreambuf_iterator<char>(second), {}), "again")
+        << backend;
+  }
+
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,237 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+// Every allocation goes through libc, the stacks must reach back into the
+// Verte functions.
+static constexpr std::string_view SOURCE = R"(fn strdup(s: str) -> str;
+fn free(p: str) -> void;
+
+fn churn(n: int) -> int {
+  if [n > 0] then {
+    free(strdup("temporary"));
+    return churn(n - 1);
+  }
+
+  return 0;
+}
+
+fn main() -> int {
+  strdup("kept");
+  return churn(100);
+}
+)";
+
+/**
+ * @struct ProtoField
+ * @brief A field of a protobuf message, enough to read a pprof profile.
+ */
+struct ProtoField {
+  uint64_t number = 0;    /**< The field number. */
+  uint64_t value = 0;     /**< The value of a varint. */
+  std::string_view bytes; /**< The payload of a length delimited field. */
+};
+
+static uint64_t readVarint(std::string_view &data) {
+  uint64_t value = 0;
+  for (int shift = 0; !data.empty(); shift += 7) {
+    const auto byte = static_cast<uint8_t>(data.front());
+    data.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+    if (!(byte & 0x80))
+      break;
+  }
+
+  return value;
+}
+
+static std::vector<ProtoField> readFields(std::string_view data) {
+  std::vector<ProtoField> fields;
+  while (!data.empty()) {
+    const uint64_t key = readVarint(data);
+    ProtoField field{key >> 3};
+
+    if ((key & 7) == 2) {
+      const auto size = readVarint(data);
+      field.bytes = data.substr(0, size);
+      data.remove_prefix(size);
+    } else {
+      field.value = readVarint(data);
+    }
+
+    fields.push_back(field);
+  }
+
+  return fields;
+}
+
+static std::vector<uint64_t> readPacked(std::string_view data) {
+  std::vector<uint64_t> values;
+  while (!data.empty())
+    values.push_back(readVarint(data));
+
+  return values;
+}
+
+/**
+ * @class AllocTest
+ * @brief Fixture providing a fresh directory for the program and profile.
+ */
+class AllocTest : public Test {
+protected:
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() /
+                std::format("verte-alloc-test-{}", getpid());
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  std::filesystem::path directory;
+};
+
+TEST_F(AllocTest, TestKeepsFramePointers) {
+  Options options;
+  options.output = OutputKind::IR;
+  options.codegen.framePointers = true;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, HasSubstr("\"frame-pointer\"=\"all\""));
+
+  options.codegen.framePointers = false;
+  ASSERT_THAT(compile(SOURCE, options).output,
+              Not(HasSubstr("\"frame-pointer\"")));
+}
+
+TEST_F(AllocTest, TestWritesProfile) {
+  Options options;
+  options.codegen.framePointers = true;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  const auto profile = directory / "alloc.pprof";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(
+      linker.link({object.string()}, executable.string(), false, true));
+
+  // Sample every allocation, so the counts are exact.
+  const auto command =
+      std::format("VERTE_ALLOC_SAMPLE=1 VERTE_ALLOC_PROFILE={} {} 2>/dev/null",
+                  profile.string(), executable.string());
+  const int status = std::system(command.c_str());
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  std::ifstream input(profile, std::ios::binary);
+  const std::string data{std::istreambuf_iterator<char>(input), {}};
+  ASSERT_FALSE(data.empty());
+
+  std::vector<std::string_view> strings;
+  std::vector<std::vector<uint64_t>> sampleStacks, sampleValues;
+  std::map<uint64_t, uint64_t> addresses;
+  std::vector<std::pair<uint64_t, uint64_t>> executableRanges;
+  std::vector<std::vector<ProtoField>> mappings;
+
+  for (const auto &field : readFields(data)) {
+    if (field.number == 6)
+      strings.push_back(field.bytes);
+
+    else if (field.number == 3)
+      mappings.push_back(readFields(field.bytes));
+
+    else if (field.number == 4) {
+      uint64_t id = 0, address = 0;
+      for (const auto &location : readFields(field.bytes)) {
+        if (location.number == 1)
+          id = location.value;
+        if (location.number == 3)
+          address = location.value;
+      }
+
+      addresses[id] = address;
+    }
+
+    else if (field.number == 2) {
+      const auto sample = readFields(field.bytes);
+      sampleStacks.push_back(readPacked(sample[0].bytes));
+      sampleValues.push_back(readPacked(sample[1].bytes));
+    }
+  }
+
+  ASSERT_GE(strings.size(), 8u);
+  ASSERT_EQ(strings[0], "");
+  ASSERT_EQ(strings[1], "alloc_objects");
+  ASSERT_EQ(strings[6], "inuse_space");
+
+  // The code of the executable itself.
+  for (const auto &mapping : mappings) {
+    uint64_t start = 0, limit = 0, filename = 0;
+    for (const auto &field : mapping) {
+      start = field.number == 2 ? field.value : start;
+      limit = field.number == 3 ? field.value : limit;
+      filename = field.number == 5 ? field.value : filename;
+    }
+
+    ASSERT_LT(filename, strings.size());
+    if (std::filesystem::path(strings[filename]) == executable)
+      executableRanges.emplace_back(start, limit);
+  }
+
+  ASSERT_FALSE(executableRanges.empty());
+
+  // Every level of the recursion is a site of its own, the churned copies
+  // were all freed while the kept one is still live. Their stacks go through
+  // libc back into the program.
+  uint64_t churned = 0, kept = 0;
+  for (size_t i = 0; i < sampleStacks.size(); ++i) {
+    const auto &values = sampleValues[i];
+    ASSERT_EQ(values.size(), 4u);
+
+    if (values[1] == values[0] * sizeof("temporary")) {
+      churned += values[0];
+      ASSERT_EQ(values[2], 0u);
+    } else if (values[1] == values[0] * sizeof("kept")) {
+      kept += values[0];
+      ASSERT_EQ(values[3], sizeof("kept"));
+    } else {
+      continue;
+    }
+
+    bool inProgram = false;
+    for (const auto id : sampleStacks[i]) {
+      ASSERT_TRUE(addresses.contains(id));
+      for (const auto &[start, limit] : executableRanges)
+        inProgram |= addresses[id] >= start && addresses[id] < limit;
+    }
+
+    ASSERT_TRUE(inProgram);
+  }
+
+  ASSERT_EQ(churned, 100u);
+  ASSERT_EQ(kept, 1u);
+}
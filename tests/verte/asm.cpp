@@ -0,0 +1,141 @@
+#include "verte/driver/compile.hpp"
+#include "verte/driver/jit.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/sexpr.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(
+fn swap(x: int) -> int { return asm("bswapl $0", "=r,0", x) -> int; }
+
+fn sum(a: int, b: int) -> int {
+  return asm("leal ($1,$2), $0", "=r,r,r", a, b) -> int;
+}
+
+fn ticks() -> int { return asm volatile("rdtsc", "={eax},~{edx}") -> int; }
+
+fn relax() -> void { asm("pause", "~{memory}"); }
+)";
+
+static Result emit(std::string_view source, OutputKind output,
+                   unsigned optLevel = 0) {
+  Options options;
+  options.output = output;
+  options.optLevel = optLevel;
+  return compile(source, options);
+}
+
+static std::string firstError(std::string_view source) {
+  const Result result = emit(source, OutputKind::IR);
+  EXPECT_FALSE(result.success());
+  return result.diagnostics.empty() ? "" : result.diagnostics[0].message;
+}
+
+TEST(AsmTest, TestParses) {
+  lexer::Lexer lexer("fn f(x: int) -> int { return asm volatile(\"bswapl "
+                     "$0\", \"=r,0\", x + 1) -> int; }");
+  nodes::Parser parser(lexer.allTokens());
+
+  std::ostringstream out;
+  visitors::SexprPrinter printer(out);
+  parser.parse()->accept(printer);
+
+  ASSERT_EQ(out.str(), "(fn f ((x int)) int (block (return (asm-volatile int "
+                       "\"bswapl $0\" \"=r,0\" (+ x 1)))))\n");
+}
+
+TEST(AsmTest, TestLowersToInlineAsm) {
+  const Result result = emit(SOURCE, OutputKind::IR);
+  ASSERT_TRUE(result.success());
+
+  const std::string &ir = result.output;
+  ASSERT_THAT(ir, HasSubstr("call i32 asm \"bswapl $0\", \"=r,0\"(i32 %x"));
+  ASSERT_THAT(ir, HasSubstr("call i32 asm sideeffect \"rdtsc\", "
+                            "\"={eax},~{edx}\"()"));
+
+  // Without an output, the assembly is kept for its effects.
+  ASSERT_THAT(ir, HasSubstr("call void asm sideeffect \"pause\""));
+}
+
+TEST(AsmTest, TestRuns) {
+  jit::Session session;
+  ASSERT_TRUE(session.compile(SOURCE).success());
+
+  ASSERT_EQ(session.lookup<int32_t(int32_t)>("swap")(0x11223344), 0x44332211);
+  ASSERT_EQ(session.lookup<int32_t(int32_t, int32_t)>("sum")(40, 2), 42);
+  session.lookup<void()>("relax")();
+}
+
+TEST(AsmTest, TestOptimizerMergesPureAssembly) {
+  const std::string source = R"(
+fn twice(x: int) -> int {
+  return asm("bswapl $0", "=r,0", x) -> int + asm("bswapl $0", "=r,0", x) -> int;
+}
+
+fn clock() -> int {
+  return asm volatile("rdtsc", "={eax},~{edx}") -> int -
+         asm volatile("rdtsc", "={eax},~{edx}") -> int;
+}
+)";
+
+  const Result result = emit(source, OutputKind::IR, 2);
+  ASSERT_TRUE(result.success());
+
+  size_t swaps = 0, clocks = 0;
+  for (size_t at = 0; (at = result.output.find("asm \"bswapl", at)) !=
+                      std::string::npos;
+       ++at)
+    swaps++;
+
+  for (size_t at = 0; (at = result.output.find("asm sideeffect \"rdtsc", at)) !=
+                      std::string::npos;
+       ++at)
+    clocks++;
+
+  ASSERT_EQ(swaps, 1u);
+  ASSERT_EQ(clocks, 2u);
+}
+
+TEST(AsmTest, TestChecksConstraints) {
+  ASSERT_THAT(firstError("fn f(x: int) -> int { return asm(\"\", \"=r,r\") "
+                         "-> int; }"),
+              HasSubstr("has 0 operand(s) for 1 input constraint(s)"));
+
+  ASSERT_THAT(firstError("fn f(x: int) -> void { asm(\"\", \"=r,r\", x); }"),
+              HasSubstr("must have 0 output constraint(s), got 1"));
+
+  ASSERT_THAT(firstError("fn f(x: bool) -> int { return asm(\"\", \"=r,0\", x) "
+                         "-> int; }"),
+              HasSubstr("tied to an output of another type"));
+
+  ASSERT_THAT(firstError("fn f(s: str) -> void { asm(\"\", \"*m\", s); }"),
+              HasSubstr("memory operands are not supported"));
+
+  ASSERT_THAT(firstError("fn f() -> void { asm(\"\", \"=\"); }"),
+              HasSubstr("Invalid inline assembly constraints"));
+
+  ASSERT_THAT(firstError("const X: int = asm(\"\", \"=r\") -> int;"),
+              HasSubstr("Inline assembly must be inside a function"));
+}
+
+TEST(AsmTest, TestReportsTargetErrors) {
+  const std::string source = "fn f() -> void { asm(\"notaninstruction\", "
+                             "\"\"); }";
+
+  const Result result = emit(source, OutputKind::OBJECT);
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("invalid instruction mnemonic 'notaninstruction'"));
+
+  jit::Session session;
+  ASSERT_TRUE(session.compile(source).success());
+  ASSERT_THROW(session.lookup<void()>("f"), errors::JitError);
+}
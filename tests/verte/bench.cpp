@@ -0,0 +1,107 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+// Without the black boxes, `square(7)` would fold to a constant at -O2 and
+// the benchmark would measure nothing.
+static constexpr std::string_view SOURCE = R"(fn square(x: int) -> int {
+  return x * x;
+}
+
+bench square_7 {
+  black_box(square(black_box(7)));
+}
+
+bench empty {}
+)";
+
+static Options benchOptions(OutputKind output) {
+  Options options;
+  options.output = output;
+  options.optLevel = 2;
+  options.codegen.bench = true;
+  return options;
+}
+
+// The body of a function of printed IR, from its `define` to its `}`.
+static std::string body(const std::string &ir, const std::string &name) {
+  const auto start = ir.find("@" + name + "(");
+  if (start == std::string::npos)
+    return "";
+
+  return ir.substr(start, ir.find("\n}", start) - start);
+}
+
+TEST(BenchTest, TestBlackBoxKeepsArgument) {
+  const Result result = compile(SOURCE, benchOptions(OutputKind::IR));
+  ASSERT_TRUE(result.success());
+
+  const std::string bench = body(result.output, "bench.square_7");
+  ASSERT_FALSE(bench.empty()) << result.output;
+
+  // The constant goes into the first black box as is, and the result of the
+  // call comes out of the second one: neither is folded away.
+  ASSERT_THAT(bench, HasSubstr(R"(asm sideeffect "", "=r,0,~{memory}"(i32 7))"));
+  ASSERT_THAT(bench, Not(HasSubstr("i32 49")));
+
+  size_t boxes = 0;
+  for (size_t at = bench.find("asm sideeffect"); at != std::string::npos;
+       at = bench.find("asm sideeffect", at + 1))
+    boxes++;
+
+  ASSERT_EQ(boxes, 2u);
+
+  // The harness replaces `main`, with a table of both benchmarks.
+  ASSERT_THAT(result.output, HasSubstr("@bench.table"));
+  ASSERT_THAT(result.output, HasSubstr("call i32 @verte_bench_main("));
+}
+
+TEST(BenchTest, TestHarnessRunsAndReports) {
+  const Result result = compile(SOURCE, benchOptions(OutputKind::OBJECT));
+  ASSERT_TRUE(result.success());
+
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-bench-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  const auto object = directory / "bench.o";
+  const auto executable = directory / "bench";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  const auto command = std::format("{} --json --samples 3 --filter square",
+                                   executable.string());
+  FILE *pipe = popen(command.c_str(), "r");
+  ASSERT_NE(pipe, nullptr);
+
+  std::string output;
+  for (int c; (c = std::fgetc(pipe)) != EOF;)
+    output += static_cast<char>(c);
+
+  const int status = pclose(pipe);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  ASSERT_THAT(output, HasSubstr(R"("name": "square_7")"));
+  ASSERT_THAT(output, HasSubstr(R"("samples": 3)"));
+  ASSERT_THAT(output, ContainsRegex(R"("mean_ns": [0-9]+\.[0-9]+)"));
+  ASSERT_THAT(output, Not(HasSubstr("empty")));
+
+  std::filesystem::remove_all(directory);
+}
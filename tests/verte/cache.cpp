@@ -0,0 +1,126 @@
+#include "verte/driver/cache.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = "fn f() -> int { return 1; }";
+
+/**
+ * @class CacheTest
+ * @brief Fixture serving a fresh cache directory on a free port.
+ */
+class CacheTest : public Test {
+protected:
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() /
+                std::format("verte-cache-test-{}", getpid());
+    std::filesystem::remove_all(directory);
+
+    server = std::make_unique<cache::Server>(
+        utils::Endpoint{"127.0.0.1", 0}, directory);
+    thread = std::thread([this] { server->run(); });
+  }
+
+  void TearDown() override {
+    server->stop();
+    thread.join();
+    std::filesystem::remove_all(directory);
+  }
+
+  cache::Client client() const {
+    return cache::Client({"127.0.0.1", server->getPort()});
+  }
+
+  std::filesystem::path directory;
+  std::unique_ptr<cache::Server> server;
+  std::thread thread;
+};
+
+TEST(CacheKeyTest, TestKeyCoversSourceAndOptions) {
+  Options options;
+  const auto key = cache::computeKey(SOURCE, options);
+  ASSERT_TRUE(cache::isKey(key));
+  ASSERT_EQ(key, cache::computeKey(SOURCE, options));
+  ASSERT_NE(key, cache::computeKey("fn f() -> int { return 2; }", options));
+
+  options.output = OutputKind::IR;
+  ASSERT_NE(key, cache::computeKey(SOURCE, options));
+}
+
+TEST(CacheKeyTest, TestFromUrl) {
+  ASSERT_TRUE(cache::Client::fromUrl("http://localhost:8080"));
+  ASSERT_TRUE(cache::Client::fromUrl("http://cache/v1/cache/"));
+  ASSERT_FALSE(cache::Client::fromUrl("https://localhost:8080"));
+  ASSERT_FALSE(cache::Client::fromUrl("http://:8080"));
+}
+
+TEST_F(CacheTest, TestMissThenHit) {
+  int compiles = 0;
+  auto build = [&](std::string_view source, const Options &options) {
+    compiles++;
+    return compile(source, options);
+  };
+
+  const Result first = client().compile(SOURCE, {}, build);
+  ASSERT_TRUE(first.success());
+  ASSERT_EQ(compiles, 1);
+
+  // A second client, i.e on another agent, reuses the uploaded object.
+  const Result second = client().compile(SOURCE, {}, build);
+  ASSERT_EQ(compiles, 1);
+  ASSERT_EQ(second.output, first.output);
+}
+
+TEST_F(CacheTest, TestFailuresAreNotUploaded) {
+  int compiles = 0;
+  auto build = [&](std::string_view source, const Options &options) {
+    compiles++;
+    return compile(source, options);
+  };
+
+  ASSERT_FALSE(client().compile("fn f( {", {}, build).success());
+  ASSERT_FALSE(client().compile("fn f( {", {}, build).success());
+  ASSERT_EQ(compiles, 2);
+}
+
+TEST_F(CacheTest, TestFailedWriteIsNotPublished) {
+  const auto key = cache::computeKey(SOURCE, {});
+  const auto entry = directory / key.substr(0, 2) / key;
+
+  // The first upload of the server is written aside there, which a directory
+  // makes fail.
+  auto temporary = entry;
+  temporary += std::format(".{}.0.tmp", getpid());
+  std::filesystem::create_directories(temporary);
+
+  ASSERT_FALSE(client().put(key, compile(SOURCE)));
+  ASSERT_FALSE(std::filesystem::exists(entry));
+  ASSERT_FALSE(std::filesystem::exists(temporary));
+  ASSERT_FALSE(client().get(key));
+}
+
+TEST(CacheServerTest, TestUnreachableServerIsAMiss) {
+  // Reserve a port, then close it so that nothing listens there.
+  uint16_t port;
+  {
+    cache::Server server({"127.0.0.1", 0},
+                         std::filesystem::temp_directory_path());
+    port = server.getPort();
+  }
+
+  cache::Client client({"127.0.0.1", port});
+  ASSERT_FALSE(client.get(cache::computeKey(SOURCE, {})));
+  ASSERT_TRUE(client.compile(SOURCE, {}, [](auto source, const auto &options) {
+                      return compile(source, options);
+                    }).success());
+}
@@ -0,0 +1,210 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/sexpr.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+// Two stages of a pipeline, then the non-blocking operations on a full and
+// an empty channel. The exit code tells the first check that failed.
+static constexpr std::string_view SOURCE = R"(fn puts(s: str) -> int;
+
+numbers: chan<int> = chan<int>(16);
+total: int = 0;
+
+fn produce(n: int) -> int {
+  if [n > 1000] then {
+    send(numbers, 0);
+    return 0;
+  }
+
+  send(numbers, n);
+  return produce(n + 1);
+}
+
+fn consume(sum: int) -> int {
+  n: int = recv(numbers);
+  if [n == 0] then { return sum; }
+  return consume(sum + n);
+}
+
+fn stage(i: int) -> void {
+  if [i == 0] then { produce(1); }
+  if [i == 1] then { total = consume(0); }
+}
+
+fn main() -> int {
+  parallel_for(2, stage);
+  if [total != 500500] then { return 1; }
+
+  small: chan<int> = chan<int>(2);
+  if [try_send(small, 7) == false] then { return 2; }
+  if [try_send(small, 8) == false] then { return 2; }
+  if [try_send(small, 9)] then { return 3; }
+
+  if [try_recv(small, -1) != 7] then { return 4; }
+  if [recv(small) != 8] then { return 4; }
+  if [try_recv(small, -1) != -1] then { return 5; }
+
+  flags: chan<bool> = chan<bool>(1);
+  send(flags, true);
+  if [recv(flags) == false] then { return 6; }
+
+  words: chan<str> = chan<str>(1);
+  send(words, "pipeline");
+  puts(recv(words));
+  return 0;
+}
+)";
+
+static std::string firstError(std::string_view source) {
+  const Result result = compile(source);
+  EXPECT_FALSE(result.success());
+  return result.diagnostics.empty() ? "" : result.diagnostics[0].message;
+}
+
+TEST(ChanTest, TestParses) {
+  lexer::Lexer lexer("fn f(c: chan<int>) -> int { d: chan<str> = "
+                     "chan<str>(4); return recv(c); }");
+  nodes::Parser parser(lexer.allTokens());
+
+  std::ostringstream out;
+  visitors::SexprPrinter printer(out);
+  parser.parse()->accept(printer);
+
+  ASSERT_EQ(out.str(), "(fn f ((c chan<int>)) int (block (var d chan<str> "
+                       "(call chan<str> 4)) (return (call recv c))))\n");
+}
+
+TEST(ChanTest, TestLowersToRuntime) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+
+  const std::string &ir = result.output;
+  ASSERT_THAT(ir, HasSubstr("%\"chan<int>\" = type { ptr }"));
+  ASSERT_THAT(ir, HasSubstr("@numbers = global %\"chan<int>\" "
+                            "zeroinitializer"));
+  ASSERT_THAT(ir, HasSubstr("@llvm.global_ctors"));
+  ASSERT_THAT(ir, HasSubstr("call ptr @verte_chan_new(i32 16)"));
+  ASSERT_THAT(ir, HasSubstr("call void @verte_chan_send(ptr %handle"));
+  ASSERT_THAT(ir, HasSubstr("call i64 @verte_chan_recv(ptr %handle"));
+  ASSERT_THAT(ir, HasSubstr("call i32 @verte_chan_try_recv(ptr %handle"));
+}
+
+TEST(ChanTest, TestRejectsInvalidUses) {
+  ASSERT_THAT(firstError("fn f(c: chan<int>) -> void { send(c, \"x\"); }"),
+              HasSubstr("`send` expects a `int` value for a `chan<int>`"));
+
+  ASSERT_THAT(firstError("fn f() -> int { return recv(1); }"),
+              HasSubstr("`recv` expects a channel"));
+
+  ASSERT_THAT(firstError("fn f(c: chan<int>) -> int { return try_recv(c); }"),
+              HasSubstr("`try_recv` expects 2 argument(s)"));
+
+  ASSERT_THAT(firstError("fn f(c: chan<void>) -> void {}"),
+              HasSubstr("Channels carry `int`, `float`"));
+
+  ASSERT_THAT(firstError("const C: chan<int> = chan<int>(4);"),
+              HasSubstr("Global channels must be mutable and shared"));
+
+  ASSERT_THAT(firstError("fn f() -> void { c: chan<int> = chan<int>(-1); }"),
+              HasSubstr("`chan<int>` expects a positive capacity"));
+}
+
+TEST(ChanTest, TestDoesNotShadowFunctions) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  const Result result = compile(R"(fn send(fd: int, s: str) -> int;
+fn f() -> int { return send(1, "x"); }
+)",
+                                options);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, HasSubstr("call i32 @send(i32 1"));
+}
+
+TEST(ChanTest, TestRunsPipeline) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-chan-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  const Result result = compile(SOURCE);
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  FILE *pipe = popen(executable.c_str(), "r");
+  ASSERT_NE(pipe, nullptr);
+
+  std::string output;
+  for (int c; (c = std::fgetc(pipe)) != EOF;)
+    output += static_cast<char>(c);
+
+  const int status = pclose(pipe);
+  std::filesystem::remove_all(directory);
+
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  ASSERT_EQ(output, "pipeline\n");
+}
+
+TEST(ChanTest, TestAbortsOnInvalidCapacity) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-chan-capacity-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  // The capacity is only known when the program runs.
+  const Result result = compile(R"(fn none() -> int { return 0; }
+
+fn main() -> int {
+  c: chan<int> = chan<int>(none());
+  return 0;
+}
+)");
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  const auto command = std::format("{} 2>&1", executable.string());
+  FILE *pipe = popen(command.c_str(), "r");
+  ASSERT_NE(pipe, nullptr);
+
+  std::string output;
+  for (int c; (c = std::fgetc(pipe)) != EOF;)
+    output += static_cast<char>(c);
+
+  const int status = pclose(pipe);
+  std::filesystem::remove_all(directory);
+
+  ASSERT_FALSE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  ASSERT_THAT(output, HasSubstr("channel capacity must be positive, got 0"));
+}
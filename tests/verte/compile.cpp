@@ -0,0 +1,142 @@
+#include "verte/driver/compile.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(
+fn add(a: int, b: int) -> int {
+  return a + b;
+}
+)";
+
+TEST(CompileTest, TestEmitIr) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+  ASSERT_TRUE(result.diagnostics.empty());
+  ASSERT_THAT(result.output, HasSubstr("define i32 @add(i32 %a, i32 %b)"));
+}
+
+TEST(CompileTest, TestEmitBitcode) {
+  Options options;
+  options.output = OutputKind::BITCODE;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, StartsWith("BC\xC0\xDE"));
+}
+
+TEST(CompileTest, TestEmitObject) {
+  const Result result = compile(SOURCE);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, StartsWith("\x7F"
+                                        "ELF"));
+}
+
+TEST(CompileTest, TestEmitObjectAtEveryLevel) {
+  // -O0 emits through FastISel and, as the driver does, skips the verifier.
+  for (unsigned level = 0; level <= 3; ++level) {
+    Options options;
+    options.optLevel = level;
+    options.verify = level > 0;
+
+    const Result result = compile(SOURCE, options);
+    ASSERT_TRUE(result.success()) << level;
+    ASSERT_THAT(result.output, StartsWith("\x7F"
+                                          "ELF"))
+        << level;
+  }
+}
+
+TEST(CompileTest, TestEmitAssembly) {
+  Options options;
+  options.output = OutputKind::ASSEMBLY;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, HasSubstr("add:"));
+  ASSERT_THAT(result.output, Not(HasSubstr(".loc")));
+}
+
+TEST(CompileTest, TestEmitAnnotatedAssembly) {
+  Options options;
+  options.output = OutputKind::ASSEMBLY;
+  options.annotate = true;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+
+  // The summary comes first, then the lines with their instructions.
+  const std::string &assembly = result.output;
+  const size_t summary = assembly.find(" add: ");
+  const size_t line = assembly.find("   3 |   return a + b;");
+  ASSERT_NE(summary, std::string::npos);
+  ASSERT_NE(line, std::string::npos);
+  ASSERT_LT(summary, line);
+
+  ASSERT_THAT(assembly, ContainsRegex(" add: [1-9][0-9]* bytes of code, "
+                                      "[0-9]+ bytes of static stack frame"));
+
+  // The line table is left out of the listing.
+  ASSERT_THAT(assembly, Not(HasSubstr(".loc")));
+  ASSERT_THAT(assembly, Not(HasSubstr(".debug_info")));
+}
+
+TEST(CompileTest, TestParserDiagnostic) {
+  const Result result = compile("fn add(a: int) -> int { return a }");
+  ASSERT_FALSE(result.success());
+  ASSERT_TRUE(result.output.empty());
+
+  ASSERT_EQ(result.diagnostics.size(), 1);
+  ASSERT_EQ(result.diagnostics[0].severity, Diagnostic::Severity::ERROR);
+  ASSERT_THAT(result.diagnostics[0].message, HasSubstr("Expected a `;`"));
+  ASSERT_EQ(result.diagnostics[0].line, 1);
+}
+
+TEST(CompileTest, TestCodegenDiagnostic) {
+  const Result result = compile("fn main() -> int { return missing(); }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Unknown function referenced: missing"));
+}
+
+TEST(CompileTest, TestSharedVisibility) {
+  Options options;
+  options.output = OutputKind::IR;
+  options.moduleName = "libmath";
+  options.codegen.shared = true;
+
+  const Result result = compile(R"(
+fn helper(a: int) -> int {
+  return a;
+}
+
+#[export]
+fn add(a: int, b: int) -> int {
+  return helper(a) + b;
+}
+
+#[export]
+const version: int = 3;
+)",
+                                options);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, HasSubstr("define i32 @add("));
+  ASSERT_THAT(result.output, HasSubstr("define hidden i32 @helper("));
+  ASSERT_THAT(result.header, HasSubstr("#ifndef LIBMATH_H"));
+  ASSERT_THAT(result.header, HasSubstr("int32_t add(int32_t a, int32_t b);"));
+  ASSERT_THAT(result.header, HasSubstr("extern const int32_t version;"));
+  ASSERT_THAT(result.header, Not(HasSubstr("helper")));
+}
+
+TEST(CompileTest, TestUnknownAttribute) {
+  const Result result = compile("#[inline] fn f() -> void {}");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message, HasSubstr("Unknown attribute"));
+}
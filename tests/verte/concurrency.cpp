@@ -0,0 +1,94 @@
+#include "verte/driver/compile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <format>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace verte;
+
+/**
+ * @brief Generate a program with a given number of functions.
+ * @param seed Varies the constants used by the program.
+ * @param functions The number of functions.
+ * @return The source of the program.
+ */
+static std::string generateSource(int seed, int functions) {
+  std::string source = std::format("const SEED: int = {};\n", seed);
+  source += "fn f0(x: int) -> int { return x + SEED; }\n";
+
+  for (int i = 1; i < functions; ++i) {
+    source += std::format("fn f{}(x: int) -> int {{\n"
+                          "  if [x > {}] then {{ return f{}(x - 1) * 2; }}\n"
+                          "  return x % {};\n"
+                          "}}\n",
+                          i, i, i - 1, i + 1);
+  }
+
+  return source;
+}
+
+// Run with `-DVERTE_SANITIZER=thread` to check the pipelines are race-free.
+TEST(ConcurrencyTest, TestIndependentCompilations) {
+  constexpr int SOURCES = 8;
+  constexpr int ROUNDS = 16;
+
+  const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+
+  // Serial reference outputs, for every output kind.
+  std::vector<std::string> sources;
+  std::vector<std::vector<std::string>> expected(SOURCES);
+
+  for (int i = 0; i < SOURCES; ++i) {
+    sources.push_back(generateSource(i, 16 + i));
+
+    for (auto kind : {OutputKind::OBJECT, OutputKind::BITCODE, OutputKind::IR}) {
+      Options options;
+      options.output = kind;
+
+      const Result result = compile(sources[i], options);
+      ASSERT_TRUE(result.success());
+      expected[i].push_back(result.output);
+    }
+  }
+
+  std::atomic<int> mismatches = 0;
+  std::vector<std::thread> workers;
+
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      for (int round = 0; round < ROUNDS; ++round) {
+        const int i = (t + round) % SOURCES;
+        const int kind = round % 3;
+
+        Options options;
+        options.output = static_cast<OutputKind>(kind);
+        options.logLevel = utils::LogLevel::NONE;
+
+        const Result result = compile(sources[i], options);
+        if (!result.success() || result.output != expected[i][kind])
+          mismatches++;
+      }
+    });
+  }
+
+  for (auto &worker : workers)
+    worker.join();
+
+  ASSERT_EQ(mismatches, 0);
+}
+
+TEST(ConcurrencyTest, TestScopedLogLevel) {
+  utils::logging::setLevel(utils::LogLevel::ERROR);
+
+  std::thread([] {
+    utils::logging::ScopedLevel level(utils::LogLevel::INFO);
+    ASSERT_EQ(utils::logging::getLevel(), utils::LogLevel::INFO);
+  }).join();
+
+  ASSERT_EQ(utils::logging::getLevel(), utils::LogLevel::ERROR);
+  utils::logging::setLevel(utils::LogLevel::NONE);
+}
@@ -0,0 +1,117 @@
+#include "verte/frontend/lexer/lexer.hpp"
+#include "verte/frontend/parser/parser.hpp"
+#include "verte/frontend/visitors/json.hpp"
+#include "verte/frontend/visitors/pretty.hpp"
+#include "verte/frontend/visitors/sexpr.hpp"
+#include "verte/utils/writer.hpp"
+
+#include "llvm/Support/JSON.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(#[export]
+const LIMIT: int = 10;
+
+fn clamp(x: int) -> int {
+  if [x > LIMIT] then { return LIMIT; } else { return -x; }
+}
+
+fn greet() -> str { return "say \"hi\"\n"; }
+)";
+
+static std::unique_ptr<nodes::ProgramNode> parse(std::string_view source) {
+  lexer::Lexer lexer(source);
+  nodes::Parser parser(lexer.allTokens());
+  return parser.parse();
+}
+
+TEST(WriterTest, TestBuffersWrites) {
+  std::ostringstream out;
+
+  {
+    utils::BufferedWriter writer(out, 8);
+    writer << "abc" << 'd';
+    writer.fill(' ', 3);
+    ASSERT_EQ(out.str(), "");
+
+    // Past the buffer, and larger than it.
+    writer << "ef" << std::string(20, 'x');
+    writer.number(12345);
+    ASSERT_EQ(out.str(), "abcd   ef" + std::string(20, 'x'));
+
+    writer.fill('-', 19);
+  }
+
+  ASSERT_EQ(out.str(), "abcd   ef" + std::string(20, 'x') + "12345" +
+                           std::string(19, '-'));
+}
+
+TEST(DumpTest, TestText) {
+  std::ostringstream out;
+  visitors::PrettyPrinter printer(out);
+  parse("fn f(x: int) -> int { return x + 1; }")->accept(printer);
+
+  ASSERT_EQ(out.str(), "Program Node:\n"
+                       "  FuncDecl Node:\n"
+                       "    Proto Node: f\n"
+                       "      Arg: x : int\n"
+                       "      Return Node: int\n"
+                       "    Block Node:\n"
+                       "      Return Node:\n"
+                       "        Binary Node: +\n"
+                       "          Variable: x\n"
+                       "          Literal: 1\n");
+}
+
+TEST(DumpTest, TestJsonLines) {
+  std::ostringstream out;
+  visitors::JsonPrinter printer(out);
+  parse(SOURCE)->accept(printer);
+
+  std::vector<llvm::json::Value> items;
+  std::istringstream lines(out.str());
+  for (std::string line; std::getline(lines, line);) {
+    auto item = llvm::json::parse(line);
+    ASSERT_TRUE(static_cast<bool>(item)) << llvm::toString(item.takeError());
+    items.push_back(std::move(*item));
+  }
+
+  ASSERT_EQ(items.size(), 3u);
+
+  const auto *constant = items[0].getAsObject();
+  ASSERT_EQ(constant->getString("kind")->str(), "VarDecl");
+  ASSERT_EQ(constant->getString("name")->str(), "LIMIT");
+  ASSERT_TRUE(*constant->getBoolean("constant"));
+  const auto &attribute = (*constant->getArray("attributes"))[0];
+  ASSERT_EQ(attribute.getAsObject()->getString("name")->str(), "export");
+
+  // Spans point back into the source.
+  const auto *clamp = items[1].getAsObject();
+  const auto offset = *clamp->getInteger("offset");
+  ASSERT_EQ(SOURCE.substr(offset, 2), "fn");
+  ASSERT_EQ(clamp->getObject("proto")->getString("returns")->str(), "int");
+
+  const auto *body = items[2].getAsObject()->getObject("body");
+  const auto *value = (*body->getArray("body"))[0].getAsObject()->getObject(
+      "value");
+  ASSERT_EQ(value->getString("value")->str(), "say \"hi\"\n");
+}
+
+TEST(DumpTest, TestSexpr) {
+  std::ostringstream out;
+  visitors::SexprPrinter printer(out);
+  parse(SOURCE)->accept(printer);
+
+  ASSERT_EQ(out.str(),
+            "(const LIMIT int 10 (attr export))\n"
+            "(fn clamp ((x int)) int (block (if (> x LIMIT) (block (return "
+            "LIMIT)) (block (return (- x))))))\n"
+            "(fn greet () str (block (return \"say \\\"hi\\\"\\n\")))\n");
+}
@@ -0,0 +1,116 @@
+#include "verte/utils/flat_map.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace ::testing;
+using namespace verte;
+
+TEST(FlatMapTest, TestInsertFindErase) {
+  utils::FlatMap<std::string, int> map = {{"one", 1}, {"two", 2}};
+  ASSERT_EQ(map.size(), 2u);
+  ASSERT_EQ(map.at("one"), 1);
+  ASSERT_THROW((void)map.at("three"), std::out_of_range);
+
+  map["three"] = 3;
+  ASSERT_TRUE(map.contains("three"));
+  ASSERT_FALSE(map.try_emplace("three", 4).second);
+  ASSERT_EQ(map["three"], 3);
+
+  // Lookups take any string-like key without copying it.
+  const std::string_view key = "two";
+  ASSERT_EQ(map.find(key)->second, 2);
+  ASSERT_EQ(map.erase(key), 1u);
+  ASSERT_EQ(map.erase(key), 0u);
+  ASSERT_EQ(map.find(key), map.end());
+  ASSERT_EQ(map.size(), 2u);
+
+  std::map<std::string, int> entries(map.begin(), map.end());
+  ASSERT_THAT(entries, ElementsAre(Pair("one", 1), Pair("three", 3)));
+}
+
+TEST(FlatMapTest, TestReserve) {
+  utils::FlatMap<int, int> map;
+  map.reserve(1000);
+  const size_t slots = map.slotCount();
+  ASSERT_GE(slots, 1000u);
+
+  for (int i = 0; i < 1000; ++i)
+    map[i] = i;
+
+  ASSERT_EQ(map.slotCount(), slots);
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.slotCount(), slots);
+  ASSERT_EQ(map.begin(), map.end());
+}
+
+TEST(FlatMapTest, TestMatchesUnorderedMap) {
+  utils::FlatMap<std::string, int> map;
+  std::unordered_map<std::string, int> expected;
+  std::mt19937 random(42);
+
+  // Few keys, so that inserts and erases keep hitting the same groups.
+  for (int i = 0; i < 200000; ++i) {
+    const std::string key = "k" + std::to_string(random() % 512);
+
+    switch (random() % 3) {
+      case 0:
+        map[key] = i;
+        expected[key] = i;
+        break;
+
+      case 1:
+        ASSERT_EQ(map.erase(key), expected.erase(key));
+        break;
+
+      default:
+        ASSERT_EQ(map.contains(key), expected.contains(key));
+        if (expected.contains(key))
+          ASSERT_EQ(map.at(key), expected.at(key));
+    }
+
+    ASSERT_EQ(map.size(), expected.size());
+  }
+
+  // Erased slots are reclaimed rather than growing the table.
+  ASSERT_LE(map.slotCount(), 1024u);
+
+  size_t visited = 0;
+  for (const auto &[key, value] : map) {
+    ASSERT_EQ(expected.at(key), value);
+    visited++;
+  }
+
+  ASSERT_EQ(visited, expected.size());
+}
+
+TEST(FlatMapTest, TestCopyAndMove) {
+  utils::FlatMap<std::string, std::unique_ptr<int>> owned;
+  for (int i = 0; i < 100; ++i)
+    owned.try_emplace(std::to_string(i), std::make_unique<int>(i));
+
+  auto moved = std::move(owned);
+  ASSERT_TRUE(owned.empty());
+  ASSERT_EQ(*moved.at("42"), 42);
+
+  utils::FlatMap<std::string, std::string> map;
+  for (int i = 0; i < 100; ++i)
+    map[std::to_string(i)] = std::string(64, static_cast<char>('a' + i % 26));
+
+  auto copy = map;
+  map.erase("7");
+  ASSERT_EQ(copy.size(), 100u);
+  ASSERT_EQ(copy.at("7"), std::string(64, 'h'));
+
+  copy = std::move(map);
+  ASSERT_EQ(copy.size(), 99u);
+}
@@ -0,0 +1,210 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+#include "verte/driver/jit.hpp"
+#include "verte/driver/stream.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(const STEP: int = 2;
+total: int = 40;
+
+#[thread_local]
+hits: int = 0;
+
+fn bump() -> int {
+  total = total + STEP;
+  hits = hits + 1;
+  return total;
+}
+
+fn count(n: int) -> int {
+  if [n > 0] then {
+    bump();
+    return count(n - 1);
+  }
+
+  return hits;
+}
+
+fn reset() -> void { total = 0; }
+)";
+
+static std::string emitIr(std::string_view source, Options options = {}) {
+  options.output = OutputKind::IR;
+  const Result result = compile(source, options);
+  EXPECT_TRUE(result.success());
+  return result.output;
+}
+
+TEST(GlobalsTest, TestMutableGlobal) {
+  jit::Session session;
+  ASSERT_TRUE(session.compile(R"(counter: int = 0;
+
+fn next() -> int {
+  counter = counter + 1;
+  return counter;
+}
+)").success());
+
+  auto next = session.lookup<int32_t()>("next");
+  ASSERT_EQ(next(), 1);
+  ASSERT_EQ(next(), 2);
+  ASSERT_EQ(next(), 3);
+}
+
+TEST(GlobalsTest, TestThreadLocalModel) {
+  std::string ir = emitIr(SOURCE);
+  ASSERT_THAT(ir, HasSubstr("@STEP = constant i32 2"));
+  ASSERT_THAT(ir, HasSubstr("@total = global i32 40"));
+  ASSERT_THAT(ir, HasSubstr("@hits = thread_local(initialexec) global i32 0"));
+  ASSERT_THAT(ir, HasSubstr("store i32 %addtmp, ptr @total"));
+
+  // A library may be loaded after the start of the program.
+  Options options;
+  options.codegen.shared = true;
+  ir = emitIr(SOURCE, options);
+  ASSERT_THAT(ir, HasSubstr("@hits = hidden thread_local global i32 0"));
+}
+
+TEST(GlobalsTest, TestThreadLocalRuns) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-globals-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  const Result result =
+      compile(std::string(SOURCE) + "fn main() -> int { return count(7); }\n");
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  const int status = std::system(executable.c_str());
+  std::filesystem::remove_all(directory);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 7);
+}
+
+TEST(GlobalsTest, TestRedeclaresAcrossModules) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  // One item per module, the functions see the globals of earlier ones.
+  stream::StreamingCompiler compiler(options, 1);
+  std::istringstream in{std::string(SOURCE)};
+  std::string outputs;
+  const Result result = compiler.compile(
+      in, [&](std::string_view output) { outputs += output; });
+
+  ASSERT_TRUE(result.success()) << result.diagnostics[0].message;
+  ASSERT_THAT(outputs, HasSubstr("@total = external global i32"));
+  ASSERT_THAT(outputs,
+              HasSubstr("@hits = external thread_local(initialexec) global"));
+}
+
+TEST(GlobalsTest, TestHeader) {
+  Options options;
+  options.output = OutputKind::IR;
+  options.codegen.shared = true;
+
+  const Result result = compile(R"(#[export]
+counter: int = 0;
+
+#[export]
+#[thread_local]
+scratch: int = 0;
+)",
+                                options);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.header, HasSubstr("\nextern int32_t counter;"));
+  ASSERT_THAT(result.header, HasSubstr("extern __thread int32_t scratch;"));
+}
+
+TEST(GlobalsTest, TestHeaderCompiles) {
+  Options options;
+  options.output = OutputKind::IR;
+  options.moduleName = "libname";
+  options.codegen.shared = true;
+
+  const Result result = compile(R"(#[export]
+const NAME: str = "verte";
+
+#[export]
+const VERSION: int = 3;
+
+#[export]
+fn greet(name: str) -> str {
+  return name;
+}
+)",
+                                options);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.header, HasSubstr("extern const char *const NAME;"));
+  ASSERT_THAT(result.header, HasSubstr("extern const int32_t VERSION;"));
+
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-header-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "libname.h") << result.header;
+  std::ofstream(directory / "main.c") << "#include \"libname.h\"\n";
+
+  // The header is included from both C and C++.
+  const int c = std::system(
+      std::format("gcc -fsyntax-only -Wall -Werror -x c {}",
+                  (directory / "main.c").string())
+          .c_str());
+  const int cpp = std::system(
+      std::format("g++ -fsyntax-only -Wall -Werror -x c++ {}",
+                  (directory / "main.c").string())
+          .c_str());
+
+  std::filesystem::remove_all(directory);
+  ASSERT_EQ(c, 0);
+  ASSERT_EQ(cpp, 0);
+}
+
+TEST(GlobalsTest, TestRejectsInvalidGlobals) {
+  Result result = compile("const X: int = 1; fn f() -> void { X = 2; }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Cannot assign to a constant"));
+
+  result = compile("#[thread_local] const X: int = 1;");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Attribute `thread_local` only applies to mutable"));
+
+  result = compile("#[thread_local] fn f() -> void {}");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Attribute `thread_local` only applies to mutable"));
+
+  result = compile("a: int = 1; b: int = a;");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("must be initialized by a constant"));
+
+  result = compile("a: int = 1; a = 2;");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("can only be assigned in a function"));
+}
@@ -0,0 +1,67 @@
+#include "verte/driver/jit.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace verte;
+
+static int32_t hostScale(int32_t value) { return value * 10; }
+
+static bool hostEven(int32_t value) { return value % 2 == 0; }
+
+TEST(JitTest, TestCallVerteFunction) {
+  jit::Session session;
+  ASSERT_TRUE(session.compile("fn add(a: int, b: int) -> int { return a + b; }")
+                  .success());
+
+  auto add = session.lookup<int32_t(int32_t, int32_t)>("add");
+  ASSERT_EQ(add(2, 3), 5);
+}
+
+TEST(JitTest, TestCallHostFunction) {
+  jit::Session session;
+  session.define("scale(value: int) -> int", &hostScale);
+  session.define("even(value: int) -> bool", &hostEven);
+
+  const auto result = session.compile(R"(
+    fn run(x: int) -> int {
+      if [even(x)] then { return scale(x); }
+      return x;
+    }
+  )");
+
+  ASSERT_TRUE(result.success());
+
+  auto run = session.lookup<int32_t(int32_t)>("run");
+  ASSERT_EQ(run(4), 40);
+  ASSERT_EQ(run(3), 3);
+}
+
+TEST(JitTest, TestCallAcrossCompilations) {
+  jit::Session session;
+  ASSERT_TRUE(session.compile("fn twice(x: int) -> int { return x * 2; }")
+                  .success());
+
+  ASSERT_TRUE(
+      session.compile("fn quad(x: int) -> int { return twice(twice(x)); }")
+          .success());
+
+  ASSERT_EQ(session.lookup<int32_t(int32_t)>("quad")(3), 12);
+}
+
+TEST(JitTest, TestSignatureMismatch) {
+  jit::Session session;
+  ASSERT_THROW(session.define("scale(value: int) -> bool", &hostScale),
+               errors::JitError);
+
+  ASSERT_TRUE(session.compile("fn id(x: int) -> int { return x; }").success());
+  ASSERT_THROW(session.lookup<bool(int32_t)>("id"), errors::JitError);
+  ASSERT_THROW(session.lookup<int32_t(int32_t)>("missing"), errors::JitError);
+}
+
+TEST(JitTest, TestCompileDiagnostics) {
+  jit::Session session;
+  const auto result = session.compile("fn f() -> int { return g(); }");
+
+  ASSERT_FALSE(result.success());
+  ASSERT_EQ(result.diagnostics.size(), 1);
+}
@@ -0,0 +1,220 @@
+#include "verte/driver/lsp.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <format>
+#include <random>
+#include <sstream>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(const SCALE: int = 3;
+
+fn scale(x: int) -> int {
+  if [x > 0] then { return x * SCALE; } else { return 0; }
+}
+
+bench scaling { black_box(scale(7)); }
+
+fn twice(x: int) -> int { return scale(x) * 2; }
+)";
+
+/**
+ * @brief Get the offset of the n-th occurrence of a text.
+ */
+static uint32_t offsetOf(std::string_view source, std::string_view text,
+                         int nth = 0) {
+  size_t offset = source.find(text);
+  while (nth-- > 0)
+    offset = source.find(text, offset + 1);
+
+  return static_cast<uint32_t>(offset);
+}
+
+/**
+ * @brief Describe the analysis of a document, to compare documents.
+ */
+static std::string describe(const lsp::Document &document) {
+  std::string description;
+  for (const auto &symbol : document.getSymbols())
+    description += std::format("{} {} {}\n", symbol.detail,
+                               symbol.selection.offset, symbol.extent.length);
+
+  for (const auto &diagnostic : document.getDiagnostics())
+    description += std::format("{} {}\n", diagnostic.location.offset,
+                               diagnostic.message);
+
+  return description;
+}
+
+TEST(LspTest, TestLookup) {
+  lsp::Document document{std::string(SOURCE)};
+  ASSERT_THAT(document.getDiagnostics(), IsEmpty());
+
+  // A constant used in a function.
+  auto constant = document.lookup(offsetOf(SOURCE, "SCALE", 1) + 2);
+  ASSERT_TRUE(constant.has_value());
+  ASSERT_EQ(constant->location.offset, offsetOf(SOURCE, "SCALE", 1));
+  ASSERT_EQ(constant->symbol.selection.offset, offsetOf(SOURCE, "SCALE"));
+  ASSERT_EQ(constant->symbol.detail, "const SCALE: int");
+
+  // A parameter, resolved within its own function.
+  auto param = document.lookup(offsetOf(SOURCE, "scale(x)") + 6);
+  ASSERT_TRUE(param.has_value());
+  ASSERT_EQ(param->symbol.kind, lsp::Symbol::Kind::PARAMETER);
+  ASSERT_EQ(param->symbol.selection.offset, offsetOf(SOURCE, "x: int", 1));
+
+  // A call, from another item.
+  auto call = document.lookup(offsetOf(SOURCE, "scale(7)"));
+  ASSERT_TRUE(call.has_value());
+  ASSERT_EQ(call->symbol.detail, "fn scale(x: int) -> int");
+  ASSERT_EQ(call->symbol.selection.offset, offsetOf(SOURCE, "scale"));
+
+  // Keywords and literals are no names.
+  ASSERT_FALSE(document.lookup(offsetOf(SOURCE, "return")).has_value());
+  ASSERT_FALSE(document.lookup(offsetOf(SOURCE, "2;")).has_value());
+
+  const auto symbols = document.getSymbols();
+  ASSERT_EQ(symbols.size(), 4u);
+  ASSERT_EQ(symbols[2].kind, lsp::Symbol::Kind::BENCH);
+  ASSERT_EQ(symbols[3].extent.end(), offsetOf(SOURCE, "}\n", 3) + 1);
+}
+
+TEST(LspTest, TestDiagnostics) {
+  std::string source(SOURCE);
+  source.replace(offsetOf(source, "scale(x) * 2"), 5, "scal");
+  source += "fn broken(x: int) -> int { return x +; }\n";
+
+  lsp::Document document(source);
+  const auto diagnostics = document.getDiagnostics();
+  ASSERT_EQ(diagnostics.size(), 2u);
+  ASSERT_EQ(diagnostics[0].message, "Unknown function referenced: scal");
+  ASSERT_EQ(diagnostics[0].location.offset, offsetOf(source, "scal(x)"));
+  ASSERT_EQ(diagnostics[1].location.offset, offsetOf(source, "+;") + 1);
+
+  // Fixing the source clears them.
+  document.update(std::string(SOURCE));
+  ASSERT_THAT(document.getDiagnostics(), IsEmpty());
+}
+
+TEST(LspTest, TestIncrementalEdits) {
+  std::string source;
+  for (int i = 0; i < 200; ++i)
+    source += std::format("fn f{}(x: int) -> int {{\n  return x + {};\n}}\n\n",
+                          i, i);
+
+  lsp::Document document(source);
+  ASSERT_EQ(document.getStats().items, 200u);
+
+  // Only the items around the edit are parsed again, the following ones move.
+  const auto position = document.toPosition(offsetOf(source, "x + 100"));
+  document.edit(position, {position.line, position.character + 1}, "100 * x");
+  ASSERT_LE(document.getStats().reparsed, 2u);
+  ASSERT_EQ(document.getStats().items, 200u);
+  ASSERT_EQ(describe(document), describe(lsp::Document(document.getText())));
+
+  auto call = document.lookup(offsetOf(document.getText(), "x + 150"));
+  ASSERT_TRUE(call.has_value());
+  ASSERT_EQ(call->symbol.selection.offset,
+            offsetOf(document.getText(), "x: int", 150));
+}
+
+TEST(LspTest, TestRandomEditsMatchFullAnalysis) {
+  std::mt19937 random(42);
+  constexpr std::string_view pieces[] = {
+      "}", "{", ";", "else { }", "/*", "*/", "\"", "\n", "x", "fn g() -> int",
+      "SCALE", " "};
+
+  lsp::Document document{std::string(SOURCE)};
+  for (int i = 0; i < 300; ++i) {
+    std::string text = document.getText();
+    const size_t at = random() % (text.size() + 1);
+    const size_t erase = std::min<size_t>(random() % 4, text.size() - at);
+
+    text.replace(at, erase, pieces[random() % std::size(pieces)]);
+    if (text.size() > 2000)
+      text = SOURCE;
+
+    document.update(text);
+    ASSERT_EQ(describe(document), describe(lsp::Document(text)))
+        << "After edit " << i << ":\n"
+        << text;
+  }
+}
+
+TEST(LspTest, TestPositions) {
+  lsp::Document document("a\n\"\xc3\xa9\xf0\x9f\x98\x80\" b\n");
+
+  // `é` is one UTF-16 unit, the emoji two.
+  ASSERT_EQ(document.toPosition(10).line, 1u);
+  ASSERT_EQ(document.toPosition(10).character, 5u);
+  ASSERT_EQ(document.toOffset({1, 5}), 10u);
+  ASSERT_EQ(document.toOffset({1, 99}), 12u);
+  ASSERT_EQ(document.toOffset({7, 0}), document.getText().size());
+}
+
+TEST(LspTest, TestServerSession) {
+  auto frame = [](const llvm::json::Value &message) {
+    std::ostringstream out;
+    lsp::writeMessage(out, message);
+    return out.str();
+  };
+
+  const std::string uri = "file:///tmp/main.vt";
+  std::istringstream in(
+      frame(llvm::json::Object{{"jsonrpc", "2.0"},
+                               {"id", 1},
+                               {"method", "initialize"},
+                               {"params", llvm::json::Object{}}}) +
+      frame(llvm::json::Object{
+          {"jsonrpc", "2.0"},
+          {"method", "textDocument/didOpen"},
+          {"params",
+           llvm::json::Object{
+               {"textDocument",
+                llvm::json::Object{{"uri", uri},
+                                   {"text", std::string(SOURCE)}}}}}}) +
+      frame(llvm::json::Object{
+          {"jsonrpc", "2.0"},
+          {"id", 2},
+          {"method", "textDocument/definition"},
+          {"params",
+           llvm::json::Object{
+               {"textDocument", llvm::json::Object{{"uri", uri}}},
+               {"position",
+                llvm::json::Object{{"line", 8}, {"character", 35}}}}}}) +
+      frame(llvm::json::Object{
+          {"jsonrpc", "2.0"}, {"id", 3}, {"method", "shutdown"}}) +
+      frame(llvm::json::Object{{"jsonrpc", "2.0"}, {"method", "exit"}}));
+
+  std::ostringstream out;
+  lsp::Server server(out);
+  ASSERT_EQ(server.run(in), 0);
+
+  std::istringstream replies(out.str());
+  std::vector<llvm::json::Value> messages;
+  while (auto body = lsp::readMessage(replies))
+    messages.push_back(llvm::cantFail(llvm::json::parse(*body)));
+
+  ASSERT_EQ(messages.size(), 4u);
+  const auto *capabilities =
+      messages[0].getAsObject()->getObject("result")->getObject(
+          "capabilities");
+  ASSERT_TRUE(*capabilities->getBoolean("hoverProvider"));
+
+  const auto *published = messages[1].getAsObject();
+  ASSERT_EQ(published->getString("method")->str(),
+            "textDocument/publishDiagnostics");
+  ASSERT_TRUE(published->getObject("params")
+                  ->getArray("diagnostics")
+                  ->empty());
+
+  // `scale` of `return scale(x) * 2;` leads to its declaration.
+  const auto *definition = messages[2].getAsObject()->getObject("result");
+  ASSERT_NE(definition, nullptr);
+  const auto *start = definition->getObject("range")->getObject("start");
+  ASSERT_EQ(*start->getInteger("line"), 2);
+  ASSERT_EQ(*start->getInteger("character"), 3);
+}
@@ -0,0 +1,109 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/backend/codegen/mca.hpp"
+#include "verte/driver/compile.hpp"
+
+#include "llvm/Support/Host.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using namespace verte;
+
+// The tail calls become loops at -O2, gcd is a loop around the division.
+static const std::string PROGRAM = R"(fn gcd(a: int, b: int) -> int {
+  if [b == 0] then { return a; }
+  return gcd(b, a % b);
+}
+
+fn power(base: int, exponent: int) -> int {
+  if [exponent == 0] then { return 1; }
+  return base * power(base, exponent - 1);
+}
+)";
+
+// The CPUs are those of x86, the estimates only make sense for one of them.
+static std::string assemble(const std::string &cpu) {
+  Options options;
+  options.output = OutputKind::ASSEMBLY;
+  options.optLevel = 2;
+  options.cpu = cpu;
+
+  const Result result = compile(PROGRAM, options);
+  EXPECT_TRUE(result.success());
+  return result.output;
+}
+
+static bool isX86() {
+  return llvm::sys::getDefaultTargetTriple().starts_with("x86_64");
+}
+
+TEST(McaTest, TestEstimatesInnermostLoops) {
+  if (!isX86())
+    GTEST_SKIP() << "The test models an x86 CPU";
+
+  codegen::ThroughputEstimator estimator("skylake");
+  std::vector<codegen::ThroughputEstimate> estimates;
+  std::string error;
+
+  ASSERT_TRUE(estimator.estimate(assemble("skylake"), "", estimates, error))
+      << error;
+  ASSERT_EQ(estimates.size(), 2u);
+
+  ASSERT_EQ(estimates[0].function, "gcd");
+  ASSERT_THAT(estimates[0].region, StartsWith(".LBB0_"));
+  ASSERT_EQ(estimates[1].function, "power");
+
+  for (const auto &estimate : estimates) {
+    ASSERT_GT(estimate.instructions, 0u);
+    ASSERT_GT(estimate.cycles, 0);
+    ASSERT_GT(estimate.ipc, 0);
+    ASSERT_FALSE(estimate.pressure.empty());
+  }
+
+  // The division is the longest latency of the machine.
+  ASSERT_GT(estimates[0].cycles, estimates[1].cycles);
+
+  const std::string report = estimator.report(estimates);
+  ASSERT_THAT(report, HasSubstr("Throughput on skylake"));
+  ASSERT_THAT(report, HasSubstr("gcd, loop at .LBB0_"));
+  ASSERT_THAT(report, HasSubstr("Cycles per iteration"));
+  ASSERT_THAT(report, HasSubstr("Resource pressure per iteration"));
+}
+
+TEST(McaTest, TestEstimatesNamedFunction) {
+  if (!isX86())
+    GTEST_SKIP() << "The test models an x86 CPU";
+
+  codegen::ThroughputEstimator estimator("skylake");
+  std::vector<codegen::ThroughputEstimate> estimates;
+  std::string error;
+
+  ASSERT_TRUE(
+      estimator.estimate(assemble("skylake"), "power", estimates, error))
+      << error;
+  ASSERT_EQ(estimates.size(), 1u);
+  ASSERT_EQ(estimates[0].function, "power");
+  ASSERT_TRUE(estimates[0].region.empty());
+  ASSERT_THAT(estimator.report(estimates), HasSubstr("power, whole function"));
+
+  estimates.clear();
+  ASSERT_FALSE(
+      estimator.estimate(assemble("skylake"), "missing", estimates, error));
+  ASSERT_THAT(error, HasSubstr("No function named missing"));
+}
+
+TEST(McaTest, TestRejectsUnknownCpu) {
+  std::string error;
+  ASSERT_EQ(codegen::resolveCpu("not-a-cpu", error), "");
+  ASSERT_THAT(error, HasSubstr("Unknown CPU"));
+  ASSERT_FALSE(codegen::resolveCpu("native", error).empty());
+
+  codegen::ThroughputEstimator estimator("not-a-cpu");
+  std::vector<codegen::ThroughputEstimate> estimates;
+  ASSERT_FALSE(estimator.estimate("", "", estimates, error));
+  ASSERT_THAT(error, HasSubstr("Unknown CPU"));
+}
@@ -0,0 +1,159 @@
+#include "verte/driver/objects.hpp"
+#include "verte/backend/codegen/compiler.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(const LIMIT: int = 100;
+
+fn scale(x: int) -> int {
+  y: int = x * 3;
+  if [y > LIMIT] then { return LIMIT; } else { return y; }
+}
+
+fn twice(x: int) -> int { return scale(x) + scale(x); }
+
+fn main() -> int { return twice(5); }
+)";
+
+/**
+ * @class ObjectsTest
+ * @brief Fixture providing a fresh object store.
+ */
+class ObjectsTest : public Test {
+protected:
+  void SetUp() override {
+    directory = std::filesystem::temp_directory_path() /
+                std::format("verte-objects-test-{}", getpid());
+    std::filesystem::remove_all(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+
+  size_t stored() const {
+    return static_cast<size_t>(
+        std::distance(std::filesystem::directory_iterator(directory), {}));
+  }
+
+  std::filesystem::path directory;
+};
+
+TEST_F(ObjectsTest, TestReusesUnchangedFunctions) {
+  objects::FunctionCompiler compiler({}, directory);
+
+  Result result = compiler.compile(SOURCE);
+  ASSERT_TRUE(result.success()) << result.diagnostics[0].message;
+  ASSERT_EQ(compiler.getStats().functions, 3u);
+  ASSERT_EQ(compiler.getStats().reused, 0u);
+  ASSERT_EQ(compiler.getObjects().size(), 4u);
+  ASSERT_EQ(stored(), 4u);
+
+  // Whitespace and comments are not changes, a new compiler shares the store.
+  objects::FunctionCompiler other({}, directory);
+  result = other.compile(std::string("// Scaling.\n") + std::string(SOURCE));
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(other.getStats().reused, 3u);
+  ASSERT_EQ(other.getObjects(), compiler.getObjects());
+
+  std::string edited(SOURCE);
+  edited.replace(edited.find("x * 3"), 5, "x * 4");
+  result = compiler.compile(edited);
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(compiler.getStats().reused, 2u);
+  ASSERT_EQ(stored(), 5u);
+}
+
+TEST_F(ObjectsTest, TestRecompilesDependents) {
+  Options options;
+  options.optLevel = 2;
+  objects::FunctionCompiler compiler(options, directory);
+  ASSERT_TRUE(compiler.compile(SOURCE).success());
+
+  // The callers of a changed signature no longer match it.
+  std::string edited(SOURCE);
+  edited.replace(edited.find("scale(x: int)"), 13, "scale(x: int, k: int)");
+  ASSERT_FALSE(compiler.compile(edited).success());
+
+  // Declaring a callee after its caller fails, as it does in one module.
+  const std::string moved = "fn g() -> int { return f(); }\n"
+                            "fn f() -> int { return 1; }\n";
+  ASSERT_TRUE(compiler.compile("fn f() -> int { return 1; }\n"
+                               "fn g() -> int { return f(); }\n")
+                  .success());
+  ASSERT_THAT(compiler.compile(moved).diagnostics[0].message,
+              HasSubstr("Unknown function referenced: f"));
+
+  // Other optimization levels get their own objects.
+  objects::FunctionCompiler unoptimized({}, directory);
+  ASSERT_TRUE(unoptimized.compile(SOURCE).success());
+  ASSERT_EQ(unoptimized.getStats().reused, 0u);
+}
+
+TEST_F(ObjectsTest, TestReportsRedefinitions) {
+  objects::FunctionCompiler compiler({}, directory);
+  ASSERT_TRUE(compiler.compile("fn f() -> int { return 1; }").success());
+
+  const Result result = compiler.compile("fn f() -> int { return 1; }\n"
+                                         "fn f() -> int { return 1; }\n");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Redefinition of function: f"));
+}
+
+TEST_F(ObjectsTest, TestLinksReusedObjects) {
+  objects::FunctionCompiler compiler({}, directory);
+  ASSERT_TRUE(compiler.compile(SOURCE).success());
+
+  std::string edited(SOURCE);
+  edited.replace(edited.find("twice(5)"), 8, "twice(7)");
+  ASSERT_TRUE(compiler.compile(edited).success());
+  ASSERT_EQ(compiler.getStats().reused, 2u);
+
+  std::vector<std::string> objectFiles;
+  for (const auto &object : compiler.getObjects())
+    objectFiles.push_back(object.string());
+
+  const auto executable = directory / "a.out";
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link(objectFiles, executable.string(), false));
+
+  // 7 * 3 = 21, twice.
+  const int status = std::system(executable.c_str());
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 42);
+}
+
+TEST_F(ObjectsTest, TestFoldsEarlierConstants) {
+  objects::FunctionCompiler compiler({}, directory);
+
+  // `B` is initialized after `f` went into its own object.
+  const Result result = compiler.compile(R"(const A: int = 2;
+fn f() -> int { return A; }
+const B: int = A + 1;
+fn main() -> int { return f() + B; }
+)");
+  ASSERT_TRUE(result.success()) << result.diagnostics[0].message;
+
+  std::vector<std::string> objectFiles;
+  for (const auto &object : compiler.getObjects())
+    objectFiles.push_back(object.string());
+
+  const auto executable = directory / "a.out";
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link(objectFiles, executable.string(), false));
+
+  const int status = std::system(executable.c_str());
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 5);
+}
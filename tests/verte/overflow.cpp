@@ -0,0 +1,139 @@
+#include "verte/driver/compile.hpp"
+#include "verte/driver/jit.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr int32_t MAX = std::numeric_limits<int32_t>::max();
+static constexpr int32_t MIN = std::numeric_limits<int32_t>::min();
+
+static constexpr std::string_view SOURCE = R"(
+fn add(a: int, b: int) -> int { return a + b; }
+fn sub(a: int, b: int) -> int { return a - b; }
+fn mul(a: int, b: int) -> int { return a * b; }
+fn neg(a: int) -> int { return -a; }
+)";
+
+static Options withOverflow(codegen::Overflow overflow) {
+  Options options;
+  options.codegen.overflow = overflow;
+  return options;
+}
+
+static std::string emitIr(std::string_view source, Options options = {}) {
+  options.output = OutputKind::IR;
+  const Result result = compile(source, options);
+  EXPECT_TRUE(result.success());
+  return result.output;
+}
+
+static size_t count(const std::string &text, std::string_view pattern) {
+  size_t found = 0;
+  for (size_t at = text.find(pattern); at != std::string::npos;
+       at = text.find(pattern, at + 1))
+    found++;
+
+  return found;
+}
+
+TEST(OverflowTest, TestWrapByDefault) {
+  const std::string ir = emitIr(SOURCE);
+  ASSERT_THAT(ir, Not(HasSubstr("with.overflow")));
+  ASSERT_THAT(ir, HasSubstr("add i32 %a"));
+
+  jit::Session session;
+  ASSERT_TRUE(session.compile(SOURCE).success());
+  ASSERT_EQ(session.lookup<int32_t(int32_t, int32_t)>("add")(MAX, 1), MIN);
+}
+
+TEST(OverflowTest, TestTrapSharesOneColdBlock) {
+  const std::string ir = emitIr(R"(
+fn poly(x: int, y: int) -> int { return x * x + y * 3 - 7; }
+)", withOverflow(codegen::Overflow::TRAP));
+
+  ASSERT_THAT(ir, HasSubstr("@llvm.smul.with.overflow.i32"));
+  ASSERT_THAT(ir, HasSubstr("@llvm.sadd.with.overflow.i32"));
+  ASSERT_EQ(count(ir, "overflow.trap:"), 1u);
+  ASSERT_EQ(count(ir, "call void @llvm.trap()"), 1u);
+  ASSERT_THAT(ir, HasSubstr("!{!\"branch_weights\", i32 1, i32 1048576}"));
+}
+
+TEST(OverflowTest, TestTrapAborts) {
+  jit::Session session(withOverflow(codegen::Overflow::TRAP));
+  ASSERT_TRUE(session.compile(SOURCE).success());
+
+  auto add = session.lookup<int32_t(int32_t, int32_t)>("add");
+  auto mul = session.lookup<int32_t(int32_t, int32_t)>("mul");
+  auto neg = session.lookup<int32_t(int32_t)>("neg");
+  ASSERT_EQ(add(MAX - 1, 1), MAX);
+  ASSERT_EQ(mul(-46340, 46340), -2147395600);
+  ASSERT_EQ(neg(MAX), -MAX);
+
+  ASSERT_DEATH(add(MAX, 1), "");
+  ASSERT_DEATH(mul(65536, 32768), "");
+  ASSERT_DEATH(neg(MIN), "");
+}
+
+TEST(OverflowTest, TestSaturate) {
+  jit::Session session(withOverflow(codegen::Overflow::SATURATE));
+  ASSERT_TRUE(session.compile(SOURCE).success());
+
+  auto add = session.lookup<int32_t(int32_t, int32_t)>("add");
+  auto sub = session.lookup<int32_t(int32_t, int32_t)>("sub");
+  auto mul = session.lookup<int32_t(int32_t, int32_t)>("mul");
+  auto neg = session.lookup<int32_t(int32_t)>("neg");
+  ASSERT_EQ(add(MAX, 1), MAX);
+  ASSERT_EQ(add(2, 3), 5);
+  ASSERT_EQ(sub(MIN, 1), MIN);
+  ASSERT_EQ(mul(65536, 65536), MAX);
+  ASSERT_EQ(mul(-65536, 65536), MIN);
+  ASSERT_EQ(mul(-7, 6), -42);
+  ASSERT_EQ(neg(MIN), MAX);
+}
+
+TEST(OverflowTest, TestFunctionAttributeOverrides) {
+  const std::string ir = emitIr(R"(
+#[overflow(saturate)]
+fn clamped(a: int, b: int) -> int { return a + b; }
+
+#[overflow(wrap)]
+fn hash(a: int) -> int { return a * 31; }
+
+fn checked(a: int, b: int) -> int { return a + b; }
+)", withOverflow(codegen::Overflow::TRAP));
+
+  ASSERT_THAT(ir, HasSubstr("@llvm.sadd.sat.i32"));
+  ASSERT_THAT(ir, HasSubstr("%multmp = mul i32"));
+  ASSERT_EQ(count(ir, "overflow.trap:"), 1u);
+}
+
+TEST(OverflowTest, TestFoldsConstants) {
+  const std::string ir = emitIr("const BIG: int = 2147483647 + 1;",
+                                withOverflow(codegen::Overflow::SATURATE));
+  ASSERT_THAT(ir, HasSubstr("@BIG = constant i32 2147483647"));
+
+  const Result result = compile("const BIG: int = 2147483647 + 1;",
+                                withOverflow(codegen::Overflow::TRAP));
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Integer overflow in constant expression."));
+}
+
+TEST(OverflowTest, TestRejectsInvalidAttributes) {
+  Result result = compile("#[overflow(panic)] fn f() -> int { return 1; }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Attribute `overflow` takes one of"));
+
+  result = compile("#[overflow(trap)] const X: int = 1;");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Attribute `overflow` only applies to functions"));
+}
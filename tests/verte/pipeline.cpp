@@ -0,0 +1,85 @@
+#include "verte/driver/pipeline.hpp"
+#include "verte/utils/queue.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(const SCALE: int = 3;
+
+fn scale(x: int) -> int {
+  y: int = x * SCALE;
+  if [y > 100] then { return 100; } else { return y; }
+}
+
+bench scaling { black_box(scale(7)); }
+
+fn twice(x: int) -> int { return scale(x) + scale(x); }
+)";
+
+TEST(PipelineTest, TestQueueKeepsOrder) {
+  utils::SpscQueue<int> queue(4);
+
+  std::thread producer([&] {
+    for (int i = 0; i < 100000; ++i)
+      queue.push(i);
+
+    queue.close();
+  });
+
+  int expected = 0;
+  while (auto value = queue.pop())
+    ASSERT_EQ(*value, expected++);
+
+  producer.join();
+  ASSERT_EQ(expected, 100000);
+}
+
+TEST(PipelineTest, TestMatchesSequentialCompilation) {
+  for (unsigned level = 0; level <= 3; ++level) {
+    Options options;
+    options.output = OutputKind::IR;
+    options.optLevel = level;
+    options.codegen.bench = level % 2 == 1;
+
+    pipeline::PipelinedCompiler compiler(options, 2);
+    const Result pipelined = compiler.compile(SOURCE);
+    ASSERT_TRUE(pipelined.success());
+    ASSERT_EQ(compiler.getStats().items, 4u);
+    ASSERT_EQ(pipelined.output, compile(SOURCE, options).output)
+        << "At -O" << level;
+  }
+}
+
+TEST(PipelineTest, TestOptimizes) {
+  Options options;
+  options.output = OutputKind::IR;
+  options.optLevel = 2;
+
+  const Result result = pipeline::PipelinedCompiler(options).compile(SOURCE);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output, Not(HasSubstr("alloca")));
+}
+
+TEST(PipelineTest, TestReportsEarliestStage) {
+  // The parser fails before the lexer does, the lexical error still wins.
+  const std::string source =
+      std::string(SOURCE) + "fn broken() -> int { return 1 }\n\"unterminated";
+
+  const Result pipelined = pipeline::PipelinedCompiler({}).compile(source);
+  const Result sequential = compile(source);
+  ASSERT_FALSE(pipelined.success());
+  ASSERT_EQ(pipelined.diagnostics.size(), 1u);
+  ASSERT_EQ(pipelined.diagnostics[0].message,
+            sequential.diagnostics[0].message);
+  ASSERT_EQ(pipelined.diagnostics[0].line, sequential.diagnostics[0].line);
+
+  const Result generated = pipeline::PipelinedCompiler({}).compile(
+      "fn main() -> int { return missing(); }");
+  ASSERT_THAT(generated.diagnostics[0].message,
+              HasSubstr("Unknown function referenced: missing"));
+}
@@ -0,0 +1,131 @@
+#include "verte/backend/codegen/compiler.hpp"
+#include "verte/driver/compile.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+// Every iteration prints a byte, the loops must run each of them once.
+static constexpr std::string_view SOURCE = R"(fn putchar(c: int) -> int;
+fn puts(s: str) -> int;
+fn strcpy(dest: str, src: str) -> str;
+
+fn inner(i: int) -> void { putchar(65); }
+
+fn outer(i: int) -> void { parallel_for(4, inner); }
+
+fn main() -> int {
+  parallel_for(100, inner);
+  parallel_for(5, outer);
+  puts(strcpy(node_alloc(16), ""));
+  puts(strcpy(node_alloc(4194304), "local"));
+  return numa_nodes() * 10 + numa_node();
+}
+)";
+
+/**
+ * @brief Count the online NUMA nodes.
+ */
+static int onlineNodes() {
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string list;
+  if (!std::getline(online, list) || list.empty())
+    return 1;
+
+  int nodes = 0;
+  for (size_t at = 0; at < list.size();) {
+    size_t stop = list.find(',', at);
+    stop = stop == std::string::npos ? list.size() : stop;
+
+    const std::string range = list.substr(at, stop - at);
+    const size_t dash = range.find('-');
+    nodes += dash == std::string::npos
+                 ? 1
+                 : std::stoi(range.substr(dash + 1)) -
+                       std::stoi(range.substr(0, dash)) + 1;
+
+    at = stop + 1;
+  }
+
+  return nodes;
+}
+
+TEST(PoolTest, TestLowersBuiltins) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  const Result result = compile(SOURCE, options);
+  ASSERT_TRUE(result.success());
+  ASSERT_THAT(result.output,
+              HasSubstr("call void @verte_parallel_for(i32 100, void (i32)* "
+                        "@inner)"));
+  ASSERT_THAT(result.output, HasSubstr("call ptr @verte_node_alloc(i64 16)"));
+  ASSERT_THAT(result.output, HasSubstr("call i32 @verte_numa_nodes()"));
+}
+
+TEST(PoolTest, TestRejectsInvalidBodies) {
+  Result result = compile(R"(fn body(i: int) -> int { return i; }
+fn main() -> int { parallel_for(10, body); return 0; })");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("expects the name of a `fn(int) -> void`"));
+
+  result = compile("fn main() -> int { parallel_for(10); return 0; }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("expects a count and a function"));
+
+  result = compile("fn main() -> int { return numa_node(1); }");
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("`numa_node` expects 0 argument(s)"));
+}
+
+TEST(PoolTest, TestRunsEveryIteration) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-pool-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+
+  const Result result = compile(SOURCE);
+  ASSERT_TRUE(result.success());
+
+  const auto object = directory / "a.o";
+  const auto executable = directory / "a.out";
+  std::ofstream(object, std::ios::binary) << result.output;
+
+  codegen::Compiler linker;
+  ASSERT_TRUE(linker.link({object.string()}, executable.string()));
+
+  // More workers than CPUs are capped, ask for several anyway.
+  const auto command =
+      std::format("VERTE_POOL_THREADS=4 {}", executable.string());
+  FILE *pipe = popen(command.c_str(), "r");
+  ASSERT_NE(pipe, nullptr);
+
+  std::string output;
+  for (int c; (c = std::fgetc(pipe)) != EOF;)
+    output += static_cast<char>(c);
+
+  const int status = pclose(pipe);
+  std::filesystem::remove_all(directory);
+
+  ASSERT_TRUE(WIFEXITED(status));
+
+  // Nodes without CPUs, i.e only memory, get no workers.
+  const int nodes = WEXITSTATUS(status) / 10;
+  ASSERT_GE(nodes, 1);
+  ASSERT_LE(nodes, onlineNodes());
+  ASSERT_LT(WEXITSTATUS(status) % 10, nodes);
+  ASSERT_EQ(output, std::string(120, 'A') + "\nlocal\n");
+}
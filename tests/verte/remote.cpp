@@ -0,0 +1,134 @@
+#include "verte/driver/remote.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ::testing;
+using namespace verte;
+
+/**
+ * @class WorkerPool
+ * @brief Workers listening on free localhost ports, served by threads.
+ */
+class WorkerPool {
+public:
+  explicit WorkerPool(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      auto *worker = workers
+                         .emplace_back(std::make_unique<remote::Worker>(
+                             utils::Endpoint{"127.0.0.1", 0}, 2))
+                         .get();
+
+      threads.emplace_back([worker] { worker->run(); });
+      endpoints.push_back({"127.0.0.1", worker->getPort()});
+    }
+  }
+
+  ~WorkerPool() {
+    for (auto &worker : workers)
+      worker->stop();
+
+    for (auto &thread : threads)
+      thread.join();
+  }
+
+  std::vector<std::unique_ptr<remote::Worker>> workers;
+  std::vector<std::thread> threads;
+  std::vector<utils::Endpoint> endpoints;
+};
+
+TEST(RemoteTest, TestEndpointParse) {
+  auto endpoint = utils::Endpoint::parse("localhost:7890");
+  ASSERT_TRUE(endpoint);
+  ASSERT_EQ(endpoint->host, "localhost");
+  ASSERT_EQ(endpoint->port, 7890);
+
+  ASSERT_FALSE(utils::Endpoint::parse("localhost"));
+  ASSERT_FALSE(utils::Endpoint::parse("localhost:99999"));
+}
+
+TEST(RemoteTest, TestJobsMatchLocalCompile) {
+  WorkerPool pool(3);
+  remote::Scheduler scheduler(pool.endpoints);
+  ASSERT_EQ(scheduler.healthyWorkers(), 3u);
+
+  Options options;
+  options.output = OutputKind::IR;
+
+  // Compile from several threads, spreading the jobs over the pool.
+  constexpr int JOBS = 12;
+  std::vector<Result> results(JOBS);
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < JOBS; ++i) {
+    threads.emplace_back([&, i] {
+      auto source = std::format("fn f(x: int) -> int {{ return x * {}; }}", i);
+      results[i] = scheduler.compile(source, options);
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (int i = 0; i < JOBS; ++i) {
+    auto source = std::format("fn f(x: int) -> int {{ return x * {}; }}", i);
+    const Result local = compile(source, options);
+
+    ASSERT_TRUE(results[i].success());
+    ASSERT_TRUE(results[i].diagnostics.empty());
+    ASSERT_EQ(results[i].output, local.output);
+  }
+}
+
+TEST(RemoteTest, TestRemoteDiagnostics) {
+  WorkerPool pool(1);
+  remote::Scheduler scheduler(pool.endpoints);
+
+  const Result result = scheduler.compile("fn f( -> int {}");
+  ASSERT_FALSE(result.success());
+  ASSERT_EQ(result.diagnostics.size(), 1u);
+  ASSERT_NE(result.diagnostics[0].line, 0u);
+}
+
+TEST(RemoteTest, TestFallback) {
+  // Reserve a port, then close it so that nothing listens there.
+  uint16_t port;
+  {
+    remote::Worker worker({"127.0.0.1", 0});
+    port = worker.getPort();
+  }
+
+  remote::Scheduler scheduler({{"127.0.0.1", port}});
+  ASSERT_EQ(scheduler.healthyWorkers(), 0u);
+
+  const Result result = scheduler.compile("fn f() -> int { return 1; }");
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(result.diagnostics[0].severity, Diagnostic::Severity::WARNING);
+  ASSERT_THAT(result.output, StartsWith("\x7F"
+                                        "ELF"));
+
+  remote::SchedulerOptions strict;
+  strict.localFallback = false;
+  remote::Scheduler strictScheduler({{"127.0.0.1", port}}, strict);
+  ASSERT_FALSE(strictScheduler.compile("fn f() -> int { return 1; }").success());
+}
+
+TEST(RemoteTest, TestFailover) {
+  WorkerPool pool(2);
+  remote::Scheduler scheduler(pool.endpoints);
+  ASSERT_EQ(scheduler.healthyWorkers(), 2u);
+
+  // Jobs keep going to the remaining worker once one of them is gone.
+  pool.workers[0]->stop();
+  for (int i = 0; i < 4; ++i) {
+    const Result result = scheduler.compile("fn f() -> int { return 1; }");
+    ASSERT_TRUE(result.success());
+    ASSERT_TRUE(result.diagnostics.empty());
+  }
+}
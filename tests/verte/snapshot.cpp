@@ -0,0 +1,147 @@
+#include "verte/driver/compile.hpp"
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace verte;
+
+// The corpus is compiled at every level, each defined function gives one line
+// of the snapshot: its blocks, the allocas mem2reg left, the calls to
+// functions of the module the inliner of -O2 and -O3 left, then its
+// instructions by opcode.
+// The numbers depend on the passes of LLVM, so there is one snapshot per
+// major version. Regenerate it with VERTE_UPDATE_SNAPSHOTS=1 and review the
+// diff like any other change.
+static const std::filesystem::path DIRECTORY = VERTE_SNAPSHOT_DIR;
+
+static std::filesystem::path snapshotPath() {
+  return DIRECTORY / std::format("codegen.llvm{}.txt", LLVM_VERSION_MAJOR);
+}
+
+static std::string describe(const llvm::Function &function) {
+  std::map<std::string, int> opcodes;
+  int allocas = 0;
+  int calls = 0;
+
+  for (const auto &block : function)
+    for (const auto &instruction : block) {
+      opcodes[instruction.getOpcodeName()]++;
+      allocas += llvm::isa<llvm::AllocaInst>(instruction);
+
+      if (const auto *call = llvm::dyn_cast<llvm::CallInst>(&instruction))
+        if (const auto *callee = call->getCalledFunction())
+          calls += !callee->isDeclaration();
+    }
+
+  std::string line = std::format("{} blocks={} allocas={} calls={}",
+                                 function.getName().str(), function.size(),
+                                 allocas, calls);
+
+  for (const auto &[opcode, count] : opcodes)
+    line += std::format(" {}={}", opcode, count);
+
+  return line;
+}
+
+static std::vector<std::string> collect() {
+  std::vector<std::filesystem::path> programs;
+  for (const auto &entry : std::filesystem::directory_iterator(DIRECTORY /
+                                                               "corpus"))
+    programs.push_back(entry.path());
+
+  std::sort(programs.begin(), programs.end());
+
+  std::vector<std::string> lines;
+  for (const auto &program : programs) {
+    std::ifstream file(program);
+    const std::string source((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+    for (unsigned level = 0; level <= 3; ++level) {
+      Options options;
+      options.optLevel = level;
+
+      Result result;
+      llvm::LLVMContext context;
+      auto module = generate(source, context, options, result);
+      EXPECT_TRUE(module) << program;
+      if (!module)
+        continue;
+
+      optimize(*module, options);
+      for (const auto &function : *module)
+        if (!function.isDeclaration())
+          lines.push_back(std::format("{} -O{} {}",
+                                      program.filename().string(), level,
+                                      describe(function)));
+    }
+  }
+
+  return lines;
+}
+
+// Keyed by program, level and function, so a failure names what changed.
+static std::map<std::string, std::string>
+index(const std::vector<std::string> &lines) {
+  std::map<std::string, std::string> functions;
+  for (const auto &line : lines) {
+    std::istringstream words(line);
+    std::string program, level, name;
+    words >> program >> level >> name;
+    functions[program + " " + level + " " + name] = line;
+  }
+
+  return functions;
+}
+
+TEST(SnapshotTest, TestCodegenMatchesSnapshot) {
+  const std::vector<std::string> actual = collect();
+  ASSERT_FALSE(actual.empty());
+
+  if (std::getenv("VERTE_UPDATE_SNAPSHOTS")) {
+    std::ofstream out(snapshotPath());
+    for (const auto &line : actual)
+      out << line << "\n";
+
+    return;
+  }
+
+  // A missing snapshot fails, a skip would let every regression through.
+  std::ifstream file(snapshotPath());
+  ASSERT_TRUE(file) << "No snapshot for LLVM " << LLVM_VERSION_MAJOR
+                    << ", run with VERTE_UPDATE_SNAPSHOTS=1 to record one";
+
+  std::vector<std::string> expected;
+  for (std::string line; std::getline(file, line);)
+    if (!line.empty())
+      expected.push_back(line);
+
+  const auto actualFunctions = index(actual);
+  const auto expectedFunctions = index(expected);
+
+  for (const auto &[key, line] : expectedFunctions) {
+    const auto found = actualFunctions.find(key);
+    if (found == actualFunctions.end())
+      ADD_FAILURE() << "Function disappeared: " << key;
+    else
+      EXPECT_EQ(found->second, line) << "Codegen changed: " << key;
+  }
+
+  for (const auto &[key, line] : actualFunctions)
+    if (!expectedFunctions.contains(key))
+      ADD_FAILURE() << "New function: " << line;
+}
@@ -0,0 +1,146 @@
+#include "verte/driver/stream.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <format>
+#include <sstream>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(const SCALE: int = 3;
+const LIMIT: int = 100;
+
+/* Scales a value,
+   saturating at 100. */
+fn scale(x: int) -> int {
+  y: int = x * SCALE; // Never negative.
+  if [y > LIMIT] then { return LIMIT; } else { return y; }
+}
+
+fn greeting() -> str { return "hello, world"; }
+
+fn twice(x: int) -> int { return scale(x) + scale(LIMIT); }
+)";
+
+/**
+ * @brief Compile a source by streaming it.
+ */
+static std::vector<std::string> run(stream::StreamingCompiler &compiler,
+                                    std::string_view source, Result &result) {
+  std::istringstream in{std::string(source)};
+  std::vector<std::string> outputs;
+
+  result = compiler.compile(
+      in, [&](std::string_view output) { outputs.emplace_back(output); });
+
+  return outputs;
+}
+
+TEST(StreamTest, TestMatchesWholeCompilation) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  // Small chunks cut tokens, comments and strings everywhere.
+  for (size_t chunk : {1, 2, 3, 7, 64}) {
+    stream::StreamingCompiler compiler(options, 1 << 20, chunk);
+    Result result;
+    const auto outputs = run(compiler, SOURCE, result);
+
+    ASSERT_TRUE(result.success()) << result.diagnostics[0].message;
+    ASSERT_EQ(compiler.getStats().items, 5u);
+    ASSERT_EQ(outputs.size(), 1u);
+    ASSERT_EQ(outputs[0], compile(SOURCE, options).output)
+        << "With chunks of " << chunk;
+  }
+}
+
+TEST(StreamTest, TestSplitsModules) {
+  Options options;
+  options.output = OutputKind::IR;
+
+  stream::StreamingCompiler compiler(options, 1);
+  Result result;
+  const auto outputs = run(compiler, SOURCE, result);
+
+  // The constants only flush with the first function.
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(compiler.getStats().modules, 4u);
+  ASSERT_EQ(outputs.size(), 4u);
+
+  ASSERT_THAT(outputs[0], HasSubstr("define i32 @scale"));
+  ASSERT_THAT(outputs[2], HasSubstr("declare i32 @scale(i32)"));
+  ASSERT_THAT(outputs[2], HasSubstr("@LIMIT = external constant i32"));
+  ASSERT_THAT(outputs[2], HasSubstr("define i32 @twice"));
+  ASSERT_THAT(outputs[3], Not(HasSubstr("define")));
+}
+
+TEST(StreamTest, TestSharedHeader) {
+  Options options;
+  options.codegen.shared = true;
+
+  const std::string source = "#[export]\nconst version: int = 3;\n"
+                             "#[export]\nfn add(a: int, b: int) -> int {"
+                             " return a + b + version; }\n";
+
+  stream::StreamingCompiler compiler(options, 1);
+  Result result;
+  run(compiler, source, result);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(result.header, compile(source, options).header);
+}
+
+TEST(StreamTest, TestBoundedMemory) {
+  std::string source;
+  for (int i = 0; i < 2000; ++i)
+    source += std::format("fn f{}(x: int) -> int {{ return x * {}; }}\n", i, i);
+
+  stream::StreamingCompiler compiler({}, 1000, 256);
+  Result result;
+  const auto outputs = run(compiler, source, result);
+
+  ASSERT_TRUE(result.success());
+  ASSERT_EQ(compiler.getStats().items, 2000u);
+  ASSERT_GT(outputs.size(), 4u);
+  ASSERT_LE(compiler.getStats().maxBuffer, 512u);
+  ASSERT_LE(compiler.getStats().maxTokens, 20u);
+}
+
+TEST(StreamTest, TestErrorStopsReading) {
+  std::string source = "fn f() -> str { return \"\\q\"; }\n";
+  for (int i = 0; i < 2000; ++i)
+    source += std::format("fn f{}(x: int) -> int {{ return x * {}; }}\n", i, i);
+
+  // The invalid escape is reported without reading the rest of the stream.
+  stream::StreamingCompiler compiler({}, 1000, 256);
+  Result result;
+  run(compiler, source, result);
+
+  ASSERT_FALSE(result.success());
+  ASSERT_THAT(result.diagnostics[0].message,
+              HasSubstr("Invalid escape sequence"));
+  ASSERT_LE(compiler.getStats().maxBuffer, 512u);
+}
+
+TEST(StreamTest, TestReportsErrors) {
+  const std::string source = std::string(SOURCE) + "\nfn f() -> str {\n"
+                                                   "  return \"unterminated;\n"
+                                                   "}\n";
+
+  stream::StreamingCompiler compiler({}, 1 << 20, 5);
+  Result result;
+  run(compiler, source, result);
+  const Result expected = compile(source);
+
+  ASSERT_FALSE(result.success());
+  ASSERT_EQ(result.diagnostics.size(), 1u);
+  ASSERT_EQ(result.diagnostics[0].message, expected.diagnostics[0].message);
+  ASSERT_EQ(result.diagnostics[0].line, expected.diagnostics[0].line);
+
+  std::istringstream in("fn f() -> int { return g(); }");
+  const Result generated = compiler.compile(in, [](std::string_view) {});
+  ASSERT_THAT(generated.diagnostics[0].message,
+              HasSubstr("Unknown function referenced: g"));
+}
@@ -0,0 +1,101 @@
+#include "verte/driver/watch.hpp"
+#include "verte/frontend/lexer/lexer.hpp"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace ::testing;
+using namespace verte;
+
+static constexpr std::string_view SOURCE = R"(
+const SCALE: int = 3;
+
+#[export]
+fn scale(x: int) -> int {
+  if [x > 0] then { return x * SCALE; } else { return 0; }
+}
+
+fn twice(x: int) -> int { return scale(x) * 2; }
+)";
+
+TEST(WatchTest, TestSplitItems) {
+  lexer::Lexer lexer(SOURCE);
+  const auto tokens = lexer.allTokens();
+  const auto items = watch::splitItems(tokens);
+
+  ASSERT_EQ(items.size(), 3u);
+  ASSERT_TRUE(tokens[items[0].first].is(lexer::Token::Type::CONST));
+  ASSERT_TRUE(tokens[items[1].first].is(lexer::Token::Type::HASH));
+  ASSERT_TRUE(tokens[items[2].first].is(lexer::Token::Type::FN));
+  ASSERT_EQ(items[2].second, tokens.size() - 1);
+}
+
+TEST(WatchTest, TestReuseUnchangedItems) {
+  Options options;
+  options.output = OutputKind::IR;
+  watch::IncrementalCompiler incremental(options);
+
+  const Result first = incremental.compile(SOURCE);
+  ASSERT_TRUE(first.success());
+  ASSERT_EQ(first.output, compile(SOURCE, options).output);
+  ASSERT_EQ(incremental.getStats().reused, 0u);
+
+  // Comments and whitespace are not changes.
+  const Result same = incremental.compile(std::string(SOURCE) + "\n// Done.\n");
+  ASSERT_EQ(same.output, first.output);
+  ASSERT_EQ(incremental.getStats().reused, 3u);
+
+  // Only the edited item is parsed again.
+  std::string edited(SOURCE);
+  edited.replace(edited.find("* 2"), 3, "* 4");
+
+  const Result second = incremental.compile(edited);
+  ASSERT_TRUE(second.success());
+  ASSERT_EQ(second.output, compile(edited, options).output);
+  ASSERT_EQ(incremental.getStats().reused, 2u);
+}
+
+TEST(WatchTest, TestRecoverFromErrors) {
+  Options options;
+  options.output = OutputKind::IR;
+  watch::IncrementalCompiler incremental(options);
+
+  std::string broken(SOURCE);
+  broken.replace(broken.find("* 2;"), 4, "* ;");
+
+  const Result failed = incremental.compile(broken);
+  ASSERT_FALSE(failed.success());
+  ASSERT_NE(failed.diagnostics[0].line, 0u);
+
+  const Result fixed = incremental.compile(SOURCE);
+  ASSERT_TRUE(fixed.success());
+  ASSERT_EQ(fixed.output, compile(SOURCE, options).output);
+}
+
+TEST(WatchTest, TestWatcherSeesSaves) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         std::format("verte-watch-test-{}", getpid());
+  std::filesystem::create_directories(directory);
+  const auto file = directory / "main.vt";
+  std::ofstream(file) << SOURCE;
+
+  watch::Watcher watcher(file);
+  std::thread saver([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // Save by replacing the file, as many editors do.
+    std::ofstream(directory / "main.vt.swp") << "fn f() -> void {}";
+    std::filesystem::rename(directory / "main.vt.swp", file);
+  });
+
+  watcher.wait();
+  saver.join();
+  std::filesystem::remove_all(directory);
+}
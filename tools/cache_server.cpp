@@ -0,0 +1,51 @@
+/**
+ * @brief Reference server of the shared compilation cache.
+ * @file cache_server.cpp
+ */
+
+#include "verte/driver/cache.hpp"
+#include "verte/utils/logger.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <csignal>
+
+using namespace verte;
+
+// clang-format off
+static llvm::cl::opt<std::string> directory{
+  llvm::cl::Positional,
+  llvm::cl::desc("<cache directory>"),
+  llvm::cl::Required};
+
+static llvm::cl::opt<std::string> listen{
+  "listen",
+  llvm::cl::desc("Endpoint to serve the cache on"),
+  llvm::cl::value_desc("host:port"),
+  llvm::cl::init("127.0.0.1:8080")};
+
+static llvm::cl::opt<std::string> prefix{
+  "prefix",
+  llvm::cl::desc("Path the entries are served under"),
+  llvm::cl::init("/v1/cache")};
+// clang-format on
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv, "Verte cache server\n");
+  utils::logging::setLevel(utils::LogLevel::INFO);
+
+  const auto endpoint = utils::Endpoint::parse(listen.getValue());
+  if (!endpoint) {
+    llvm::errs() << "verte-cache-server: error: invalid endpoint, expected "
+                    "`host:port`\n";
+    return -1;
+  }
+
+  // Clients may go away mid-answer.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  cache::Server server(*endpoint, directory.getValue(), prefix.getValue());
+  server.run();
+  return 0;
+}